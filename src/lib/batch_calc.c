@@ -0,0 +1,767 @@
+/*
+Calculate the field of a model on computation points read in batches.
+*/
+
+
+/* Needed for pthreads and sysconf */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #define BATCH_THREADS
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+#include "logger.h"
+#include "parsers.h"
+#include "binpoints.h"
+#include "batch_calc.h"
+
+
+/* Number of batches in the pipeline for each calculating thread */
+#define BATCHES_PER_THREAD 4
+/* Maximum number of calculating threads */
+#define BATCH_MAX_THREADS 256
+/* Maximum size of an input line */
+#define BATCH_LINE_SIZE 10000
+
+
+/* A batch of consecutive input lines (or binary records) */
+typedef struct point_batch_struct
+{
+    long seq; /* position of the batch in the input */
+    int size; /* number of lines (or records) in the batch */
+    int remaining; /* number of chunks still to be calculated */
+    int *ispoint; /* if each line is a point or a comment to be echoed */
+    size_t *lines; /* where each line starts in 'text' */
+    char *text; /* the lines read, without the \n for points */
+    size_t textsize;
+    size_t textcapacity;
+    double *points; /* the 3 coordinates of each point */
+    double *partial; /* all components of the field of each chunk on each
+                        point */
+    double *results; /* the output components on each point */
+    double *records; /* binary output records (input record + results) */
+} POINT_BATCH;
+
+
+/* Calculate all components of the field of a chunk of the model on the points
+of a batch */
+static void calc_batch_chunk(const BATCH_CALC *calc, POINT_BATCH *batch,
+                             int chunk)
+{
+    calc->calc(calc->model, chunk, batch->size, batch->ispoint, batch->points,
+               batch->partial + (size_t)chunk*BATCH_SIZE*calc->ncomponents);
+}
+
+
+/* Add the fields of the chunks on the points of a batch, in the order of the
+chunks, and keep the output components */
+static void sum_batch_chunks(const BATCH_CALC *calc, POINT_BATCH *batch)
+{
+    const double *partial;
+    double *res;
+    int ncomp = calc->ncomponents, k, c, chunk;
+
+    for(k = 0; k < batch->size; k++)
+    {
+        res = batch->results + calc->noutput*k;
+        for(c = 0; c < calc->noutput; c++)
+        {
+            res[c] = 0;
+        }
+        if(!batch->ispoint[k])
+        {
+            continue;
+        }
+        for(chunk = 0; chunk < calc->nchunks; chunk++)
+        {
+            partial = batch->partial +
+                      ((size_t)chunk*BATCH_SIZE + k)*ncomp;
+            for(c = 0; c < calc->noutput; c++)
+            {
+                res[c] += partial[calc->components[c]];
+            }
+        }
+    }
+}
+
+
+/* Free a batch of points */
+static void free_point_batch(POINT_BATCH *batch)
+{
+    if(batch == NULL)
+    {
+        return;
+    }
+    free(batch->ispoint);
+    free(batch->lines);
+    free(batch->text);
+    free(batch->points);
+    free(batch->partial);
+    free(batch->results);
+    free(batch->records);
+    free(batch);
+}
+
+
+/* Allocate a batch of points for a calculation. Returns NULL if there isn't
+enough memory. */
+static POINT_BATCH * new_point_batch(const BATCH_CALC *calc,
+                                     const BATCH_OUTPUT *output)
+{
+    int ncols = output->ncols;
+    POINT_BATCH *batch;
+
+    batch = (POINT_BATCH *)malloc(sizeof(POINT_BATCH));
+    if(batch == NULL)
+    {
+        return NULL;
+    }
+    batch->seq = 0;
+    batch->size = 0;
+    batch->remaining = 0;
+    batch->textsize = 0;
+    batch->textcapacity = 2*BATCH_LINE_SIZE;
+    batch->ispoint = (int *)malloc(BATCH_SIZE*sizeof(int));
+    batch->lines = (size_t *)malloc(BATCH_SIZE*sizeof(size_t));
+    batch->points = (double *)malloc(3*BATCH_SIZE*sizeof(double));
+    batch->partial = (double *)malloc(
+        (size_t)calc->nchunks*BATCH_SIZE*calc->ncomponents*sizeof(double));
+    batch->results = (double *)malloc(
+        BATCH_SIZE*output->ncomponents*sizeof(double));
+    batch->text = NULL;
+    batch->records = NULL;
+    if(ncols > 0)
+    {
+        batch->records = (double *)malloc(
+            (ncols + output->ncomponents)*BATCH_SIZE*sizeof(double));
+    }
+    else
+    {
+        batch->text = (char *)malloc(batch->textcapacity);
+    }
+    if(batch->ispoint == NULL || batch->lines == NULL ||
+       batch->points == NULL || batch->partial == NULL ||
+       batch->results == NULL || (ncols > 0 && batch->records == NULL) ||
+       (ncols == 0 && batch->text == NULL))
+    {
+        free_point_batch(batch);
+        return NULL;
+    }
+    return batch;
+}
+
+
+/* Make room for another line in the text of a batch. Returns where the line
+should go or NULL if there isn't enough memory. */
+static char * point_batch_line(POINT_BATCH *batch)
+{
+    char *text;
+
+    if(batch->textcapacity - batch->textsize < BATCH_LINE_SIZE)
+    {
+        text = (char *)realloc(batch->text, 2*batch->textcapacity);
+        if(text == NULL)
+        {
+            log_error("problem allocating memory for the computation points");
+            return NULL;
+        }
+        batch->text = text;
+        batch->textcapacity *= 2;
+    }
+    return batch->text + batch->textsize;
+}
+
+
+/* Read the next batch of points (or make them if using a grid). Comments and
+blank lines are kept in the batch so that they are echoed in the same place of
+the output. Bad lines are skipped. Returns the number of lines (or records) in
+the batch. */
+static int read_point_batch(BATCH_INPUT *input, const BATCH_OUTPUT *output,
+                            POINT_BATCH *batch)
+{
+    const double *record;
+    double *point;
+    char *buff = NULL;
+    int ncols = output->ncols + output->ncomponents, nchars;
+
+    batch->size = 0;
+    batch->textsize = 0;
+    while(batch->size < BATCH_SIZE && !input->eof)
+    {
+        point = batch->points + 3*batch->size;
+        batch->ispoint[batch->size] = 1;
+        if(input->binin != NULL)
+        {
+            record = read_binpoint(input->binin);
+            if(record == NULL)
+            {
+                input->error = input->binin->error;
+                input->eof = 1;
+                break;
+            }
+            memcpy(batch->records + ncols*batch->size, record,
+                   output->ncols*sizeof(double));
+            memcpy(point, record, 3*sizeof(double));
+            input->npoints++;
+            batch->size++;
+            continue;
+        }
+        if(batch->text != NULL)
+        {
+            buff = point_batch_line(batch);
+            if(buff == NULL)
+            {
+                input->error = 1;
+                input->eof = 1;
+                break;
+            }
+        }
+        if(input->grid != NULL)
+        {
+            /* Put a blank line after each row of the grid, like tessgrd */
+            if(input->endrow && batch->text != NULL)
+            {
+                input->endrow = 0;
+                strcpy(buff, "\n");
+                batch->ispoint[batch->size] = 0;
+            }
+            else if(input->next == (long)input->grid->nlon*input->grid->nlat)
+            {
+                input->eof = 1;
+                break;
+            }
+            else
+            {
+                points_grid_point(input->grid, input->next, point);
+                input->next++;
+                input->endrow = input->next % input->grid->nlon == 0;
+                input->npoints++;
+                if(batch->text == NULL)
+                {
+                    memcpy(batch->records + ncols*batch->size, point,
+                           3*sizeof(double));
+                    batch->size++;
+                    continue;
+                }
+                format_doubles(buff, point, 3, output->precision);
+            }
+        }
+        else
+        {
+            if(fgets(buff, BATCH_LINE_SIZE, stdin) == NULL)
+            {
+                if(ferror(stdin))
+                {
+                    log_error("problem encountered reading line %d",
+                              input->line + 1);
+                    input->error = 1;
+                }
+                input->eof = 1;
+                break;
+            }
+            input->line++;
+            /* Check for comments and blank lines */
+            if(buff[0] == '#' || buff[0] == '\r' || buff[0] == '\n')
+            {
+                batch->ispoint[batch->size] = 0;
+            }
+            else
+            {
+                if(scan_doubles(buff, point, 3, &nchars) != 3)
+                {
+                    log_warning("bad/invalid computation point at line %d",
+                                input->line);
+                    log_warning("skipping this line and continuing");
+                    input->bad_input++;
+                    continue;
+                }
+                /* Need to remove \n and \r from end of buff first to print
+                   the result in the end */
+                strstrip(buff);
+                input->npoints++;
+            }
+        }
+        batch->lines[batch->size] = batch->textsize;
+        batch->textsize += strlen(buff) + 1;
+        batch->size++;
+    }
+    return batch->size;
+}
+
+
+/* Write the results of a batch to stdout. Returns the number of points
+written. */
+static int write_point_batch(POINT_BATCH *batch, const BATCH_OUTPUT *output)
+{
+    int ncomp = output->ncomponents, ncols = output->ncols + ncomp, k,
+        points = 0;
+
+    if(output->ncols > 0)
+    {
+        for(k = 0; k < batch->size; k++)
+        {
+            memcpy(batch->records + ncols*k + output->ncols,
+                   batch->results + ncomp*k, ncomp*sizeof(double));
+        }
+        fwrite(batch->records, ncols*sizeof(double), batch->size, stdout);
+        return batch->size;
+    }
+    for(k = 0; k < batch->size; k++)
+    {
+        if(!batch->ispoint[k])
+        {
+            fputs(batch->text + batch->lines[k], stdout);
+            continue;
+        }
+        print_doubles(stdout, batch->text + batch->lines[k],
+                      batch->results + ncomp*k, ncomp, output->precision);
+        points++;
+    }
+    return points;
+}
+
+
+/* Read, calculate and write the points one batch at a time. Returns the
+number of points calculated. */
+static long run_batch_serial(const BATCH_CALC *calc, BATCH_INPUT *input,
+                             const BATCH_OUTPUT *output)
+{
+    POINT_BATCH *batch;
+    long points = 0;
+    int chunk;
+
+    batch = new_point_batch(calc, output);
+    if(batch == NULL)
+    {
+        log_error("problem allocating memory for the computation points");
+        input->error = 1;
+        return 0;
+    }
+    while(read_point_batch(input, output, batch) > 0)
+    {
+        for(chunk = 0; chunk < calc->nchunks; chunk++)
+        {
+            calc_batch_chunk(calc, batch, chunk);
+        }
+        sum_batch_chunks(calc, batch);
+        points += write_point_batch(batch, output);
+    }
+    free_point_batch(batch);
+    return points;
+}
+
+
+#ifdef BATCH_THREADS
+/* A chunk of the model to be calculated on a batch. A NULL batch means that
+no more tasks will come. */
+typedef struct batch_task_struct
+{
+    POINT_BATCH *batch;
+    int chunk;
+} BATCH_TASK;
+
+
+/* Queue of tasks passed between the threads of the pipeline. There are never
+more tasks than the capacity, so adding doesn't have to wait. */
+typedef struct batch_queue_struct
+{
+    BATCH_TASK *items;
+    int capacity;
+    int first;
+    int count;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+} BATCH_QUEUE;
+
+
+/* The pipeline: one thread reads the batches, several threads calculate the
+chunks of the model on them and the main thread adds the chunks and writes the
+batches in the order of the input. */
+typedef struct batch_pipeline_struct
+{
+    BATCH_QUEUE empty; /* batches free to be read into */
+    BATCH_QUEUE read; /* chunks of the batches waiting to be calculated */
+    BATCH_QUEUE done; /* batches waiting to be written */
+    pthread_mutex_t lock; /* for the remaining chunks of the batches */
+    const BATCH_CALC *calc;
+    BATCH_INPUT *input;
+    const BATCH_OUTPUT *output;
+    int nworkers;
+} BATCH_PIPELINE;
+
+
+/* Initialize a queue. Returns 1 if there wasn't enough memory. */
+static int init_batch_queue(BATCH_QUEUE *queue, int capacity)
+{
+    queue->items = (BATCH_TASK *)malloc(capacity*sizeof(BATCH_TASK));
+    if(queue->items == NULL)
+    {
+        return 1;
+    }
+    queue->capacity = capacity;
+    queue->first = 0;
+    queue->count = 0;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->ready, NULL);
+    return 0;
+}
+
+
+/* Free the memory of a queue */
+static void free_batch_queue(BATCH_QUEUE *queue)
+{
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->ready);
+    free(queue->items);
+}
+
+
+/* Add a task to the end of a queue */
+static void batch_queue_push(BATCH_QUEUE *queue, POINT_BATCH *batch,
+                             int chunk)
+{
+    BATCH_TASK *task;
+
+    pthread_mutex_lock(&queue->lock);
+    task = &queue->items[(queue->first + queue->count) % queue->capacity];
+    task->batch = batch;
+    task->chunk = chunk;
+    queue->count++;
+    pthread_cond_signal(&queue->ready);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+/* Remove the task in the start of a queue. Waits if the queue is empty. */
+static BATCH_TASK batch_queue_pop(BATCH_QUEUE *queue)
+{
+    BATCH_TASK task;
+
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0)
+    {
+        pthread_cond_wait(&queue->ready, &queue->lock);
+    }
+    task = queue->items[queue->first];
+    queue->first = (queue->first + 1) % queue->capacity;
+    queue->count--;
+    pthread_mutex_unlock(&queue->lock);
+    return task;
+}
+
+
+/* Thread that reads the batches of points */
+static void * batch_reader(void *arg)
+{
+    BATCH_PIPELINE *pipeline = (BATCH_PIPELINE *)arg;
+    POINT_BATCH *batch;
+    long seq;
+    int k;
+
+    for(seq = 0; !pipeline->input->eof; seq++)
+    {
+        batch = batch_queue_pop(&pipeline->empty).batch;
+        batch->seq = seq;
+        if(read_point_batch(pipeline->input, pipeline->output, batch) == 0)
+        {
+            batch_queue_push(&pipeline->empty, batch, 0);
+            break;
+        }
+        batch->remaining = pipeline->calc->nchunks;
+        for(k = 0; k < pipeline->calc->nchunks; k++)
+        {
+            batch_queue_push(&pipeline->read, batch, k);
+        }
+    }
+    /* Tell each calculating thread to stop */
+    for(k = 0; k < pipeline->nworkers; k++)
+    {
+        batch_queue_push(&pipeline->read, NULL, 0);
+    }
+    return NULL;
+}
+
+
+/* Thread that calculates the chunks of the model on the batches of points.
+The thread that calculates the last chunk of a batch adds the chunks. */
+static void * batch_worker(void *arg)
+{
+    BATCH_PIPELINE *pipeline = (BATCH_PIPELINE *)arg;
+    BATCH_TASK task;
+    int last;
+
+    for(;;)
+    {
+        task = batch_queue_pop(&pipeline->read);
+        if(task.batch == NULL)
+        {
+            batch_queue_push(&pipeline->done, NULL, 0);
+            return NULL;
+        }
+        calc_batch_chunk(pipeline->calc, task.batch, task.chunk);
+        pthread_mutex_lock(&pipeline->lock);
+        task.batch->remaining--;
+        last = task.batch->remaining == 0;
+        pthread_mutex_unlock(&pipeline->lock);
+        if(last)
+        {
+            sum_batch_chunks(pipeline->calc, task.batch);
+            batch_queue_push(&pipeline->done, task.batch, 0);
+        }
+    }
+}
+
+
+/* Read, calculate and write the points using a pipeline of threads. Returns
+the number of points calculated or -1 if the threads couldn't be started
+(before reading any input). */
+static long run_batch_pipeline(const BATCH_CALC *calc, int nthreads,
+                               BATCH_INPUT *input, const BATCH_OUTPUT *output)
+{
+    BATCH_PIPELINE pipeline;
+    pthread_t threads[BATCH_MAX_THREADS], reader;
+    POINT_BATCH **pending = NULL, *batch;
+    long next = 0, points = 0;
+    int nbatches, nstarted = 0, finished, k, rc = 0;
+
+    nbatches = BATCHES_PER_THREAD*nthreads;
+    if(init_batch_queue(&pipeline.empty, nbatches))
+    {
+        return -1;
+    }
+    if(init_batch_queue(&pipeline.read, nbatches*calc->nchunks + nthreads))
+    {
+        free_batch_queue(&pipeline.empty);
+        return -1;
+    }
+    if(init_batch_queue(&pipeline.done, nbatches + nthreads))
+    {
+        free_batch_queue(&pipeline.empty);
+        free_batch_queue(&pipeline.read);
+        return -1;
+    }
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pipeline.calc = calc;
+    pipeline.input = input;
+    pipeline.output = output;
+    /* Batches waiting for the ones before them to be written */
+    pending = (POINT_BATCH **)calloc(nbatches, sizeof(POINT_BATCH *));
+    rc = pending == NULL;
+    for(k = 0; k < nbatches && !rc; k++)
+    {
+        batch = new_point_batch(calc, output);
+        if(batch == NULL)
+        {
+            rc = 1;
+            break;
+        }
+        batch_queue_push(&pipeline.empty, batch, 0);
+    }
+    if(!rc)
+    {
+        for(nstarted = 0; nstarted < nthreads; nstarted++)
+        {
+            if(pthread_create(&threads[nstarted], NULL, batch_worker,
+                              &pipeline) != 0)
+            {
+                break;
+            }
+        }
+        pipeline.nworkers = nstarted;
+        rc = nstarted == 0 ||
+             pthread_create(&reader, NULL, batch_reader, &pipeline) != 0;
+    }
+    if(rc)
+    {
+        /* Stop the calculating threads that were started */
+        for(k = 0; k < nstarted; k++)
+        {
+            batch_queue_push(&pipeline.read, NULL, 0);
+        }
+        for(k = 0; k < nstarted; k++)
+        {
+            pthread_join(threads[k], NULL);
+        }
+        points = -1;
+    }
+    else
+    {
+        log_info("Calculating with %d thread(s)", nstarted);
+        /* Write the batches in order as they are calculated */
+        for(finished = 0; finished < nstarted; )
+        {
+            batch = batch_queue_pop(&pipeline.done).batch;
+            if(batch == NULL)
+            {
+                finished++;
+                continue;
+            }
+            pending[batch->seq % nbatches] = batch;
+            while(pending[next % nbatches] != NULL)
+            {
+                batch = pending[next % nbatches];
+                pending[next % nbatches] = NULL;
+                points += write_point_batch(batch, output);
+                batch_queue_push(&pipeline.empty, batch, 0);
+                next++;
+            }
+        }
+        pthread_join(reader, NULL);
+        for(k = 0; k < nstarted; k++)
+        {
+            pthread_join(threads[k], NULL);
+        }
+    }
+    while(pipeline.empty.count > 0)
+    {
+        free_point_batch(batch_queue_pop(&pipeline.empty).batch);
+    }
+    free(pending);
+    pthread_mutex_destroy(&pipeline.lock);
+    free_batch_queue(&pipeline.empty);
+    free_batch_queue(&pipeline.read);
+    free_batch_queue(&pipeline.done);
+    return points;
+}
+#endif
+
+
+/* Set up where the points come from and where the results go */
+int open_batch_io(const BASIC_ARGS *args, int ncomponents, BATCH_INPUT *input,
+                  BATCH_OUTPUT *output)
+{
+    input->grid = args->grid.parsed ? &args->grid : NULL;
+    input->next = 0;
+    input->endrow = 0;
+    input->binin = NULL;
+    input->line = 0;
+    input->npoints = 0;
+    input->bad_input = 0;
+    input->eof = 0;
+    input->error = 0;
+    output->ncols = 0;
+    output->ncomponents = ncomponents;
+    output->precision = args->precision;
+
+    /* Write the output in large blocks */
+    setvbuf(stdout, NULL, _IOFBF, 65536);
+    /* Binary output only has the header of the records */
+    if(args->binary && args->grid.parsed)
+    {
+        output->ncols = 3;
+        write_binpoints_header(stdout, 3 + ncomponents);
+    }
+    else if(args->binary)
+    {
+        input->binin = open_binpoints(stdin);
+        if(input->binin == NULL || input->binin->ncols < 3)
+        {
+            log_error("invalid binary input. Needs at least 3 values per "
+                      "record");
+            return 1;
+        }
+        output->ncols = input->binin->ncols;
+        write_binpoints_header(stdout, input->binin->ncols + ncomponents);
+    }
+    return 0;
+}
+
+
+/* Free what open_batch_io() allocated */
+void close_batch_io(BATCH_INPUT *input)
+{
+    if(input->binin != NULL)
+    {
+        close_binpoints(input->binin);
+        input->binin = NULL;
+    }
+}
+
+
+/* Read each computation point, calculate the field of the model on it and
+write the results */
+long run_batch_calc(const BATCH_CALC *calc, int nthreads, BATCH_INPUT *input,
+                    const BATCH_OUTPUT *output)
+{
+    long points = -1;
+
+#ifdef BATCH_THREADS
+    if(nthreads == 0)
+    {
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if(nthreads > BATCH_MAX_THREADS)
+    {
+        nthreads = BATCH_MAX_THREADS;
+    }
+    if(nthreads > 1)
+    {
+        points = run_batch_pipeline(calc, nthreads, input, output);
+        if(points < 0)
+        {
+            log_warning("failed to start the calculating threads. "
+                        "Calculating with a single thread");
+        }
+    }
+#else
+    if(nthreads > 1)
+    {
+        log_warning("threads aren't supported on this system. "
+                    "Calculating with a single thread");
+    }
+#endif
+    if(points < 0)
+    {
+        points = run_batch_serial(calc, input, output);
+    }
+    return points;
+}
+
+
+/* Find the components given in a list (option -s) in the names of the
+components of a field */
+int find_components(const char *list, const char *const *names, int n,
+                    int *components)
+{
+    const char *name = list, *end;
+    size_t len;
+    int found = 0, c, k;
+
+    for(;;)
+    {
+        end = strchr(name, ',');
+        len = end != NULL ? (size_t)(end - name) : strlen(name);
+        for(c = 0; c < n; c++)
+        {
+            if(strlen(names[c]) == len && strncmp(names[c], name, len) == 0)
+            {
+                break;
+            }
+        }
+        if(c == n)
+        {
+            log_error("invalid component '%.*s' in '%s'", (int)len, name,
+                      list);
+            return 0;
+        }
+        for(k = 0; k < found; k++)
+        {
+            if(components[k] == c)
+            {
+                log_error("repeated component '%s' in '%s'", names[c], list);
+                return 0;
+            }
+        }
+        components[found] = c;
+        found++;
+        if(end == NULL)
+        {
+            return found;
+        }
+        name = end + 1;
+    }
+}
@@ -0,0 +1,132 @@
+/*
+Calculate the field of a model on computation points read in batches. Used by
+the generic main functions of the prism and sphere programs.
+
+The computation points are read from stdin in batches of consecutive lines (or
+binary records) or made from a regular grid. The model is split into chunks by
+the caller. Each thread calculates the field of one chunk on all points of a
+batch. The results of the chunks are added in the order of the chunks, so the
+results are the same for any number of threads. Comments and blank lines of
+the input are echoed in the same place of the output, which is written in the
+order of the input.
+*/
+
+
+#ifndef _TESSEROIDS_BATCH_CALC_H_
+#define _TESSEROIDS_BATCH_CALC_H_
+
+
+/* For the definitions of BASIC_ARGS, POINTS_GRID_ARGS and BINPOINTS */
+#include "parsers.h"
+#include "binpoints.h"
+
+
+/** Number of input lines (or binary records) in each batch of points */
+#define BATCH_SIZE 128
+
+
+/** A model split into chunks and how to calculate its field */
+typedef struct batch_calc_struct
+{
+    const void *model; /**< the model, passed to calc */
+    int nchunks; /**< number of chunks of the model */
+    int ncomponents; /**< number of components of the field */
+    void (*calc)(const void *model, int chunk, int npoints,
+                 const int *ispoint, const double *points,
+                 double *results); /**< calculates all components of the field
+                    of a chunk of the model on the points of a batch. points
+                    has the 3 coordinates of each point as read from the
+                    input and results gets the ncomponents components on each
+                    point. Only the points with ispoint[k] != 0 are used.
+                    Called from several threads at the same time */
+    int noutput; /**< number of components in the output */
+    const int *components; /**< index of each output component in the
+                                components of the field */
+} BATCH_CALC;
+
+
+/** Where the computation points are read from (see open_batch_io()) */
+typedef struct batch_input_struct
+{
+    const POINTS_GRID_ARGS *grid; /**< grid of points. NULL if reading stdin */
+    long next; /**< index of the next point of the grid */
+    int endrow; /**< if a row of the grid just ended */
+    BINPOINTS *binin; /**< binary input. NULL if reading text */
+    int line; /**< number of text lines read */
+    long npoints; /**< number of points read */
+    int bad_input; /**< number of bad lines skipped */
+    int eof; /**< if there is nothing left to read */
+    int error; /**< if there was an error reading */
+} BATCH_INPUT;
+
+
+/** Where the results go (see open_batch_io()) */
+typedef struct batch_output_struct
+{
+    int ncols; /**< number of values in the binary input records (3 for a
+                    grid of points). 0 for text */
+    int ncomponents; /**< number of results of each point */
+    int precision; /**< number of significant digits of text output */
+} BATCH_OUTPUT;
+
+
+/** Set up where the points come from and where the results go
+
+The points are made from the grid of options -r, -b and -z if it was given or
+read from stdin. With option --binary, reads the header of the binary input
+and writes the header of the binary output. The header of text output is left
+to the caller.
+
+@param args the parsed arguments of the program
+@param ncomponents number of results of each point
+@param input used to return where the points come from
+@param output used to return where the results go
+
+@return 0 if all went well. 1 if the binary input is invalid (logs the error).
+*/
+extern int open_batch_io(const BASIC_ARGS *args, int ncomponents,
+                         BATCH_INPUT *input, BATCH_OUTPUT *output);
+
+
+/** Free the memory allocated by open_batch_io()
+
+@param input where the points come from
+*/
+extern void close_batch_io(BATCH_INPUT *input);
+
+
+/** Calculate the field of a model on all the computation points
+
+Reads each point, calculates the field of all chunks of the model on it and
+writes the results to stdout.
+
+@param calc the model and how to calculate its field
+@param nthreads number of calculating threads. 0 to use the number of
+                processors. Uses a single thread if threads aren't supported
+                or can't be started
+@param input where the points come from. input->error is set if there was an
+             error reading the points (logs the error)
+@param output where the results go
+
+@return the number of points calculated
+*/
+extern long run_batch_calc(const BATCH_CALC *calc, int nthreads,
+                           BATCH_INPUT *input, const BATCH_OUTPUT *output);
+
+
+/** Find the components given in a list (option -s) in the names of the
+components of a field
+
+@param list names of the components separated by commas
+@param names names of all the components of the field
+@param n number of components of the field
+@param components used to return the index in names of each component of the
+                  list. Must have room for n components
+
+@return the number of components in the list or 0 if one of them is invalid
+        or repeated (logs the error)
+*/
+extern int find_components(const char *list, const char *const *names, int n,
+                           int *components);
+
+#endif
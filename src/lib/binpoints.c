@@ -0,0 +1,272 @@
+/*
+Binary input and output of computation points and results.
+*/
+
+
+/* Needed for mmap, fileno, pwrite (POSIX.1-2008) and ftruncate */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #define BINPOINTS_MMAP
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+#include "logger.h"
+#include "binpoints.h"
+
+
+/* Identifies the binary format in the start of the file */
+#define BINPOINTS_MAGIC "TESSPTS1"
+/* Size of the magic string and the 2 int header */
+#define BINPOINTS_HEADSIZE (8 + 2*sizeof(int))
+
+
+/* Write the header of a binary point file. */
+int write_binpoints_header(FILE *stream, int ncols)
+{
+    int head[2];
+
+    head[0] = ncols;
+    head[1] = 0;
+    if(fwrite(BINPOINTS_MAGIC, 1, 8, stream) != 8 ||
+       fwrite(head, sizeof(int), 2, stream) != 2)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Open a binary point file for reading and read its header. */
+BINPOINTS * open_binpoints(FILE *stream)
+{
+    BINPOINTS *points;
+    char magic[8];
+    int head[2];
+#ifdef BINPOINTS_MMAP
+    struct stat info;
+    void *map;
+#endif
+
+    points = (BINPOINTS *)malloc(sizeof(BINPOINTS));
+    if(points == NULL)
+    {
+        log_error("problem allocating memory for binary input");
+        return NULL;
+    }
+    points->stream = stream;
+    points->record = NULL;
+    points->map = NULL;
+    points->mapsize = 0;
+    points->offset = 0;
+    points->error = 0;
+#ifdef BINPOINTS_MMAP
+    /* Map regular files. Pipes and terminals are read as streams. */
+    if(ftell(stream) == 0 && fstat(fileno(stream), &info) == 0 &&
+       S_ISREG(info.st_mode) && info.st_size >= (off_t)BINPOINTS_HEADSIZE)
+    {
+        map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE,
+                   fileno(stream), 0);
+        if(map != MAP_FAILED)
+        {
+            posix_madvise(map, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+            points->map = (char *)map;
+            points->mapsize = (size_t)info.st_size;
+        }
+    }
+#endif
+    if(points->map != NULL)
+    {
+        memcpy(magic, points->map, 8);
+        memcpy(head, points->map + 8, 2*sizeof(int));
+        points->offset = BINPOINTS_HEADSIZE;
+    }
+    else if(fread(magic, 1, 8, stream) != 8 ||
+            fread(head, sizeof(int), 2, stream) != 2)
+    {
+        log_error("failed to read the header of the binary input");
+        free(points);
+        return NULL;
+    }
+    points->ncols = head[0];
+    if(strncmp(magic, BINPOINTS_MAGIC, 8) != 0 || points->ncols <= 0)
+    {
+        log_error("invalid header in the binary input");
+        close_binpoints(points);
+        return NULL;
+    }
+    points->record = (double *)malloc(points->ncols*sizeof(double));
+    if(points->record == NULL)
+    {
+        log_error("problem allocating memory for binary input");
+        close_binpoints(points);
+        return NULL;
+    }
+    return points;
+}
+
+
+/* Read the next record of a binary point file. */
+const double * read_binpoint(BINPOINTS *points)
+{
+    size_t recsize = points->ncols*sizeof(double), nread;
+    const double *record;
+
+    if(points->map != NULL)
+    {
+        if(points->offset == points->mapsize)
+        {
+            return NULL;
+        }
+        if(points->mapsize - points->offset < recsize)
+        {
+            log_error("incomplete record in the end of the binary input");
+            points->error = 1;
+            return NULL;
+        }
+        record = (const double *)(points->map + points->offset);
+        points->offset += recsize;
+        return record;
+    }
+    nread = fread(points->record, 1, recsize, points->stream);
+    if(nread == 0 && ferror(points->stream))
+    {
+        log_error("problem reading the binary input");
+        points->error = 1;
+        return NULL;
+    }
+    if(nread == 0)
+    {
+        return NULL;
+    }
+    if(nread != recsize)
+    {
+        log_error("incomplete record in the end of the binary input");
+        points->error = 1;
+        return NULL;
+    }
+    return points->record;
+}
+
+
+/* Close a binary point file opened with open_binpoints(). */
+void close_binpoints(BINPOINTS *points)
+{
+#ifdef BINPOINTS_MMAP
+    if(points->map != NULL)
+    {
+        munmap(points->map, points->mapsize);
+    }
+#endif
+    free(points->record);
+    free(points);
+}
+
+
+/* Create a binary result file and write its header. */
+BINRESULTS * create_binresults(const char *fname, int ncols, long nrecords)
+{
+    BINRESULTS *results;
+
+    results = (BINRESULTS *)malloc(sizeof(BINRESULTS));
+    if(results == NULL)
+    {
+        log_error("problem allocating memory for binary output");
+        return NULL;
+    }
+    results->ncols = ncols;
+    results->error = 0;
+    results->stream = fopen(fname, "wb");
+    if(results->stream == NULL)
+    {
+        log_error("unable to create file %s", fname);
+        free(results);
+        return NULL;
+    }
+    /* The records are written directly to the file descriptor, so the header
+     * can't stay in the buffer of the stream */
+    if(write_binpoints_header(results->stream, ncols) != 0 ||
+       fflush(results->stream) != 0)
+    {
+        log_error("failed to write the header of file %s", fname);
+        fclose(results->stream);
+        free(results);
+        return NULL;
+    }
+#ifdef BINPOINTS_MMAP
+    if(nrecords > 0 &&
+       ftruncate(fileno(results->stream), (off_t)BINPOINTS_HEADSIZE +
+                 (off_t)nrecords*ncols*sizeof(double)) != 0)
+    {
+        log_warning("couldn't set the size of file %s", fname);
+    }
+#endif
+    return results;
+}
+
+
+/* Write consecutive records to a binary result file. */
+int write_binresults(BINRESULTS *results, long first, const double *records,
+                     int n)
+{
+    size_t nbytes = (size_t)n*results->ncols*sizeof(double);
+#ifdef BINPOINTS_MMAP
+    const char *data = (const char *)records;
+    off_t offset;
+    ssize_t nwritten;
+
+    offset = (off_t)BINPOINTS_HEADSIZE +
+             (off_t)first*results->ncols*sizeof(double);
+    while(nbytes > 0)
+    {
+        nwritten = pwrite(fileno(results->stream), data, nbytes, offset);
+        if(nwritten <= 0)
+        {
+            results->error = 1;
+            return 1;
+        }
+        data += nwritten;
+        offset += nwritten;
+        nbytes -= (size_t)nwritten;
+    }
+#else
+    if(fseek(results->stream, (long)BINPOINTS_HEADSIZE +
+             first*results->ncols*(long)sizeof(double), SEEK_SET) != 0 ||
+       fwrite(records, 1, nbytes, results->stream) != nbytes)
+    {
+        results->error = 1;
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+
+/* Close a binary result file created with create_binresults(). */
+int close_binresults(BINRESULTS *results, long nrecords)
+{
+    int error = results->error;
+
+#ifdef BINPOINTS_MMAP
+    if(ftruncate(fileno(results->stream), (off_t)BINPOINTS_HEADSIZE +
+                 (off_t)nrecords*results->ncols*sizeof(double)) != 0)
+    {
+        error = 1;
+    }
+#endif
+    if(fclose(results->stream) != 0)
+    {
+        error = 1;
+    }
+    free(results);
+    if(error)
+    {
+        log_error("failed to write the results to the binary file");
+    }
+    return error;
+}
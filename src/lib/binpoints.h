@@ -0,0 +1,156 @@
+/*
+Binary input and output of computation points and results.
+
+A binary point file (or stream) has a small header followed by fixed size
+records of double precision numbers (native byte order):
+
+    - 8 bytes with the string TESSPTS1
+    - int: number of values in each record (NCOLS)
+    - int: unused (padding)
+    - the records, each with NCOLS doubles
+
+The first 3 values of a record are the coordinates of a computation point. The
+tessg* and prismg* programs append their result to each record, so their
+output is a binary point file with NCOLS + 1 values per record. This way the
+programs can be piped together without converting the numbers to text.
+
+Input from a regular file is memory mapped where supported. Pipes are read as
+a stream.
+
+A binary result file (see create_binresults()) has the same format, but each
+record is written at a fixed position given by the index of its computation
+point. Several threads can write their records to the file at the same time
+(using pwrite where supported), in any order.
+*/
+
+#ifndef _TESSEROIDS_BINPOINTS_H_
+#define _TESSEROIDS_BINPOINTS_H_
+
+
+/* Need for the definition of FILE */
+#include <stdio.h>
+
+
+/** An open binary point file for reading */
+typedef struct binpoints_struct
+{
+    int ncols; /**< number of values in each record */
+    FILE *stream; /**< the stream being read */
+    double *record; /**< buffer for the records read from the stream */
+    char *map; /**< the memory mapped file. NULL if reading from stream */
+    size_t mapsize; /**< size of the memory mapped file */
+    size_t offset; /**< position of the next record in the mapped file */
+    int error; /**< flag to indicate that the input ended in an incomplete
+                    record or couldn't be read */
+} BINPOINTS;
+
+
+/** A binary result file open for writing */
+typedef struct binresults_struct
+{
+    int ncols; /**< number of values in each record */
+    FILE *stream; /**< the file */
+    int error; /**< flag to indicate that a record couldn't be written */
+} BINRESULTS;
+
+
+/** Write the header of a binary point file.
+
+@param stream open FILE for writing in binary mode
+@param ncols number of values in each record
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there was an error writing the header
+*/
+extern int write_binpoints_header(FILE *stream, int ncols);
+
+
+/** Open a binary point file for reading and read its header.
+
+If the stream is a regular file that hasn't been read yet, it is memory
+mapped. Otherwise, it is read record by record.
+
+<b>WARNING</b>: Don't forget to close using close_binpoints()!
+
+@param stream open FILE for reading in binary mode
+
+@return pointer to the open file. NULL if the header is invalid or there was
+        an error allocating memory.
+*/
+extern BINPOINTS * open_binpoints(FILE *stream);
+
+
+/** Read the next record of a binary point file.
+
+@param points the open binary point file
+
+@return pointer to the ncols values of the record. Valid until the next call.
+        NULL if there are no more records or if the last record is
+        incomplete or couldn't be read (logs an error and sets
+        points->error).
+*/
+extern const double * read_binpoint(BINPOINTS *points);
+
+
+/** Close a binary point file opened with open_binpoints().
+
+Doesn't close the stream.
+
+@param points the open binary point file
+*/
+extern void close_binpoints(BINPOINTS *points);
+
+
+
+/** Create a binary result file and write its header.
+
+If the number of records is known, the file is made large enough for all of
+them from the start.
+
+<b>WARNING</b>: Don't forget to close using close_binresults()!
+
+@param fname name of the file
+@param ncols number of values in each record
+@param nrecords number of records the file will have. Use 0 if not known.
+
+@return pointer to the open file. NULL if the file can't be created (logs an
+        error).
+*/
+extern BINRESULTS * create_binresults(const char *fname, int ncols,
+                                      long nrecords);
+
+
+/** Write consecutive records to a binary result file.
+
+Where pwrite is supported, can be called from several threads at the same
+time. Otherwise, only from one thread.
+
+@param results the open binary result file
+@param first index of the first record (the first record of the file is 0)
+@param records the values of the records (ncols for each record)
+@param n number of records to write
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there was an error writing (also sets results->error)
+*/
+extern int write_binresults(BINRESULTS *results, long first,
+                            const double *records, int n);
+
+
+/** Close a binary result file created with create_binresults().
+
+Sets the size of the file to the header plus 'nrecords' records.
+
+@param results the open binary result file
+@param nrecords number of records written
+
+@return Return code:
+    - 0: if all went well
+    - 1: if any of the records couldn't be written (logs an error)
+*/
+extern int close_binresults(BINRESULTS *results, long nrecords);
+
+
+#endif
@@ -8,6 +8,7 @@ Defines the TESSEROID, SPHERE, and PRISM structures.
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <limits.h>
 #include "constants.h"
 #include "logger.h"
 #include "geometry.h"
@@ -43,11 +44,415 @@ int split_tess(TESSEROID tess, int nlon, int nlat, int nr, TESSEROID *split)
 }
 
 
+/* Find the vertical columns of tesseroids in a model. */
+long tess_find_columns(TESSEROID *model, long size, long *columns)
+{
+    long i, ncols = 0;
+
+    for(i = 0; i < size; i++)
+    {
+        if(i == 0 ||
+           model[i].w != model[i - 1].w || model[i].e != model[i - 1].e ||
+           model[i].s != model[i - 1].s || model[i].n != model[i - 1].n)
+        {
+            columns[ncols] = i;
+            ncols++;
+        }
+    }
+    columns[ncols] = size;
+    return ncols;
+}
+
+
+/* Make a new TESS_GRID structure and allocate memory for the cells. */
+TESS_GRID * new_tess_grid(double w, double s, double dlon, double dlat,
+                          int nlon, int nlat, int nlayers)
+{
+    TESS_GRID *grid;
+
+    grid = (TESS_GRID *)malloc(sizeof(TESS_GRID));
+    if(grid == NULL)
+    {
+        return NULL;
+    }
+    grid->w = w;
+    grid->s = s;
+    grid->dlon = dlon;
+    grid->dlat = dlat;
+    grid->nlon = nlon;
+    grid->nlat = nlat;
+    grid->nlayers = nlayers;
+    grid->radii = (double *)malloc(
+        (size_t)nlon*nlat*(nlayers + 1)*sizeof(double));
+    if(grid->radii == NULL)
+    {
+        free(grid);
+        return NULL;
+    }
+    grid->density = (double *)malloc((size_t)nlon*nlat*nlayers*sizeof(double));
+    if(grid->density == NULL)
+    {
+        free(grid->radii);
+        free(grid);
+        return NULL;
+    }
+    return grid;
+}
+
+
+/* Free the memory allocated by new_tess_grid(). */
+void free_tess_grid(TESS_GRID *grid)
+{
+    free(grid->radii);
+    free(grid->density);
+    free(grid);
+}
+
+
+/* Generate the tesseroids of a cell of a grid model. */
+int tess_grid_column(TESS_GRID *grid, int cell, TESSEROID *column)
+{
+    double w, s, *radii, *density;
+    int l, t = 0;
+
+    w = grid->w + (cell % grid->nlon)*grid->dlon;
+    s = grid->s + (cell / grid->nlon)*grid->dlat;
+    radii = grid->radii + (size_t)cell*(grid->nlayers + 1);
+    density = grid->density + (size_t)cell*grid->nlayers;
+    for(l = 0; l < grid->nlayers; l++)
+    {
+        if(radii[l] == radii[l + 1])
+        {
+            continue;
+        }
+        column[t].w = w;
+        column[t].e = w + grid->dlon;
+        column[t].s = s;
+        column[t].n = s + grid->dlat;
+        column[t].r2 = radii[l];
+        column[t].r1 = radii[l + 1];
+        column[t].density = density[l];
+        t++;
+    }
+    return t;
+}
+
+
+/* Build a multi-resolution pyramid of coarsened grids from a grid model */
+TESS_PYRAMID * new_tess_pyramid(TESS_GRID *grid, int maxlevels)
+{
+    TESS_PYRAMID *pyramid;
+    TESS_GRID *fine, *coarse;
+    double d2r = PI/180., area, weight, volume, mass, top, bottom, rtop,
+           rbottom;
+    int k, i, j, a, b, l, cell, child, nl;
+
+    pyramid = (TESS_PYRAMID *)malloc(sizeof(TESS_PYRAMID));
+    if(pyramid == NULL)
+    {
+        return NULL;
+    }
+    k = 1;
+    while(k < maxlevels && (grid->nlon >> k) > 0 && (grid->nlat >> k) > 0)
+    {
+        k++;
+    }
+    pyramid->levels = (TESS_GRID **)malloc(k*sizeof(TESS_GRID *));
+    if(pyramid->levels == NULL)
+    {
+        free(pyramid);
+        return NULL;
+    }
+    pyramid->levels[0] = grid;
+    nl = grid->nlayers;
+    for(pyramid->nlevels = 1; pyramid->nlevels < k; pyramid->nlevels++)
+    {
+        fine = pyramid->levels[pyramid->nlevels - 1];
+        coarse = new_tess_grid(grid->w, grid->s, 2*fine->dlon, 2*fine->dlat,
+                               grid->nlon >> pyramid->nlevels,
+                               grid->nlat >> pyramid->nlevels, nl);
+        if(coarse == NULL)
+        {
+            free_tess_pyramid(pyramid);
+            return NULL;
+        }
+        pyramid->levels[pyramid->nlevels] = coarse;
+        for(j = 0; j < coarse->nlat; j++)
+        {
+            for(i = 0; i < coarse->nlon; i++)
+            {
+                cell = j*coarse->nlon + i;
+                /* The interfaces are the area weighted mean of the ones of
+                 * the 2 x 2 finer cells */
+                area = 0;
+                for(l = 0; l <= nl; l++)
+                {
+                    coarse->radii[(size_t)cell*(nl + 1) + l] = 0;
+                }
+                for(b = 0; b < 2; b++)
+                {
+                    weight = sin(d2r*(fine->s + (2*j + b + 1)*fine->dlat)) -
+                             sin(d2r*(fine->s + (2*j + b)*fine->dlat));
+                    for(a = 0; a < 2; a++)
+                    {
+                        child = (2*j + b)*fine->nlon + 2*i + a;
+                        for(l = 0; l <= nl; l++)
+                        {
+                            coarse->radii[(size_t)cell*(nl + 1) + l] +=
+                                weight*fine->radii[(size_t)child*(nl + 1) + l];
+                        }
+                        area += weight;
+                    }
+                }
+                for(l = 0; l <= nl; l++)
+                {
+                    coarse->radii[(size_t)cell*(nl + 1) + l] /= area;
+                }
+                /* The density conserves the mass of each layer */
+                for(l = 0; l < nl; l++)
+                {
+                    mass = 0;
+                    for(b = 0; b < 2; b++)
+                    {
+                        weight = sin(d2r*(fine->s + (2*j + b + 1)*fine->dlat))
+                                 - sin(d2r*(fine->s + (2*j + b)*fine->dlat));
+                        for(a = 0; a < 2; a++)
+                        {
+                            child = (2*j + b)*fine->nlon + 2*i + a;
+                            top = fine->radii[(size_t)child*(nl + 1) + l];
+                            bottom = fine->radii[(size_t)child*(nl + 1) + l + 1];
+                            mass += fine->density[(size_t)child*nl + l]*weight*
+                                    (top*top*top - bottom*bottom*bottom);
+                        }
+                    }
+                    rtop = coarse->radii[(size_t)cell*(nl + 1) + l];
+                    rbottom = coarse->radii[(size_t)cell*(nl + 1) + l + 1];
+                    /* Mass and volume without the common factor
+                     * d2r*fine->dlon/3. area is the sum over the 2 x 2 cells,
+                     * which have half the width of the coarse cell. */
+                    volume = area*(rtop*rtop*rtop - rbottom*rbottom*rbottom);
+                    coarse->density[(size_t)cell*nl + l] =
+                        volume > 0 ? mass/volume : 0;
+                }
+            }
+        }
+    }
+    return pyramid;
+}
+
+
+/* Free the memory allocated by new_tess_pyramid(). */
+void free_tess_pyramid(TESS_PYRAMID *pyramid)
+{
+    int k;
+
+    for(k = 1; k < pyramid->nlevels; k++)
+    {
+        free_tess_grid(pyramid->levels[k]);
+    }
+    free(pyramid->levels);
+    free(pyramid);
+}
+
+
+/* Build a lon/lat spatial index of the columns of a tesseroid model. */
+TESS_INDEX * new_tess_index(TESSEROID *model, long *columns, long ncolumns,
+                            double minsize)
+{
+    TESS_INDEX *index;
+    double minlon, maxlon, minlat, maxlat, size, nlon, nlat;
+    long c, b, *count;
+
+    index = (TESS_INDEX *)malloc(sizeof(TESS_INDEX));
+    if(index == NULL)
+    {
+        return NULL;
+    }
+    index->lon = (double *)malloc(ncolumns*sizeof(double));
+    index->lat = (double *)malloc(ncolumns*sizeof(double));
+    index->items = (long *)malloc(ncolumns*sizeof(long));
+    if(index->lon == NULL || index->lat == NULL || index->items == NULL)
+    {
+        free(index->lon);
+        free(index->lat);
+        free(index->items);
+        free(index);
+        return NULL;
+    }
+    minlon = maxlon = 0.5*(model[0].w + model[0].e);
+    minlat = maxlat = 0.5*(model[0].s + model[0].n);
+    for(c = 0; c < ncolumns; c++)
+    {
+        index->lon[c] = 0.5*(model[columns[c]].w + model[columns[c]].e);
+        index->lat[c] = 0.5*(model[columns[c]].s + model[columns[c]].n);
+        if(index->lon[c] < minlon)
+            minlon = index->lon[c];
+        if(index->lon[c] > maxlon)
+            maxlon = index->lon[c];
+        if(index->lat[c] < minlat)
+            minlat = index->lat[c];
+        if(index->lat[c] > maxlat)
+            maxlat = index->lat[c];
+    }
+    /* Don't make more buckets than columns. The area is zero if the columns
+     * are on a meridian or a parallel, so also don't make more buckets than
+     * columns along each dimension. */
+    size = sqrt((maxlon - minlon)*(maxlat - minlat)/ncolumns);
+    if(size < minsize)
+    {
+        size = minsize;
+    }
+    index->dlon = size;
+    index->dlat = size;
+    if(index->dlon < (maxlon - minlon)/ncolumns)
+    {
+        index->dlon = (maxlon - minlon)/ncolumns;
+    }
+    if(index->dlat < (maxlat - minlat)/ncolumns)
+    {
+        index->dlat = (maxlat - minlat)/ncolumns;
+    }
+    if(index->dlon <= 0)
+    {
+        index->dlon = 1;
+    }
+    if(index->dlat <= 0)
+    {
+        index->dlat = 1;
+    }
+    /* That gives at most 3*ncolumns + 1 buckets. Check anyway that they can
+     * be counted. */
+    nlon = floor((maxlon - minlon)/index->dlon) + 1;
+    nlat = floor((maxlat - minlat)/index->dlat) + 1;
+    if(nlon*nlat > 3.0*ncolumns + 1 || nlon*nlat >= INT_MAX)
+    {
+        index->start = NULL;
+        free_tess_index(index);
+        return NULL;
+    }
+    index->w = minlon;
+    index->s = minlat;
+    index->nlon = (int)nlon;
+    index->nlat = (int)nlat;
+    index->start = (long *)malloc(
+        ((size_t)index->nlon*index->nlat + 1)*sizeof(long));
+    count = (long *)calloc((size_t)index->nlon*index->nlat, sizeof(long));
+    if(index->start == NULL || count == NULL)
+    {
+        free(count);
+        free_tess_index(index);
+        return NULL;
+    }
+    /* Count the columns in each bucket and then put them in place */
+    for(c = 0; c < ncolumns; c++)
+    {
+        b = (long)((index->lat[c] - index->s)/index->dlat)*index->nlon +
+            (long)((index->lon[c] - index->w)/index->dlon);
+        count[b]++;
+    }
+    index->start[0] = 0;
+    for(b = 0; b < (long)index->nlon*index->nlat; b++)
+    {
+        index->start[b + 1] = index->start[b] + count[b];
+        count[b] = index->start[b];
+    }
+    for(c = 0; c < ncolumns; c++)
+    {
+        b = (long)((index->lat[c] - index->s)/index->dlat)*index->nlon +
+            (long)((index->lon[c] - index->w)/index->dlon);
+        index->items[count[b]] = c;
+        count[b]++;
+    }
+    free(count);
+    return index;
+}
+
+
+/* Free the memory allocated by new_tess_index(). */
+void free_tess_index(TESS_INDEX *index)
+{
+    free(index->start);
+    free(index->items);
+    free(index->lon);
+    free(index->lat);
+    free(index);
+}
+
+
+/* Find the columns of a model inside a spherical cap using a spatial index. */
+long tess_index_query(TESS_INDEX *index, double lon, double lat, double radius,
+                      long *found)
+{
+    double d2r = PI/180., coslat, sinlat, cosradius, dlon, lonmin, lonmax,
+           latmin, latmax, shift;
+    int i, j, i1, i2, j1, j2, inext;
+    long b, k, c, nfound = 0;
+
+    coslat = cos(d2r*lat);
+    sinlat = sin(d2r*lat);
+    cosradius = cos(d2r*radius);
+    latmin = lat - radius;
+    latmax = lat + radius;
+    /* Longitude range of the cap. All longitudes if it contains a pole. */
+    if(latmin <= -90 || latmax >= 90)
+    {
+        dlon = 180;
+    }
+    else
+    {
+        dlon = asin(sin(d2r*radius)/coslat)/d2r;
+    }
+    j1 = (int)floor((latmin - index->s)/index->dlat);
+    j2 = (int)floor((latmax - index->s)/index->dlat);
+    if(j1 < 0)
+        j1 = 0;
+    if(j2 > index->nlat - 1)
+        j2 = index->nlat - 1;
+    /* Look at the cap shifted by -360, 0 and 360 degrees so that the
+     * longitudes of the model and the cap don't need to be in the same
+     * range. The ranges of buckets are increasing, so skip the ones already
+     * visited for the previous shift. */
+    inext = 0;
+    for(shift = -360; shift <= 360; shift += 360)
+    {
+        lonmin = lon + shift - dlon;
+        lonmax = lon + shift + dlon;
+        i1 = (int)floor((lonmin - index->w)/index->dlon);
+        i2 = (int)floor((lonmax - index->w)/index->dlon);
+        if(i1 < inext)
+            i1 = inext;
+        if(i2 > index->nlon - 1)
+            i2 = index->nlon - 1;
+        if(i2 + 1 > inext)
+            inext = i2 + 1;
+        for(j = j1; j <= j2; j++)
+        {
+            for(i = i1; i <= i2; i++)
+            {
+                b = (long)j*index->nlon + i;
+                for(k = index->start[b]; k < index->start[b + 1]; k++)
+                {
+                    c = index->items[k];
+                    if(sinlat*sin(d2r*index->lat[c]) + coslat*
+                       cos(d2r*index->lat[c])*cos(d2r*(lon - index->lon[c]))
+                       >= cosradius)
+                    {
+                        found[nfound] = c;
+                        nfound++;
+                    }
+                }
+            }
+        }
+    }
+    return nfound;
+}
+
+
 /* Calculate the total mass of a tesseroid model. */
-double tess_total_mass(TESSEROID *model, int size)
+double tess_total_mass(TESSEROID *model, long size)
 {
     double mass;
-    int i;
+    long i;
 
     for(mass = 0, i = 0; i < size; i++)
     {
@@ -59,11 +464,11 @@ double tess_total_mass(TESSEROID *model, int size)
 
 
 /* Calculate the mass of a tesseroid model within a density range. */
-double tess_range_mass(TESSEROID *model, int size, double low_dens,
+double tess_range_mass(TESSEROID *model, long size, double low_dens,
                        double high_dens)
 {
     double mass;
-    int i;
+    long i;
 
     for(mass = 0, i = 0; i < size; i++)
     {
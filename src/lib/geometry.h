@@ -20,6 +20,56 @@ typedef struct tess_struct {
 } TESSEROID;
 
 
+/* Store a tesseroid model of stacked layers on a regular grid.
+The borders of the tesseroids are implied by the grid, so only the radius of
+the interfaces and the density of the layers are stored for each grid cell.
+Cells are ordered with longitude varying first, i.e., cell (i, j) has index
+j*nlon + i. */
+typedef struct tess_grid_struct {
+    double w; /* western border of the grid in degrees */
+    double s; /* southern border of the grid in degrees */
+    double dlon; /* size of the cells in longitude in degrees */
+    double dlat; /* size of the cells in latitude in degrees */
+    int nlon; /* number of cells in longitude */
+    int nlat; /* number of cells in latitude */
+    int nlayers; /* number of layers in each cell */
+    double *radii; /* nlayers + 1 interface radii per cell, from top to bottom,
+                      in SI units */
+    double *density; /* nlayers densities per cell, in SI units */
+} TESS_GRID;
+
+
+/* Store a multi-resolution (level-of-detail) pyramid of a grid model.
+Each level is a grid with cells twice as large as the level below it. A cell
+of a coarse level replaces the 2 x 2 cells below it by layers with the mean
+interface radii and densities that conserve the mass of each layer. Coarse
+levels only have the cells that are complete, i.e., level k has
+nlon >> k by nlat >> k cells of the original grid. */
+typedef struct tess_pyramid_struct {
+    int nlevels; /* number of levels, including the original grid */
+    TESS_GRID **levels; /* the grids of each level. levels[0] is the original
+                           grid */
+} TESS_PYRAMID;
+
+
+/* Store a lon/lat spatial index of the columns of a tesseroid model.
+The centers of the columns are put in buckets of a regular grid that covers
+the model. The columns of bucket (i, j) are items[start[b]] to
+items[start[b + 1] - 1], with b = j*nlon + i. */
+typedef struct tess_index_struct {
+    double w; /* longitude of the western border of the buckets in degrees */
+    double s; /* latitude of the southern border of the buckets in degrees */
+    double dlon; /* size of the buckets in longitude in degrees */
+    double dlat; /* size of the buckets in latitude in degrees */
+    int nlon; /* number of buckets in longitude */
+    int nlat; /* number of buckets in latitude */
+    long *start; /* nlon*nlat + 1 indexes of the first item of each bucket */
+    long *items; /* the indexes of the columns sorted by bucket */
+    double *lon; /* longitude of the center of each column */
+    double *lat; /* latitude of the center of each column */
+} TESS_INDEX;
+
+
 /* Store information on a rectangular prism */
 typedef struct prism_struct {
     double density; /* in SI units */
@@ -56,6 +106,134 @@ extern int split_tess(TESSEROID tess, int nlon, int nlat, int nr,
                       TESSEROID *split);
 
 
+/* Find the vertical columns of tesseroids in a model.
+
+A column is a sequence of consecutive tesseroids with the same w, e, s, and n
+borders (i.e., the layers of a grid cell as output by tesslayers).
+
+@param model array of tesseroids
+@param size size of the model
+@param columns array of size + 1 integers with memory allocated. Used to return
+               the index of the first tesseroid of each column. The element
+               after the last column is set to size.
+
+Returns:
+    Number of columns found.
+*/
+extern long tess_find_columns(TESSEROID *model, long size, long *columns);
+
+
+
+/* Make a new TESS_GRID structure and allocate memory for the cells.
+
+<b>WARNING</b>: Don't forget to free the memory using free_tess_grid()!
+
+@param w western border of the grid in degrees
+@param s southern border of the grid in degrees
+@param dlon size of the cells in longitude in degrees
+@param dlat size of the cells in latitude in degrees
+@param nlon number of cells in longitude
+@param nlat number of cells in latitude
+@param nlayers number of layers in each cell
+
+@return pointer to the new grid. NULL if there was an error with allocation.
+*/
+extern TESS_GRID * new_tess_grid(double w, double s, double dlon, double dlat,
+                                 int nlon, int nlat, int nlayers);
+
+
+/* Free the memory allocated by new_tess_grid().
+
+@param grid pointer to the grid
+*/
+extern void free_tess_grid(TESS_GRID *grid);
+
+
+/* Generate the tesseroids of a cell of a grid model.
+
+Layers with zero thickness are skipped.
+
+@param grid the grid model
+@param cell index of the cell in the grid (j*nlon + i)
+@param column array of grid->nlayers tesseroids with memory allocated. Used to
+              return the tesseroids of the cell.
+
+Returns:
+    Number of tesseroids in column.
+*/
+extern int tess_grid_column(TESS_GRID *grid, int cell, TESSEROID *column);
+
+
+/* Build a multi-resolution pyramid of coarsened grids from a grid model.
+
+Coarse levels are added until there are no complete cells left or maxlevels
+is reached. The original grid is used as level 0 and is not copied.
+
+<b>WARNING</b>: Don't forget to free the memory using free_tess_pyramid()!
+
+@param grid the grid model
+@param maxlevels maximum number of levels in the pyramid, including the
+                 original grid
+
+@return pointer to the pyramid. NULL if there was an error allocating memory.
+*/
+extern TESS_PYRAMID * new_tess_pyramid(TESS_GRID *grid, int maxlevels);
+
+
+/* Free the memory allocated by new_tess_pyramid().
+
+Does not free the original grid (level 0).
+
+@param pyramid pointer to the pyramid
+*/
+extern void free_tess_pyramid(TESS_PYRAMID *pyramid);
+
+
+/* Build a lon/lat spatial index of the columns of a tesseroid model.
+
+The size of the buckets is at least minsize but is increased so that there
+are about as many buckets as columns in the model or less, in total and along
+each dimension (for columns on a single meridian or parallel).
+
+<b>WARNING</b>: Don't forget to free the memory using free_tess_index()!
+
+@param model TESSEROID array defining the model
+@param columns index of the first tesseroid of each column in the model plus
+               the index one past the end of the last column (see
+               tess_find_columns())
+@param ncolumns number of columns in the model
+@param minsize minimum size of the buckets in degrees
+
+@return pointer to the index. NULL if there was an error allocating memory.
+*/
+extern TESS_INDEX * new_tess_index(TESSEROID *model, long *columns,
+                                   long ncolumns, double minsize);
+
+
+/* Free the memory allocated by new_tess_index().
+
+@param index pointer to the index
+*/
+extern void free_tess_index(TESS_INDEX *index);
+
+
+/* Find the columns of a model inside a spherical cap using a spatial index.
+
+A column is inside the cap if its center is at most radius degrees (angular
+distance) away from the center of the cap. Longitudes are taken modulo 360.
+
+@param index the spatial index of the model (see new_tess_index())
+@param lon longitude of the center of the cap in degrees
+@param lat latitude of the center of the cap in degrees
+@param radius angular radius of the cap in degrees
+@param found array with memory allocated for ncolumns integers. Used to return
+             the indexes of the columns inside the cap.
+
+@return number of columns inside the cap
+*/
+extern long tess_index_query(TESS_INDEX *index, double lon, double lat,
+                             double radius, long *found);
+
 
 /* Calculate the total mass of a tesseroid model.
 
@@ -66,7 +244,7 @@ Give all in SI units and degrees!
 
 @return The calculated mass
 */
-extern double tess_total_mass(TESSEROID *model, int size);
+extern double tess_total_mass(TESSEROID *model, long size);
 
 
 /* Calculate the mass of a tesseroid model within a density range.
@@ -80,7 +258,7 @@ Give all in SI units and degrees!
 
 @return The calculated mass
 */
-extern double tess_range_mass(TESSEROID *model, int size, double low_dens,
+extern double tess_range_mass(TESSEROID *model, long size, double low_dens,
                               double high_dens);
 
 
@@ -20,122 +20,1100 @@ Max error allowed for the root-finder algorithm */
 const double GLQ_MAXERROR = 0.000000000000001;
 
 
+/** \var GLQ_MAX_TABULATED
+Highest order with tabulated nodes and weights */
+const int GLQ_MAX_TABULATED = 64;
+
+
+/* The arrays of a GLQ structure start at multiples of this many bytes */
+#define GLQ_ALIGN 64
+
+/* Number of terms of the Taylor series of the Legendre polynomials used to
+ * go from one node to the next in glq_nodes_weights */
+#define GLQ_TAYLOR_TERMS 30
+
+/* Number of tabulated zeros of the Bessel function J0 (the others are
+ * calculated with McMahon's expansion) */
+#define GLQ_BESSEL_ZEROS 10
+
+
+/* Non-negative GLQ nodes of the orders 2 to GLQ_MAX_TABULATED in ascending
+order, one order after the other. Those of order n start at n*n/4 - 1. The
+negative nodes are symmetric. Calculated with 50 digits of precision and
+rounded to double. */
+static const double GLQ_TABLE_NODES[] = {
+    /* order 2 */
+    5.7735026918962573e-01,
+    /* order 3 */
+    0.0000000000000000e+00, 7.7459666924148340e-01,
+    /* order 4 */
+    3.3998104358485626e-01, 8.6113631159405257e-01,
+    /* order 5 */
+    0.0000000000000000e+00, 5.3846931010568311e-01, 9.0617984593866396e-01,
+    /* order 6 */
+    2.3861918608319690e-01, 6.6120938646626448e-01, 9.3246951420315205e-01,
+    /* order 7 */
+    0.0000000000000000e+00, 4.0584515137739718e-01, 7.4153118559939446e-01,
+    9.4910791234275849e-01,
+    /* order 8 */
+    1.8343464249564981e-01, 5.2553240991632899e-01, 7.9666647741362673e-01,
+    9.6028985649753629e-01,
+    /* order 9 */
+    0.0000000000000000e+00, 3.2425342340380892e-01, 6.1337143270059036e-01,
+    8.3603110732663577e-01, 9.6816023950762609e-01,
+    /* order 10 */
+    1.4887433898163122e-01, 4.3339539412924721e-01, 6.7940956829902444e-01,
+    8.6506336668898454e-01, 9.7390652851717174e-01,
+    /* order 11 */
+    0.0000000000000000e+00, 2.6954315595234496e-01, 5.1909612920681181e-01,
+    7.3015200557404936e-01, 8.8706259976809532e-01, 9.7822865814605697e-01,
+    /* order 12 */
+    1.2523340851146891e-01, 3.6783149899818018e-01, 5.8731795428661748e-01,
+    7.6990267419430469e-01, 9.0411725637047491e-01, 9.8156063424671924e-01,
+    /* order 13 */
+    0.0000000000000000e+00, 2.3045831595513480e-01, 4.4849275103644687e-01,
+    6.4234933944034023e-01, 8.0157809073330988e-01, 9.1759839922297792e-01,
+    9.8418305471858814e-01,
+    /* order 14 */
+    1.0805494870734367e-01, 3.1911236892788974e-01, 5.1524863635815410e-01,
+    6.8729290481168548e-01, 8.2720131506976502e-01, 9.2843488366357352e-01,
+    9.8628380869681231e-01,
+    /* order 15 */
+    0.0000000000000000e+00, 2.0119409399743451e-01, 3.9415134707756339e-01,
+    5.7097217260853883e-01, 7.2441773136017007e-01, 8.4820658341042721e-01,
+    9.3727339240070595e-01, 9.8799251802048538e-01,
+    /* order 16 */
+    9.5012509837637441e-02, 2.8160355077925892e-01, 4.5801677765722737e-01,
+    6.1787624440264377e-01, 7.5540440835500300e-01, 8.6563120238783176e-01,
+    9.4457502307323260e-01, 9.8940093499164994e-01,
+    /* order 17 */
+    0.0000000000000000e+00, 1.7848418149584785e-01, 3.5123176345387630e-01,
+    5.1269053708647694e-01, 6.5767115921669073e-01, 7.8151400389680137e-01,
+    8.8023915372698591e-01, 9.5067552176876780e-01, 9.9057547531441736e-01,
+    /* order 18 */
+    8.4775013041735306e-02, 2.5188622569150548e-01, 4.1175116146284263e-01,
+    5.5977083107394754e-01, 6.9168704306035322e-01, 8.0370495897252314e-01,
+    8.9260246649755570e-01, 9.5582394957139771e-01, 9.9156516842093090e-01,
+    /* order 19 */
+    0.0000000000000000e+00, 1.6035864564022537e-01, 3.1656409996362983e-01,
+    4.6457074137596094e-01, 6.0054530466168099e-01, 7.2096617733522939e-01,
+    8.2271465653714282e-01, 9.0315590361481790e-01, 9.6020815213483002e-01,
+    9.9240684384358435e-01,
+    /* order 20 */
+    7.6526521133497338e-02, 2.2778585114164507e-01, 3.7370608871541955e-01,
+    5.1086700195082713e-01, 6.3605368072651502e-01, 7.4633190646015080e-01,
+    8.3911697182221878e-01, 9.1223442825132595e-01, 9.6397192727791381e-01,
+    9.9312859918509488e-01,
+    /* order 21 */
+    0.0000000000000000e+00, 1.4556185416089509e-01, 2.8802131680240112e-01,
+    4.2434212020743878e-01, 5.5161883588721983e-01, 6.6713880419741234e-01,
+    7.6843996347567789e-01, 8.5336336458331730e-01, 9.2009933415040079e-01,
+    9.6722683856630631e-01, 9.9375217062038945e-01,
+    /* order 22 */
+    6.9739273319722225e-02, 2.0786042668822127e-01, 3.4193582089208424e-01,
+    4.6935583798675701e-01, 5.8764040350691160e-01, 6.9448726318668275e-01,
+    7.8781680597920811e-01, 8.6581257772030018e-01, 9.2695677218717398e-01,
+    9.7006049783542869e-01, 9.9429458548239924e-01,
+    /* order 23 */
+    0.0000000000000000e+00, 1.3325682429846611e-01, 2.6413568097034495e-01,
+    3.9030103803029081e-01, 5.0950147784600752e-01, 6.1960987576364612e-01,
+    7.1866136313195017e-01, 8.0488840161883990e-01, 8.7675235827044162e-01,
+    9.3297108682601615e-01, 9.7254247121811521e-01, 9.9476933499755216e-01,
+    /* order 24 */
+    6.4056892862605630e-02, 1.9111886747361631e-01, 3.1504267969616340e-01,
+    4.3379350762604513e-01, 5.4542147138883956e-01, 6.4809365193697555e-01,
+    7.4012419157855436e-01, 8.2000198597390295e-01, 8.8641552700440107e-01,
+    9.3827455200273280e-01, 9.7472855597130947e-01, 9.9518721999702131e-01,
+    /* order 25 */
+    0.0000000000000000e+00, 1.2286469261071040e-01, 2.4386688372098844e-01,
+    3.6117230580938786e-01, 4.7300273144571497e-01, 5.7766293024122295e-01,
+    6.7356636847346840e-01, 7.5925926303735758e-01, 8.3344262876083397e-01,
+    8.9499199787827532e-01, 9.4297457122897432e-01, 9.7666392145951753e-01,
+    9.9555696979049813e-01,
+    /* order 26 */
+    5.9230093429313208e-02, 1.7685882035689018e-01, 2.9200483948595690e-01,
+    4.0305175512348629e-01, 5.0844071482450570e-01, 6.0669229301761807e-01,
+    6.9642726041995728e-01, 7.7638594882067891e-01, 8.4544594278849805e-01,
+    9.0263786198430707e-01, 9.4715906666171423e-01, 9.7838544595647103e-01,
+    9.9588570114561692e-01,
+    /* order 27 */
+    0.0000000000000000e+00, 1.1397258560952997e-01, 2.2645936543953685e-01,
+    3.3599390363850890e-01, 4.4114825175002687e-01, 5.4055156457945686e-01,
+    6.3290797194649517e-01, 7.1701347373942370e-01, 7.9177163907050818e-01,
+    8.5620790801829449e-01, 9.0948232067749113e-01, 9.5090055781470506e-01,
+    9.7992347596150120e-01, 9.9617926288898861e-01,
+    /* order 28 */
+    5.5079289884034273e-02, 1.6456928213338076e-01, 2.7206162763517810e-01,
+    3.7625151608907870e-01, 4.7587422495511827e-01, 5.6972047181140173e-01,
+    6.5665109403886501e-01, 7.3561087801363179e-01, 8.0564137091717913e-01,
+    8.6589252257439508e-01, 9.1563302639213207e-01, 9.5425928062893817e-01,
+    9.8130316537087270e-01, 9.9644249757395442e-01,
+    /* order 29 */
+    0.0000000000000000e+00, 1.0627823013267923e-01, 2.1135228616600107e-01,
+    3.1403163786763993e-01, 4.1315288817400864e-01, 5.0759295512422764e-01,
+    5.9628179713822782e-01, 6.7821453760268646e-01, 7.5246285173447713e-01,
+    8.1818548761525245e-01, 8.7463780492010279e-01, 9.2118023295305873e-01,
+    9.5728559577808769e-01, 9.8254550526141315e-01, 9.9667944226059657e-01,
+    /* order 30 */
+    5.1471842555317698e-02, 1.5386991360858354e-01, 2.5463692616788985e-01,
+    3.5270472553087812e-01, 4.4703376953808915e-01, 5.3662414814201986e-01,
+    6.2052618298924289e-01, 6.9785049479331585e-01, 7.6777743210482619e-01,
+    8.2956576238276836e-01, 8.8256053579205274e-01, 9.2620004742927431e-01,
+    9.6002186496830755e-01, 9.8366812327974718e-01, 9.9689348407464951e-01,
+    /* order 31 */
+    0.0000000000000000e+00, 9.9555312152341521e-02, 1.9812119933557062e-01,
+    2.9471806998170164e-01, 3.8838590160823294e-01, 4.7819378204490248e-01,
+    5.6324916140714931e-01, 6.4270672292426034e-01, 7.1577678458685323e-01,
+    7.8173314841662489e-01, 8.3992032014626739e-01, 8.8976002994827108e-01,
+    9.3075699789664812e-01, 9.6250392509294969e-01, 9.8468590966515246e-01,
+    9.9708748181947704e-01,
+    /* order 32 */
+    4.8307665687738317e-02, 1.4447196158279649e-01, 2.3928736225213706e-01,
+    3.3186860228212767e-01, 4.2135127613063533e-01, 5.0689990893222936e-01,
+    5.8771575724076230e-01, 6.6304426693021523e-01, 7.3218211874028971e-01,
+    7.9448379596794239e-01, 8.4936761373256997e-01, 8.9632115576605209e-01,
+    9.3490607593773967e-01, 9.6476225558750639e-01, 9.8561151154526838e-01,
+    9.9726386184948157e-01,
+    /* order 33 */
+    0.0000000000000000e+00, 9.3631065854733381e-02, 1.8643929882799157e-01,
+    2.7760909715249704e-01, 3.6633925774807335e-01, 4.5185001727245072e-01,
+    5.3338990478634762e-01, 6.1024234583637904e-01, 6.8173195996974278e-01,
+    7.4723049644956219e-01, 8.0616235627416655e-01, 8.5800965267650409e-01,
+    9.0231676774343361e-01, 9.3869437261116839e-01, 9.6682290968999274e-01,
+    9.8645572623064248e-01, 9.9742469424645519e-01,
+    /* order 34 */
+    4.5509821953102540e-02, 1.3615235725918298e-01, 2.2566669161644948e-01,
+    3.1331108133946323e-01, 3.9835927775864594e-01, 4.8010654519032703e-01,
+    5.5787550066974667e-01, 6.3102172708052851e-01, 6.9893911321626290e-01,
+    7.6106487662987299e-01, 8.1688422790093362e-01, 8.6593463833456452e-01,
+    9.0780967771832444e-01, 9.4216239740510710e-01, 9.6870826253334430e-01,
+    9.8722781640630952e-01, 9.9757175379084195e-01,
+    /* order 35 */
+    0.0000000000000000e+00, 8.8371343275659264e-02, 1.7605106116598956e-01,
+    2.6235294120929603e-01, 3.4660155443081392e-01, 4.2813754151781425e-01,
+    5.0632277324148867e-01, 5.8054534474976449e-01, 6.5022436466589040e-01,
+    7.1481450155662873e-01, 7.7381025228691258e-01, 8.2674989909222540e-01,
+    8.7321912502522236e-01, 9.1285426135931758e-01, 9.4534514820782733e-01,
+    9.7043761603922984e-01, 9.8793576444385145e-01, 9.9770656909960032e-01,
+    /* order 36 */
+    4.3018198473708608e-02, 1.2873610380938480e-01, 2.1350089231686559e-01,
+    2.9668499534402826e-01, 3.7767254711968923e-01, 4.5586394443342027e-01,
+    5.3068028592624517e-01, 6.0156765813598057e-01, 6.6800123658552102e-01,
+    7.2948917159355653e-01, 7.8557623013220657e-01, 8.3584716699247530e-01,
+    8.7992980089039718e-01, 9.1749777451565906e-01, 9.4827298439950758e-01,
+    9.7202769104969799e-01, 9.8858647890221218e-01, 9.9783046248408580e-01,
+    /* order 37 */
+    0.0000000000000000e+00, 8.3670408954769904e-02, 1.6675393023985197e-01,
+    2.4866779279136575e-01, 3.2883742988370701e-01, 4.0670050931832613e-01,
+    4.8171087780320554e-01, 5.5334239186158174e-01, 6.2109260840892444e-01,
+    6.8448630913095931e-01, 7.4307883398196528e-01, 7.9645920050990227e-01,
+    8.4425298734055598e-01, 8.8612496215548608e-01, 9.2178143741246377e-01,
+    9.5097234326209479e-01, 9.7349303005648580e-01, 9.8918596321431917e-01,
+    9.9794458247791362e-01,
+    /* order 38 */
+    4.0785147904578239e-02, 1.2208402533786741e-01, 2.0257045389211670e-01,
+    2.8170880979016527e-01, 3.5897244047943500e-01, 4.3384716943237650e-01,
+    5.0583471792793111e-01, 5.7445602104780713e-01, 6.3925441582968168e-01,
+    6.9979868037918436e-01, 7.5568590375397071e-01, 8.0654416760531678e-01,
+    8.5203502193236214e-01, 8.9185573900463222e-01, 9.2574133204858444e-01,
+    9.5346633093352962e-01, 9.7484632859015352e-01, 9.8973945426638554e-01,
+    9.9804993053568758e-01,
+    /* order 39 */
+    0.0000000000000000e+00, 7.9443804608755483e-02, 1.5838533999783780e-01,
+    2.3632551246183578e-01, 3.1277155924818595e-01, 3.8724016397156147e-01,
+    4.5926051230913606e-01, 5.2837726866043744e-01, 5.9415345495727800e-01,
+    6.5617321343201096e-01, 7.1404443589453470e-01, 7.6740124293106349e-01,
+    8.1590629743014309e-01, 8.5925293799990621e-01, 8.9716711929299287e-01,
+    9.2940914848673828e-01, 9.5577521232465223e-01, 9.7609870933347109e-01,
+    9.9025153685468603e-01, 9.9814738306643291e-01,
+    /* order 40 */
+    3.8772417506050823e-02, 1.1608407067525521e-01, 1.9269758070137111e-01,
+    2.6815218500725369e-01, 3.4199409082575849e-01, 4.1377920437160498e-01,
+    4.8307580168617870e-01, 5.4946712509512818e-01, 6.1255388966798019e-01,
+    6.7195668461417957e-01, 7.2731825518992710e-01, 7.7830565142651942e-01,
+    8.2461223083331170e-01, 8.6595950321225945e-01, 9.0209880696887434e-01,
+    9.3281280827867652e-01, 9.5791681921379168e-01, 9.7725994998377430e-01,
+    9.9072623869945697e-01, 9.9823770971055925e-01,
+    /* order 41 */
+    0.0000000000000000e+00, 7.5623258989163000e-02, 1.5081335486399217e-01,
+    2.2513960563342278e-01, 2.9817627734182489e-01, 3.6950502264048146e-01,
+    4.3871727705140706e-01, 5.0541659919940607e-01, 5.6922094161021586e-01,
+    6.2976483907219627e-01, 6.8670150203495128e-01, 7.3970480306992614e-01,
+    7.8847114504740934e-01, 8.3272120040136133e-01, 8.7220151169244142e-01,
+    9.0668594475810116e-01, 9.3597698749785385e-01, 9.5990689173034627e-01,
+    9.7833867356108339e-01, 9.9116710969901634e-01, 9.9832158857477149e-01,
+    /* order 42 */
+    3.6948943165351779e-02, 1.1064502720851987e-01, 1.8373680656485455e-01,
+    2.5582507934287907e-01, 3.2651612446541151e-01, 3.9542385204297503e-01,
+    4.6217191207042191e-01, 5.2639574993119231e-01, 5.8774459748510932e-01,
+    6.4588338886924779e-01, 7.0049459055617125e-01, 7.5127993568948048e-01,
+    7.9796205325548741e-01, 8.4028598326181692e-01, 8.7802056981217269e-01,
+    9.1095972490412747e-01, 9.3892355735498823e-01, 9.6175936533820450e-01,
+    9.7934250806374823e-01, 9.9157728834086090e-01, 9.9839961899006247e-01,
+    /* order 43 */
+    0.0000000000000000e+00, 7.2152990874586237e-02, 1.4392980951071332e-01,
+    2.1495624486051820e-01, 2.8486199803291362e-01, 3.5328261286430379e-01,
+    4.1986137602926926e-01, 4.8425117678573470e-01, 5.4611631666008476e-01,
+    6.0513425963960099e-01, 6.6099731375149817e-01, 7.1341423526895709e-01,
+    7.6211174719495511e-01, 8.0683596413693859e-01, 8.4735371620931510e-01,
+    8.8345376521861685e-01, 9.1494790720613872e-01, 9.4167195684763783e-01,
+    9.6348661301408001e-01, 9.8027822098025530e-01, 9.9195955759324417e-01,
+    9.9847233224250775e-01,
+    /* order 44 */
+    3.5289236964135356e-02, 1.0569190170865325e-01, 1.7556801477551678e-01,
+    2.4456945692820126e-01, 3.1235246650278581e-01, 3.7857935201470716e-01,
+    4.4292017452541149e-01, 5.0505439138820230e-01, 5.6467245318547077e-01,
+    6.2147734590357584e-01, 6.7518607066612235e-01, 7.2553105366071702e-01,
+    7.7226147924875588e-01, 8.1514453964513500e-01, 8.5396659500471039e-01,
+    8.8853423828604317e-01, 9.1867525998417576e-01, 9.4423950911819410e-01,
+    9.6509965042249313e-01, 9.8115183307791398e-01, 9.9231639213851586e-01,
+    9.9854020063677418e-01,
+    /* order 45 */
+    0.0000000000000000e+00, 6.8986980163144168e-02, 1.3764520598325303e-01,
+    2.0564748978326375e-01, 2.7266976975237756e-01, 3.3839265425060217e-01,
+    4.0250294385854191e-01, 4.6469512391963508e-01, 5.2467282046291608e-01,
+    5.8215021256935318e-01, 6.3685339445322331e-01, 6.8852168077120057e-01,
+    7.3690884894549036e-01, 7.8178431259390624e-01, 8.2293422050208631e-01,
+    8.6016247596066420e-01, 8.9329167175324176e-01, 9.2216393671900043e-01,
+    9.4664169099562911e-01, 9.6660831039689465e-01, 9.8196871503454053e-01,
+    9.9264999844720370e-01, 9.9860364518193667e-01,
+    /* order 46 */
+    3.3772190016052042e-02, 1.0116247530558424e-01, 1.6809117946710353e-01,
+    2.3425292220626978e-01, 2.9934582270186999e-01, 3.6307287702099572e-01,
+    4.2514331328282839e-01, 4.8527391838816464e-01, 5.4319033026180263e-01,
+    5.9862828971271520e-01, 6.5133484620199766e-01, 7.0106951202040568e-01,
+    7.4760535961566610e-01, 7.9073005707527422e-01, 8.3024683706606606e-01,
+    8.6597539486685804e-01, 8.9775271153394198e-01, 9.2543379880675392e-01,
+    9.4889236344608985e-01, 9.6802139185399194e-01, 9.8273366980416688e-01,
+    9.9296234890617441e-01, 9.9866304213381796e-01,
+    /* order 47 */
+    0.0000000000000000e+00, 6.6086923916355678e-02, 1.3188486655451490e-01,
+    1.9710611027911182e-01, 2.6146545921497455e-01, 3.2468148633773591e-01,
+    3.8647776408466716e-01, 4.4658407310485571e-01, 5.0473758386357792e-01,
+    5.6068400593466416e-01, 6.1417869995637364e-01, 6.6498774739033273e-01,
+    7.1288897340906432e-01, 7.5767291844543860e-01, 7.9914375416774197e-01,
+    8.3712013989990208e-01, 8.7143601579689633e-01, 9.0194132943852534e-01,
+    9.2850269301236066e-01, 9.5100396925770847e-01, 9.6934678732656454e-01,
+    9.8345100307162370e-01, 9.9325521098776859e-01, 9.9871872858421207e-01,
+    /* order 48 */
+    3.2380170962869360e-02, 9.7004699209462697e-02, 1.6122235606889171e-01,
+    2.2476379039468905e-01, 2.8736248735545555e-01, 3.4875588629216075e-01,
+    4.0868648199071672e-01, 4.6690290475095841e-01, 5.2316097472223300e-01,
+    5.7722472608397268e-01, 6.2886739677651360e-01, 6.7787237963266389e-01,
+    7.2403413092381463e-01, 7.6715903251574036e-01, 8.0706620402944262e-01,
+    8.4358826162439349e-01, 8.7657202027424785e-01, 9.0587913671556963e-01,
+    9.3138669070655433e-01, 9.5298770316043091e-01, 9.7059159254624727e-01,
+    9.8412458372282685e-01, 9.9353017226635076e-01, 9.9877100725242607e-01,
+    /* order 49 */
+    0.0000000000000000e+00, 6.3420684982686784e-02, 1.2658599726967204e-01,
+    1.8924159246181357e-01, 2.5113517861257728e-01, 3.1201753211974875e-01,
+    3.7164350126228490e-01, 4.2977299334157654e-01, 4.8617194145249204e-01,
+    5.4061324699172608e-01, 5.9287769410890068e-01, 6.4275483241923770e-01,
+    6.9004382442513212e-01, 7.3455425423740273e-01, 7.7610689434544666e-01,
+    8.1453442735985548e-01, 8.4968211984416575e-01, 8.8140844557300890e-01,
+    9.0958565582807327e-01, 9.3410029475581013e-01, 9.5485365867413718e-01,
+    9.7176220090155541e-01, 9.8475789591421303e-01, 9.9378866194416782e-01,
+    9.9882015060663543e-01,
+    /* order 50 */
+    3.1098338327188876e-02, 9.3174701560086143e-02, 1.5489058999814589e-01,
+    2.1600723687604176e-01, 2.7628819377953201e-01, 3.3550024541943735e-01,
+    3.9341431189756515e-01, 4.4980633497403877e-01, 5.0445814490746421e-01,
+    5.5715830451465009e-01, 6.0770292718495023e-01, 6.5589646568543936e-01,
+    7.0155246870682220e-01, 7.4449430222606849e-01, 7.8455583290039932e-01,
+    8.2158207085933599e-01, 8.5542976942994609e-01, 8.8596797952361306e-01,
+    9.1307855665579185e-01, 9.3665661894487795e-01, 9.5661095524280793e-01,
+    9.7286438510669204e-01, 9.8535408404800584e-01, 9.9403196943209071e-01,
+    9.9886640442007102e-01,
+    /* order 51 */
+    0.0000000000000000e+00, 6.0961100150578727e-02, 1.2169542101888876e-01,
+    1.8197702695707754e-01, 2.4158166644779872e-01, 3.0028760633533191e-01,
+    3.5787645668840951e-01, 4.1413398322630390e-01, 4.6885090428604104e-01,
+    5.2182366936618585e-01, 5.7285521635130388e-01, 6.2175570460072327e-01,
+    6.6834322117537004e-01, 7.1244445757703667e-01, 7.5389535448537548e-01,
+    7.9254171209938118e-01, 8.2823976382306486e-01, 8.6085671118229234e-01,
+    8.9027121802952736e-01, 9.1637386230978024e-01, 9.3906754400296233e-01,
+    9.5826784861390824e-01, 9.7390336801932387e-01, 9.8591599173590294e-01,
+    9.9426126043675256e-01, 9.9890999084890353e-01,
+    /* order 52 */
+    2.9914109797338766e-02, 8.9635244648900561e-02, 1.4903550860694917e-01,
+    2.0790226415636606e-01, 2.6602478360500181e-01, 3.2319500343480784e-01,
+    3.7920826911609368e-01, 4.3386406771876168e-01, 4.8696674569809606e-01,
+    5.3832620928582742e-01, 5.8775860497957910e-01, 6.3508697769524591e-01,
+    6.8014190422716769e-01, 7.2276209974998318e-01, 7.6279499519374494e-01,
+    8.0009728343046838e-01, 8.3453543232673455e-01, 8.6598616284606755e-01,
+    8.9433689053449528e-01, 9.1948612891642456e-01, 9.4134385364135909e-01,
+    9.5983182693308655e-01, 9.7488388422174455e-01, 9.8644619565154990e-01,
+    9.9447759092921606e-01, 9.9895111110395030e-01,
+    /* order 53 */
+    0.0000000000000000e+00, 5.8685054300259464e-02, 1.1716780907195515e-01,
+    1.7524666215532575e-01, 2.3272140372427261e-01, 2.8939390645162621e-01,
+    3.4506880849572236e-01, 3.9955418695395295e-01, 4.5266221946184582e-01,
+    5.0420983165713340e-01, 5.5401932827706790e-01, 6.0191900571376933e-01,
+    6.4774374391651002e-01, 6.9133557560136671e-01, 7.3254423080751030e-01,
+    7.7122765492553236e-01, 8.0725249841689550e-01, 8.4049457654580140e-01,
+    8.7083929755824130e-01, 8.9818205787542660e-01, 9.2242860304281216e-01,
+    9.4349535346444191e-01, 9.6130969462313631e-01, 9.7581023371498454e-01,
+    9.8694703502337155e-01, 9.9468191930800709e-01, 9.9898994777632821e-01,
+    /* order 54 */
+    2.8816748199341779e-02, 8.6354518263248220e-02, 1.4360542731625614e-01,
+    2.0037929360621357e-01, 2.5648752006999731e-01, 3.1174372083446822e-01,
+    3.6596434037219117e-01, 4.1896926325520450e-01, 4.7058241248138227e-01,
+    5.2063233438593304e-01, 5.6895276819520946e-01, 6.1538319833112742e-01,
+    6.5976938763198312e-01, 7.0196388971917290e-01, 7.4182653880918437e-01,
+    7.7922491534625404e-01, 8.1403478591356782e-01, 8.4614051597077300e-01,
+    8.7543545406556889e-01, 9.0182228628470162e-01, 9.2521335986665154e-01,
+    9.4553097516499585e-01, 9.6270764578592360e-01, 9.7668632885790319e-01,
+    9.8742063739734354e-01, 9.9487511701833886e-01, 9.9902666686734098e-01,
+    /* order 55 */
+    0.0000000000000000e+00, 5.6572753818336777e-02, 1.1296428805932926e-01,
+    1.6899396364687322e-01, 2.2448230064784550e-01, 2.7925155320080652e-01,
+    3.3312627889002389e-01, 3.8593390074097944e-01, 4.3750526003717460e-01,
+    4.8767515818747409e-01, 5.3628288590834328e-01, 5.8317273802603209e-01,
+    6.2819451224992817e-01, 6.7120399031982636e-01, 7.1206339998663781e-01,
+    7.5064185634802194e-01, 7.8681578112762240e-01, 8.2046929855932094e-01,
+    8.5149460661715448e-01, 8.7979232241989547e-01, 9.0527180074400004e-01,
+    9.2785142472079174e-01, 9.4745886804121071e-01, 9.6403132859313523e-01,
+    9.7751573550398918e-01, 9.8786894119888924e-01, 9.9505797784741190e-01,
+    9.9906141956481853e-01,
+    /* order 56 */
+    2.7797035287275437e-02, 8.3305186822435373e-02, 1.3855584681037625e-01,
+    1.9337823863527526e-01, 2.4760290943433721e-01, 3.0106225386722069e-01,
+    3.5359103217495452e-01, 4.0502688092709127e-01, 4.5521081487845960e-01,
+    5.0398771838438172e-01, 5.5120682485553463e-01, 5.9672218277066336e-01,
+    6.4039310680700690e-01, 6.8208461269447040e-01, 7.2166783445018812e-01,
+    7.5902042270512893e-01, 7.9402692289386645e-01, 8.2657913214288170e-01,
+    8.5657643376274861e-01, 8.8392610832782759e-01, 9.0854362042065551e-01,
+    9.3035288024749629e-01, 9.4928647956196266e-01, 9.6528590190549013e-01,
+    9.7830170914025638e-01, 9.8829371554016154e-01, 9.9523122608106973e-01,
+    9.9909434380146556e-01,
+    /* order 57 */
+    0.0000000000000000e+00, 5.4607151001646821e-02, 1.0905133280878780e-01,
+    1.6317006259126426e-01, 2.1680182879612403e-01, 2.6978657316183874e-01,
+    3.2196616839537862e-01, 3.7318489008659445e-01, 4.2328988145156393e-01,
+    4.7213160951797573e-01, 5.1956431139118764e-01, 5.6544642926923672e-01,
+    6.0964103290871541e-01, 6.5201622828097694e-01, 6.9244555119951778e-01,
+    7.3080834474452327e-01, 7.6699011935945016e-01, 8.0088289454721828e-01,
+    8.3238552115043907e-01, 8.6140398326204692e-01, 8.8785167888222138e-01,
+    9.1164967852139123e-01, 9.3272696106710173e-01, 9.5102062644787677e-01,
+    9.6647608517188666e-01, 9.7904722670946875e-01, 9.8869657765022201e-01,
+    9.9539552367843032e-01, 9.9912556562526289e-01,
+    /* order 58 */
+    2.6847012365942356e-02, 8.0463630214142726e-02, 1.3384825059546684e-01,
+    1.8684695183576133e-01, 2.3930692496615347e-01, 2.9107691431110921e-01,
+    3.4200765359799529e-01, 3.9195229633075312e-01, 4.4076683918683957e-01,
+    4.8831053721671847e-01, 5.3444630964884754e-01, 5.7904113513022504e-01,
+    6.2196643526307915e-01, 6.6309844533212525e-01, 7.0231857115390817e-01,
+    7.3951373102004225e-01, 7.7457668174965277e-01, 8.0740632791308820e-01,
+    8.3790801333937337e-01, 8.6599379407480748e-01, 8.9158269202203022e-01,
+    9.1460092856435249e-01, 9.3498213758825932e-01, 9.5266755751886911e-01,
+    9.6760620250292406e-01, 9.7975501469435033e-01, 9.8907900824844264e-01,
+    9.9555147659729093e-01, 9.9915520040738659e-01,
+    /* order 59 */
+    0.0000000000000000e+00, 5.2773484088310001e-02, 1.0539987901634415e-01,
+    1.5773250558785798e-01, 2.0962550339203653e-01, 2.6093423734281174e-01,
+    3.1151570080301372e-01, 3.6122891416979480e-01, 4.0993531781041898e-01,
+    4.5749915825326670e-01, 5.0378786655771801e-01, 5.4867242780839642e-01,
+    5.9202774070403019e-01, 6.3373296623885012e-01, 6.7367186450493721e-01,
+    7.1173311867719768e-01, 7.4781064527864027e-01, 7.8180388986236093e-01,
+    8.1361810728821160e-01, 8.4316462581687224e-01, 8.7036109429288222e-01,
+    8.9513171174347206e-01, 9.1740743878815523e-01, 9.3712619035345390e-01,
+    9.5423300937695110e-01, 9.6868022168178158e-01, 9.8042757395671565e-01,
+    9.8944236513373096e-01, 9.9569964038324599e-01, 9.9918335390929469e-01,
+    /* order 60 */
+    2.5959772301247800e-02, 7.7809333949536569e-02, 1.2944913539694500e-01,
+    1.8073996487342542e-01, 2.3154355137602933e-01, 2.8172293742326171e-01,
+    3.3114284826844820e-01, 3.7967005657679798e-01, 4.2717374158307841e-01,
+    4.7352584176170709e-01, 5.1860140005856969e-01, 5.6227890075394449e-01,
+    6.0444059704851039e-01, 6.4497282848947701e-01, 6.8376632738135545e-01,
+    7.2071651335573039e-01, 7.5572377530658563e-01, 7.8869373993226410e-01,
+    8.1953752616214581e-01, 8.4817198478592959e-01, 8.7451992264689826e-01,
+    8.9851031081004595e-01, 9.2007847617762750e-01, 9.3916627611642323e-01,
+    9.5572225583999615e-01, 9.6970178876505275e-01, 9.8106720175259821e-01,
+    9.8978789522222177e-01, 9.9584052511883814e-01, 9.9921012322743608e-01,
+    /* order 61 */
+    0.0000000000000000e+00, 5.1058906707974347e-02, 1.0198460656227407e-01,
+    1.5264424023081530e-01, 2.0290564251805851e-01, 2.5263768716905349e-01,
+    3.0171062896303069e-01, 3.4999644220406684e-01, 3.9736915472575662e-01,
+    4.4370517653853159e-01, 4.8888362226225213e-01, 5.3278662650292530e-01,
+    5.7529965135083061e-01, 6.1631178519792174e-01, 6.5571603209507090e-01,
+    6.9340959089449117e-01, 7.2929412344946509e-01, 7.6327601117231225e-01,
+    7.9526659928235965e-01, 8.2518242810865994e-01, 8.5294545084766349e-01,
+    8.7848323721488109e-01, 9.0172916247400114e-01, 9.2262258138295528e-01,
+    9.4110898668136111e-01, 9.5714015191298407e-01, 9.7067425883318292e-01,
+    9.8167601128403703e-01, 9.9011674523251703e-01, 9.9597459981512027e-01,
+    9.9923559763136349e-01,
+    /* order 62 */
+    2.5129291421820615e-02, 7.5324395496234334e-02, 1.2532922361589680e-01,
+    1.7501745924901563e-01, 2.2426358560416554e-01, 2.7294320269672634e-01,
+    3.2093334159419401e-01, 3.6811277504656453e-01, 4.1436232371712606e-01,
+    4.5956515724011338e-01, 5.0360708934475595e-01, 5.4637686630025106e-01,
+    5.8776644795308730e-01, 6.2767128064688515e-01, 6.6599056133547940e-01,
+    7.0262749222229703e-01, 7.3748952528315670e-01, 7.7048859605541931e-01,
+    8.0154134610397643e-01, 8.3056933360400487e-01, 8.5749923151207097e-01,
+    8.8226301283189734e-01, 9.0479812252109348e-01, 9.2504763563620374e-01,
+    9.4296040139232851e-01, 9.5849117297392705e-01, 9.7160072337165182e-01,
+    9.8225594909723668e-01, 9.9042997118929033e-01, 9.9610229631626712e-01,
+    9.9925985930877703e-01,
+    /* order 63 */
+    0.0000000000000000e+00, 4.9452187116159625e-02, 9.8783356446945275e-02,
+    1.4787278635787196e-01, 1.9660034679150667e-01, 2.4484679324595338e-01,
+    2.9249405858625144e-01, 3.3942554197458441e-01, 3.8552639421224788e-01,
+    4.3068379879511159e-01, 4.7478724799480437e-01, 5.1772881329003329e-01,
+    5.5940340948628497e-01, 5.9970905187762524e-01, 6.3854710582136542e-01,
+    6.7582252811498611e-01, 7.1144409958484578e-01, 7.4532464831784739e-01,
+    7.7738126299037236e-01, 8.0753549577345674e-01, 8.3571355431950289e-01,
+    8.6184648236412376e-01, 8.8587032850785341e-01, 9.0772630277853161e-01,
+    9.2736092062184317e-01, 9.4472613404100980e-01, 9.5977944975894192e-01,
+    9.7248403469757005e-01, 9.8280881059372727e-01, 9.9072854689218948e-01,
+    9.9622401277797012e-01, 9.9928298402912374e-01,
+    /* order 64 */
+    2.4350292663424433e-02, 7.2993121787799042e-02, 1.2146281929612056e-01,
+    1.6964442042399283e-01, 2.1742364374000708e-01, 2.6468716220876742e-01,
+    3.1132287199021097e-01, 3.5722015833766813e-01, 4.0227015796399163e-01,
+    4.4636601725346409e-01, 4.8940314570705296e-01, 5.3127946401989457e-01,
+    5.7189564620263400e-01, 6.1115535517239328e-01, 6.4896547125465731e-01,
+    6.8523631305423327e-01, 7.1988185017161088e-01, 7.5281990726053194e-01,
+    7.8397235894334139e-01, 8.1326531512279754e-01, 8.4062929625258032e-01,
+    8.6599939815409277e-01, 8.8931544599511414e-01, 9.1052213707850282e-01,
+    9.2956917213193957e-01, 9.4641137485840277e-01, 9.6100879965205377e-01,
+    9.7332682778991098e-01, 9.8333625388462598e-01, 9.9101337147674429e-01,
+    9.9634011677195533e-01, 9.9930504173577217e-01
+};
+
+/* Weights of the nodes in GLQ_TABLE_NODES (same order) */
+static const double GLQ_TABLE_WEIGHTS[] = {
+    /* order 2 */
+    1.0000000000000000e+00,
+    /* order 3 */
+    8.8888888888888884e-01, 5.5555555555555558e-01,
+    /* order 4 */
+    6.5214515486254609e-01, 3.4785484513745385e-01,
+    /* order 5 */
+    5.6888888888888889e-01, 4.7862867049936647e-01, 2.3692688505618908e-01,
+    /* order 6 */
+    4.6791393457269104e-01, 3.6076157304813861e-01, 1.7132449237917036e-01,
+    /* order 7 */
+    4.1795918367346940e-01, 3.8183005050511892e-01, 2.7970539148927664e-01,
+    1.2948496616886970e-01,
+    /* order 8 */
+    3.6268378337836199e-01, 3.1370664587788727e-01, 2.2238103445337448e-01,
+    1.0122853629037626e-01,
+    /* order 9 */
+    3.3023935500125978e-01, 3.1234707704000286e-01, 2.6061069640293544e-01,
+    1.8064816069485740e-01, 8.1274388361574412e-02,
+    /* order 10 */
+    2.9552422471475287e-01, 2.6926671930999635e-01, 2.1908636251598204e-01,
+    1.4945134915058059e-01, 6.6671344308688138e-02,
+    /* order 11 */
+    2.7292508677790062e-01, 2.6280454451024665e-01, 2.3319376459199048e-01,
+    1.8629021092773426e-01, 1.2558036946490461e-01, 5.5668567116173663e-02,
+    /* order 12 */
+    2.4914704581340277e-01, 2.3349253653835481e-01, 2.0316742672306592e-01,
+    1.6007832854334622e-01, 1.0693932599531843e-01, 4.7175336386511828e-02,
+    /* order 13 */
+    2.3255155323087390e-01, 2.2628318026289723e-01, 2.0781604753688851e-01,
+    1.7814598076194574e-01, 1.3887351021978725e-01, 9.2121499837728452e-02,
+    4.0484004765315877e-02,
+    /* order 14 */
+    2.1526385346315779e-01, 2.0519846372129560e-01, 1.8553839747793782e-01,
+    1.5720316715819355e-01, 1.2151857068790319e-01, 8.0158087159760208e-02,
+    3.5119460331751860e-02,
+    /* order 15 */
+    2.0257824192556129e-01, 1.9843148532711158e-01, 1.8616100001556221e-01,
+    1.6626920581699392e-01, 1.3957067792615432e-01, 1.0715922046717194e-01,
+    7.0366047488108124e-02, 3.0753241996117269e-02,
+    /* order 16 */
+    1.8945061045506850e-01, 1.8260341504492358e-01, 1.6915651939500254e-01,
+    1.4959598881657674e-01, 1.2462897125553388e-01, 9.5158511682492786e-02,
+    6.2253523938647894e-02, 2.7152459411754096e-02,
+    /* order 17 */
+    1.7944647035620653e-01, 1.7656270536699264e-01, 1.6800410215645004e-01,
+    1.5404576107681028e-01, 1.3513636846852548e-01, 1.1188384719340397e-01,
+    8.5036148317179178e-02, 5.5459529373987203e-02, 2.4148302868547931e-02,
+    /* order 18 */
+    1.6914238296314360e-01, 1.6427648374583273e-01, 1.5468467512626524e-01,
+    1.4064291467065065e-01, 1.2255520671147846e-01, 1.0094204410628717e-01,
+    7.6425730254889052e-02, 4.9714548894969797e-02, 2.1616013526483312e-02,
+    /* order 19 */
+    1.6105444984878370e-01, 1.5896884339395434e-01, 1.5276604206585967e-01,
+    1.4260670217360660e-01, 1.2875396253933621e-01, 1.1156664554733399e-01,
+    9.1490021622449999e-02, 6.9044542737641226e-02, 4.4814226765699600e-02,
+    1.9461788229726478e-02,
+    /* order 20 */
+    1.5275338713072584e-01, 1.4917298647260374e-01, 1.4209610931838204e-01,
+    1.3168863844917664e-01, 1.1819453196151841e-01, 1.0193011981724044e-01,
+    8.3276741576704755e-02, 6.2672048334109068e-02, 4.0601429800386939e-02,
+    1.7614007139152118e-02,
+    /* order 21 */
+    1.4608113364969041e-01, 1.4452440398997005e-01, 1.3988739479107315e-01,
+    1.3226893863333747e-01, 1.2183141605372853e-01, 1.0879729916714838e-01,
+    9.3444423456033862e-02, 7.6100113628379304e-02, 5.7134425426857205e-02,
+    3.6953789770852494e-02, 1.6017228257774335e-02,
+    /* order 22 */
+    1.3925187285563198e-01, 1.3654149834601517e-01, 1.3117350478706238e-01,
+    1.2325237681051242e-01, 1.1293229608053922e-01, 1.0041414444288096e-01,
+    8.5941606217067729e-02, 6.9796468424520489e-02, 5.2293335152683286e-02,
+    3.3774901584814152e-02, 1.4627995298272200e-02,
+    /* order 23 */
+    1.3365457218610619e-01, 1.3246203940469661e-01, 1.2890572218808216e-01,
+    1.2304908430672953e-01, 1.1499664022241136e-01, 1.0489209146454141e-01,
+    9.2915766060035154e-02, 7.9281411776718949e-02, 6.4232421408525850e-02,
+    4.8037671731084669e-02, 3.0988005856979445e-02, 1.3411859487141771e-02,
+    /* order 24 */
+    1.2793819534675216e-01, 1.2583745634682830e-01, 1.2167047292780339e-01,
+    1.1550566805372560e-01, 1.0744427011596563e-01, 9.7618652104113884e-02,
+    8.6190161531953274e-02, 7.3346481411080300e-02, 5.9298584915436783e-02,
+    4.4277438817419808e-02, 2.8531388628933663e-02, 1.2341229799987200e-02,
+    /* order 25 */
+    1.2317605372671545e-01, 1.2224244299031004e-01, 1.1945576353578477e-01,
+    1.1485825914571164e-01, 1.0851962447426365e-01, 1.0053594906705064e-01,
+    9.1028261982963654e-02, 8.0140700335001022e-02, 6.8038333812356910e-02,
+    5.4904695975835194e-02, 4.0939156701306316e-02, 2.6354986615032137e-02,
+    1.1393798501026288e-02,
+    /* order 26 */
+    1.1832141527926228e-01, 1.1666044348529658e-01, 1.1336181654631966e-01,
+    1.0847184052857659e-01, 1.0205916109442542e-01, 9.4213800355914146e-02,
+    8.5045894313485235e-02, 7.4684149765659749e-02, 6.3274046329574840e-02,
+    5.0975825297147809e-02, 3.7962383294362766e-02, 2.4417851092631910e-02,
+    1.0551372617343006e-02,
+    /* order 27 */
+    1.1422086737895699e-01, 1.1347634610896515e-01, 1.1125248835684519e-01,
+    1.0757828578853319e-01, 1.0250163781774579e-01, 9.6088727370028507e-02,
+    8.8423158543756944e-02, 7.9604867773057766e-02, 6.9748823766245596e-02,
+    5.8983536859833596e-02, 4.7449412520615061e-02, 3.5297053757419712e-02,
+    2.2686231596180623e-02, 9.7989960512943602e-03,
+    /* order 28 */
+    1.1004701301647520e-01, 1.0871119225829413e-01, 1.0605576592284642e-01,
+    1.0211296757806076e-01, 9.6930657997929923e-02, 9.0571744393032838e-02,
+    8.3113417228901212e-02, 7.4646214234568783e-02, 6.5272923966999602e-02,
+    5.5107345675716748e-02, 4.4272934759004227e-02, 3.2901427782304378e-02,
+    2.1132112592771261e-02, 9.1242825930945171e-03,
+    /* order 29 */
+    1.0647938171831424e-01, 1.0587615509732094e-01, 1.0407331007772938e-01,
+    1.0109127375991496e-01, 9.6963834094408605e-02, 9.1737757139258760e-02,
+    8.5472257366172533e-02, 7.8238327135763786e-02, 7.0117933255051279e-02,
+    6.1203090657079136e-02, 5.1594826902497927e-02, 4.1402062518682836e-02,
+    3.0740492202093624e-02, 1.9732085056122707e-02, 8.5169038787464100e-03,
+    /* order 30 */
+    1.0285265289355884e-01, 1.0176238974840550e-01, 9.9593420586795267e-02,
+    9.6368737174644253e-02, 9.2122522237786122e-02, 8.6899787201082976e-02,
+    8.0755895229420213e-02, 7.3755974737705204e-02, 6.5974229882180491e-02,
+    5.7493156217619065e-02, 4.8402672830594053e-02, 3.8799192569627050e-02,
+    2.8784707883323369e-02, 1.8466468311090958e-02, 7.9681924961666050e-03,
+    /* order 31 */
+    9.9720544793426458e-02, 9.9225011226672308e-02, 9.7743335386328720e-02,
+    9.5290242912319509e-02, 9.1890113893641476e-02, 8.7576740608477879e-02,
+    8.2392991761589263e-02, 7.6390386598776616e-02, 6.9628583235410366e-02,
+    6.2174786561028428e-02, 5.4103082424916855e-02, 4.5493707527201104e-02,
+    3.6432273912385467e-02, 2.7009019184979423e-02, 1.7318620790310584e-02,
+    7.4708315792487755e-03,
+    /* order 32 */
+    9.6540088514727798e-02, 9.5638720079274861e-02, 9.3844399080804566e-02,
+    9.1173878695763891e-02, 8.7652093004403811e-02, 8.3311924226946749e-02,
+    7.8193895787070311e-02, 7.2345794108848505e-02, 6.5822222776361849e-02,
+    5.8684093478535544e-02, 5.0998059262376175e-02, 4.2835898022226683e-02,
+    3.4273862913021431e-02, 2.5392065309262059e-02, 1.6274394730905670e-02,
+    7.0186100094700964e-03,
+    /* order 33 */
+    9.3768446160210003e-02, 9.3356426065596118e-02, 9.2123986643316849e-02,
+    9.0081958660638575e-02, 8.7248287618844331e-02, 8.3647876067038704e-02,
+    7.9312364794886736e-02, 7.4279854843954149e-02, 6.8594572818656718e-02,
+    6.2306482530317481e-02, 5.5470846631663559e-02, 4.8147742818711696e-02,
+    4.0401541331669594e-02, 3.2300358632328954e-02, 2.3915548101749479e-02,
+    1.5321701512934676e-02, 6.6062278475873780e-03,
+    /* order 34 */
+    9.0956740330259869e-02, 9.0203044370640736e-02, 8.8701897835693863e-02,
+    8.6465739747035752e-02, 8.3513099699845661e-02, 7.9868444339771846e-02,
+    7.5561974660031936e-02, 7.0629375814255727e-02, 6.5111521554076415e-02,
+    5.9054135827524494e-02, 5.2507414572678109e-02, 4.5525611523353271e-02,
+    3.8166593796387517e-02, 3.0491380638446131e-02, 2.2563721985494969e-02,
+    1.4450162748595036e-02, 6.2291405559086847e-03,
+    /* order 35 */
+    8.8486794907104288e-02, 8.8140530430275463e-02, 8.7104446997183532e-02,
+    8.5386653392099124e-02, 8.3000593728856584e-02, 7.9964942242324269e-02,
+    7.6303457155442053e-02, 7.2044794772560067e-02, 6.7222285269086898e-02,
+    6.1873671966080186e-02, 5.6040816212370129e-02, 4.9769370401353527e-02,
+    4.3108422326170216e-02, 3.6110115863463382e-02, 2.8829260108894254e-02,
+    2.1322979911483582e-02, 1.3650828348361493e-02, 5.8834334204430853e-03,
+    /* order 36 */
+    8.5983275670394751e-02, 8.5346685739338624e-02, 8.4078218979661931e-02,
+    8.2187266704339706e-02, 7.9687828912071601e-02, 7.6598410645870668e-02,
+    7.2941885005653059e-02, 6.8745323835736449e-02, 6.4039797355015485e-02,
+    5.8860144245324819e-02, 5.3244713977759921e-02, 4.7235083490265978e-02,
+    4.0875750923644892e-02, 3.4213810770307232e-02, 2.7298621498568779e-02,
+    2.0181515297735472e-02, 1.2915947284065574e-02, 5.5657196642450455e-03,
+    /* order 37 */
+    8.3768360993138904e-02, 8.3474573625862789e-02, 8.2595272236437256e-02,
+    8.1136624508465024e-02, 7.9108861837529382e-02, 7.6526207570529234e-02,
+    7.3406777248488167e-02, 6.9772451555700346e-02, 6.5648722872751253e-02,
+    6.1064516523225990e-02, 5.6051987998274919e-02, 5.0646297654824604e-02,
+    4.4885364662437165e-02, 3.8809602501934541e-02, 3.2461639847521484e-02,
+    2.5886036990558935e-02, 1.9129044489083966e-02, 1.2238780100307557e-02,
+    5.2730572794979389e-03,
+    /* order 38 */
+    8.1525029280385783e-02, 8.0982493770597103e-02, 7.9901033243527819e-02,
+    7.8287844658210953e-02, 7.6153663548446396e-02, 7.3512692584743453e-02,
+    7.0382507066898956e-02, 6.6783937979140409e-02, 6.2740933392133061e-02,
+    5.8280399146997203e-02, 5.3432019910332321e-02, 4.8228061860758682e-02,
+    4.2703158504674432e-02, 3.6894081594024741e-02, 3.0839500545175053e-02,
+    2.4579739738232374e-02, 1.8156577709613236e-02, 1.1613444716468675e-02,
+    5.0028807496393457e-03,
+    /* order 39 */
+    7.9527622139442852e-02, 7.9276222568368471e-02, 7.8523613287371175e-02,
+    7.7274552544682018e-02, 7.5536937322836062e-02, 7.3321753414268623e-02,
+    7.0643005970608755e-02, 6.7517630966231271e-02, 6.3965388138682383e-02,
+    6.0008736088596151e-02, 5.5672690340916299e-02, 5.0984665292129402e-02,
+    4.5974301108916635e-02, 4.0673276847933842e-02, 3.5115111498131332e-02,
+    2.9334955983903378e-02, 2.3369384832178163e-02, 1.7256229093724918e-02,
+    1.1034788939164594e-02, 4.7529446916351010e-03,
+    /* order 40 */
+    7.7505947978424805e-02, 7.7039818164247972e-02, 7.6110361900626242e-02,
+    7.4723169057968261e-02, 7.2886582395804062e-02, 7.0611647391286780e-02,
+    6.7912045815233898e-02, 6.4804013456601042e-02, 6.1306242492928938e-02,
+    5.7439769099391552e-02, 5.3227846983936823e-02, 4.8695807635072232e-02,
+    4.3870908185673269e-02, 3.8782167974472016e-02, 3.3460195282547844e-02,
+    2.7937006980023400e-02, 2.2245849194166958e-02, 1.6421058381907890e-02,
+    1.0498284531152813e-02, 4.5212770985331909e-03,
+    /* order 41 */
+    7.5695535647298376e-02, 7.5478747092715820e-02, 7.4829623176221549e-02,
+    7.3751882027223464e-02, 7.2251696861023076e-02, 7.0337660620817491e-02,
+    6.8020736760876763e-02, 6.5314196453527415e-02, 6.2233542580966320e-02,
+    5.8796420949871947e-02, 5.5022519242578741e-02, 5.0933454294617493e-02,
+    4.6552648369014342e-02, 4.1905195195909690e-02, 3.7017716703507987e-02,
+    3.1918211731699279e-02, 2.6635899207110444e-02, 2.1201063368779555e-02,
+    1.5644938407818589e-02, 9.9999387739059462e-03, 4.3061403581648875e-03,
+    /* order 42 */
+    7.3864234232172879e-02, 7.3460813453467527e-02, 7.2656175243804105e-02,
+    7.1454714265170985e-02, 6.9862992492594159e-02, 6.7889703376521948e-02,
+    6.5545624364908975e-02, 6.2843558045002579e-02, 5.9798262227586656e-02,
+    5.6426369358018383e-02, 5.2746295699174071e-02, 4.8778140792803244e-02,
+    4.4543577771965881e-02, 4.0065735180692265e-02, 3.5369071097592110e-02,
+    3.0479240699603467e-02, 2.5422959526113047e-02, 2.0227869569052644e-02,
+    1.4922443697357493e-02, 9.5362203017485027e-03, 4.1059986046490847e-03,
+    /* order 43 */
+    7.2215751693798985e-02, 7.2027501971421978e-02, 7.1463734252514136e-02,
+    7.0527387765085034e-02, 6.9223344193656680e-02, 6.7558402229365169e-02,
+    6.5541242126322799e-02, 6.3182380449396114e-02, 6.0494115249991293e-02,
+    5.7490461956910523e-02, 5.4187080318881788e-02, 5.0601192784390153e-02,
+    4.6751494754346583e-02, 4.2658057197982081e-02, 3.8342222194132657e-02,
+    3.3826492086860289e-02, 2.9134413261498494e-02, 2.4290456613838815e-02,
+    1.9319901423683901e-02, 1.4248756431576486e-02, 9.1039966374014038e-03,
+    3.9194902538441274e-03,
+    /* order 44 */
+    7.0549157789354069e-02, 7.0197685473558216e-02, 6.9496491861572585e-02,
+    6.8449070269366655e-02, 6.7060638906293657e-02, 6.5338114879181439e-02,
+    6.3290079733203858e-02, 6.0926736701561970e-02, 5.8259859877595493e-02,
+    5.5302735563728056e-02, 5.2070096091704460e-02, 4.8578046448352036e-02,
+    4.4843984081970031e-02, 4.0886512310346221e-02, 3.6725347813808873e-02,
+    3.2381222812069822e-02, 2.7875782821281010e-02, 2.3231481902019211e-02,
+    1.8471481736814750e-02, 1.3619586755579985e-02, 8.7004813675248434e-03,
+    3.7454048031127776e-03,
+    /* order 45 */
+    6.9041824829232018e-02, 6.8877316977661321e-02, 6.8384577378669681e-02,
+    6.7565954163607542e-02, 6.6425348449842533e-02, 6.4968195750723434e-02,
+    6.3201440073819934e-02, 6.1133500831066521e-02, 5.8774232718841739e-02,
+    5.6134878759786476e-02, 5.3228016731268951e-02, 5.0067499237952028e-02,
+    4.6668387718373366e-02, 4.3046880709164972e-02, 3.9220236729302450e-02,
+    3.5206692201609019e-02, 3.1025374934515466e-02, 2.6696213967577664e-02,
+    2.2239847550578732e-02, 1.7677535257937589e-02, 1.3031104991582785e-02,
+    8.3231892962182408e-03, 3.5826631552835588e-03,
+    /* order 46 */
+    6.7518685849036461e-02, 6.7210613600678176e-02, 6.6595874768454882e-02,
+    6.5677274267781208e-02, 6.4459003467139064e-02, 6.2946621064394512e-02,
+    6.1147027724650478e-02, 5.9068434595546317e-02, 5.6720325843991233e-02,
+    5.4113415385856754e-02, 5.1259598007143019e-02, 4.8171895101712200e-02,
+    4.4864395277318128e-02, 4.1352190109678728e-02, 3.7651305357386068e-02,
+    3.3778627999106900e-02, 2.9751829552202756e-02, 2.5589286397130012e-02,
+    2.1309998754136500e-02, 1.6933514007836239e-02, 1.2479883770988685e-02,
+    7.9698982297246226e-03, 3.4303008681070483e-03,
+    /* order 47 */
+    6.6135129623655475e-02, 6.5990533588810477e-02, 6.5557377766549740e-02,
+    6.4837556238945729e-02, 6.3834216605717031e-02, 6.2551746220921661e-02,
+    6.0995753008739648e-02, 5.9173040942338877e-02, 5.7091580293231539e-02,
+    5.4760472781530227e-02, 5.2189911780057142e-02, 4.9391137747361168e-02,
+    4.6376389086505911e-02, 4.3158848648479541e-02, 3.9752586122531006e-02,
+    3.6172496584174950e-02, 3.2434235515184755e-02, 2.8554150700643387e-02,
+    2.4549211659658818e-02, 2.0436938147668428e-02, 1.6235333146433061e-02,
+    1.1962848464312321e-02, 7.6386162958488333e-03, 3.2874538425280149e-03,
+    /* order 48 */
+    6.4737696812683918e-02, 6.4466164435950088e-02, 6.3924238584648185e-02,
+    6.3114192286254020e-02, 6.2039423159892665e-02, 6.0704439165893881e-02,
+    5.9114839698395635e-02, 5.7277292100403214e-02, 5.5199503699984165e-02,
+    5.2890189485193667e-02, 5.0359035553854473e-02, 4.7616658492490478e-02,
+    4.4674560856694280e-02, 4.1545082943464748e-02, 3.8241351065830709e-02,
+    3.4777222564770442e-02, 3.1167227832798090e-02, 2.7426509708356948e-02,
+    2.3570760839324380e-02, 1.9616160457355529e-02, 1.5579315722943849e-02,
+    1.1477234579234540e-02, 7.3275539012762625e-03, 3.1533460523058385e-03,
+    /* order 49 */
+    6.3463281404790600e-02, 6.3335509296491746e-02, 6.2952707465195698e-02,
+    6.2316417320057264e-02, 6.1429200979192938e-02, 6.0294630953152017e-02,
+    5.8917275760027268e-02, 5.7302681530187478e-02, 5.5457349674803591e-02,
+    5.3388710708258971e-02, 5.1105094330144589e-02, 4.8615695887828242e-02,
+    4.5930539355595851e-02, 4.3060436981259595e-02, 4.0016945766373019e-02,
+    3.6812320963000689e-02, 3.3459466791622178e-02, 2.9971884620583825e-02,
+    2.6363618927066016e-02, 2.2649201587446675e-02, 1.8843595853089458e-02,
+    1.4962144935624651e-02, 1.1020551031593580e-02, 7.0350995900864514e-03,
+    3.0272789889229049e-03,
+    /* order 50 */
+    6.2176616655347260e-02, 6.1936067420683243e-02, 6.1455899590316665e-02,
+    6.0737970841770218e-02, 5.9785058704265460e-02, 5.8600849813222444e-02,
+    5.7189925647728380e-02, 5.5557744806212520e-02, 5.3710621888996245e-02,
+    5.1655703069581137e-02, 4.9400938449466317e-02, 4.6955051303948434e-02,
+    4.4327504338803274e-02, 4.1528463090147696e-02, 3.8568756612587678e-02,
+    3.5459835615146151e-02, 3.2213728223578014e-02, 2.8842993580535197e-02,
+    2.5360673570012392e-02, 2.1780243170124794e-02, 1.8115560713489392e-02,
+    1.4380822761485574e-02, 1.0590548383650969e-02, 6.7597991957454012e-03,
+    2.9086225531551411e-03,
+    /* order 51 */
+    6.0998924841205879e-02, 6.0885464844856345e-02, 6.0545506934737793e-02,
+    5.9980315777503256e-02, 5.9191993922961546e-02, 5.8183473982592139e-02,
+    5.6958507720258664e-02, 5.5521652095738692e-02, 5.3878252313045563e-02,
+    5.2034421936697085e-02, 4.9997020150057407e-02, 4.7773626240623104e-02,
+    4.5372511407650071e-02, 4.2802607997880084e-02, 4.0073476285496457e-02,
+    3.7195268923260291e-02, 3.4178693204188336e-02, 3.1034971290160009e-02,
+    2.7775798594162477e-02, 2.4413300573781434e-02, 2.0959988401703211e-02,
+    1.7428714723401052e-02, 1.3832634006477822e-02, 1.0185191297821731e-02,
+    6.5003377832526001e-03, 2.7968071710898954e-03,
+    /* order 52 */
+    5.9810365745291860e-02, 5.9596260171248160e-02, 5.9168815466042968e-02,
+    5.8529561771813871e-02, 5.7680787452526826e-02, 5.6625530902368597e-02,
+    5.5367569669302653e-02, 5.3911406932757262e-02, 5.2262255383906990e-02,
+    5.0426018566342379e-02, 4.8409269744074897e-02, 4.6219228372784790e-02,
+    4.3863734259000406e-02, 4.1351219500560268e-02, 3.8690678310423977e-02,
+    3.5891634835097233e-02, 3.2964109089718800e-02, 2.9918581147143946e-02,
+    2.6765953746504013e-02, 2.3517513553984463e-02, 2.0184891507980793e-02,
+    1.6780023396300737e-02, 1.3315114982340961e-02, 9.8026345794627514e-03,
+    6.2555239629732773e-03, 2.6913169500471113e-03,
+    /* order 53 */
+    5.8718794151164364e-02, 5.8617586232720266e-02, 5.8314311362256011e-02,
+    5.7810014991713198e-02, 5.7106435536267194e-02, 5.6205998381739709e-02,
+    5.5111807523933597e-02, 5.3827634868731031e-02, 5.2357907229872720e-02,
+    5.0707691069292717e-02, 4.8882675032699142e-02, 4.6889150340750314e-02,
+    4.4733989103672808e-02, 4.2424620634520016e-02, 3.9969005843540385e-02,
+    3.7375609803482916e-02, 3.4653372583534237e-02, 3.1811678459019326e-02,
+    2.8860323617823737e-02, 2.5809482510757518e-02, 2.2669673057070207e-02,
+    1.9451721107636894e-02, 1.6166725256687463e-02, 1.2826026144240379e-02,
+    9.4412022849403449e-03, 6.0242762269486737e-03, 2.5916837205670318e-03,
+    /* order 54 */
+    5.7617536707147025e-02, 5.7426137054112113e-02, 5.7043973558794599e-02,
+    5.6472315730625965e-02, 5.5713062560589985e-02, 5.4768736213057986e-02,
+    5.3642473647553611e-02, 5.2338016198298747e-02, 5.0859697146188147e-02,
+    4.9212427324528886e-02, 4.7401678806444990e-02, 4.5433466728276715e-02,
+    4.3314329309597013e-02, 4.1051306136644976e-02, 3.8651914782102517e-02,
+    3.6124125840383554e-02, 3.3476336464372647e-02, 3.0717342497870677e-02,
+    2.7856309310595871e-02, 2.4902741467208774e-02, 2.1866451422853084e-02,
+    1.8757527621469379e-02, 1.5586303035924131e-02, 1.2363328128847644e-02,
+    9.0993694555093971e-03, 5.8056110152399851e-03, 2.4974818357615860e-03,
+    /* order 55 */
+    5.6602976444560422e-02, 5.6512318249772001e-02, 5.6240634071084365e-02,
+    5.5788794195284090e-02, 5.5158246002508689e-02, 5.4351009329911104e-02,
+    5.3369670001605474e-02, 5.2217371545632087e-02, 5.0897805124493982e-02,
+    4.9415197711551742e-02, 4.7774298551200696e-02, 4.5980363946283839e-02,
+    4.4039140421606587e-02, 4.1956846317718760e-02, 3.9740151874337180e-02,
+    3.7396157867965546e-02, 3.4932372873589884e-02, 3.2356689226185835e-02,
+    2.9677357765161040e-02, 2.6902961456396271e-02, 2.4042388009725621e-02,
+    2.1104801668016454e-02, 1.8099614520729064e-02, 1.5036458333511788e-02,
+    1.1925160719848612e-02, 8.7757461070585279e-03, 5.5986322665607675e-03,
+    2.4083236199797888e-03,
+    /* order 56 */
+    5.5579746306514397e-02, 5.5407952503245123e-02, 5.5064895901762424e-02,
+    5.4551636870889424e-02, 5.3869761865714488e-02, 5.3021378524010766e-02,
+    5.2009109151741402e-02, 5.0836082617798484e-02, 4.9505924683047577e-02,
+    4.8022746793600260e-02, 4.6391133373001894e-02, 4.4616127652692281e-02,
+    4.2703216084667088e-02, 4.0658311384744517e-02, 3.8487734259247661e-02,
+    3.6198193872315189e-02, 3.3796767115611762e-02, 3.1290876747310445e-02,
+    2.8688268473822741e-02, 2.5996987058391954e-02, 2.3225351562565315e-02,
+    2.0381929882402571e-02, 1.7475512911400946e-02, 1.4515089278021472e-02,
+    1.1509824340383383e-02, 8.4690631633078869e-03, 5.4025222460153382e-03,
+    2.3238553757732156e-03,
+    /* order 57 */
+    5.4634328756584027e-02, 5.4552803604761883e-02, 5.4308471452498640e-02,
+    5.3902061483298576e-02, 5.3334786584819160e-02, 5.2608339729177431e-02,
+    5.1724888920517825e-02, 5.0687070724927411e-02, 4.9497982402019677e-02,
+    4.8161172661687748e-02, 4.6680631073641503e-02, 4.5060776161381155e-02,
+    4.3306442216215199e-02, 4.1422864870801109e-02, 3.9415665475480116e-02,
+    3.7290834324417314e-02, 3.5054712782312619e-02, 3.2713974366371572e-02,
+    3.0275604842693999e-02, 2.7746881402180193e-02, 2.5135350990918123e-02,
+    2.2448807890776436e-02, 1.9695270699488520e-02, 1.6882959023441550e-02,
+    1.4020270790753556e-02, 1.1115763732335989e-02, 8.1781600678212333e-03,
+    5.2165334747187797e-03, 2.2437538722506630e-03,
+    /* order 58 */
+    5.3681119863334847e-02, 5.3526343304058255e-02, 5.3217236446579011e-02,
+    5.2754690526370836e-02, 5.2140039183669822e-02, 5.1375054618285725e-02,
+    5.0461942479953129e-02, 4.9403335508962393e-02, 4.8202285945417749e-02,
+    4.6862256729026344e-02, 4.5387111514819806e-02, 4.3781103533640252e-02,
+    4.2048863329582124e-02, 4.0195385409867800e-02, 3.8226013845858435e-02,
+    3.6146426867087272e-02, 3.3962620493416008e-02, 3.1680891253809330e-02,
+    2.9307818044160491e-02, 2.6850243181981870e-02, 2.4315252724963952e-02,
+    2.1710156140146236e-02, 1.9042465461893407e-02, 1.6319874234970964e-02,
+    1.3550237112988812e-02, 1.0741553532878773e-02, 7.9019738499986752e-03,
+    5.0399816126502428e-03, 2.1677232496274501e-03,
+    /* order 59 */
+    5.2798012621990423e-02, 5.2724433859127930e-02, 5.2503902647828740e-02,
+    5.2137033648375394e-02, 5.1624849390891479e-02, 5.0968777425393914e-02,
+    5.0170646342996901e-02, 4.9232680679361984e-02, 4.8157494714606439e-02,
+    4.6948085186962016e-02, 4.5607822940509767e-02, 4.4140443530297384e-02,
+    4.2550036811067636e-02, 4.0841035538686711e-02, 3.9018203016160012e-02,
+    3.7086619818870924e-02, 3.5051669636400107e-02, 3.2919024271045275e-02,
+    3.0694627836111682e-02, 2.8384680200534800e-02, 2.5995619731298499e-02,
+    2.3534105393713364e-02, 2.1006998288437186e-02, 1.8421342753610029e-02,
+    1.5784347313081468e-02, 1.3103366306345191e-02, 1.0385885500995862e-02,
+    7.6395294534875756e-03, 4.8722391682652849e-03, 2.0954922845412235e-03,
+    /* order 60 */
+    5.1907877631220636e-02, 5.1767943174910187e-02, 5.1488451500980935e-02,
+    5.1070156069855627e-02, 5.0514184532509374e-02, 4.9822035690550180e-02,
+    4.8995575455756835e-02, 4.8037031819971182e-02, 4.6948988848912201e-02,
+    4.5734379716114486e-02, 4.4396478795787113e-02, 4.2938892835935639e-02,
+    4.1365551235584753e-02, 3.9680695452380801e-02, 3.7888867569243444e-02,
+    3.5994898051084502e-02, 3.4003892724946423e-02, 3.1921219019296329e-02,
+    2.9752491500788944e-02, 2.7503556749924791e-02, 2.5180477621521247e-02,
+    2.2789516943997820e-02, 2.0337120729457286e-02, 1.7829901014207720e-02,
+    1.5274618596784799e-02, 1.2678166476815959e-02, 1.0047557182287984e-02,
+    7.3899311633454558e-03, 4.7127299269535683e-03, 2.0268119688737585e-03,
+    /* order 61 */
+    5.1081119440786221e-02, 5.1014487038697265e-02, 5.0814763668818340e-02,
+    5.0482470386797408e-02, 5.0018474108178251e-02, 4.9423985346735588e-02,
+    4.8700555056411528e-02, 4.7850070585095605e-02, 4.6874750750809067e-02,
+    4.5777140053145961e-02, 4.4560102035083489e-02, 4.3226811812496095e-02,
+    4.1780747790888494e-02, 4.0225682590998249e-02, 3.8565673207008176e-02,
+    3.6805050423154816e-02, 3.4948407516533352e-02, 3.3000588275907412e-02,
+    3.0966674368397396e-02, 2.8851972088183402e-02, 2.6661998524150889e-02,
+    2.4402467187544203e-02, 2.2079273148319045e-02, 1.9698477746101180e-02,
+    1.7266292987613743e-02, 1.4789065884937915e-02, 1.2273263507812104e-02,
+    9.7254618303561340e-03, 7.1523549917490896e-03, 4.5609240060124172e-03,
+    1.9614533616702829e-03,
+    /* order 62 */
+    5.0248000375256278e-02, 5.0121069569043289e-02, 4.9867528594952394e-02,
+    4.9488017919699291e-02, 4.8983496220517835e-02, 4.8355237963477675e-02,
+    4.7604830184101235e-02, 4.6734168478415522e-02, 4.5745452214570180e-02,
+    4.4641178977124413e-02, 4.3424138258047418e-02, 4.2097404410385099e-02,
+    4.0664328882417444e-02, 3.9128531751963083e-02, 3.7493892582280031e-02,
+    3.5764540622768140e-02, 3.3944844379410546e-02, 3.2039400581624682e-02,
+    3.0053022573989872e-02, 2.7990728163314639e-02, 2.5857726954024697e-02,
+    2.3659407208682794e-02, 2.1401322277669967e-02, 1.9089176658573199e-02,
+    1.6728811790177316e-02, 1.4326191823806518e-02, 1.1887390117010501e-02,
+    9.4185794284203875e-03, 6.9260419018309606e-03, 4.4163334569309052e-03,
+    1.8992056795136905e-03,
+    /* order 63 */
+    4.9472366623931022e-02, 4.9411833039918182e-02, 4.9230380423747562e-02,
+    4.8928452820511989e-02, 4.8506789097883848e-02, 4.7966421137995131e-02,
+    4.7308671312268916e-02, 4.6535149245383697e-02, 4.5647747876292610e-02,
+    4.4648638825941396e-02, 4.3540267083027592e-02, 4.2325345020815822e-02,
+    4.1006845759666399e-02, 3.9587995891544096e-02, 3.8072267584349555e-02,
+    3.6463370085457289e-02, 3.4765240645355876e-02, 3.2982034883779342e-02,
+    3.1118116622219819e-02, 2.9178047208280527e-02, 2.7166574359097934e-02,
+    2.5088620553344987e-02, 2.2949271004889932e-02, 2.0753761258039089e-02,
+    1.8507464460161271e-02, 1.6215878410338339e-02, 1.3884612616115611e-02,
+    1.1519376076880042e-02, 9.1259686763266561e-03, 6.7102917659601366e-03,
+    4.2785083468637620e-03, 1.8398745955770842e-03,
+    /* order 64 */
+    4.8690957009139724e-02, 4.8575467441503428e-02, 4.8344762234802954e-02,
+    4.7999388596458310e-02, 4.7540165714830308e-02, 4.6968182816210020e-02,
+    4.6284796581314416e-02, 4.5491627927418142e-02, 4.4590558163756566e-02,
+    4.3583724529323450e-02, 4.2473515123653591e-02, 4.1262563242623528e-02,
+    3.9953741132720343e-02, 3.8550153178615626e-02, 3.7055128540240047e-02,
+    3.5472213256882386e-02, 3.3805161837141606e-02, 3.2057928354851550e-02,
+    3.0234657072402478e-02, 2.8339672614259483e-02, 2.6377469715054658e-02,
+    2.4352702568710874e-02, 2.2270173808383253e-02, 2.0134823153530209e-02,
+    1.7951715775697343e-02, 1.5726030476024718e-02, 1.3463047896718643e-02,
+    1.1168139460131128e-02, 8.8467598263639469e-03, 6.5044579689783628e-03,
+    4.1470332605624679e-03, 1.7832807216964330e-03
+};
+
+
+/* First zeros of the Bessel function J0 */
+static const double GLQ_BESSEL_J0_ZEROS[GLQ_BESSEL_ZEROS] = {
+    2.4048255576957729e+00, 5.5200781102863106e+00, 8.6537279129110125e+00,
+    1.1791534439014281e+01, 1.4930917708487787e+01, 1.8071063967910924e+01,
+    2.1211636629879258e+01, 2.4352471530749302e+01, 2.7493479132040253e+01,
+    3.0634606468431976e+01};
+
+
 /* Make a new GLQ structure and set all the parameters needed */
 GLQ * glq_new(int order, double lower, double upper)
 {
     GLQ *glq;
-    int rc;
+    char *arrays;
+    size_t stride, misalign;
 
-    glq = (GLQ *)malloc(sizeof(GLQ));
-    if(glq == NULL)
+    if(order < 2 || order > GLQ_MAX_ORDER)
     {
+        log_error("glq_new invalid GLQ order %d. Should be from 2 to %d.",
+                  order, GLQ_MAX_ORDER);
         return NULL;
     }
-    glq->order = order;
-    glq->nodes = (double *)malloc(sizeof(double)*order);
-    if(glq->nodes == NULL)
+    /* The structure and its arrays are a single allocation. The arrays start
+     * at multiples of GLQ_ALIGN bytes. */
+    stride = ((sizeof(double)*order + GLQ_ALIGN - 1)/GLQ_ALIGN)*GLQ_ALIGN;
+    glq = (GLQ *)malloc(sizeof(GLQ) + GLQ_ALIGN + 5*stride);
+    if(glq == NULL)
     {
-        free(glq);
         return NULL;
     }
-    glq->nodes_unscaled = (double *)malloc(sizeof(double)*order);
-    if(glq->nodes_unscaled == NULL)
+    arrays = (char *)(glq + 1);
+    misalign = (size_t)((unsigned long)arrays % GLQ_ALIGN);
+    if(misalign != 0)
     {
-        free(glq);
-        free(glq->nodes);
-        return NULL;
+        arrays += GLQ_ALIGN - misalign;
     }
-    glq->weights = (double *)malloc(sizeof(double)*order);
-    if(glq->weights == NULL)
+    glq->order = order;
+    glq->nodes = (double *)arrays;
+    glq->weights = (double *)(arrays + stride);
+    glq->nodes_unscaled = (double *)(arrays + 2*stride);
+    glq->nodes_sin = (double *)(arrays + 3*stride);
+    glq->nodes_cos = (double *)(arrays + 4*stride);
+    glq_nodes_weights(order, glq->nodes_unscaled, glq->weights);
+    glq_set_limits(lower, upper, glq);
+    return glq;
+}
+
+
+/* Free the memory allocated to make a GLQ structure */
+void glq_free(GLQ *glq)
+{
+    free(glq);
+}
+
+
+/* Copy the nodes and weights of an order <= GLQ_MAX_TABULATED from the
+ * tables */
+static void glq_table(int order, double *nodes, double *weights)
+{
+    int half = (order + 1)/2, start = order*order/4 - 1, j;
+
+    for(j = 0; j < half; j++)
     {
-        free(glq);
-        free(glq->nodes);
-        free(glq->nodes_unscaled);
-        return NULL;
+        nodes[half - 1 - j] = -GLQ_TABLE_NODES[start + j];
+        weights[half - 1 - j] = GLQ_TABLE_WEIGHTS[start + j];
+        nodes[order - half + j] = GLQ_TABLE_NODES[start + j];
+        weights[order - half + j] = GLQ_TABLE_WEIGHTS[start + j];
     }
-    glq->nodes_sin = (double *)malloc(sizeof(double)*order);
-    if(glq->nodes_sin == NULL)
+}
+
+
+/* The k-th zero of the Bessel function J0 (k >= 1) */
+static double glq_bessel_zero(int k)
+{
+    double b, b2;
+
+    if(k <= GLQ_BESSEL_ZEROS)
     {
-        free(glq);
-        free(glq->nodes);
-        free(glq->nodes_unscaled);
-        free(glq->weights);
-        return NULL;
+        return GLQ_BESSEL_J0_ZEROS[k - 1];
     }
-    glq->nodes_cos = (double *)malloc(sizeof(double)*order);
-    if(glq->nodes_cos == NULL)
+    /* McMahon's expansion. The error is < 1e-12 for k > 10 */
+    b = (k - 0.25)*PI;
+    b2 = 1./(b*b);
+    return b + (0.125 + (-31./384. + (3779./15360. -
+                6277237./3440640.*b2)*b2)*b2)/b;
+}
+
+
+/* Calculate the Legendre polynomial Pn and its derivative at x0 + h from
+ * their values p and dp at x0 with the Taylor series of Pn around x0. The
+ * coefficients of the series come from the Legendre differential equation. */
+static void glq_taylor(int order, double x0, double p, double dp, double h,
+                       double *pn, double *pn_line)
+{
+    double coefs[GLQ_TAYLOR_TERMS], nn = order*(order + 1.),
+           one_x2 = 1. - x0*x0;
+    int k;
+
+    coefs[0] = p;
+    coefs[1] = dp;
+    for(k = 0; k < GLQ_TAYLOR_TERMS - 2; k++)
     {
-        free(glq);
-        free(glq->nodes);
-        free(glq->nodes_unscaled);
-        free(glq->weights);
-        free(glq->nodes_sin);
-        return NULL;
+        coefs[k + 2] = (2*x0*(k + 1)*coefs[k + 1] -
+                        (nn - k*(k + 1.))*coefs[k]/(k + 1))/((k + 2)*one_x2);
     }
-    rc = glq_nodes(order, glq->nodes_unscaled);
-    if(rc != 0 && rc != 3)
+    *pn = coefs[GLQ_TAYLOR_TERMS - 1];
+    *pn_line = (GLQ_TAYLOR_TERMS - 1)*coefs[GLQ_TAYLOR_TERMS - 1];
+    for(k = GLQ_TAYLOR_TERMS - 2; k >= 0; k--)
     {
-        switch(rc)
+        *pn = *pn*h + coefs[k];
+        if(k > 0)
         {
-            case 1:
-                log_error("glq_nodes invalid GLQ order %d. Should be >= 2.",
-                          order);
-                break;
-            case 2:
-                log_error("glq_nodes NULL pointer for nodes");
-                break;
-            default:
-                log_error("glq_nodes unknown error code %g", rc);
-                break;
+            *pn_line = *pn_line*h + k*coefs[k];
         }
-        glq_free(glq);
-        return NULL;
     }
-    else if(rc == 3)
+}
+
+
+/* Calculate the nodes and weights of orders > GLQ_MAX_TABULATED in O(order)
+ * operations. Goes from the center of [-1, 1] to 1, one node at a time
+ * (Glaser et al., 2007): the asymptotic expansion of the nodes in terms of
+ * the zeros of J0 (Olver, 1974) gives a first guess of each node that Newton's
+ * method refines using the Taylor series of Pn around the previous node. */
+static void glq_asymptotic(int order, double *nodes, double *weights)
+{
+    double x0 = 0, p = 1, dp = 0, rho = order + 0.5, alpha, h, dh, pn,
+           pn_line;
+    int half = (order + 1)/2, j, k, it;
+
+    /* Pn and its derivative at 0 */
+    for(k = 1; k <= order/2; k++)
+    {
+        p *= -(2*k - 1.)/(2*k);
+    }
+    j = 0;
+    if(order % 2 == 1)
     {
-        log_warning("glq_nodes max iterations reached in root finder");
-        log_warning("nodes might not have desired accuracy %g", GLQ_MAXERROR);
+        dp = order*p;
+        p = 0;
+        nodes[half - 1] = 0;
+        weights[half - 1] = 2./(dp*dp);
+        j = 1;
     }
-    rc = glq_weights(order, glq->nodes_unscaled, glq->weights);
-    if(rc != 0)
+    for(; j < half; j++)
     {
-        switch(rc)
+        /* Count the nodes from 1 for the asymptotic expansion */
+        alpha = glq_bessel_zero(half - j)/rho;
+        h = cos(alpha + (alpha*cos(alpha)/sin(alpha) - 1)/(8*alpha*rho*rho))
+            - x0;
+        for(it = 0; it < 10; it++)
         {
-            case 1:
-                log_error("glq_weights invalid GLQ order %d. Should be >= 2.",
-                          order);
-                break;
-            case 2:
-                log_error("glq_weights NULL pointer for nodes");
-                break;
-            case 3:
-                log_error("glq_weights NULL pointer for weights");
-                break;
-            default:
-                log_error("glq_weights unknown error code %d\n", rc);
+            glq_taylor(order, x0, p, dp, h, &pn, &pn_line);
+            dh = pn/pn_line;
+            h -= dh;
+            if(fabs(dh) <= GLQ_MAXERROR*fabs(x0 + h))
+            {
                 break;
+            }
         }
-        glq_free(glq);
-        return NULL;
-    }
-    if(glq_set_limits(lower, upper, glq) != 0)
-    {
-        glq_free(glq);
-        return NULL;
+        glq_taylor(order, x0, p, dp, h, &p, &dp);
+        x0 += h;
+        nodes[half - 1 - j] = -x0;
+        nodes[order - half + j] = x0;
+        weights[half - 1 - j] = 2./((1 - x0*x0)*dp*dp);
+        weights[order - half + j] = weights[half - 1 - j];
     }
-    return glq;
 }
 
 
-/* Free the memory allocated to make a GLQ structure */
-void glq_free(GLQ *glq)
+/* Calculates the GLQ nodes and weights from tables or in O(order)
+ * operations. */
+int glq_nodes_weights(int order, double *nodes, double *weights)
 {
-    free(glq->nodes);
-    free(glq->nodes_unscaled);
-    free(glq->weights);
-    free(glq->nodes_sin);
-    free(glq->nodes_cos);
-    free(glq);
+    if(order < 2)
+    {
+        return 1;
+    }
+    if(nodes == NULL)
+    {
+        return 2;
+    }
+    if(weights == NULL)
+    {
+        return 3;
+    }
+    if(order <= GLQ_MAX_TABULATED)
+    {
+        glq_table(order, nodes, weights);
+    }
+    else
+    {
+        glq_asymptotic(order, nodes, weights);
+    }
+    return 0;
 }
 
 
@@ -306,3 +1284,22 @@ void glq_precompute_sincos(GLQ *glq)
         glq->nodes_cos[i] = cos(d2r*glq->nodes[i]);
     }
 }
+
+
+/* Calculate the sine and cossine of the GLQ nodes put in the integration
+ * limits, without changing the GLQ structure */
+void glq_scale_sincos(const GLQ *glq, double lower, double upper,
+                      double *nodes_sin, double *nodes_cos)
+{
+    /* Same operations as glq_set_limits and glq_precompute_sincos */
+    double d2r = PI/180., tmpplus = 0.5*(upper + lower),
+           tmpminus = 0.5*(upper - lower), node;
+    register int i;
+
+    for(i = 0; i < glq->order; i++)
+    {
+        node = tmpminus*glq->nodes_unscaled[i] + tmpplus;
+        nodes_sin[i] = sin(d2r*node);
+        nodes_cos[i] = cos(d2r*node);
+    }
+}
@@ -61,7 +61,25 @@ Max error allowed for the root-finder algorithm */
 extern const double GLQ_MAXERROR;
 
 
-/** Store the nodes and weights needed for a GLQ integration */
+/** \var GLQ_MAX_TABULATED
+Highest order with tabulated nodes and weights */
+extern const int GLQ_MAX_TABULATED;
+
+
+/** Highest order allowed by glq_new(). Functions can keep the scaled nodes of
+any GLQ structure in arrays of this size on the stack (see glq_scale_sincos()).
+*/
+#define GLQ_MAX_ORDER 1024
+
+
+/** Store the nodes and weights needed for a GLQ integration
+
+The structure and its arrays are allocated together by glq_new().
+
+The unit rule (order, weights and nodes_unscaled) doesn't change after
+glq_new(), so a structure can be shared by several threads if only they are
+used (see glq_scale_sincos()). The other arrays are changed by
+glq_set_limits() and glq_precompute_sincos(). */
 typedef struct glq_struct
 {
     int order; /**< order of the quadrature, ie number of nodes */
@@ -80,14 +98,20 @@ typedef struct glq_struct
 <b>WARNING</b>: Don't forget to free the memory malloced by this function using
 glq_free()!
 
+The nodes and weights of orders up to GLQ_MAX_TABULATED are copied from tables
+and the others are calculated in O(order) operations (see glq_nodes_weights()).
+The structure and all its arrays are a single allocation (the arrays are
+aligned to cache lines), so making a GLQ structure is cheap.
+
 Prints error and warning messages using the logging.h module.
 
-@param order order of the quadrature, ie number of nodes
+@param order order of the quadrature, ie number of nodes. From 2 to
+             GLQ_MAX_ORDER.
 @param lower lower integration limit
 @param upper upper integration limit
 
 @return GLQ data structure with the nodes and weights calculated. NULL if there
-    was an error with allocation.
+    was an error with allocation or an invalid order.
 */
 extern GLQ * glq_new(int order, double lower, double upper);
 
@@ -120,8 +144,38 @@ be reset using this function.
 extern int glq_set_limits(double lower, double upper, GLQ *glq);
 
 
+/** Calculates the GLQ nodes and weights in the [-1,1] interval.
+
+The nodes and weights of orders up to GLQ_MAX_TABULATED come from tables
+calculated with 50 digits of precision. Higher orders are calculated in
+O(order) operations with the method of:
+
+  Glaser, A., Liu, X. and Rokhlin, V., 2007, "A fast algorithm for the
+  calculation of the roots of special functions", SIAM Journal on Scientific
+  Computing, 29(4), pp 1420-1438
+
+starting from the asymptotic expansion of the nodes in terms of the zeros of
+the Bessel function J0. Their errors are similar to those of glq_nodes() and
+glq_weights().
+
+@param order order of the quadrature, ie number of nodes and weights. Must be
+             >= 2.
+@param nodes pre-allocated array to return the nodes.
+@param weights pre-allocated array to return the weights
+
+@return Return code:
+    - 0: if everything went OK
+    - 1: if invalid order
+    - 2: if NULL pointer for nodes
+    - 3: if NULL pointer for weights
+*/
+extern int glq_nodes_weights(int order, double *nodes, double *weights);
+
+
 /** Calculates the GLQ nodes using glq_next_root.
 
+Much slower than glq_nodes_weights(), which is what glq_new() uses.
+
 Nodes will be in the [-1,1] interval. To convert them to the integration limits
 use glq_scale_nodes
 
@@ -189,4 +243,20 @@ extern int glq_weights(int order, double *nodes, double *weights);
 /* Precompute the sine and cossine of the GLQ nodes and store them in the
  * structure */
 extern void glq_precompute_sincos(GLQ *glq);
+
+
+/** Calculate the sine and cossine of the GLQ nodes put in the integration
+limits, without changing the GLQ structure.
+
+Gives the same values as glq_set_limits() followed by glq_precompute_sincos().
+Only reads the unit rule, so many threads can use the same GLQ structure.
+
+@param glq pointer to a GLQ structure created with glq_new()
+@param lower lower integration limit (in degrees)
+@param upper upper integration limit (in degrees)
+@param nodes_sin array of glq->order elements to return the sines
+@param nodes_cos array of glq->order elements to return the cossines
+*/
+extern void glq_scale_sincos(const GLQ *glq, double lower, double upper,
+                             double *nodes_sin, double *nodes_cos);
 #endif
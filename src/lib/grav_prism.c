@@ -467,3 +467,142 @@ double prism_gzz(PRISM prism, double xp, double yp, double zp)
 
     return res;
 }
+
+
+/* Calculates the 3 components of gravitational attraction cause by a prism.
+The logarithms and arctangents of each corner are shared by the components. */
+int prism_g(PRISM prism, double xp, double yp, double zp, double *g)
+{
+    double x[2], y[2], z[2], r, logx, logy, logz, sign, scale;
+    register int i, j, k;
+
+    /* First thing to do is make P the origin of the coordinate system */
+    x[0] = prism.x2 - xp;
+    x[1] = prism.x1 - xp;
+    y[0] = prism.y2 - yp;
+    y[1] = prism.y1 - yp;
+    z[0] = prism.z2 - zp;
+    z[1] = prism.z1 - zp;
+
+    g[0] = 0;
+    g[1] = 0;
+    g[2] = 0;
+
+    /* Evaluate the integration limits. The sign of each corner is
+     * (-1)^(i + j + k). */
+    for(k=0; k<=1; k++)
+    {
+        for(j=0; j<=1; j++)
+        {
+            for(i=0; i<=1; i++)
+            {
+                sign = (i + j + k) % 2 ? -1 : 1;
+                r = sqrt(x[i]*x[i] + y[j]*y[j] + z[k]*z[k]);
+                logx = safe_log(x[i] + r);
+                logy = safe_log(y[j] + r);
+                logz = safe_log(z[k] + r);
+                g[0] += sign*(-(y[j]*logz + z[k]*logy
+                                - x[i]*safe_atan2(z[k]*y[j], x[i]*r)));
+                g[1] += sign*(-(z[k]*logx + x[i]*logz
+                                - y[j]*safe_atan2(z[k]*x[i], y[j]*r)));
+                g[2] += sign*(-(x[i]*logy + y[j]*logx
+                                - z[k]*safe_atan2(x[i]*y[j], z[k]*r)));
+            }
+        }
+    }
+
+    /* Now all that is left is to multiply by the gravitational constant and
+       density and convert it to mGal units */
+    scale = G*SI2MGAL*prism.density;
+    g[0] *= scale;
+    g[1] *= scale;
+    g[2] *= scale;
+
+    return 0;
+}
+
+
+/* Calculates the gravity gradient tensor cause by a prism. The distance to
+each corner is computed once for all the components. */
+int prism_ggt(PRISM prism, double xp, double yp, double zp, double *ggt)
+{
+    double x[2], y[2], z[2], r, rtmp, xtmp, ytmp, ztmp, sign, scale;
+    register int i, j, k, c;
+
+    /* First thing to do is make P the origin of the coordinate system */
+    x[0] = prism.x2 - xp;
+    x[1] = prism.x1 - xp;
+    y[0] = prism.y2 - yp;
+    y[1] = prism.y1 - yp;
+    z[0] = prism.z2 - zp;
+    z[1] = prism.z1 - zp;
+
+    for(c = 0; c < 6; c++)
+    {
+        ggt[c] = 0;
+    }
+
+    /* Evaluate the integration limits. The sign of each corner is
+     * (-1)^(i + j + k). */
+    for(k=0; k<=1; k++)
+    {
+        for(j=0; j<=1; j++)
+        {
+            for(i=0; i<=1; i++)
+            {
+                sign = (i + j + k) % 2 ? -1 : 1;
+                r = sqrt(x[i]*x[i] + y[j]*y[j] + z[k]*z[k]);
+                ggt[0] += sign*(-safe_atan2(z[k]*y[j], x[i]*r));
+                /* The log of the off-diagonal components is singular on
+                 * some edges of the prism. Use a point slightly off the
+                 * edge instead (same as prism_gxy, prism_gxz and
+                 * prism_gyz). */
+                if(x[i] == 0 && y[j] == 0 && z[k] < 0)
+                {
+                    xtmp = 0.0001*(prism.x2 - prism.x1);
+                    ytmp = 0.0001*(prism.y2 - prism.y1);
+                    rtmp = sqrt(xtmp*xtmp + ytmp*ytmp + z[k]*z[k]);
+                    ggt[1] += sign*safe_log(z[k] + rtmp);
+                }
+                else
+                {
+                    ggt[1] += sign*safe_log(z[k] + r);
+                }
+                if(x[i] == 0 && z[k] == 0 && y[j] < 0)
+                {
+                    xtmp = 0.0001*(prism.x2 - prism.x1);
+                    ztmp = 0.0001*(prism.z2 - prism.z1);
+                    rtmp = sqrt(xtmp*xtmp + ztmp*ztmp + y[j]*y[j]);
+                    ggt[2] += sign*safe_log(y[j] + rtmp);
+                }
+                else
+                {
+                    ggt[2] += sign*safe_log(y[j] + r);
+                }
+                ggt[3] += sign*(-safe_atan2(z[k]*x[i], y[j]*r));
+                if(z[k] == 0 && y[j] == 0 && x[i] < 0)
+                {
+                    ytmp = 0.0001*(prism.y2 - prism.y1);
+                    ztmp = 0.0001*(prism.z2 - prism.z1);
+                    rtmp = sqrt(ztmp*ztmp + ytmp*ytmp + x[i]*x[i]);
+                    ggt[4] += sign*safe_log(x[i] + rtmp);
+                }
+                else
+                {
+                    ggt[4] += sign*safe_log(x[i] + r);
+                }
+                ggt[5] += sign*(-safe_atan2(x[i]*y[j], z[k]*r));
+            }
+        }
+    }
+
+    /* Now all that is left is to multiply by the gravitational constant and
+        density and convert it to Eotvos units */
+    scale = G*SI2EOTVOS*prism.density;
+    for(c = 0; c < 6; c++)
+    {
+        ggt[c] *= scale;
+    }
+
+    return 0;
+}
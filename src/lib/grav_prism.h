@@ -33,4 +33,14 @@ extern double prism_gyy(PRISM prism, double xp, double yp, double zp);
 extern double prism_gyz(PRISM prism, double xp, double yp, double zp);
 extern double prism_gzz(PRISM prism, double xp, double yp, double zp);
 
+/* Calculates the 3 components of the gravitational attraction of a prism in
+one pass (same results as prism_gx, prism_gy and prism_gz). Returns gx, gy, gz
+in g. */
+extern int prism_g(PRISM prism, double xp, double yp, double zp, double *g);
+
+/* Calculates the gravity gradient tensor of a prism in one pass (same results
+as prism_gxx and the others). Returns gxx, gxy, gxz, gyy, gyz, gzz in ggt. */
+extern int prism_ggt(PRISM prism, double xp, double yp, double zp,
+                     double *ggt);
+
 #endif
@@ -0,0 +1,620 @@
+/*
+Functions that calculate the gravitational potential and its first and second
+derivatives for a whole model of rectangular prisms stored as a structure of
+arrays.
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "geometry.h"
+#include "constants.h"
+#include "grav_prism_soa.h"
+
+
+/* The corners of a block of prisms, relative to the computation point. The
+corners of all prisms for the same combination of borders are contiguous. A
+block of shared corners (see prism_soa_share_vertices()) is a block of
+8*PRISM_SOA_BLOCK unique corners instead. */
+typedef struct prism_corners_struct {
+    int n; /* number of corners */
+    int nprisms; /* number of prisms. 0 for shared corners */
+    double x[8*PRISM_SOA_BLOCK];
+    double y[8*PRISM_SOA_BLOCK];
+    double z[8*PRISM_SOA_BLOCK];
+    double r[8*PRISM_SOA_BLOCK]; /* distance to the computation point */
+    double weight[8*PRISM_SOA_BLOCK]; /* (-1)^(i + j + k) times density */
+    double lx[8*PRISM_SOA_BLOCK]; /* dimensions of the prism of the corner */
+    double ly[8*PRISM_SOA_BLOCK];
+    double lz[8*PRISM_SOA_BLOCK];
+    double term[8*PRISM_SOA_BLOCK]; /* result of the kernel for each corner */
+} PRISM_CORNERS;
+
+
+/* Copy a prism model into a structure of arrays. */
+PRISM_SOA * new_prism_soa(PRISM *model, int size)
+{
+    PRISM_SOA *soa;
+    double *data;
+    int i;
+
+    soa = (PRISM_SOA *)malloc(sizeof(PRISM_SOA));
+    if(soa == NULL)
+    {
+        return NULL;
+    }
+    data = (double *)malloc(7*(size_t)size*sizeof(double));
+    if(data == NULL)
+    {
+        free(soa);
+        return NULL;
+    }
+    soa->size = size;
+    soa->density = data;
+    soa->x1 = data + size;
+    soa->x2 = data + 2*size;
+    soa->y1 = data + 3*size;
+    soa->y2 = data + 4*size;
+    soa->z1 = data + 5*size;
+    soa->z2 = data + 6*size;
+    soa->nvertices = 0;
+    soa->vx = NULL;
+    soa->vy = NULL;
+    soa->vz = NULL;
+    soa->vweight = NULL;
+    for(i = 0; i < size; i++)
+    {
+        soa->density[i] = model[i].density;
+        soa->x1[i] = model[i].x1;
+        soa->x2[i] = model[i].x2;
+        soa->y1[i] = model[i].y1;
+        soa->y2[i] = model[i].y2;
+        soa->z1[i] = model[i].z1;
+        soa->z2[i] = model[i].z2;
+    }
+    return soa;
+}
+
+
+/* Free a model allocated with new_prism_soa(). */
+void free_prism_soa(PRISM_SOA *model)
+{
+    free(model->vx);
+    free(model->density);
+    free(model);
+}
+
+
+/* Hash the coordinates of a corner (FNV-1a on the bytes of the doubles) */
+static unsigned long hash_corner(double x, double y, double z)
+{
+    unsigned char bytes[3*sizeof(double)];
+    unsigned long hash = 2166136261UL;
+    size_t i;
+
+    memcpy(bytes, &x, sizeof(double));
+    memcpy(bytes + sizeof(double), &y, sizeof(double));
+    memcpy(bytes + 2*sizeof(double), &z, sizeof(double));
+    for(i = 0; i < sizeof(bytes); i++)
+    {
+        hash = ((hash ^ bytes[i])*16777619UL) & 0xffffffffUL;
+    }
+    return hash;
+}
+
+
+/* Evaluate the kernels once for each corner shared by several prisms. */
+int prism_soa_share_vertices(PRISM_SOA *model)
+{
+    double *data, *vx, *vy, *vz, *vweight, x, y, z, sign;
+    int *table, nslots, nvert, slot, i, j, k, p, v;
+
+    /* Open addressing hash table of the indexes of the unique corners. The
+     * table is at least twice as big as the number of corners. */
+    for(nslots = 1024; nslots < 16*model->size; nslots *= 2);
+    table = (int *)malloc(nslots*sizeof(int));
+    data = (double *)malloc(4*8*(size_t)model->size*sizeof(double));
+    if(table == NULL || data == NULL)
+    {
+        free(table);
+        free(data);
+        return -1;
+    }
+    vx = data;
+    vy = data + 8*model->size;
+    vz = data + 2*8*model->size;
+    vweight = data + 3*8*model->size;
+    for(slot = 0; slot < nslots; slot++)
+    {
+        table[slot] = -1;
+    }
+    nvert = 0;
+    for(p = 0; p < model->size; p++)
+    {
+        for(k = 0; k <= 1; k++)
+        {
+            z = k ? model->z1[p] : model->z2[p];
+            for(j = 0; j <= 1; j++)
+            {
+                y = j ? model->y1[p] : model->y2[p];
+                for(i = 0; i <= 1; i++)
+                {
+                    x = i ? model->x1[p] : model->x2[p];
+                    sign = (i + j + k) % 2 ? -1 : 1;
+                    slot = (int)(hash_corner(x, y, z) & (nslots - 1));
+                    while(table[slot] != -1 &&
+                          (vx[table[slot]] != x || vy[table[slot]] != y ||
+                           vz[table[slot]] != z))
+                    {
+                        slot = (slot + 1) & (nslots - 1);
+                    }
+                    if(table[slot] == -1)
+                    {
+                        table[slot] = nvert;
+                        vx[nvert] = x;
+                        vy[nvert] = y;
+                        vz[nvert] = z;
+                        vweight[nvert] = 0;
+                        nvert++;
+                    }
+                    vweight[table[slot]] += sign*model->density[p];
+                }
+            }
+        }
+    }
+    free(table);
+    /* Corners inside a body of constant density cancel out */
+    for(v = 0, j = 0; v < nvert; v++)
+    {
+        if(vweight[v] != 0)
+        {
+            vx[j] = vx[v];
+            vy[j] = vy[v];
+            vz[j] = vz[v];
+            vweight[j] = vweight[v];
+            j++;
+        }
+    }
+    if(j >= 8*model->size)
+    {
+        free(data);
+        return j;
+    }
+    /* Pack the arrays in the start of the allocation */
+    memmove(data + j, vy, j*sizeof(double));
+    memmove(data + 2*j, vz, j*sizeof(double));
+    memmove(data + 3*j, vweight, j*sizeof(double));
+    vx = (double *)realloc(data, 4*(size_t)j*sizeof(double));
+    if(vx != NULL)
+    {
+        data = vx;
+    }
+    free(model->vx);
+    model->nvertices = j;
+    model->vx = data;
+    model->vy = data + j;
+    model->vz = data + 2*j;
+    model->vweight = data + 3*j;
+    return j;
+}
+
+
+/* Check if the computation point is on the continuation of an edge of a prism
+along the third coordinate, on its positive side (where gxy, gxz or gyz need
+the size of the prism). The corners of all prisms are checked because the
+ones that cancel out when shared also need it. */
+static int prism_soa_on_edge(int size, const double *a1, const double *a2,
+                             const double *b1, const double *b2,
+                             const double *c1, const double *c2, double a,
+                             double b, double c)
+{
+    int p;
+
+    for(p = 0; p < size; p++)
+    {
+        if((a1[p] == a || a2[p] == a) && (b1[p] == b || b2[p] == b) &&
+           (c1[p] < c || c2[p] < c))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* Compute the corners of block number 'block', relative to the computation
+point. If 'shared' is true, the block is of the shared corners. Like the
+functions of grav_prism.c, index 0 is the upper border (x2, y2, z2) and index
+1 the lower one. Returns the number of corners (0 after the last block). */
+static int prism_soa_corners(PRISM_SOA *model, int block, int shared,
+                             double xp, double yp, double zp,
+                             PRISM_CORNERS *c)
+{
+    double *xs, *ys, *zs, sign;
+    int start, n, i, j, k, p, m;
+
+    if(shared)
+    {
+        start = 8*PRISM_SOA_BLOCK*block;
+        n = model->nvertices - start;
+        if(n <= 0)
+        {
+            return 0;
+        }
+        if(n > 8*PRISM_SOA_BLOCK)
+        {
+            n = 8*PRISM_SOA_BLOCK;
+        }
+        c->n = n;
+        c->nprisms = 0;
+        for(m = 0; m < n; m++)
+        {
+            c->x[m] = model->vx[start + m] - xp;
+            c->y[m] = model->vy[start + m] - yp;
+            c->z[m] = model->vz[start + m] - zp;
+            c->weight[m] = model->vweight[start + m];
+        }
+    }
+    else
+    {
+        start = PRISM_SOA_BLOCK*block;
+        n = model->size - start;
+        if(n <= 0)
+        {
+            return 0;
+        }
+        if(n > PRISM_SOA_BLOCK)
+        {
+            n = PRISM_SOA_BLOCK;
+        }
+        c->n = 8*n;
+        c->nprisms = n;
+        m = 0;
+        for(k = 0; k <= 1; k++)
+        {
+            zs = (k ? model->z1 : model->z2) + start;
+            for(j = 0; j <= 1; j++)
+            {
+                ys = (j ? model->y1 : model->y2) + start;
+                for(i = 0; i <= 1; i++)
+                {
+                    xs = (i ? model->x1 : model->x2) + start;
+                    sign = (i + j + k) % 2 ? -1 : 1;
+                    for(p = 0; p < n; p++, m++)
+                    {
+                        c->x[m] = xs[p] - xp;
+                        c->y[m] = ys[p] - yp;
+                        c->z[m] = zs[p] - zp;
+                        c->weight[m] = sign*model->density[start + p];
+                        c->lx[m] = model->x2[start + p] -
+                                   model->x1[start + p];
+                        c->ly[m] = model->y2[start + p] -
+                                   model->y1[start + p];
+                        c->lz[m] = model->z2[start + p] -
+                                   model->z1[start + p];
+                    }
+                }
+            }
+        }
+    }
+    for(m = 0; m < c->n; m++)
+    {
+        c->r[m] = sqrt(c->x[m]*c->x[m] + c->y[m]*c->y[m] +
+                       c->z[m]*c->z[m]);
+    }
+    return c->n;
+}
+
+
+/* Add the terms of the corners of each prism first, like grav_prism.c does, so
+that the large terms of the corners cancel out before adding the prisms. The
+shared corners are simply added. */
+static double prism_soa_sum(PRISM_CORNERS *c)
+{
+    double acc[PRISM_SOA_BLOCK], res = 0;
+    int n = c->nprisms, corner, p;
+
+    if(n == 0)
+    {
+        for(p = 0; p < c->n; p++)
+        {
+            res += c->term[p];
+        }
+        return res;
+    }
+    for(p = 0; p < n; p++)
+    {
+        acc[p] = c->term[p];
+    }
+    for(corner = 1; corner < 8; corner++)
+    {
+        for(p = 0; p < n; p++)
+        {
+            acc[p] += c->term[corner*n + p];
+        }
+    }
+    for(p = 0; p < n; p++)
+    {
+        res += acc[p];
+    }
+    return res;
+}
+
+
+/* safe_log without branches */
+static double log_nz(double x)
+{
+    return log(x + (x == 0));
+}
+
+
+/* safe_atan2 without branches */
+static double atan_nz(double y, double x)
+{
+    return atan(y/(y == 0 ? 1 : x));
+}
+
+
+/* Calculates the potential of a prism model. */
+double prism_pot_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            c.term[m] = c.weight[m]*(x*y*log_nz(z + r) + y*z*log_nz(x + r)
+                                     + x*z*log_nz(y + r)
+                                     - 0.5*x*x*atan_nz(z*y, x*r)
+                                     - 0.5*y*y*atan_nz(z*x, y*r)
+                                     - 0.5*z*z*atan_nz(x*y, z*r));
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G;
+}
+
+
+/* Calculates the gx component of the gravitational attraction of a prism
+model. */
+double prism_gx_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            c.term[m] = c.weight[m]*(-(y*log_nz(z + r) + z*log_nz(y + r)
+                                       - x*atan_nz(z*y, x*r)));
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2MGAL;
+}
+
+
+/* Calculates the gy component of the gravitational attraction of a prism
+model. */
+double prism_gy_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            c.term[m] = c.weight[m]*(-(z*log_nz(x + r) + x*log_nz(z + r)
+                                       - y*atan_nz(z*x, y*r)));
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2MGAL;
+}
+
+
+/* Calculates the gz component of the gravitational attraction of a prism
+model. */
+double prism_gz_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            c.term[m] = c.weight[m]*(-(x*log_nz(y + r) + y*log_nz(x + r)
+                                       - z*atan_nz(x*y, z*r)));
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2MGAL;
+}
+
+
+/* Calculates the gxx component of the gravity gradient tensor of a prism
+model. */
+double prism_gxx_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            c.term[m] = -c.weight[m]*atan_nz(c.z[m]*c.y[m], c.x[m]*c.r[m]);
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gxy component of the gravity gradient tensor of a prism
+model. */
+double prism_gxy_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared, b, m;
+
+    /* The shared corners don't know the sizes of their prisms */
+    shared = model->nvertices > 0 &&
+             !prism_soa_on_edge(model->size, model->x1, model->x2, model->y1,
+                               model->y2, model->z1, model->z2, xp, yp, zp);
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            /* Slightly off the edge of the prism, like prism_gxy. Only
+             * the corners of whole prisms have the sizes */
+            if(!shared && x == 0 && y == 0 && z < 0)
+            {
+                r = sqrt(1e-8*(c.lx[m]*c.lx[m] + c.ly[m]*c.ly[m]) + z*z);
+            }
+            c.term[m] = c.weight[m]*log_nz(z + r);
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gxz component of the gravity gradient tensor of a prism
+model. */
+double prism_gxz_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared, b, m;
+
+    /* The shared corners don't know the sizes of their prisms */
+    shared = model->nvertices > 0 &&
+             !prism_soa_on_edge(model->size, model->x1, model->x2, model->z1,
+                               model->z2, model->y1, model->y2, xp, zp, yp);
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            /* Slightly off the edge of the prism, like prism_gxz. Only
+             * the corners of whole prisms have the sizes */
+            if(!shared && x == 0 && z == 0 && y < 0)
+            {
+                r = sqrt(1e-8*(c.lx[m]*c.lx[m] + c.lz[m]*c.lz[m]) + y*y);
+            }
+            c.term[m] = c.weight[m]*log_nz(y + r);
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gyy component of the gravity gradient tensor of a prism
+model. */
+double prism_gyy_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            c.term[m] = -c.weight[m]*atan_nz(c.z[m]*c.x[m], c.y[m]*c.r[m]);
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gyz component of the gravity gradient tensor of a prism
+model. */
+double prism_gyz_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0, x, y, z, r;
+    int shared, b, m;
+
+    /* The shared corners don't know the sizes of their prisms */
+    shared = model->nvertices > 0 &&
+             !prism_soa_on_edge(model->size, model->z1, model->z2, model->y1,
+                               model->y2, model->x1, model->x2, zp, yp, xp);
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            x = c.x[m];
+            y = c.y[m];
+            z = c.z[m];
+            r = c.r[m];
+            /* Slightly off the edge of the prism, like prism_gyz. Only
+             * the corners of whole prisms have the sizes */
+            if(!shared && z == 0 && y == 0 && x < 0)
+            {
+                r = sqrt(1e-8*(c.ly[m]*c.ly[m] + c.lz[m]*c.lz[m]) + x*x);
+            }
+            c.term[m] = c.weight[m]*log_nz(x + r);
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gzz component of the gravity gradient tensor of a prism
+model. */
+double prism_gzz_soa(PRISM_SOA *model, double xp, double yp, double zp)
+{
+    PRISM_CORNERS c;
+    double res = 0;
+    int shared = model->nvertices > 0, b, m;
+
+    for(b = 0; prism_soa_corners(model, b, shared, xp, yp, zp, &c); b++)
+    {
+        for(m = 0; m < c.n; m++)
+        {
+            c.term[m] = -c.weight[m]*atan_nz(c.x[m]*c.y[m], c.z[m]*c.r[m]);
+        }
+        res += prism_soa_sum(&c);
+    }
+    return res*G*SI2EOTVOS;
+}
@@ -0,0 +1,165 @@
+/*
+Functions that calculate the gravitational potential and its first and second
+derivatives for a whole model of rectangular prisms stored as a structure of
+arrays. Uses the formulas in Nagy et al. (2000), like grav_prism.c.
+
+The borders and densities of the prisms are in separate arrays. The prisms are
+calculated in blocks of PRISM_SOA_BLOCK: the coordinates and distances of the
+corners of all the prisms of a block are computed first, then each kernel runs
+over all the corners of the block in a single loop without branches. The
+branches of safe_log() and safe_atan2() are replaced by arithmetic:
+
+    safe_log(x) = log(x + (x == 0))
+    safe_atan2(y, x) = atan(y/x), or 0 if y == 0
+
+(safe_atan2 shifts atan2 by PI when x < 0, which is the same as atan(y/x)).
+The results are the same as adding the results of the functions in
+grav_prism.c for each prism, except for rounding.
+
+The field of a prism is a sum of the same kernel evaluated at its 8 corners
+with signs +1 and -1. Neighboring prisms (like the ones of a regular grid
+converted with tess2prism --flatten, and the layers of each column) have
+corners in common. prism_soa_share_vertices() finds the unique corners of the
+model and adds the signed densities of the prisms that share each one, so
+that the kernels are evaluated once per corner. The corners inside a body of
+constant density cancel out and are not evaluated at all.
+
+The coordinate system used is that of the article, ie:
+
+x -> North  y -> East  z -> Down
+
+References
+----------
+
+* Nagy, D., Papp, G., Benedek, J. (2000): The gravitational potential and its
+  derivatives for the prism. Journal of Geodesy, 74, 552–560.
+*/
+
+
+#ifndef _TESSEROIDS_GRAV_PRISM_SOA_H_
+#define _TESSEROIDS_GRAV_PRISM_SOA_H_
+
+
+/* Needed for definition of PRISM */
+#include "geometry.h"
+
+
+/** Number of prisms calculated together */
+#define PRISM_SOA_BLOCK 32
+
+
+/** A prism model stored as a structure of arrays (see new_prism_soa()) */
+typedef struct prism_soa_struct {
+    int size; /**< number of prisms */
+    double *density; /**< densities of the prisms */
+    double *x1; /**< southern borders of the prisms */
+    double *x2; /**< northern borders of the prisms */
+    double *y1; /**< western borders of the prisms */
+    double *y2; /**< eastern borders of the prisms */
+    double *z1; /**< tops of the prisms */
+    double *z2; /**< bottoms of the prisms */
+    int nvertices; /**< number of shared corners. 0 if not used */
+    double *vx; /**< x coordinates of the shared corners */
+    double *vy; /**< y coordinates of the shared corners */
+    double *vz; /**< z coordinates of the shared corners */
+    double *vweight; /**< sum of the signed densities of each corner */
+} PRISM_SOA;
+
+
+/** Copy a prism model into a structure of arrays.
+
+All the arrays are in a single allocation.
+
+<b>WARNING</b>: Don't forget to free the model using free_prism_soa()!
+
+@param model the prisms
+@param size number of prisms
+
+@return pointer to the new model. NULL if there wasn't enough memory.
+*/
+extern PRISM_SOA * new_prism_soa(PRISM *model, int size);
+
+
+/** Free a model allocated with new_prism_soa().
+
+@param model the model
+*/
+extern void free_prism_soa(PRISM_SOA *model);
+
+
+/** Evaluate the kernels once for each corner shared by several prisms.
+
+Finds the unique corners of the prisms (with the same x, y and z) and the sum
+of the densities of the prisms that have each one, with the sign of the
+corner in each prism. Only the corners with non-zero sum are kept. They are
+used by all the functions below instead of the corners of each prism if there
+are fewer of them than 8 times the number of prisms.
+
+gxy, gxz and gyz have special cases on the edges of the prisms that depend on
+their size. These use the corners of each prism when the computation point is
+on the continuation of one of the edges.
+
+@param model the prisms. The shared corners are stored in it and freed by
+             free_prism_soa().
+
+@return the number of unique corners with non-zero sum. -1 if there wasn't
+        enough memory.
+*/
+extern int prism_soa_share_vertices(PRISM_SOA *model);
+
+
+/** Calculates the potential of a prism model.
+
+@param model the prisms
+@param xp x coordinate of the computation point
+@param yp y coordinate of the computation point
+@param zp z coordinate of the computation point
+
+@return the sum of the potentials of all the prisms (SI units)
+*/
+extern double prism_pot_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+/** Calculates the gx component of the gravitational attraction of a prism
+model. Same parameters as prism_pot_soa(). Result in mGal. */
+extern double prism_gx_soa(PRISM_SOA *model, double xp, double yp, double zp);
+
+/** Calculates the gy component of the gravitational attraction of a prism
+model. Same parameters as prism_pot_soa(). Result in mGal. */
+extern double prism_gy_soa(PRISM_SOA *model, double xp, double yp, double zp);
+
+/** Calculates the gz component of the gravitational attraction of a prism
+model. Same parameters as prism_pot_soa(). Result in mGal. */
+extern double prism_gz_soa(PRISM_SOA *model, double xp, double yp, double zp);
+
+/** Calculates the gxx component of the gravity gradient tensor of a prism
+model. Same parameters as prism_pot_soa(). Result in Eotvos. */
+extern double prism_gxx_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+/** Calculates the gxy component of the gravity gradient tensor of a prism
+model. Same parameters as prism_pot_soa(). Result in Eotvos. */
+extern double prism_gxy_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+/** Calculates the gxz component of the gravity gradient tensor of a prism
+model. Same parameters as prism_pot_soa(). Result in Eotvos. */
+extern double prism_gxz_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+/** Calculates the gyy component of the gravity gradient tensor of a prism
+model. Same parameters as prism_pot_soa(). Result in Eotvos. */
+extern double prism_gyy_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+/** Calculates the gyz component of the gravity gradient tensor of a prism
+model. Same parameters as prism_pot_soa(). Result in Eotvos. */
+extern double prism_gyz_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+/** Calculates the gzz component of the gravity gradient tensor of a prism
+model. Same parameters as prism_pot_soa(). Result in Eotvos. */
+extern double prism_gzz_soa(PRISM_SOA *model, double xp, double yp,
+                            double zp);
+
+#endif
@@ -12,6 +12,7 @@ References
 
 
 #include <math.h>
+#include <stdlib.h>
 #include "geometry.h"
 #include "constants.h"
 #include "grav_prism_sph.h"
@@ -154,66 +155,192 @@ int ggt_prism2point(double *atprism, PRISM prism, double lon, double lat,
 }
 
 
-/* Calculates the gravity gradient tensor caused by a prism. */
-int prism_ggt_sph(PRISM prism, double lonp, double latp, double rp, double *ggt)
+/* Position and orientation of a point or of the top of a prism. */
+int sph_frame(double lon, double lat, double r, SPH_FRAME *frame)
+{
+    double d2r = PI/180.;
+
+    frame->coslat = cos(d2r*lat);
+    frame->sinlat = sin(d2r*lat);
+    frame->coslon = cos(d2r*lon);
+    frame->sinlon = sin(d2r*lon);
+    frame->x = r*frame->coslat*frame->coslon;
+    frame->y = r*frame->coslat*frame->sinlon;
+    frame->z = r*frame->sinlat;
+    return 0;
+}
+
+
+/* Make the frames of the tops of all the prisms of a model. */
+SPH_FRAME * prism_frames(PRISM *model, int size)
 {
-    double x = 0, y = 0, z = 0, ggtprism[9], ggtpoint[9];
-
-    global2local(lonp, latp, rp, prism, &x, &y, &z);
-    ggtprism[0] = prism_gxx(prism, x, y, z);
-    ggtprism[1] = prism_gxy(prism, x, y, z);
-    /* -1 because the prisms z is Down, but transformation assumes z is Up */
-    /* z -> Up is the system of the tesseroid */
-    ggtprism[2] = -1*prism_gxz(prism, x, y, z);
-    ggtprism[3] = ggtprism[1];
-    ggtprism[4] = prism_gyy(prism, x, y, z);
-    /* Same as xz */
-    ggtprism[5] = -1*prism_gyz(prism, x, y, z);
-    ggtprism[6] = ggtprism[2];
-    ggtprism[7] = ggtprism[5];
-    ggtprism[8] = -(ggtprism[0] + ggtprism[4]);
-    ggt_prism2point(ggtprism, prism, lonp, latp, rp, ggtpoint);
-    ggt[0] = ggtpoint[0];
-    ggt[1] = ggtpoint[1];
-    ggt[2] = ggtpoint[2];
-    ggt[3] = ggtpoint[4];
-    ggt[4] = ggtpoint[5];
-    ggt[5] = ggtpoint[8];
+    SPH_FRAME *frames;
+    int i;
+
+    frames = (SPH_FRAME *)malloc(size*sizeof(SPH_FRAME));
+    if(frames == NULL)
+    {
+        return NULL;
+    }
+    for(i = 0; i < size; i++)
+    {
+        sph_frame(model[i].lon, model[i].lat, model[i].r, &frames[i]);
+    }
+    return frames;
+}
+
+
+/* Same as global2local but with the trigonometric functions already
+computed. cos(90 - lat) = sin(lat) and cos(180 - lon) = -cos(lon). */
+static void frame2local(const SPH_FRAME *prism, const SPH_FRAME *point,
+                        double *x, double *y, double *z)
+{
+    double X, Y, Z;
+
+    X = point->x - prism->x;
+    Y = point->y - prism->y;
+    Z = point->z - prism->z;
+    *x = -X*prism->sinlat*prism->coslon - Y*prism->sinlat*prism->sinlon +
+         Z*prism->coslat;
+    *y = -X*prism->sinlon + Y*prism->coslon;
+    /* -1 because Nagy et al. (2000) use z->down */
+    *z = -(X*prism->coslat*prism->coslon + Y*prism->coslat*prism->sinlon +
+           Z*prism->sinlat);
+}
+
+
+/* The matrix of g_prism2point and ggt_prism2point from the frames. Uses
+cos(a - b) and sin(a - b) for the difference in longitude. */
+static void frame_rotation(const SPH_FRAME *prism, const SPH_FRAME *point,
+                           double *R)
+{
+    double cosbeta, sinbeta;
+
+    cosbeta = prism->coslon*point->coslon + prism->sinlon*point->sinlon;
+    sinbeta = prism->sinlon*point->coslon - prism->coslon*point->sinlon;
+    R[0] = cosbeta*point->sinlat*prism->sinlat +
+           point->coslat*prism->coslat;
+    R[1] = sinbeta*point->sinlat;
+    R[2] = -cosbeta*point->sinlat*prism->coslat +
+           point->coslat*prism->sinlat;
+    R[3] = -sinbeta*prism->sinlat;
+    R[4] = cosbeta;
+    R[5] = sinbeta*prism->coslat;
+    R[6] = -cosbeta*point->coslat*prism->sinlat +
+           point->sinlat*prism->coslat;
+    R[7] = -sinbeta*point->coslat;
+    R[8] = cosbeta*point->coslat*prism->coslat +
+           point->sinlat*prism->sinlat;
+}
+
+
+/* Calculates the gravity gradient tensor caused by a prism using the frames
+of the prism and of the computation point. */
+int prism_ggt_sph_frame(PRISM prism, const SPH_FRAME *pframe,
+                        const SPH_FRAME *point, double *ggt)
+{
+    double x, y, z, local[6], T[6], R[9], M[9];
+    int i;
+
+    frame2local(pframe, point, &x, &y, &z);
+    /* All components in one pass over the corners of the prism */
+    prism_ggt(prism, x, y, z, local);
+    /* The symmetric tensor with z -> Up (the system of the tesseroid). -1
+     * because the prisms z is Down. The order is xx, xy, xz, yy, yz, zz. */
+    T[0] = local[0];
+    T[1] = local[1];
+    T[2] = -local[2];
+    T[3] = local[3];
+    T[4] = -local[4];
+    T[5] = local[5];
+    frame_rotation(pframe, point, R);
+    /* M = R*T */
+    for(i = 0; i < 3; i++)
+    {
+        M[3*i] = R[3*i]*T[0] + R[3*i + 1]*T[1] + R[3*i + 2]*T[2];
+        M[3*i + 1] = R[3*i]*T[1] + R[3*i + 1]*T[3] + R[3*i + 2]*T[4];
+        M[3*i + 2] = R[3*i]*T[2] + R[3*i + 1]*T[4] + R[3*i + 2]*T[5];
+    }
+    /* The upper triangle of M*R^T (the result is symmetric) */
+    ggt[0] = M[0]*R[0] + M[1]*R[1] + M[2]*R[2];
+    ggt[1] = M[0]*R[3] + M[1]*R[4] + M[2]*R[5];
+    ggt[2] = M[0]*R[6] + M[1]*R[7] + M[2]*R[8];
+    ggt[3] = M[3]*R[3] + M[4]*R[4] + M[5]*R[5];
+    ggt[4] = M[3]*R[6] + M[4]*R[7] + M[5]*R[8];
+    ggt[5] = M[6]*R[6] + M[7]*R[7] + M[8]*R[8];
 
     return 0;
 }
 
 
-/* Calculates the gravitational attraction caused by a prism. */
-int prism_g_sph(PRISM prism, double lonp, double latp, double rp, double *gx,
-                double *gy, double *gz)
+/* Calculates the gravitational attraction caused by a prism using the frames
+of the prism and of the computation point. */
+int prism_g_sph_frame(PRISM prism, const SPH_FRAME *pframe,
+                      const SPH_FRAME *point, double *g)
 {
-    double x = 0, y = 0, z = 0, gprism[3], gpoint[3];
+    double x, y, z, gprism[3], R[9];
 
-    global2local(lonp, latp, rp, prism, &x, &y, &z);
-    gprism[0] = prism_gx(prism, x, y, z);
-    gprism[1] = prism_gy(prism, x, y, z);
+    frame2local(pframe, point, &x, &y, &z);
+    /* All components in one pass over the corners of the prism */
+    prism_g(prism, x, y, z, gprism);
     /* Nagy wants z down, but the transformation assumes z up */
-    gprism[2] = -prism_gz(prism, x, y, z);
-    g_prism2point(gprism, prism, lonp, latp, rp, gpoint);
-    *gx = gpoint[0];
-    *gy = gpoint[1];
+    gprism[2] = -gprism[2];
+    frame_rotation(pframe, point, R);
+    g[0] = R[0]*gprism[0] + R[1]*gprism[1] + R[2]*gprism[2];
+    g[1] = R[3]*gprism[0] + R[4]*gprism[1] + R[5]*gprism[2];
     /* Put z back down again to maintain the normal convention for gz */
-    *gz = -gpoint[2];
+    g[2] = -(R[6]*gprism[0] + R[7]*gprism[1] + R[8]*gprism[2]);
 
     return 0;
 }
 
-/* Calculates the potential caused by a prism. */
-double prism_pot_sph(PRISM prism, double lonp, double latp, double rp)
+
+/* Calculates the potential caused by a prism using the frames of the prism
+and of the computation point. */
+double prism_pot_sph_frame(PRISM prism, const SPH_FRAME *pframe,
+                           const SPH_FRAME *point)
 {
-    double x = 0, y = 0, z = 0, res;
+    double x, y, z;
+
+    frame2local(pframe, point, &x, &y, &z);
+    return prism_pot(prism, x, y, z);
+}
+
 
-    global2local(lonp, latp, rp, prism, &x, &y, &z);
-    res = prism_pot(prism, x, y, z);
+/* Calculates the gravity gradient tensor caused by a prism. */
+int prism_ggt_sph(PRISM prism, double lonp, double latp, double rp, double *ggt)
+{
+    SPH_FRAME pframe, point;
 
-    return res;
+    sph_frame(prism.lon, prism.lat, prism.r, &pframe);
+    sph_frame(lonp, latp, rp, &point);
+    return prism_ggt_sph_frame(prism, &pframe, &point, ggt);
 }
 
 
+/* Calculates the gravitational attraction caused by a prism. */
+int prism_g_sph(PRISM prism, double lonp, double latp, double rp, double *gx,
+                double *gy, double *gz)
+{
+    SPH_FRAME pframe, point;
+    double g[3];
 
+    sph_frame(prism.lon, prism.lat, prism.r, &pframe);
+    sph_frame(lonp, latp, rp, &point);
+    prism_g_sph_frame(prism, &pframe, &point, g);
+    *gx = g[0];
+    *gy = g[1];
+    *gz = g[2];
+
+    return 0;
+}
+
+/* Calculates the potential caused by a prism. */
+double prism_pot_sph(PRISM prism, double lonp, double latp, double rp)
+{
+    SPH_FRAME pframe, point;
+
+    sph_frame(prism.lon, prism.lat, prism.r, &pframe);
+    sph_frame(lonp, latp, rp, &point);
+    return prism_pot_sph_frame(prism, &pframe, &point);
+}
@@ -18,6 +18,15 @@ References
 /* Needed for definition of PRISM */
 #include "geometry.h"
 
+/* Position and orientation of a point in spherical coordinates, computed once
+with sph_frame() and used for every pair of prism and computation point */
+typedef struct sph_frame_struct {
+    double x, y, z; /* geocentric Cartesian coordinates of the point */
+    double coslat, sinlat; /* cosine and sine of the latitude */
+    double coslon, sinlon; /* cosine and sine of the longitude */
+} SPH_FRAME;
+
+
 /* Transform spherical coordinates to local Cartesian coordinates of the prism
 
 Parameters:
@@ -97,4 +106,50 @@ Returns:
 * the calculated potential
 */
 extern double prism_pot_sph(PRISM prism, double lonp, double latp, double rp);
+
+
+/* Compute the position and orientation of a point.
+
+Parameters:
+
+* lon, lat, r: spherical coordinates of the point. For a prism, the
+               coordinates of the center of its top (prism.lon, prism.lat,
+               prism.r).
+* frame: used to return the frame of the point.
+*/
+extern int sph_frame(double lon, double lat, double r, SPH_FRAME *frame);
+
+/* Make the frames of the tops of all the prisms of a model.
+
+Allocates memory. Don't forget to free the frames!
+
+Parameters:
+
+* model: the prisms.
+* size: number of prisms in the model.
+
+Returns:
+
+* the frames. NULL if there wasn't enough memory.
+*/
+extern SPH_FRAME * prism_frames(PRISM *model, int size);
+
+/* Same as prism_ggt_sph but with the frames of the prism (see prism_frames)
+and of the computation point (see sph_frame). No trigonometric functions are
+evaluated.
+*/
+extern int prism_ggt_sph_frame(PRISM prism, const SPH_FRAME *pframe,
+    const SPH_FRAME *point, double *ggt);
+
+/* Same as prism_g_sph but with the frames of the prism and of the computation
+point. The 3 components of the gravity vector are returned in g.
+*/
+extern int prism_g_sph_frame(PRISM prism, const SPH_FRAME *pframe,
+    const SPH_FRAME *point, double *g);
+
+/* Same as prism_pot_sph but with the frames of the prism and of the
+computation point.
+*/
+extern double prism_pot_sph_frame(PRISM prism, const SPH_FRAME *pframe,
+    const SPH_FRAME *point);
 #endif
@@ -150,7 +150,7 @@ double sphere_gxy(SPHERE sphere, double lonp, double latp, double rp)
 
     kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
 
-    kern = (3*sphere.rc*sphere.rc*kphi*coslatp*sin(d2r*(sphere.lonc - lonp)))/
+    kern = (3*sphere.rc*sphere.rc*kphi*coslatc*sin(d2r*(sphere.lonc - lonp)))/
                                                                 pow(l_sqr, 2.5);
 
     return G*SI2EOTVOS*mass*kern;
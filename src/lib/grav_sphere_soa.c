@@ -0,0 +1,390 @@
+/*
+Functions that calculate the gravitational potential and its first and second
+derivatives for a whole model of spheres stored as a structure of arrays.
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+#include "geometry.h"
+#include "constants.h"
+#include "grav_sphere_soa.h"
+
+
+/* A computation point in geocentric Cartesian coordinates and the unit vectors
+of its local coordinate system */
+typedef struct sphere_point_struct {
+    double p[3];
+    double north[3];
+    double east[3];
+    double up[3];
+} SPHERE_POINT;
+
+
+/* The centers of a block of spheres relative to the computation point, in the
+local coordinate system of the point */
+typedef struct sphere_block_struct {
+    int n; /* number of spheres */
+    double x[SPHERE_SOA_BLOCK];
+    double y[SPHERE_SOA_BLOCK];
+    double z[SPHERE_SOA_BLOCK];
+    double inv2[SPHERE_SOA_BLOCK]; /* 1/distance^2 */
+    double w[SPHERE_SOA_BLOCK]; /* mass/distance */
+} SPHERE_BLOCK;
+
+
+/* Copy a sphere model into a structure of arrays. */
+SPHERE_SOA * new_sphere_soa(SPHERE *model, int size)
+{
+    SPHERE_SOA *soa;
+    double *data, d2r = PI/180.;
+    int i;
+
+    soa = (SPHERE_SOA *)malloc(sizeof(SPHERE_SOA));
+    if(soa == NULL)
+    {
+        return NULL;
+    }
+    data = (double *)malloc(4*(size_t)size*sizeof(double));
+    if(data == NULL)
+    {
+        free(soa);
+        return NULL;
+    }
+    soa->size = size;
+    soa->x = data;
+    soa->y = data + size;
+    soa->z = data + 2*size;
+    soa->mass = data + 3*size;
+    for(i = 0; i < size; i++)
+    {
+        soa->x[i] = model[i].rc*cos(d2r*model[i].latc)*cos(d2r*model[i].lonc);
+        soa->y[i] = model[i].rc*cos(d2r*model[i].latc)*sin(d2r*model[i].lonc);
+        soa->z[i] = model[i].rc*sin(d2r*model[i].latc);
+        soa->mass[i] = model[i].density*sphere_volume(model[i]);
+    }
+    return soa;
+}
+
+
+/* Free a model allocated with new_sphere_soa(). */
+void free_sphere_soa(SPHERE_SOA *model)
+{
+    free(model->x);
+    free(model);
+}
+
+
+/* Find the position and the local coordinate system of a computation point */
+static void sphere_soa_point(double lonp, double latp, double rp,
+                             SPHERE_POINT *point)
+{
+    double d2r = PI/180., coslat, sinlat, coslon, sinlon;
+
+    coslat = cos(d2r*latp);
+    sinlat = sin(d2r*latp);
+    coslon = cos(d2r*lonp);
+    sinlon = sin(d2r*lonp);
+    point->p[0] = rp*coslat*coslon;
+    point->p[1] = rp*coslat*sinlon;
+    point->p[2] = rp*sinlat;
+    point->north[0] = -sinlat*coslon;
+    point->north[1] = -sinlat*sinlon;
+    point->north[2] = coslat;
+    point->east[0] = -sinlon;
+    point->east[1] = coslon;
+    point->east[2] = 0;
+    point->up[0] = coslat*coslon;
+    point->up[1] = coslat*sinlon;
+    point->up[2] = sinlat;
+}
+
+
+/* Put the centers of block number 'block' of the model in the coordinate
+system of the computation point. Returns the number of spheres in the block
+(0 after the last block). */
+static int sphere_soa_block(SPHERE_SOA *model, int block,
+                            const SPHERE_POINT *point, SPHERE_BLOCK *s)
+{
+    const double *x, *y, *z, *mass;
+    double dx, dy, dz, l2;
+    int start = block*SPHERE_SOA_BLOCK, m = 0;
+#ifdef __SSE2__
+    __m128d px, py, pz, nx, ny, nz, ex, ey, ez, ux, uy, uz, vx, vy, vz, v2,
+            one;
+#endif
+
+    s->n = model->size - start;
+    if(s->n <= 0)
+    {
+        return 0;
+    }
+    if(s->n > SPHERE_SOA_BLOCK)
+    {
+        s->n = SPHERE_SOA_BLOCK;
+    }
+    x = model->x + start;
+    y = model->y + start;
+    z = model->z + start;
+    mass = model->mass + start;
+#ifdef __SSE2__
+    /* The same operations in the same order as the loop below, on two
+     * spheres at a time */
+    px = _mm_set1_pd(point->p[0]);
+    py = _mm_set1_pd(point->p[1]);
+    pz = _mm_set1_pd(point->p[2]);
+    nx = _mm_set1_pd(point->north[0]);
+    ny = _mm_set1_pd(point->north[1]);
+    nz = _mm_set1_pd(point->north[2]);
+    ex = _mm_set1_pd(point->east[0]);
+    ey = _mm_set1_pd(point->east[1]);
+    ez = _mm_set1_pd(point->east[2]);
+    ux = _mm_set1_pd(point->up[0]);
+    uy = _mm_set1_pd(point->up[1]);
+    uz = _mm_set1_pd(point->up[2]);
+    one = _mm_set1_pd(1.);
+    for(m = 0; m + 1 < s->n; m += 2)
+    {
+        vx = _mm_sub_pd(_mm_loadu_pd(x + m), px);
+        vy = _mm_sub_pd(_mm_loadu_pd(y + m), py);
+        vz = _mm_sub_pd(_mm_loadu_pd(z + m), pz);
+        _mm_storeu_pd(s->x + m, _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, nx),
+            _mm_mul_pd(vy, ny)), _mm_mul_pd(vz, nz)));
+        _mm_storeu_pd(s->y + m, _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, ex),
+            _mm_mul_pd(vy, ey)), _mm_mul_pd(vz, ez)));
+        _mm_storeu_pd(s->z + m, _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, ux),
+            _mm_mul_pd(vy, uy)), _mm_mul_pd(vz, uz)));
+        v2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)),
+                        _mm_mul_pd(vz, vz));
+        _mm_storeu_pd(s->inv2 + m, _mm_div_pd(one, v2));
+        _mm_storeu_pd(s->w + m, _mm_div_pd(_mm_loadu_pd(mass + m),
+                                           _mm_sqrt_pd(v2)));
+    }
+#endif
+    for(; m < s->n; m++)
+    {
+        dx = x[m] - point->p[0];
+        dy = y[m] - point->p[1];
+        dz = z[m] - point->p[2];
+        s->x[m] = dx*point->north[0] + dy*point->north[1] +
+                  dz*point->north[2];
+        s->y[m] = dx*point->east[0] + dy*point->east[1] + dz*point->east[2];
+        s->z[m] = dx*point->up[0] + dy*point->up[1] + dz*point->up[2];
+        l2 = dx*dx + dy*dy + dz*dz;
+        s->inv2[m] = 1./l2;
+        s->w[m] = mass[m]/sqrt(l2);
+    }
+    return s->n;
+}
+
+
+/* Calculates the potential of a sphere model. */
+double sphere_pot_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m];
+        }
+    }
+    return res*G;
+}
+
+
+/* Calculates the gx component of the gravitational attraction of a sphere
+model. */
+double sphere_gx_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m]*s.x[m]*s.inv2[m];
+        }
+    }
+    return res*G*SI2MGAL;
+}
+
+
+/* Calculates the gy component of the gravitational attraction of a sphere
+model. */
+double sphere_gy_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m]*s.y[m]*s.inv2[m];
+        }
+    }
+    return res*G*SI2MGAL;
+}
+
+
+/* Calculates the gz component of the gravitational attraction of a sphere
+model. */
+double sphere_gz_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m]*s.z[m]*s.inv2[m];
+        }
+    }
+    return res*G*SI2MGAL;
+}
+
+
+/* Calculates the gxx component of the gravity gradient tensor of a sphere
+model. */
+double sphere_gxx_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m]*s.inv2[m]*(3*s.x[m]*s.x[m]*s.inv2[m] - 1);
+        }
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gxy component of the gravity gradient tensor of a sphere
+model. */
+double sphere_gxy_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += 3*s.w[m]*s.x[m]*s.y[m]*s.inv2[m]*s.inv2[m];
+        }
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gxz component of the gravity gradient tensor of a sphere
+model. */
+double sphere_gxz_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += 3*s.w[m]*s.x[m]*s.z[m]*s.inv2[m]*s.inv2[m];
+        }
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gyy component of the gravity gradient tensor of a sphere
+model. */
+double sphere_gyy_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m]*s.inv2[m]*(3*s.y[m]*s.y[m]*s.inv2[m] - 1);
+        }
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gyz component of the gravity gradient tensor of a sphere
+model. */
+double sphere_gyz_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += 3*s.w[m]*s.y[m]*s.z[m]*s.inv2[m]*s.inv2[m];
+        }
+    }
+    return res*G*SI2EOTVOS;
+}
+
+
+/* Calculates the gzz component of the gravity gradient tensor of a sphere
+model. */
+double sphere_gzz_soa(SPHERE_SOA *model, double lonp, double latp, double rp)
+{
+    SPHERE_POINT point;
+    SPHERE_BLOCK s;
+    double res = 0;
+    int b, m;
+
+    sphere_soa_point(lonp, latp, rp, &point);
+    for(b = 0; sphere_soa_block(model, b, &point, &s); b++)
+    {
+        for(m = 0; m < s.n; m++)
+        {
+            res += s.w[m]*s.inv2[m]*(3*s.z[m]*s.z[m]*s.inv2[m] - 1);
+        }
+    }
+    return res*G*SI2EOTVOS;
+}
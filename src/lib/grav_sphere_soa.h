@@ -0,0 +1,123 @@
+/*
+Functions that calculate the gravitational potential and its first and second
+derivatives for a whole model of spheres stored as a structure of arrays. Give
+the same results as adding the results of the functions in grav_sphere.c for
+each sphere, except for rounding.
+
+The centers of the spheres are stored in geocentric Cartesian coordinates with
+their masses. The spheres are calculated in blocks of SPHERE_SOA_BLOCK: the
+vectors from the computation point to the centers of all the spheres of a
+block are projected on the local coordinate system of the point and their
+distances computed first, in a single loop without branches. Then each kernel
+adds the terms of the spheres of the block. The first loop, which has the
+square roots and divisions, uses SSE2 instructions if the compiler supports
+them (two spheres at a time) and gives the same results as the loop without
+them.
+
+The derivatives of the potential are made with respect to the local coordinate
+system x->North, y->East, z->out. So it would be normal for a sphere of
+positive density to have negative gz.
+*/
+
+
+#ifndef _TESSEROIDS_GRAV_SPHERE_SOA_H_
+#define _TESSEROIDS_GRAV_SPHERE_SOA_H_
+
+
+/* Needed for definition of SPHERE */
+#include "geometry.h"
+
+
+/** Number of spheres calculated together */
+#define SPHERE_SOA_BLOCK 256
+
+
+/** A sphere model stored as a structure of arrays (see new_sphere_soa()) */
+typedef struct sphere_soa_struct {
+    int size; /**< number of spheres */
+    double *x; /**< geocentric Cartesian coordinates of the centers of the */
+    double *y; /**< spheres (z is along the rotation axis and x goes through */
+    double *z; /**< longitude 0) */
+    double *mass; /**< masses of the spheres */
+} SPHERE_SOA;
+
+
+/** Copy a sphere model into a structure of arrays.
+
+All the arrays are in a single allocation.
+
+<b>WARNING</b>: Don't forget to free the model using free_sphere_soa()!
+
+@param model the spheres
+@param size number of spheres
+
+@return pointer to the new model. NULL if there wasn't enough memory.
+*/
+extern SPHERE_SOA * new_sphere_soa(SPHERE *model, int size);
+
+
+/** Free a model allocated with new_sphere_soa().
+
+@param model the model
+*/
+extern void free_sphere_soa(SPHERE_SOA *model);
+
+
+/** Calculates the potential of a sphere model.
+
+@param model the spheres
+@param lonp longitude of the computation point P in degrees
+@param latp latitude of the computation point P in degrees
+@param rp radial coordinate of the computation point P
+
+@return the sum of the potentials of all the spheres (SI units)
+*/
+extern double sphere_pot_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+/** Calculates the gx component of the gravitational attraction of a sphere
+model. Same parameters as sphere_pot_soa(). Result in mGal. */
+extern double sphere_gx_soa(SPHERE_SOA *model, double lonp, double latp,
+                            double rp);
+
+/** Calculates the gy component of the gravitational attraction of a sphere
+model. Same parameters as sphere_pot_soa(). Result in mGal. */
+extern double sphere_gy_soa(SPHERE_SOA *model, double lonp, double latp,
+                            double rp);
+
+/** Calculates the gz component of the gravitational attraction of a sphere
+model. Same parameters as sphere_pot_soa(). Result in mGal. */
+extern double sphere_gz_soa(SPHERE_SOA *model, double lonp, double latp,
+                            double rp);
+
+/** Calculates the gxx component of the gravity gradient tensor of a sphere
+model. Same parameters as sphere_pot_soa(). Result in Eotvos. */
+extern double sphere_gxx_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+/** Calculates the gxy component of the gravity gradient tensor of a sphere
+model. Same parameters as sphere_pot_soa(). Result in Eotvos. */
+extern double sphere_gxy_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+/** Calculates the gxz component of the gravity gradient tensor of a sphere
+model. Same parameters as sphere_pot_soa(). Result in Eotvos. */
+extern double sphere_gxz_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+/** Calculates the gyy component of the gravity gradient tensor of a sphere
+model. Same parameters as sphere_pot_soa(). Result in Eotvos. */
+extern double sphere_gyy_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+/** Calculates the gyz component of the gravity gradient tensor of a sphere
+model. Same parameters as sphere_pot_soa(). Result in Eotvos. */
+extern double sphere_gyz_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+/** Calculates the gzz component of the gravity gradient tensor of a sphere
+model. Same parameters as sphere_pot_soa(). Result in Eotvos. */
+extern double sphere_gzz_soa(SPHERE_SOA *model, double lonp, double latp,
+                             double rp);
+
+#endif
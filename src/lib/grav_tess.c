@@ -21,40 +21,42 @@ Karlsruhe, Germany.
 #include "grav_tess.h"
 
 #define STKSIZE 10000
+#define COLSTKSIZE 1000
+#define PYRSTKSIZE 1000
 
 
 /* Calculates the field of a tesseroid model at a given point. */
-double calc_tess_model(TESSEROID *model, int size, double lonp, double latp,
-    double rp, GLQ *glq_lon, GLQ *glq_lat, GLQ *glq_r,
-    double (*field)(TESSEROID, double, double, double, GLQ, GLQ, GLQ))
+double calc_tess_model(TESSEROID *model, long size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *))
 {
     double res;
-    int tess;
+    long tess;
 
     res = 0;
     for(tess = 0; tess < size; tess++)
     {
-        glq_set_limits(model[tess].w, model[tess].e, glq_lon);
-        glq_set_limits(model[tess].s, model[tess].n, glq_lat);
-        glq_set_limits(model[tess].r1, model[tess].r2, glq_r);
-        glq_precompute_sincos(glq_lat);
-        res += field(model[tess], lonp, latp, rp, *glq_lon, *glq_lat, *glq_r);
+        res += field(model[tess], lonp, latp, rp, glq_lon, glq_lat, glq_r);
     }
     return res;
 }
 
 
 /* Adaptatively calculate the field of a tesseroid model at a given point */
-double calc_tess_model_adapt(TESSEROID *model, int size, double lonp,
-          double latp, double rp, GLQ *glq_lon, GLQ *glq_lat, GLQ *glq_r,
-          double (*field)(TESSEROID, double, double, double, GLQ, GLQ, GLQ),
+double calc_tess_model_adapt(TESSEROID *model, long size, double lonp,
+          double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+          const GLQ *glq_r,
+          double (*field)(TESSEROID, double, double, double, const GLQ *,
+                          const GLQ *, const GLQ *),
           double ratio)
 {
     double res, distance, lont, latt, rt, d2r = PI/180.,
            coslatp, sinlatp, rp_sqr, rlonp,
            Llon, Llat, Lr,
            sinlatt, coslatt;
-    int t, n, nlon, nlat, nr, stktop = 0;
+    int n, nlon, nlat, nr, stktop = 0;
+    long t;
     TESSEROID stack[STKSIZE], tess;
 
     #define SQ(x) (x)*(x)
@@ -122,7 +124,7 @@ double calc_tess_model_adapt(TESSEROID *model, int size, double lonp,
                 {
                     log_error(
                         "Stack overflow: "
-                        "tesseroid %d in the model file on "
+                        "tesseroid %ld in the model file on "
                         "lon=%lf lat=%lf height=%lf."
                         "\n  Calculated without fully dividing the tesseroid. "
                         "Accuracy of the solution cannot be guaranteed."
@@ -135,11 +137,7 @@ double calc_tess_model_adapt(TESSEROID *model, int size, double lonp,
                         "the accuracy of the solution.",
                         t + 1, lonp, latp, rp);
                 }
-                glq_set_limits(tess.w, tess.e, glq_lon);
-                glq_set_limits(tess.s, tess.n, glq_lat);
-                glq_set_limits(tess.r1, tess.r2, glq_r);
-                glq_precompute_sincos(glq_lat);
-                res += field(tess, lonp, latp, rp, *glq_lon, *glq_lat, *glq_r);
+                res += field(tess, lonp, latp, rp, glq_lon, glq_lat, glq_r);
             }
             else
             {
@@ -161,34 +159,503 @@ double calc_tess_model_adapt(TESSEROID *model, int size, double lonp,
     return res;
 }
 
+/* Calculates the field of a tesseroid model divided in vertical columns. */
+double calc_tess_model_columns(TESSEROID *model, long *columns,
+    long ncolumns, double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *))
+{
+    double res;
+    long col;
+
+    res = 0;
+    for(col = 0; col < ncolumns; col++)
+    {
+        res += field(&model[columns[col]],
+                     (int)(columns[col + 1] - columns[col]), lonp, latp, rp,
+                     glq_lon, glq_lat, glq_r);
+    }
+    return res;
+}
+
+
+/* Halve a tesseroid in the dimensions marked with 2. Unlike split_tess, always
+ * gives exactly nlon*nlat*nr pieces, even if the tesseroid is so small that
+ * the borders of the pieces can't be told apart. */
+static int halve_tess(TESSEROID tess, int nlon, int nlat, int nr,
+                      TESSEROID *split)
+{
+    double lon[3], lat[3], r[3];
+    int i, j, k, t = 0;
+
+    lon[0] = tess.w;
+    lon[1] = nlon == 2 ? 0.5*(tess.w + tess.e) : tess.e;
+    lon[2] = tess.e;
+    lat[0] = tess.s;
+    lat[1] = nlat == 2 ? 0.5*(tess.s + tess.n) : tess.n;
+    lat[2] = tess.n;
+    r[0] = tess.r1;
+    r[1] = nr == 2 ? 0.5*(tess.r1 + tess.r2) : tess.r2;
+    r[2] = tess.r2;
+    for(k = 0; k < nr; k++)
+    {
+        for(j = 0; j < nlat; j++)
+        {
+            for(i = 0; i < nlon; i++)
+            {
+                split[t] = tess;
+                split[t].w = lon[i];
+                split[t].e = lon[i + 1];
+                split[t].s = lat[j];
+                split[t].n = lat[j + 1];
+                split[t].r1 = r[k];
+                split[t].r2 = r[k + 1];
+                t++;
+            }
+        }
+    }
+    return t;
+}
+
+
+/* Calculate the field of pieces of the layers of a column that all have the
+ * horizontal extent of 'box' */
+static double calc_tess_pieces(TESSEROID *pieces, int npieces, TESSEROID box,
+    double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *))
+{
+    int l;
+
+    for(l = 0; l < npieces; l++)
+    {
+        pieces[l].w = box.w;
+        pieces[l].e = box.e;
+        pieces[l].s = box.s;
+        pieces[l].n = box.n;
+    }
+    return field(pieces, npieces, lonp, latp, rp, glq_lon, glq_lat, glq_r);
+}
+
+
+/* Adaptatively calculate the field of a column of tesseroids at a given
+ * point */
+double calc_tess_column_adapt(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio)
+{
+    double res, part, distance, lont, latt, rt, d2r = PI/180.,
+           coslatp, rlonp, rlatp, hav, Llon, Llat, Lr, Llon_unit, Llat_unit,
+           coslatt;
+    int l, n, nlon, nlat, stktop = 0, rtop, npieces, overflow, halvelon,
+        halvelat;
+    TESSEROID stack[COLSTKSIZE], rstack[COLSTKSIZE], pieces[COLSTKSIZE],
+              box, piece;
+
+    #define SQ(x) (x)*(x)
+    /* Pre-compute these things out of the loop */
+    rlonp = d2r*lonp;
+    rlatp = d2r*latp;
+    coslatp = cos(rlatp);
+    res = 0;
+    /* Initialize the division stack with the horizontal extent of the column.
+     * Only w, e, s, n of the elements of this stack are used. */
+    stack[0] = column[0];
+    stktop = 0;
+    while(stktop >= 0)
+    {
+        /* Pop the stack */
+        box = stack[stktop];
+        stktop--;
+        /* Horizontal terms are the same for all the layers of the column */
+        lont = d2r*0.5*(box.w + box.e);
+        latt = d2r*0.5*(box.s + box.n);
+        coslatt = cos(latt);
+        /* Haversine of the angle between the point and the center of the
+         * box. The distances and sizes below are the same as the cosine
+         * formulas of calc_tess_model_adapt but don't round to zero close to
+         * the point (about 0.1 m on Earth), which kept splitting the boxes
+         * there until the stack was full. */
+        hav = SQ(sin(0.5*(latt - rlatp))) +
+              coslatp*coslatt*SQ(sin(0.5*(rlonp - lont)));
+        Llon_unit = 2*asin(coslatt*sin(0.5*d2r*(box.e - box.w)));
+        Llat_unit = d2r*(box.n - box.s);
+        /* Boxes too small to be halved in floating point aren't divided */
+        halvelon = 0.5*(box.w + box.e) > box.w &&
+                   0.5*(box.w + box.e) < box.e;
+        halvelat = 0.5*(box.s + box.n) > box.s &&
+                   0.5*(box.s + box.n) < box.n;
+        nlon = 1;
+        nlat = 1;
+        npieces = 0;
+        part = 0;
+        overflow = 0;
+        /* Divide each layer radially until all the pieces are at a suitable
+         * distance (defined by "ratio"). Mark the horizontal dimensions for
+         * division if any of the pieces needs it. */
+        for(l = 0; l < size && nlon == 1 && nlat == 1; l++)
+        {
+            rstack[0] = column[l];
+            rtop = 0;
+            while(rtop >= 0)
+            {
+                piece = rstack[rtop];
+                rtop--;
+                rt = 0.5*(piece.r2 + piece.r1);
+                distance = sqrt(SQ(rp - rt) + 4*rp*rt*hav);
+                Llon = piece.r2*Llon_unit;
+                Llat = piece.r2*Llat_unit;
+                Lr = piece.r2 - piece.r1;
+                if(distance < ratio*Llon)
+                {
+                    nlon = halvelon ? 2 : 1;
+                    overflow = overflow || !halvelon;
+                }
+                if(distance < ratio*Llat)
+                {
+                    nlat = halvelat ? 2 : 1;
+                    overflow = overflow || !halvelat;
+                }
+                if(nlon == 2 || nlat == 2)
+                {
+                    break;
+                }
+                if(distance < ratio*Lr && rt > piece.r1 && rt < piece.r2 &&
+                   rtop + 2 < COLSTKSIZE)
+                {
+                    rtop += halve_tess(piece, 1, 1, 2, &rstack[rtop + 1]);
+                }
+                else
+                {
+                    if(distance < ratio*Lr)
+                    {
+                        overflow = 1;
+                    }
+                    if(npieces == COLSTKSIZE)
+                    {
+                        /* The field is additive, so calculate the pieces
+                         * that filled the buffer and start it over */
+                        part += calc_tess_pieces(pieces, npieces, box, lonp,
+                                    latp, rp, glq_lon, glq_lat, glq_r, field);
+                        npieces = 0;
+                    }
+                    pieces[npieces] = piece;
+                    npieces++;
+                }
+            }
+        }
+        if((nlon == 2 || nlat == 2) && nlon*nlat + stktop < COLSTKSIZE)
+        {
+            /* Divide the column horizontally and start over for each part */
+            n = halve_tess(box, nlon, nlat, 1, &stack[stktop + 1]);
+            stktop += n;
+            continue;
+        }
+        if(nlon == 2 || nlat == 2 || overflow)
+        {
+            log_error(
+                "Stack overflow: "
+                "column of tesseroids on "
+                "lon=%lf lat=%lf height=%lf."
+                "\n  Calculated without fully dividing the tesseroids. "
+                "Accuracy of the solution cannot be guaranteed."
+                "\n  This is probably caused by a computation point "
+                "too close to the tesseroids."
+                "\n  Try increasing the computation height."
+                "\n  *Expert users* can try modifying the "
+                "distance-size ratio."
+                "\n  *Beware* that this might affect "
+                "the accuracy of the solution.",
+                lonp, latp, rp);
+            if(nlon == 2 || nlat == 2)
+            {
+                /* Didn't finish dividing the layers so use all of them
+                 * whole, as many at a time as fit in the buffer */
+                part = 0;
+                for(l = 0; l < size; l += npieces)
+                {
+                    npieces = size - l < COLSTKSIZE ? size - l : COLSTKSIZE;
+                    for(n = 0; n < npieces; n++)
+                    {
+                        pieces[n] = column[l + n];
+                    }
+                    part += calc_tess_pieces(pieces, npieces, box, lonp, latp,
+                                rp, glq_lon, glq_lat, glq_r, field);
+                }
+                npieces = 0;
+            }
+        }
+        res += part;
+        if(npieces > 0)
+        {
+            res += calc_tess_pieces(pieces, npieces, box, lonp, latp, rp,
+                                    glq_lon, glq_lat, glq_r, field);
+        }
+    }
+    #undef SQ
+    return res;
+}
+
+
+/* Adaptatively calculate the field of a tesseroid model divided in vertical
+ * columns */
+double calc_tess_model_columns_adapt(TESSEROID *model, long *columns,
+    long ncolumns, double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio)
+{
+    double res;
+    long col;
+
+    res = 0;
+    for(col = 0; col < ncolumns; col++)
+    {
+        res += calc_tess_column_adapt(&model[columns[col]],
+                                      (int)(columns[col + 1] - columns[col]),
+                                      lonp, latp, rp, glq_lon, glq_lat, glq_r,
+                                      field, ratio);
+    }
+    return res;
+}
+
+
+/* Calculates the field of a grid model */
+double calc_tess_grid(TESS_GRID *grid, TESSEROID *column, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *))
+{
+    double res;
+    int cell, size;
+
+    res = 0;
+    for(cell = 0; cell < grid->nlon*grid->nlat; cell++)
+    {
+        size = tess_grid_column(grid, cell, column);
+        if(size == 0)
+        {
+            continue;
+        }
+        res += field(column, size, lonp, latp, rp, glq_lon, glq_lat,
+                     glq_r);
+    }
+    return res;
+}
+
+
+/* Adaptatively calculate the field of a grid model */
+double calc_tess_grid_adapt(TESS_GRID *grid, TESSEROID *column, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio)
+{
+    double res;
+    int cell, size;
+
+    res = 0;
+    for(cell = 0; cell < grid->nlon*grid->nlat; cell++)
+    {
+        size = tess_grid_column(grid, cell, column);
+        if(size == 0)
+        {
+            continue;
+        }
+        res += calc_tess_column_adapt(column, size, lonp, latp, rp, glq_lon,
+                                      glq_lat, glq_r, field, ratio);
+    }
+    return res;
+}
+
+
+/* Adaptatively calculate the field of a grid model using the coarsest level
+ * of a multi-resolution pyramid allowed at each region */
+double calc_tess_pyramid_adapt(TESS_PYRAMID *pyramid, TESSEROID *column,
+    double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio, double lod_ratio)
+{
+    double res, distance, lont, latt, rt, d2r = PI/180., coslatp, sinlatp,
+           sinlatt, coslatt, L, Llon, Llat;
+    int stack[PYRSTKSIZE][3], stktop, top, k, i, j, a, b, size, ntop_lon,
+        ntop_lat, itop, jtop;
+    TESS_GRID *grid, *level;
+
+    #define SQ(x) (x)*(x)
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+    grid = pyramid->levels[0];
+    top = pyramid->nlevels - 1;
+    /* Number of nodes on the top level, including the incomplete ones on the
+     * borders of the grid */
+    ntop_lon = (grid->nlon + (1 << top) - 1) >> top;
+    ntop_lat = (grid->nlat + (1 << top) - 1) >> top;
+    res = 0;
+    for(jtop = 0; jtop < ntop_lat; jtop++)
+    {
+        for(itop = 0; itop < ntop_lon; itop++)
+        {
+            /* Traverse the pyramid from this node down. The stack holds the
+             * level and the cell indices on that level. */
+            stack[0][0] = top;
+            stack[0][1] = itop;
+            stack[0][2] = jtop;
+            stktop = 0;
+            while(stktop >= 0)
+            {
+                k = stack[stktop][0];
+                i = stack[stktop][1];
+                j = stack[stktop][2];
+                stktop--;
+                level = pyramid->levels[k];
+                size = 0;
+                if(i < level->nlon && j < level->nlat)
+                {
+                    size = tess_grid_column(level, j*level->nlon + i, column);
+                    /* Empty coarse cells only have empty cells below them */
+                    if(size == 0)
+                    {
+                        continue;
+                    }
+                    if(k == 0)
+                    {
+                        res += calc_tess_column_adapt(column, size, lonp, latp,
+                                    rp, glq_lon, glq_lat, glq_r, field, ratio);
+                        continue;
+                    }
+                    /* Use this level if the point is far enough away */
+                    lont = d2r*0.5*(column[0].w + column[0].e);
+                    latt = d2r*0.5*(column[0].s + column[0].n);
+                    sinlatt = sin(latt);
+                    coslatt = cos(latt);
+                    rt = 0.5*(column[0].r2 + column[size - 1].r1);
+                    distance = sqrt(SQ(rp) + SQ(rt) - 2*rp*rt*(
+                        sinlatp*sinlatt +
+                        coslatp*coslatt*cos(d2r*lonp - lont)));
+                    Llon = column[0].r2*acos(SQ(sinlatt) +
+                        SQ(coslatt)*cos(d2r*(column[0].e - column[0].w)));
+                    Llat = column[0].r2*acos(
+                        sin(d2r*column[0].n)*sin(d2r*column[0].s) +
+                        cos(d2r*column[0].n)*cos(d2r*column[0].s));
+                    L = column[0].r2 - column[size - 1].r1;
+                    if(Llon > L)
+                        L = Llon;
+                    if(Llat > L)
+                        L = Llat;
+                    if(distance >= lod_ratio*L)
+                    {
+                        res += calc_tess_column_adapt(column, size, lonp, latp,
+                                    rp, glq_lon, glq_lat, glq_r, field, ratio);
+                        continue;
+                    }
+                }
+                /* Also compute the effect of the cell if the stack is full
+                 * (but warn the user that the computation might not be very
+                 * precise). */
+                if(stktop + 4 >= PYRSTKSIZE)
+                {
+                    log_error("Stack overflow: pyramid traversal on "
+                              "lon=%lf lat=%lf height=%lf."
+                              "\n  Calculated level %d of the pyramid without "
+                              "going down to the finer levels.",
+                              lonp, latp, rp, k);
+                    if(size > 0)
+                    {
+                        res += calc_tess_column_adapt(column, size, lonp, latp,
+                                    rp, glq_lon, glq_lat, glq_r, field, ratio);
+                        continue;
+                    }
+                    /* Incomplete cells on the borders of the grid aren't in
+                     * the coarse levels, so use the cells of the grid */
+                    for(b = j << k; b < (j + 1) << k && b < grid->nlat; b++)
+                    {
+                        for(a = i << k; a < (i + 1) << k && a < grid->nlon;
+                            a++)
+                        {
+                            size = tess_grid_column(grid, b*grid->nlon + a,
+                                                    column);
+                            if(size > 0)
+                            {
+                                res += calc_tess_column_adapt(column, size,
+                                            lonp, latp, rp, glq_lon, glq_lat,
+                                            glq_r, field, ratio);
+                            }
+                        }
+                    }
+                    continue;
+                }
+                /* Go down a level to the cells that are inside the grid */
+                for(b = 0; b < 2; b++)
+                {
+                    for(a = 0; a < 2; a++)
+                    {
+                        if(((2*i + a) << (k - 1)) < grid->nlon &&
+                           ((2*j + b) << (k - 1)) < grid->nlat)
+                        {
+                            stktop++;
+                            stack[stktop][0] = k - 1;
+                            stack[stktop][1] = 2*i + a;
+                            stack[stktop][2] = 2*j + b;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    #undef SQ
+    return res;
+}
+
 
 /* Calculates potential caused by a tesseroid. */
-double tess_pot(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-               GLQ glq_lat, GLQ glq_r)
+double tess_pot(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
            coslon, rc, kappa, res,
            cospsi, wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    /* The nodes are put in the integration limits here so that the GLQ
+     * structures are only read */
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 res += wlon*wlat*wr*kappa/sqrt(l_sqr);
@@ -202,33 +669,42 @@ double tess_pot(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
 
 
 /* Calculates gx caused by a tesseroid. */
-double tess_gx(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-               GLQ glq_lat, GLQ glq_r)
+double tess_gx(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, kphi, coslatp, coslatc, sinlatp, sinlatc,
            coslon, rc, kappa, res,
            cospsi, wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 res += wlon*wlat*wr*kappa*(rc*kphi)/pow(l_sqr, 1.5);
@@ -242,34 +718,43 @@ double tess_gx(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
 
 
 /* Calculates gy caused by a tesseroid. */
-double tess_gy(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-               GLQ glq_lat, GLQ glq_r)
+double tess_gy(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
            coslon, sinlon, rc, kappa, res,
            cospsi, wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        sinlon = sin(d2r*(glq_lon.nodes[k] - lonp));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 res += wlon*wlat*wr*kappa*(rc*coslatc*sinlon)/pow(l_sqr, 1.5);
@@ -283,33 +768,42 @@ double tess_gy(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
 
 
 /* Calculates gz caused by a tesseroid. */
-double tess_gz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-               GLQ glq_lat, GLQ glq_r)
+double tess_gz(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
            coslon, cospsi, rc, kappa, res,
            wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 res += wlon*wlat*wr*kappa*(rc*cospsi - rp)/pow(l_sqr, 1.5);
@@ -324,34 +818,43 @@ double tess_gz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
 
 
 /* Calculates gxx caused by a tesseroid. */
-double tess_gxx(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-                GLQ glq_lat, GLQ glq_r)
+double tess_gxx(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, kphi, coslatp, coslatc, sinlatp, sinlatc,
            coslon, rc, kappa, res, l5,
            cospsi, wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 l5 = pow(l_sqr, 2.5);
                 kappa = rc*rc*coslatc;
@@ -366,35 +869,44 @@ double tess_gxx(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
 
 
 /* Calculates gxy caused by a tesseroid. */
-double tess_gxy(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-                GLQ glq_lat, GLQ glq_r)
+double tess_gxy(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, kphi, coslatp, coslatc, sinlatp, sinlatc,
            coslon, sinlon, rc, kappa, deltax, deltay, res,
            cospsi, wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        sinlon = sin(d2r*(glq_lon.nodes[k] - lonp));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 deltax = rc*kphi;
@@ -410,34 +922,43 @@ double tess_gxy(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
 
 
 /* Calculates gxz caused by a tesseroid. */
-double tess_gxz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-                GLQ glq_lat, GLQ glq_r)
+double tess_gxz(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, kphi, coslatp, coslatc, sinlatp, sinlatc,
            coslon, cospsi, rc, kappa, deltax, deltaz, res,
            wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
             kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 deltax = rc*kphi;
@@ -453,34 +974,43 @@ double tess_gxz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
 
 
 /* Calculates gyy caused by a tesseroid. */
-double tess_gyy(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-                GLQ glq_lat, GLQ glq_r)
+double tess_gyy(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
            coslon, sinlon, rc, kappa, deltay, res, l5,
            cospsi, wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        sinlon = sin(d2r*(glq_lon.nodes[k] - lonp));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 l5 = pow(l_sqr, 2.5);
                 kappa = rc*rc*coslatc;
@@ -496,34 +1026,43 @@ double tess_gyy(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
 
 
 /* Calculates gyz caused by a tesseroid. */
-double tess_gyz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-                GLQ glq_lat, GLQ glq_r)
+double tess_gyz(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
            coslon, sinlon, cospsi, rc, kappa, deltay, deltaz, res,
            wlon, wlat, wr, scale;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        sinlon = sin(d2r*(glq_lon.nodes[k] - lonp));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 kappa = rc*rc*coslatc;
                 deltay = rc*coslatc*sinlon;
@@ -539,33 +1078,42 @@ double tess_gyz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
 
 
 /* Calculates gzz caused by a tesseroid. */
-double tess_gzz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon,
-                GLQ glq_lat, GLQ glq_r)
+double tess_gzz(TESSEROID tess, double lonp, double latp, double rp,
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
 {
     double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
            coslon, cospsi, rc, kappa, deltaz, res,
            wlon, wlat, wr, scale, l5;
+    double lonc, lonmid, lonhalf, rmid, rhalf, sinlat[GLQ_MAX_ORDER],
+           coslat[GLQ_MAX_ORDER];
     register int i, j, k;
 
     coslatp = cos(d2r*latp);
     sinlatp = sin(d2r*latp);
 
+    lonmid = 0.5*(tess.e + tess.w);
+    lonhalf = 0.5*(tess.e - tess.w);
+    rmid = 0.5*(tess.r2 + tess.r1);
+    rhalf = 0.5*(tess.r2 - tess.r1);
+    glq_scale_sincos(glq_lat, tess.s, tess.n, sinlat, coslat);
+
     res = 0;
 
-    for(k = 0; k < glq_lon.order; k++)
+    for(k = 0; k < glq_lon->order; k++)
     {
-        coslon = cos(d2r*(lonp - glq_lon.nodes[k]));
-        wlon = glq_lon.weights[k];
-        for(j = 0; j < glq_lat.order; j++)
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
         {
-            sinlatc = glq_lat.nodes_sin[j];
-            coslatc = glq_lat.nodes_cos[j];
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
             cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
-            wlat = glq_lat.weights[j];
-            for(i = 0; i < glq_r.order; i++)
+            wlat = glq_lat->weights[j];
+            for(i = 0; i < glq_r->order; i++)
             {
-                wr = glq_r.weights[i];
-                rc = glq_r.nodes[i];
+                wr = glq_r->weights[i];
+                rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
                 l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
                 l5 = pow(l_sqr, 2.5);
                 kappa = rc*rc*coslatc;
@@ -578,3 +1126,571 @@ double tess_gzz(TESSEROID tess, double lonp, double latp, double rp, GLQ glq_lon
     res *= SI2EOTVOS*G*tess.density*scale;
     return res;
 }
+
+
+/* Calculates potential caused by a column of tesseroids. */
+double tess_pot_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    lres += glq_r->weights[i]*kappa/sqrt(l_sqr);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= G*scale;
+    return res;
+}
+
+
+/* Calculates gx caused by a column of tesseroids. */
+double tess_gx_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           kphi, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    lres += glq_r->weights[i]*kappa*(rc*kphi)/pow(l_sqr, 1.5);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2MGAL*G*scale;
+    return res;
+}
+
+
+/* Calculates gy caused by a column of tesseroids. */
+double tess_gy_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           sinlon, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    lres += glq_r->weights[i]*kappa*
+                            (rc*coslatc*sinlon)/pow(l_sqr, 1.5);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2MGAL*G*scale;
+    return res;
+}
+
+
+/* Calculates gz caused by a column of tesseroids. */
+double tess_gz_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    lres += glq_r->weights[i]*kappa*
+                            (rc*cospsi - rp)/pow(l_sqr, 1.5);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2MGAL*G*scale;
+    /* Used this to make z point down */
+    return -1*res;
+}
+
+
+/* Calculates gxx caused by a column of tesseroids. */
+double tess_gxx_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           kphi, l5, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    l5 = pow(l_sqr, 2.5);
+                    lres += glq_r->weights[i]*kappa*
+                            (3*rc*kphi*rc*kphi - l_sqr)/l5;
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2EOTVOS*G*scale;
+    return res;
+}
+
+
+/* Calculates gxy caused by a column of tesseroids. */
+double tess_gxy_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           kphi, sinlon, deltax, deltay, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    deltax = rc*kphi;
+                    deltay = rc*coslatc*sinlon;
+                    lres += glq_r->weights[i]*kappa*
+                            (3*deltax*deltay)/pow(l_sqr, 2.5);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2EOTVOS*G*scale;
+    return res;
+}
+
+
+/* Calculates gxz caused by a column of tesseroids. */
+double tess_gxz_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           kphi, deltax, deltaz, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            kphi = coslatp*sinlatc - sinlatp*coslatc*coslon;
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    deltax = rc*kphi;
+                    deltaz = rc*cospsi - rp;
+                    lres += glq_r->weights[i]*kappa*
+                            (3*deltax*deltaz)/pow(l_sqr, 2.5);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2EOTVOS*G*scale;
+    return res;
+}
+
+
+/* Calculates gyy caused by a column of tesseroids. */
+double tess_gyy_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           sinlon, deltay, l5, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    l5 = pow(l_sqr, 2.5);
+                    deltay = rc*coslatc*sinlon;
+                    lres += glq_r->weights[i]*kappa*(3*deltay*deltay -
+                                                     l_sqr)/l5;
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2EOTVOS*G*scale;
+    return res;
+}
+
+
+/* Calculates gyz caused by a column of tesseroids. */
+double tess_gyz_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           sinlon, deltay, deltaz, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        sinlon = sin(d2r*(lonc - lonp));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    deltay = rc*coslatc*sinlon;
+                    deltaz = rc*cospsi - rp;
+                    lres += glq_r->weights[i]*kappa*
+                            (3*deltay*deltaz)/pow(l_sqr, 2.5);
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2EOTVOS*G*scale;
+    return res;
+}
+
+
+/* Calculates gzz caused by a column of tesseroids. */
+double tess_gzz_column(TESSEROID *column, int size, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r)
+{
+    double d2r = PI/180., l_sqr, coslatp, coslatc, sinlatp, sinlatc,
+           coslon, cospsi, rc, kappa, res, rres, lres, rmid, rhalf,
+           deltaz, l5, wlon, wlat, scale;
+    double lonc, lonmid, lonhalf, sinlat[GLQ_MAX_ORDER], coslat[GLQ_MAX_ORDER];
+    register int i, j, k, t;
+
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+
+    lonmid = 0.5*(column[0].e + column[0].w);
+    lonhalf = 0.5*(column[0].e - column[0].w);
+    glq_scale_sincos(glq_lat, column[0].s, column[0].n, sinlat, coslat);
+
+    res = 0;
+    for(k = 0; k < glq_lon->order; k++)
+    {
+        lonc = lonhalf*glq_lon->nodes_unscaled[k] + lonmid;
+        coslon = cos(d2r*(lonp - lonc));
+        wlon = glq_lon->weights[k];
+        for(j = 0; j < glq_lat->order; j++)
+        {
+            sinlatc = sinlat[j];
+            coslatc = coslat[j];
+            cospsi = sinlatp*sinlatc + coslatp*coslatc*coslon;
+            wlat = glq_lat->weights[j];
+            /* Same horizontal terms for all layers of the column */
+            rres = 0;
+            for(t = 0; t < size; t++)
+            {
+                rhalf = 0.5*(column[t].r2 - column[t].r1);
+                rmid = 0.5*(column[t].r2 + column[t].r1);
+                lres = 0;
+                for(i = 0; i < glq_r->order; i++)
+                {
+                    rc = rhalf*glq_r->nodes_unscaled[i] + rmid;
+                    l_sqr = rp*rp + rc*rc - 2*rp*rc*cospsi;
+                    kappa = rc*rc*coslatc;
+                    l5 = pow(l_sqr, 2.5);
+                    deltaz = rc*cospsi - rp;
+                    lres += glq_r->weights[i]*kappa*(3*deltaz*deltaz -
+                                                     l_sqr)/l5;
+                }
+                rres += column[t].density*rhalf*lres;
+            }
+            res += wlon*wlat*rres;
+        }
+    }
+    scale = d2r*(column[0].e - column[0].w)*d2r*(column[0].n - column[0].s)/4.;
+    res *= SI2EOTVOS*G*scale;
+    return res;
+}
@@ -31,15 +31,15 @@ To calculate the gzz component due to a tesseroid on a regular grid:
         double lon, lat, r = MEAN_EARTH_RADIUS + 1500000, res;
         int order = 8;
 
-        glqlon = glq_new(order, tess.w, tess.e);
-        glqlat = glq_new(order, tess.s, tess.n);
-        glqr = glq_new(order, tess.r1, tess.r2);
+        glqlon = glq_new(order, -1, 1);
+        glqlat = glq_new(order, -1, 1);
+        glqr = glq_new(order, -1, 1);
 
         for(lat = 20; lat <= 70; lat += 0.5)
         {
             for(lon = -25; lon <= 25; lon += 0.5)
             {
-                res = tess_gzz(tess, lon, lat, r, *glqlon, *glqlat, *glqr);
+                res = tess_gzz(tess, lon, lat, r, glqlon, glqlat, glqr);
                 printf("%g %g %g\n", lon, lat, res);
             }
         }
@@ -113,9 +113,11 @@ the tesseroids</b>.
 
 @return the sum of the fields of all the tesseroids in the model
 */
-extern double calc_tess_model(TESSEROID *model, int size, double lonp,
-    double latp, double rp, GLQ *glq_lon, GLQ *glq_lat, GLQ *glq_r,
-    double (*field)(TESSEROID, double, double, double, GLQ, GLQ, GLQ));
+extern double calc_tess_model(TESSEROID *model, long size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *));
 
 
 /** Adaptatively calculate the field of a tesseroid model at a given point by
@@ -139,11 +141,208 @@ the tesseroids</b>.
 
 @return the sum of the fields of all the tesseroids in the model
 */
-extern double calc_tess_model_adapt(TESSEROID *model, int size, double lonp,
-    double latp, double rp, GLQ *glq_lon, GLQ *glq_lat, GLQ *glq_r,
-    double (*field)(TESSEROID, double, double, double, GLQ, GLQ, GLQ),
+extern double calc_tess_model_adapt(TESSEROID *model, long size,
+    double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
     double ratio);
 
+/** Calculates the field of a tesseroid model divided in vertical columns.
+
+A column is a set of tesseroids (layers) with the same w, e, s, and n borders.
+Use tess_find_columns() to find the columns of a model. The longitudinal and
+latitudinal GLQ nodes are put in the scale of each column only once and the
+radial integrals of all the layers are summed in a single pass by the column
+field function.
+
+Uses a function pointer to call one of the apropriate column field calculating
+functions:
+    - tess_pot_column()
+    - tess_gx_column()
+    - tess_gy_column()
+    - tess_gz_column()
+    - tess_gxx_column()
+    - tess_gxy_column()
+    - tess_gxz_column()
+    - tess_gyy_column()
+    - tess_gyz_column()
+    - tess_gzz_column()
+
+Will re-use the same GLQ structures, and therefore the <b>same order, for all
+the tesseroids</b>.
+
+@param model TESSEROID array defining the model
+@param columns index of the first tesseroid of each column in the model plus
+               the index one past the end of the last column (see
+               tess_find_columns())
+@param ncolumns number of columns in the model
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the column field calculating functions
+
+@return the sum of the fields of all the tesseroids in the model
+*/
+extern double calc_tess_model_columns(TESSEROID *model, long *columns,
+    long ncolumns, double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *));
+
+
+/** Adaptatively calculate the field of a column of tesseroids at a given
+point by splitting the column if necessary to maintain GLQ stability.
+
+The column is split horizontally if any of its layers is too close to the
+computation point. Layers are split radially on their own, so that the
+horizontal GLQ terms are computed once for all the pieces of the column.
+
+See calc_tess_model_adapt() for more details.
+
+@param column array with the layers of the column (all with the same w, e, s,
+              and n)
+@param size number of layers in the column
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the column field calculating functions
+@param ratio distance-to-size ratio for doing adaptative resizing
+
+@return the sum of the fields of all the layers in the column
+*/
+extern double calc_tess_column_adapt(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio);
+
+
+/** Adaptatively calculate the field of a tesseroid model divided in vertical
+columns.
+
+Calls calc_tess_column_adapt() for each column of the model. See
+calc_tess_model_columns() for the description of the columns.
+
+@param model TESSEROID array defining the model
+@param columns index of the first tesseroid of each column in the model plus
+               the index one past the end of the last column (see
+               tess_find_columns())
+@param ncolumns number of columns in the model
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the column field calculating functions
+@param ratio distance-to-size ratio for doing adaptative resizing
+
+@return the sum of the fields of all the tesseroids in the model
+*/
+extern double calc_tess_model_columns_adapt(TESSEROID *model,
+    long *columns, long ncolumns, double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio);
+
+
+/** Calculates the field of a grid model (see TESS_GRID).
+
+The tesseroids of each cell of the grid are generated on the fly with
+tess_grid_column() and their field is calculated as a column. See
+calc_tess_model_columns() for the column field calculating functions.
+
+@param grid the grid model
+@param column array of grid->nlayers tesseroids with memory allocated. Used as
+              a buffer for the tesseroids of each cell.
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the column field calculating functions
+
+@return the sum of the fields of all the cells of the grid
+*/
+extern double calc_tess_grid(TESS_GRID *grid, TESSEROID *column, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *));
+
+
+/** Adaptatively calculate the field of a grid model (see TESS_GRID).
+
+Calls calc_tess_column_adapt() for the tesseroids of each cell of the grid.
+
+@param grid the grid model
+@param column array of grid->nlayers tesseroids with memory allocated. Used as
+              a buffer for the tesseroids of each cell.
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the column field calculating functions
+@param ratio distance-to-size ratio for doing adaptative resizing
+
+@return the sum of the fields of all the cells of the grid
+*/
+extern double calc_tess_grid_adapt(TESS_GRID *grid, TESSEROID *column,
+    double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio);
+
+
+/** Adaptatively calculate the field of a grid model using a
+multi-resolution pyramid (see TESS_PYRAMID and new_tess_pyramid()).
+
+The pyramid is traversed from the coarsest level down. A cell of a coarse level
+is used instead of the finer cells below it if the distance to the
+computation point is at least lod_ratio times the largest dimension of the
+cell. So the fine cells are only used close to the computation point. The
+cells that are used are calculated with calc_tess_column_adapt().
+
+The coarse levels conserve the mass of each layer of the grid, so their
+fields converge to the field of the original grid as lod_ratio increases.
+
+@param pyramid the multi-resolution pyramid of the grid model
+@param column array of nlayers tesseroids with memory allocated. Used as
+              a buffer for the tesseroids of each cell.
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the column field calculating functions
+@param ratio distance-to-size ratio for doing adaptative resizing
+@param lod_ratio distance-to-size ratio for using a coarse level of the pyramid
+
+@return the sum of the fields of all the cells used
+*/
+extern double calc_tess_pyramid_adapt(TESS_PYRAMID *pyramid, TESSEROID *column,
+    double lonp, double latp, double rp, const GLQ *glq_lon,
+    const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID *, int, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double ratio, double lod_ratio);
+
 
 /** Calculates potential caused by a tesseroid.
 
@@ -155,27 +354,24 @@ V(r_p,\phi_p,\lambda_p) = G \rho \displaystyle\int_{\lambda_1}^{\lambda_2}
 
 <b>Input and output values in SI units and degrees</b>!
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required, with orders up
+to GLQ_MAX_ORDER. Only the unit rules of the GLQ structures are used (the
+nodes are put in the borders of the tesseroid on the stack), so their
+integration limits don't need to be set and the same structures can be used
+by several threads at the same time.
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_pot(TESSEROID tess, double lonp, double latp, double rp,
-                       GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 
 /** Calculates gx caused by a tesseroid (Grombein et al., 2010).
@@ -191,27 +387,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in mGal!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gx(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gy caused by a tesseroid (Grombein et al., 2010).
 
@@ -227,27 +417,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in mGal!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gy(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gz caused by a tesseroid (Grombein et al., 2010).
 
@@ -262,27 +446,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in mGal!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gz(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gxx caused by a tesseroid (Grombein et al., 2010).
 
@@ -297,27 +475,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in Eotvos!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gxx(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gxy caused by a tesseroid (Grombein et al., 2010).
 
@@ -333,27 +505,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in Eotvos!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gxy(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gxz caused by a tesseroid (Grombein et al., 2010).
 
@@ -369,27 +535,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in Eotvos!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gxz(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gyy caused by a tesseroid (Grombein et al., 2010).
 
@@ -405,27 +565,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in Eotvos!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gyy(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gyz caused by a tesseroid (Grombein et al., 2010).
 
@@ -441,27 +595,21 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in Eotvos!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gyz(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
 
 /** Calculates gzz caused by a tesseroid (Grombein et al., 2010).
 
@@ -476,26 +624,129 @@ system <b>x->North, y->East, z->out</b>
 
 <b>Input values in SI units and <b>degrees</b> and returns values in Eotvos!</b>
 
-Use function glq_new() to create the GLQ parameters required. The integration
-limits should be set to:
-    - glq_lon: lower = tess.w and upper = tess.e  (in degrees)
-    - glq_lat: lower = tess.s and upper = tess.n  (in degrees)
-    - glq_r: lower = tess.r1 and upper = tess.r2
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()).
 
 @param tess data structure describing the tesseroid
 @param lonp longitude of the computation point P
 @param latp latitude of the computation point P
 @param rp radial coordinate of the computation point P
-@param glq_lon GLQ structure with the nodes, weights and integration limits set
-    for the longitudinal integration
-@param glq_lat GLQ structure with the nodes, weights and integration limits set
-    for the latitudinal integration
-@param glq_r GLQ structure with the nodes, weights and integration limits set
-    for the radial integration
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
 
 @return field calculated at P
 */
 extern double tess_gzz(TESSEROID tess, double lonp, double latp, double rp,
-                      GLQ glq_lon, GLQ glq_lat, GLQ glq_r);
+    const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r);
+
+
+/** Calculates potential caused by a column of tesseroids.
+
+A column is a set of tesseroids (layers) with the same w, e, s, and n borders.
+The terms that depend only on the longitudinal and latitudinal GLQ nodes are
+computed once and shared by the radial integrals of all the layers. The result
+is the sum of the fields of the layers calculated with tess_pot().
+
+Use function glq_new() to create the GLQ parameters required (see
+tess_pot()). The nodes are put in the borders of the column and in the radial
+limits of each layer.
+
+@param column array with the layers of the column
+@param size number of layers in the column
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+
+@return field calculated at P
+*/
+extern double tess_pot_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+
+/** Calculates gx caused by a column of tesseroids.
+
+Same as tess_gx() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gx_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gy caused by a column of tesseroids.
+
+Same as tess_gy() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gy_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gz caused by a column of tesseroids.
+
+Same as tess_gz() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gz_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gxx caused by a column of tesseroids.
+
+Same as tess_gxx() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gxx_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gxy caused by a column of tesseroids.
+
+Same as tess_gxy() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gxy_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gxz caused by a column of tesseroids.
+
+Same as tess_gxz() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gxz_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gyy caused by a column of tesseroids.
+
+Same as tess_gyy() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gyy_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gyz caused by a column of tesseroids.
+
+Same as tess_gyz() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gyz_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
+
+/** Calculates gzz caused by a column of tesseroids.
+
+Same as tess_gzz() for each layer of the column. See tess_pot_column() for the
+description of the parameters.
+*/
+extern double tess_gzz_column(TESSEROID *column, int size, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r);
 
 #endif
@@ -0,0 +1,190 @@
+/*
+Ordering of points along a Hilbert space-filling curve.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "geometry.h"
+#include "hilbert.h"
+
+
+/* A point and its position along the curve */
+typedef struct hilbert_key_struct
+{
+    unsigned long key;
+    long index;
+} HILBERT_KEY;
+
+
+/* Position of a cell along the Hilbert curve. */
+unsigned long hilbert_index(unsigned long x, unsigned long y)
+{
+    unsigned long d = 0, s, rx, ry, tmp;
+
+    for(s = HILBERT_SIZE/2; s > 0; s /= 2)
+    {
+        rx = (x & s) > 0;
+        ry = (y & s) > 0;
+        d += s*s*((3*rx) ^ ry);
+        /* Rotate the quadrant so that the curve inside it has the standard
+         * orientation */
+        if(ry == 0)
+        {
+            if(rx == 1)
+            {
+                x = HILBERT_SIZE - 1 - x;
+                y = HILBERT_SIZE - 1 - y;
+            }
+            tmp = x;
+            x = y;
+            y = tmp;
+        }
+    }
+    return d;
+}
+
+
+/* Compare points by their position along the curve. Ties keep the original
+order. */
+static int compare_hilbert_keys(const void *a, const void *b)
+{
+    const HILBERT_KEY *ka = (const HILBERT_KEY *)a,
+                      *kb = (const HILBERT_KEY *)b;
+
+    if(ka->key != kb->key)
+    {
+        return ka->key < kb->key ? -1 : 1;
+    }
+    return ka->index < kb->index ? -1 : (ka->index > kb->index);
+}
+
+
+/* Index of the cell of a coordinate in [min, min + size] */
+static unsigned long hilbert_cell(double value, double min, double size)
+{
+    double cell;
+
+    if(size <= 0)
+    {
+        return 0;
+    }
+    cell = (value - min)/size*HILBERT_SIZE;
+    /* Also catches NaN */
+    if(!(cell >= 0))
+    {
+        return 0;
+    }
+    if(cell >= HILBERT_SIZE - 1)
+    {
+        return HILBERT_SIZE - 1;
+    }
+    return (unsigned long)cell;
+}
+
+
+/* Find the order of points along the Hilbert curve. */
+int hilbert_sort(const double *coords, int stride, long n, long *order)
+{
+    HILBERT_KEY *keys;
+    double xmin, xmax, ymin, ymax;
+    long i;
+
+    if(n <= 0)
+    {
+        return 0;
+    }
+    keys = (HILBERT_KEY *)malloc(n*sizeof(HILBERT_KEY));
+    if(keys == NULL)
+    {
+        return 1;
+    }
+    xmin = xmax = coords[0];
+    ymin = ymax = coords[1];
+    for(i = 1; i < n; i++)
+    {
+        if(coords[stride*i] < xmin)
+            xmin = coords[stride*i];
+        if(coords[stride*i] > xmax)
+            xmax = coords[stride*i];
+        if(coords[stride*i + 1] < ymin)
+            ymin = coords[stride*i + 1];
+        if(coords[stride*i + 1] > ymax)
+            ymax = coords[stride*i + 1];
+    }
+    for(i = 0; i < n; i++)
+    {
+        keys[i].key = hilbert_index(
+            hilbert_cell(coords[stride*i], xmin, xmax - xmin),
+            hilbert_cell(coords[stride*i + 1], ymin, ymax - ymin));
+        keys[i].index = i;
+    }
+    qsort(keys, n, sizeof(HILBERT_KEY), compare_hilbert_keys);
+    for(i = 0; i < n; i++)
+    {
+        order[i] = keys[i].index;
+    }
+    free(keys);
+    return 0;
+}
+
+
+/* Reorder a tesseroid model along the Hilbert curve. */
+int hilbert_sort_tess(TESSEROID *model, long size, long *order)
+{
+    TESSEROID *copy;
+    double *centers;
+    long *columns, *colorder, ncolumns, c, i, k;
+
+    if(size <= 0)
+    {
+        return 0;
+    }
+    copy = (TESSEROID *)malloc(size*sizeof(TESSEROID));
+    columns = (long *)malloc((size + 1)*sizeof(long));
+    if(copy == NULL || columns == NULL)
+    {
+        free(copy);
+        free(columns);
+        return 1;
+    }
+    ncolumns = tess_find_columns(model, size, columns);
+    centers = (double *)calloc(2*ncolumns, sizeof(double));
+    colorder = (long *)malloc(ncolumns*sizeof(long));
+    if(centers == NULL || colorder == NULL)
+    {
+        free(copy);
+        free(columns);
+        free(centers);
+        free(colorder);
+        return 1;
+    }
+    for(c = 0; c < ncolumns; c++)
+    {
+        centers[2*c] = 0.5*(model[columns[c]].w + model[columns[c]].e);
+        centers[2*c + 1] = 0.5*(model[columns[c]].s + model[columns[c]].n);
+    }
+    if(hilbert_sort(centers, 2, ncolumns, colorder) != 0)
+    {
+        free(copy);
+        free(columns);
+        free(centers);
+        free(colorder);
+        return 1;
+    }
+    memcpy(copy, model, size*sizeof(TESSEROID));
+    for(c = 0, k = 0; c < ncolumns; c++)
+    {
+        for(i = columns[colorder[c]]; i < columns[colorder[c] + 1]; i++)
+        {
+            model[k] = copy[i];
+            order[k] = i;
+            k++;
+        }
+    }
+    free(copy);
+    free(columns);
+    free(centers);
+    free(colorder);
+    return 0;
+}
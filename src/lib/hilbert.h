@@ -0,0 +1,70 @@
+/*
+Ordering of points along a Hilbert space-filling curve.
+
+The Hilbert curve visits every cell of a square grid, moving only between
+neighboring cells. Points that are close along the curve are also close in
+space, so calculating on (or with) points in the order of the curve keeps
+consecutive calculations in the same region. The curve used here has
+HILBERT_SIZE x HILBERT_SIZE cells covering the bounding box of the points.
+*/
+
+#ifndef _TESSEROIDS_HILBERT_H_
+#define _TESSEROIDS_HILBERT_H_
+
+
+/* Needed for definition of TESSEROID */
+#include "geometry.h"
+
+/** Number of cells of the curve along each dimension */
+#define HILBERT_SIZE 65536
+
+
+/** Position of a cell along the Hilbert curve.
+
+@param x index of the cell along the first dimension (0 to HILBERT_SIZE - 1)
+@param y index of the cell along the second dimension (0 to HILBERT_SIZE - 1)
+
+@return the position of the cell (0 to HILBERT_SIZE*HILBERT_SIZE - 1)
+*/
+extern unsigned long hilbert_index(unsigned long x, unsigned long y);
+
+
+/** Find the order of points along the Hilbert curve.
+
+The curve covers the bounding box of the points. Points in the same cell of
+the curve keep their original order.
+
+@param coords the coordinates of the points. The first 2 values of each point
+              are used (for example, longitude and latitude).
+@param stride number of values of each point in coords
+@param n number of points
+@param order used to return the indexes of the points in the order of the
+             curve (must have room for n longs)
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there wasn't enough memory
+*/
+extern int hilbert_sort(const double *coords, int stride, long n,
+                        long *order);
+
+
+/** Reorder a tesseroid model along the Hilbert curve.
+
+The vertical columns of the model (see tess_find_columns()) are kept together
+and in the same order, so the model can still be calculated by columns. The
+columns are sorted by the longitude and latitude of their centers.
+
+@param model TESSEROID array defining the model. Is reordered in place.
+@param size number of tesseroids in the model
+@param order used to return the position in the original model of each
+             tesseroid of the reordered model (must have room for size longs)
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there wasn't enough memory (the model is not changed)
+*/
+extern int hilbert_sort_tess(TESSEROID *model, long size, long *order);
+
+
+#endif
@@ -0,0 +1,445 @@
+/*
+Binary cache files (sidecars) of parsed model files.
+*/
+
+
+/* Needed for fileno, fstat, lstat, st_mtim, fseeko and getpid */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #define MODEL_CACHE_POSIX
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    /* Nanoseconds of the modification time of a file */
+    #ifdef __APPLE__
+        #define MTIME_NSEC(info) ((info).st_mtimespec.tv_nsec)
+    #else
+        #define MTIME_NSEC(info) ((info).st_mtim.tv_nsec)
+    #endif
+#endif
+#include "logger.h"
+#include "geometry.h"
+#include "parsers.h"
+#include "hilbert.h"
+#include "model_cache.h"
+
+
+/* Identifies the sidecar format in the start of the file */
+#define MODEL_CACHE_MAGIC "TESSMDC2"
+/* Size of the blocks in which the model file is read to hash it */
+#define MODEL_CACHE_BLOCK 65536
+
+
+/* Header of a sidecar file */
+typedef struct model_cache_header_struct
+{
+    char magic[8];
+    int kind;
+    int itemsize;
+    long count;
+    int sorted;
+    double check;
+    double srcsize;
+    double srcmtime;
+    double srcnsec;
+    double srchash;
+    double datahash;
+} MODEL_CACHE_HEADER;
+
+
+#ifdef MODEL_CACHE_POSIX
+/* Update a 32 bit hash with an array of bytes (FNV-1a on 4 bytes at a time) */
+static unsigned long hash_bytes(const unsigned char *data, size_t n,
+                                unsigned long hash)
+{
+    unsigned long word;
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4)
+    {
+        word = (unsigned long)data[i] | ((unsigned long)data[i + 1] << 8) |
+               ((unsigned long)data[i + 2] << 16) |
+               ((unsigned long)data[i + 3] << 24);
+        hash = ((hash ^ word)*16777619UL) & 0xffffffffUL;
+        hash ^= hash >> 15;
+    }
+    for(; i < n; i++)
+    {
+        hash = ((hash ^ data[i])*16777619UL) & 0xffffffffUL;
+    }
+    return hash;
+}
+
+
+/* Hash the whole contents of a file. Leaves the file at the start. Returns 1
+if the file couldn't be read. */
+static int hash_file(FILE *file, unsigned long *hash)
+{
+    unsigned char *buff;
+    size_t nread;
+
+    buff = (unsigned char *)malloc(MODEL_CACHE_BLOCK);
+    if(buff == NULL)
+    {
+        return 1;
+    }
+    *hash = 2166136261UL;
+    do
+    {
+        /* All blocks but the last have a multiple of 4 bytes, so hashing
+         * them one after the other is the same as hashing the whole file */
+        nread = fread(buff, 1, MODEL_CACHE_BLOCK, file);
+        *hash = hash_bytes(buff, nread, *hash);
+    } while(nread == MODEL_CACHE_BLOCK);
+    free(buff);
+    if(ferror(file))
+    {
+        clearerr(file);
+        fseeko(file, 0, SEEK_SET);
+        return 1;
+    }
+    return fseeko(file, 0, SEEK_SET) != 0;
+}
+
+
+/* Load the model in a sidecar if it matches the model file. Returns NULL if
+the sidecar doesn't exist or is stale or corrupted. If the model in the
+sidecar was reordered, also returns the positions in the model file. */
+static void * load_model_cache(const char *cname, MODEL_CACHE_HEADER *expect,
+                               long **order, long *size)
+{
+    MODEL_CACHE_HEADER head;
+    FILE *file;
+    char *model;
+    long *positions = NULL;
+    int rc;
+    unsigned long hash;
+    size_t nbytes;
+
+    file = fopen(cname, "rb");
+    if(file == NULL)
+    {
+        return NULL;
+    }
+    /* Not a sidecar. save_model_cache() warns about it. */
+    if(fread(&head, sizeof(MODEL_CACHE_HEADER), 1, file) != 1 ||
+       strncmp(head.magic, MODEL_CACHE_MAGIC, 8) != 0)
+    {
+        fclose(file);
+        return NULL;
+    }
+    if(head.kind != expect->kind || head.itemsize != expect->itemsize ||
+       head.check != 1.5 || head.srcsize != expect->srcsize ||
+       head.srcmtime != expect->srcmtime || head.srcnsec != expect->srcnsec ||
+       head.srchash != expect->srchash ||
+       head.count <= 0 || (head.sorted != 0 && head.sorted != 1))
+    {
+        log_info("model cache file %s is out of date", cname);
+        fclose(file);
+        return NULL;
+    }
+    nbytes = (size_t)head.count*head.itemsize;
+    model = (char *)malloc(nbytes);
+    if(head.sorted)
+    {
+        positions = (long *)malloc(head.count*sizeof(long));
+    }
+    if(model == NULL || (head.sorted && positions == NULL))
+    {
+        free(model);
+        free(positions);
+        fclose(file);
+        return NULL;
+    }
+    rc = fread(model, 1, nbytes, file) != nbytes ||
+         (head.sorted && fread(positions, sizeof(long), head.count, file) !=
+                         (size_t)head.count) ||
+         fgetc(file) != EOF;
+    if(!rc)
+    {
+        hash = hash_bytes((unsigned char *)model, nbytes, 2166136261UL);
+        if(head.sorted)
+        {
+            hash = hash_bytes((unsigned char *)positions,
+                              head.count*sizeof(long), hash);
+        }
+        rc = (double)hash != head.datahash;
+    }
+    if(rc)
+    {
+        log_warning("model cache file %s is corrupted. Rebuilding it", cname);
+        free(model);
+        free(positions);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *order = positions;
+    *size = head.count;
+    return model;
+}
+
+
+/* Write a sidecar. Writes to a temporary file first so that concurrent runs
+never see an incomplete sidecar. Only replaces a file that is a sidecar, never
+a file of the user that happens to have the same name. 'order' is NULL if the
+model is in the order of the model file. */
+static void save_model_cache(const char *cname, MODEL_CACHE_HEADER *head,
+                             const void *model, const long *order)
+{
+    FILE *file;
+    char *tmpname, magic[8];
+    size_t nbytes = (size_t)head->count*head->itemsize;
+    unsigned long hash;
+    struct stat info;
+    int rc;
+
+    if(lstat(cname, &info) == 0)
+    {
+        file = fopen(cname, "rb");
+        rc = file == NULL || fread(magic, 1, 8, file) != 8 ||
+             strncmp(magic, MODEL_CACHE_MAGIC, 8) != 0;
+        if(file != NULL)
+        {
+            fclose(file);
+        }
+        if(rc)
+        {
+            log_warning("%s is not a model cache file. Not caching the model",
+                        cname);
+            return;
+        }
+    }
+    tmpname = (char *)malloc(strlen(cname) + 30);
+    if(tmpname == NULL)
+    {
+        return;
+    }
+    sprintf(tmpname, "%s.%ld.tmp", cname, (long)getpid());
+    file = fopen(tmpname, "wb");
+    if(file == NULL)
+    {
+        log_info("can't write model cache file %s", cname);
+        free(tmpname);
+        return;
+    }
+    memcpy(head->magic, MODEL_CACHE_MAGIC, 8);
+    head->sorted = order != NULL;
+    head->check = 1.5;
+    hash = hash_bytes((const unsigned char *)model, nbytes, 2166136261UL);
+    if(order != NULL)
+    {
+        hash = hash_bytes((const unsigned char *)order,
+                          head->count*sizeof(long), hash);
+    }
+    head->datahash = (double)hash;
+    rc = fwrite(head, sizeof(MODEL_CACHE_HEADER), 1, file) != 1 ||
+         fwrite(model, 1, nbytes, file) != nbytes ||
+         (order != NULL && fwrite(order, sizeof(long), head->count, file) !=
+                           (size_t)head->count);
+    if(fclose(file) != 0 || rc || rename(tmpname, cname) != 0)
+    {
+        log_info("can't write model cache file %s", cname);
+        remove(tmpname);
+    }
+    else
+    {
+        log_info("Wrote model cache file %s", cname);
+    }
+    free(tmpname);
+}
+#endif
+
+
+/* Put a reordered tesseroid model back in the order of the model file. Frees
+the reordered model and the positions. Returns NULL if there isn't enough
+memory. */
+static TESSEROID * unsort_tess_model(TESSEROID *model, long *order,
+                                     long size)
+{
+    TESSEROID *inorder;
+    long i;
+
+    inorder = (TESSEROID *)malloc(size*sizeof(TESSEROID));
+    if(inorder != NULL)
+    {
+        for(i = 0; i < size; i++)
+        {
+            inorder[order[i]] = model[i];
+        }
+    }
+    else
+    {
+        log_error("problem allocating memory to unsort the model");
+    }
+    free(model);
+    free(order);
+    return inorder;
+}
+
+
+/* Reorder a tesseroid model along the Hilbert curve. Frees the model and
+returns NULL if there isn't enough memory. */
+static TESSEROID * sort_tess_model(TESSEROID *model, long size,
+                                   long **order)
+{
+    *order = (long *)malloc(size*sizeof(long));
+    if(*order == NULL || hilbert_sort_tess(model, size, *order) != 0)
+    {
+        log_error("problem allocating memory to sort the model");
+        free(*order);
+        *order = NULL;
+        free(model);
+        return NULL;
+    }
+    return model;
+}
+
+
+/* Read a model from the sidecar or parse it and write the sidecar. If 'order'
+is not NULL, the model is a tesseroid model reordered along the Hilbert
+curve. */
+static void * read_model_cached(FILE *modelfile, const char *fname, int kind,
+                                long **order, long *size)
+{
+    void *model;
+    long *stored = NULL;
+    int nread = 0;
+#ifdef MODEL_CACHE_POSIX
+    MODEL_CACHE_HEADER head;
+    struct stat info;
+    unsigned long srchash;
+    char *cname = NULL;
+#endif
+
+    if(order != NULL)
+    {
+        *order = NULL;
+    }
+#ifdef MODEL_CACHE_POSIX
+
+    if(ftell(modelfile) == 0 && fstat(fileno(modelfile), &info) == 0 &&
+       S_ISREG(info.st_mode) && info.st_size >= MODEL_CACHE_MINSIZE &&
+       hash_file(modelfile, &srchash) == 0)
+    {
+        cname = (char *)malloc(strlen(fname) + 7);
+    }
+    if(cname != NULL)
+    {
+        sprintf(cname, "%s.cache", fname);
+        memset(&head, 0, sizeof(MODEL_CACHE_HEADER));
+        head.kind = kind;
+        head.itemsize = kind == MODEL_CACHE_TESS ? (int)sizeof(TESSEROID) :
+                        kind == MODEL_CACHE_SPHERE ? (int)sizeof(SPHERE) :
+                                                     (int)sizeof(PRISM);
+        head.srcsize = (double)info.st_size;
+        head.srcmtime = (double)info.st_mtime;
+        head.srcnsec = (double)MTIME_NSEC(info);
+        head.srchash = (double)srchash;
+        model = load_model_cache(cname, &head, &stored, size);
+        if(model != NULL)
+        {
+            log_info("Read model from cache file %s", cname);
+            /* The sidecar has the model in either order. Only a sidecar in
+             * the order of the file is rewritten when asked to sort. */
+            if(order == NULL && stored != NULL)
+            {
+                model = unsort_tess_model((TESSEROID *)model, stored, *size);
+            }
+            else if(order != NULL && stored == NULL)
+            {
+                model = sort_tess_model((TESSEROID *)model, *size, &stored);
+                if(model != NULL)
+                {
+                    head.count = *size;
+                    save_model_cache(cname, &head, model, stored);
+                }
+            }
+            if(order != NULL)
+            {
+                *order = stored;
+            }
+            free(cname);
+            return model;
+        }
+    }
+#endif
+    if(kind == MODEL_CACHE_TESS)
+    {
+        model = read_tess_model(modelfile, size);
+    }
+    else
+    {
+        if(kind == MODEL_CACHE_SPHERE)
+        {
+            model = read_sphere_model(modelfile, &nread);
+        }
+        else
+        {
+            model = read_prism_model(modelfile,
+                                     kind == MODEL_CACHE_PRISM_SPH, &nread);
+        }
+        *size = nread;
+    }
+    if(order != NULL && model != NULL && *size > 0)
+    {
+        model = sort_tess_model((TESSEROID *)model, *size, &stored);
+        *order = stored;
+    }
+#ifdef MODEL_CACHE_POSIX
+    if(cname != NULL)
+    {
+        if(model != NULL && *size > 0)
+        {
+            head.count = *size;
+            save_model_cache(cname, &head, model, stored);
+        }
+        free(cname);
+    }
+#endif
+    return model;
+}
+
+
+/* Read tesseroids from a model file using a binary sidecar if possible. */
+TESSEROID * read_tess_model_cached(FILE *modelfile, const char *fname,
+                                   long **order, long *size)
+{
+    return (TESSEROID *)read_model_cached(modelfile, fname, MODEL_CACHE_TESS,
+                                          order, size);
+}
+
+
+/* Read rectangular prisms from a model file using a binary sidecar if
+possible. */
+PRISM * read_prism_model_cached(FILE *modelfile, const char *fname, int pos,
+                                int *size)
+{
+    PRISM *model;
+    long nread;
+
+    /* Only models of up to INT_MAX prisms are parsed or cached */
+    model = (PRISM *)read_model_cached(modelfile, fname,
+        pos ? MODEL_CACHE_PRISM_SPH : MODEL_CACHE_PRISM, NULL, &nread);
+    *size = (int)nread;
+    return model;
+}
+
+
+/* Read spheres from a model file using a binary sidecar if possible. */
+SPHERE * read_sphere_model_cached(FILE *modelfile, const char *fname,
+                                  int *size)
+{
+    SPHERE *model;
+    long nread;
+
+    /* Only models of up to INT_MAX spheres are parsed or cached */
+    model = (SPHERE *)read_model_cached(modelfile, fname, MODEL_CACHE_SPHERE,
+                                        NULL, &nread);
+    *size = (int)nread;
+    return model;
+}
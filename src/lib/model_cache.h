@@ -0,0 +1,122 @@
+/*
+Binary cache files (sidecars) of parsed model files.
+
+Parsing a large text model file takes much longer than reading the same model
+in binary. The first time a large model file is read, the parsed model is
+saved next to it in a binary sidecar file with the same name plus the
+extension .cache. Later reads of the model file load the sidecar instead of
+parsing the text.
+
+The sidecar stores the size and the modification time (with nanoseconds) of
+the model file and a hash of all of its contents. If any of them changes, the
+sidecar is considered stale and is rebuilt. Hashing the model file reads all
+of it, but that is much faster than parsing it. The contents of the sidecar
+have a checksum, so that corrupted sidecars are also rebuilt.
+
+Tesseroid models can be reordered along a Hilbert curve when read (see
+hilbert_sort_tess()). The sidecar then stores the reordered model and the
+position of each tesseroid in the model file, so both orders can be loaded
+from it without parsing the file again.
+
+File format (native byte order and sizes of int, long and double):
+
+    - 8 bytes with the string TESSMDC2
+    - int: the type of model (see MODEL_CACHE_TESS and others)
+    - int: size of each element of the model in bytes
+    - long: number of elements
+    - int: 1 if the elements are reordered along a Hilbert curve, 0 if they
+      are in the order of the model file
+    - double: 1.5 (to check the byte order)
+    - double: size of the model file in bytes
+    - double: modification time of the model file (seconds)
+    - double: nanoseconds of the modification time of the model file
+    - double: hash of the contents of the model file
+    - double: checksum of the elements
+    - the elements of the model (TESSEROID, PRISM or SPHERE structures)
+    - if the elements are reordered, the position of each one in the model
+      file (long)
+
+Only used on systems with POSIX file functions. Small model files (under
+MODEL_CACHE_MINSIZE bytes) are parsed every time.
+*/
+
+#ifndef _TESSEROIDS_MODEL_CACHE_H_
+#define _TESSEROIDS_MODEL_CACHE_H_
+
+
+#include <stdio.h>
+/* Needed for definition of TESSEROID, PRISM and SPHERE */
+#include "geometry.h"
+
+
+/** Model files smaller than this (in bytes) don't get a sidecar */
+#define MODEL_CACHE_MINSIZE 1048576
+
+/** Type of model in a sidecar: tesseroids */
+#define MODEL_CACHE_TESS 1
+/** Type of model in a sidecar: rectangular prisms */
+#define MODEL_CACHE_PRISM 2
+/** Type of model in a sidecar: prisms with the position of their tops */
+#define MODEL_CACHE_PRISM_SPH 3
+/** Type of model in a sidecar: spheres */
+#define MODEL_CACHE_SPHERE 4
+
+
+/** Read tesseroids from a model file using a binary sidecar if possible.
+
+Loads the sidecar of fname if it is valid. Otherwise, parses the file with
+read_tess_model() and writes a new sidecar (if the file is large enough and
+the sidecar can be created).
+
+If order is not NULL, the model is reordered along a Hilbert curve with
+hilbert_sort_tess() and *order gets the position in the model file of each
+tesseroid of the reordered model. Use it to report anything about single
+tesseroids in terms of the model file.
+
+Allocates memory. Don't forget to free 'model' and '*order'!
+
+@param modelfile FILE opened for reading fname. Not read from if the sidecar
+                 is used.
+@param fname name of the model file
+@param order NULL to keep the order of the model file. Otherwise, used to
+             return the positions of the reordered tesseroids in the file.
+@param size used to return the size of the model read
+
+@return pointer to array with the model. NULL if there was an error
+*/
+extern TESSEROID * read_tess_model_cached(FILE *modelfile, const char *fname,
+                                          long **order, long *size);
+
+
+/** Read rectangular prisms from a model file using a binary sidecar if
+possible.
+
+Same as read_tess_model_cached() but uses read_prism_model().
+
+@param modelfile FILE opened for reading fname
+@param fname name of the model file
+@param pos if not 0 (true) will read the spherical coordinates of the top as
+well
+@param size used to return the size of the model read
+
+@return pointer to array with the model. NULL if there was an error
+*/
+extern PRISM * read_prism_model_cached(FILE *modelfile, const char *fname,
+                                       int pos, int *size);
+
+
+/** Read spheres from a model file using a binary sidecar if possible.
+
+Same as read_tess_model_cached() but uses read_sphere_model().
+
+@param modelfile FILE opened for reading fname
+@param fname name of the model file
+@param size used to return the size of the model read
+
+@return pointer to array with the model. NULL if there was an error
+*/
+extern SPHERE * read_sphere_model_cached(FILE *modelfile, const char *fname,
+                                         int *size);
+
+
+#endif
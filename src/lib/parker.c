@@ -0,0 +1,407 @@
+/*
+Forward modeling of layered prism grids in the Fourier domain with the
+expansion of Parker (1973).
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include "logger.h"
+#include "constants.h"
+#include "geometry.h"
+#include "parker.h"
+
+
+/* Arrange a prism model as a regular grid of columns. */
+PRISM_GRID * prism_grid_from_model(PRISM *model, int size)
+{
+    PRISM_GRID *grid;
+    double x2, y2, tol;
+    int *count, ncells, i, j, k, l, p;
+
+    if(size <= 0)
+    {
+        log_error("the prism model is empty");
+        return NULL;
+    }
+    grid = (PRISM_GRID *)malloc(sizeof(PRISM_GRID));
+    if(grid == NULL)
+    {
+        log_error("problem allocating memory for the prism grid");
+        return NULL;
+    }
+    grid->dx = model[0].x2 - model[0].x1;
+    grid->dy = model[0].y2 - model[0].y1;
+    grid->x1 = model[0].x1;
+    grid->y1 = model[0].y1;
+    x2 = model[0].x2;
+    y2 = model[0].y2;
+    for(p = 1; p < size; p++)
+    {
+        grid->x1 = model[p].x1 < grid->x1 ? model[p].x1 : grid->x1;
+        grid->y1 = model[p].y1 < grid->y1 ? model[p].y1 : grid->y1;
+        x2 = model[p].x2 > x2 ? model[p].x2 : x2;
+        y2 = model[p].y2 > y2 ? model[p].y2 : y2;
+    }
+    if(grid->dx <= 0 || grid->dy <= 0)
+    {
+        log_error("the prisms must have positive dimensions");
+        free(grid);
+        return NULL;
+    }
+    grid->nx = (int)floor((x2 - grid->x1)/grid->dx + 0.5);
+    grid->ny = (int)floor((y2 - grid->y1)/grid->dy + 0.5);
+    ncells = grid->nx*grid->ny;
+    grid->nlayers = size/ncells;
+    if(grid->nlayers*ncells != size)
+    {
+        log_error("the %d prisms don't fill a %d x %d grid", size, grid->nx,
+                  grid->ny);
+        free(grid);
+        return NULL;
+    }
+    count = (int *)malloc(ncells*sizeof(int));
+    grid->top = (double *)malloc(3*(size_t)size*sizeof(double));
+    if(count == NULL || grid->top == NULL)
+    {
+        log_error("problem allocating memory for the prism grid");
+        free(count);
+        free(grid->top);
+        free(grid);
+        return NULL;
+    }
+    grid->bottom = grid->top + size;
+    grid->density = grid->top + 2*size;
+    for(k = 0; k < ncells; k++)
+    {
+        count[k] = 0;
+    }
+    tol = 1e-6*(grid->dx < grid->dy ? grid->dx : grid->dy);
+    for(p = 0; p < size; p++)
+    {
+        i = (int)floor((model[p].x1 - grid->x1)/grid->dx + 0.5);
+        j = (int)floor((model[p].y1 - grid->y1)/grid->dy + 0.5);
+        if(fabs(model[p].x2 - model[p].x1 - grid->dx) > tol ||
+           fabs(model[p].y2 - model[p].y1 - grid->dy) > tol ||
+           fabs(grid->x1 + i*grid->dx - model[p].x1) > tol ||
+           fabs(grid->y1 + j*grid->dy - model[p].y1) > tol ||
+           i < 0 || i >= grid->nx || j < 0 || j >= grid->ny)
+        {
+            log_error("prism %d is not on the %g x %g grid", p + 1,
+                      grid->dx, grid->dy);
+            free(count);
+            free_prism_grid(grid);
+            return NULL;
+        }
+        k = i*grid->ny + j;
+        if(count[k] == grid->nlayers)
+        {
+            log_error("cell %d, %d of the grid has more than %d prisms", i,
+                      j, grid->nlayers);
+            free(count);
+            free_prism_grid(grid);
+            return NULL;
+        }
+        /* Insert sorted by the top of the prisms */
+        for(l = count[k]; l > 0 && grid->top[(l - 1)*ncells + k] >
+                                   model[p].z1; l--)
+        {
+            grid->top[l*ncells + k] = grid->top[(l - 1)*ncells + k];
+            grid->bottom[l*ncells + k] = grid->bottom[(l - 1)*ncells + k];
+            grid->density[l*ncells + k] = grid->density[(l - 1)*ncells + k];
+        }
+        grid->top[l*ncells + k] = model[p].z1;
+        grid->bottom[l*ncells + k] = model[p].z2;
+        grid->density[l*ncells + k] = model[p].density;
+        count[k]++;
+    }
+    free(count);
+    return grid;
+}
+
+
+/* Free a grid allocated with prism_grid_from_model(). */
+void free_prism_grid(PRISM_GRID *grid)
+{
+    free(grid->top);
+    free(grid);
+}
+
+
+/* In place radix 2 FFT of n (a power of 2) complex values. The inverse
+transform is divided by n. */
+static void fft(double *re, double *im, int n, int inverse)
+{
+    double wr, wi, tr, ti, angle;
+    int i, j, k, len, half;
+
+    /* Bit reversal permutation */
+    for(i = 1, j = 0; i < n; i++)
+    {
+        for(k = n >> 1; j & k; k >>= 1)
+        {
+            j ^= k;
+        }
+        j |= k;
+        if(i < j)
+        {
+            tr = re[i]; re[i] = re[j]; re[j] = tr;
+            ti = im[i]; im[i] = im[j]; im[j] = ti;
+        }
+    }
+    for(len = 2; len <= n; len <<= 1)
+    {
+        half = len >> 1;
+        for(k = 0; k < half; k++)
+        {
+            angle = (inverse ? 2 : -2)*PI*k/len;
+            wr = cos(angle);
+            wi = sin(angle);
+            for(i = k; i < n; i += len)
+            {
+                j = i + half;
+                tr = wr*re[j] - wi*im[j];
+                ti = wr*im[j] + wi*re[j];
+                re[j] = re[i] - tr;
+                im[j] = im[i] - ti;
+                re[i] += tr;
+                im[i] += ti;
+            }
+        }
+    }
+    if(inverse)
+    {
+        for(i = 0; i < n; i++)
+        {
+            re[i] /= n;
+            im[i] /= n;
+        }
+    }
+}
+
+
+/* 2D FFT of an nx x ny grid (row major) using a buffer of 2*nx values for
+the columns */
+static void fft2d(double *re, double *im, int nx, int ny, int inverse,
+                  double *buff)
+{
+    int i, j;
+
+    for(i = 0; i < nx; i++)
+    {
+        fft(re + i*ny, im + i*ny, ny, inverse);
+    }
+    for(j = 0; j < ny; j++)
+    {
+        for(i = 0; i < nx; i++)
+        {
+            buff[i] = re[i*ny + j];
+            buff[nx + i] = im[i*ny + j];
+        }
+        fft(buff, buff + nx, nx, inverse);
+        for(i = 0; i < nx; i++)
+        {
+            re[i*ny + j] = buff[i];
+            im[i*ny + j] = buff[nx + i];
+        }
+    }
+}
+
+
+/* Copy the values of an interface into the padded grid and transform it.
+values[k] is multiplied by pw[k] if pw isn't NULL. */
+static void transform_cells(PRISM_GRID *grid, const double *values,
+                            const double *pw, int nx, int ny, double *re,
+                            double *im, double *buff)
+{
+    int i, j, k;
+
+    for(k = 0; k < nx*ny; k++)
+    {
+        re[k] = 0;
+        im[k] = 0;
+    }
+    for(i = 0; i < grid->nx; i++)
+    {
+        for(j = 0; j < grid->ny; j++)
+        {
+            k = i*grid->ny + j;
+            re[i*ny + j] = pw == NULL ? values[k] : values[k]*pw[k];
+        }
+    }
+    fft2d(re, im, nx, ny, 0, buff);
+}
+
+
+/* Calculate gz and gzz of a prism grid with the Parker expansion. */
+int parker_gz_gzz(PRISM_GRID *grid, double height, int nterms, int padding,
+                  double *gz, double *gzz)
+{
+    double *data, *sre, *sim, *re, *im, *kk, *buff, *pw, *surface, kx, ky,
+           z0t, z0b, z0, sign, factor, fact, sincx, sincy;
+    int ncells = grid->nx*grid->ny, nx, ny, npad, l, s, n, i, j, k, flat;
+
+    if(nterms < 1)
+    {
+        log_error("the Parker expansion needs at least 1 term");
+        return 1;
+    }
+    if(padding < 1)
+    {
+        log_error("invalid padding factor %d", padding);
+        return 1;
+    }
+    for(k = 0; k < grid->nlayers*ncells; k++)
+    {
+        if(grid->top[k] < -height)
+        {
+            log_error("the computation points at height %g must be above "
+                      "all the prisms", height);
+            return 1;
+        }
+    }
+    /* Pad to at least 'padding' times the size of the grid */
+    for(nx = 2; nx < padding*grid->nx; nx *= 2);
+    for(ny = 2; ny < padding*grid->ny; ny *= 2);
+    npad = nx*ny;
+    data = (double *)malloc((5*(size_t)npad + 2*(nx > ny ? nx : ny) +
+                             ncells)*sizeof(double));
+    if(data == NULL)
+    {
+        log_error("problem allocating memory for the Parker expansion");
+        return 1;
+    }
+    sre = data;
+    sim = data + npad;
+    re = data + 2*npad;
+    im = data + 3*npad;
+    kk = data + 4*npad;
+    buff = data + 5*npad;
+    pw = buff + 2*(nx > ny ? nx : ny);
+    for(i = 0; i < nx; i++)
+    {
+        kx = 2*PI*(i < nx/2 ? i : i - nx)/(nx*grid->dx);
+        for(j = 0; j < ny; j++)
+        {
+            ky = 2*PI*(j < ny/2 ? j : j - ny)/(ny*grid->dy);
+            kk[i*ny + j] = sqrt(kx*kx + ky*ky);
+            sre[i*ny + j] = 0;
+            sim[i*ny + j] = 0;
+        }
+    }
+    for(l = 0; l < grid->nlayers; l++)
+    {
+        /* Mean depths of the interfaces below the computation points */
+        z0t = 0;
+        z0b = 0;
+        for(k = 0; k < ncells; k++)
+        {
+            z0t += grid->top[l*ncells + k] + height;
+            z0b += grid->bottom[l*ncells + k] + height;
+        }
+        z0t /= ncells;
+        z0b /= ncells;
+        /* The first term of both interfaces together, to avoid dividing by
+         * |k| = 0 */
+        transform_cells(grid, grid->density + l*ncells, NULL, nx, ny, re, im,
+                        buff);
+        for(k = 0; k < npad; k++)
+        {
+            if(kk[k] == 0)
+            {
+                factor = z0b - z0t;
+            }
+            else
+            {
+                factor = (exp(-kk[k]*z0t) - exp(-kk[k]*z0b))/kk[k];
+            }
+            sre[k] += factor*re[k];
+            sim[k] += factor*im[k];
+        }
+        /* The other terms of the tops (sign 1) and bottoms (sign -1) */
+        for(s = 0; s < 2; s++)
+        {
+            surface = (s == 0 ? grid->top : grid->bottom) + l*ncells;
+            z0 = s == 0 ? z0t : z0b;
+            sign = s == 0 ? 1 : -1;
+            flat = 1;
+            for(k = 0; k < ncells; k++)
+            {
+                pw[k] = 1;
+                if(surface[k] + height != z0)
+                {
+                    flat = 0;
+                }
+            }
+            if(flat)
+            {
+                continue;
+            }
+            for(n = 1, fact = 1; n <= nterms; n++)
+            {
+                fact *= n;
+                for(k = 0; k < ncells; k++)
+                {
+                    pw[k] *= surface[k] + height - z0;
+                }
+                transform_cells(grid, grid->density + l*ncells, pw, nx, ny,
+                                re, im, buff);
+                for(k = 0; k < npad; k++)
+                {
+                    factor = -sign*exp(-kk[k]*z0)*pow(-kk[k], n - 1)/fact;
+                    sre[k] += factor*re[k];
+                    sim[k] += factor*im[k];
+                }
+            }
+        }
+    }
+    /* The transform of the prisms is that of the cells times the transform of
+     * the box of each cell */
+    for(i = 0; i < nx; i++)
+    {
+        kx = PI*(i < nx/2 ? i : i - nx)/nx;
+        sincx = kx == 0 ? 1 : sin(kx)/kx;
+        for(j = 0; j < ny; j++)
+        {
+            ky = PI*(j < ny/2 ? j : j - ny)/ny;
+            sincy = ky == 0 ? 1 : sin(ky)/ky;
+            factor = 2*PI*G*sincx*sincy;
+            sre[i*ny + j] *= factor;
+            sim[i*ny + j] *= factor;
+        }
+    }
+    if(gz != NULL)
+    {
+        for(k = 0; k < npad; k++)
+        {
+            re[k] = sre[k];
+            im[k] = sim[k];
+        }
+        fft2d(re, im, nx, ny, 1, buff);
+        for(i = 0; i < grid->nx; i++)
+        {
+            for(j = 0; j < grid->ny; j++)
+            {
+                gz[i*grid->ny + j] = SI2MGAL*re[i*ny + j];
+            }
+        }
+    }
+    if(gzz != NULL)
+    {
+        for(k = 0; k < npad; k++)
+        {
+            re[k] = kk[k]*sre[k];
+            im[k] = kk[k]*sim[k];
+        }
+        fft2d(re, im, nx, ny, 1, buff);
+        for(i = 0; i < grid->nx; i++)
+        {
+            for(j = 0; j < grid->ny; j++)
+            {
+                gzz[i*grid->ny + j] = SI2EOTVOS*re[i*ny + j];
+            }
+        }
+    }
+    free(data);
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+Forward modeling of layered prism grids in the Fourier domain with the
+expansion of Parker (1973).
+
+The model is a regular grid of columns of prisms in Cartesian coordinates,
+like the prisms generated by tess2prism --flatten from a model generated by
+tesslayers. Each column has the same number of layers. The field is calculated
+on the centers of the cells of the grid at a constant height above all the
+prisms.
+
+Each interface (the tops or the bottoms of a layer) of depth z(x, y) below
+the computation points is expanded around its mean depth z0:
+
+    exp(-|k| z) = exp(-|k| z0) sum_n (-|k|)^n (z - z0)^n / n!
+
+so that the Fourier transform of gz is a sum of the transforms of
+density*(z - z0)^n over the interfaces:
+
+    F[gz] = 2 PI G sum_layers [ (exp(-|k| z0t) - exp(-|k| z0b))/|k| F[density]
+            + sum_{n >= 1} (-|k|)^(n-1)/n! (exp(-|k| z0b) F[density (zb - z0b)^n]
+                                        - exp(-|k| z0t) F[density (zt - z0t)^n])]
+
+and F[gzz] = |k| F[gz]. Since the density and the depths are constant inside
+each cell, the transforms of the cell values are multiplied by the transform of
+the cell (a product of sinc functions). The series is cut after a number of
+terms (flat interfaces only need the first one). The grids are padded with
+zeros (to powers of 2) to reduce the effect of the periodicity of the discrete
+Fourier transform: the field of the copies of the model around the grid. This
+effect shrinks with the cube of the padding factor.
+
+The cost is O(N log N) on the number of cells N instead of O(N^2) for the
+prismg* programs. The results approach the exact prism formulas as the number
+of terms grows, except for the edges of the grid.
+
+The coordinate system used is that of the prisms, ie:
+
+x -> North  y -> East  z -> Down
+
+References
+----------
+
+* Parker, R. L. (1973): The rapid calculation of potential anomalies.
+  Geophysical Journal of the Royal Astronomical Society, 31, 447-455.
+*/
+
+
+#ifndef _TESSEROIDS_PARKER_H_
+#define _TESSEROIDS_PARKER_H_
+
+
+/* Needed for definition of PRISM */
+#include "geometry.h"
+
+
+/** A regular grid of columns of prisms (see prism_grid_from_model()) */
+typedef struct prism_grid_struct {
+    int nx; /**< number of cells in the x direction */
+    int ny; /**< number of cells in the y direction */
+    int nlayers; /**< number of prisms in each column */
+    double x1; /**< southern border of the grid */
+    double y1; /**< western border of the grid */
+    double dx; /**< size of the cells in the x direction */
+    double dy; /**< size of the cells in the y direction */
+    double *top; /**< tops of the prisms. The prism of layer l (from the top)
+                      in cell i (along x), j (along y) is at index
+                      (l*nx + i)*ny + j */
+    double *bottom; /**< bottoms of the prisms (same order as top) */
+    double *density; /**< densities of the prisms (same order as top) */
+} PRISM_GRID;
+
+
+/** Arrange a prism model as a regular grid of columns.
+
+All the prisms must have the same horizontal dimensions and be on the same
+grid, and all the cells of the grid must have the same number of prisms. The
+prisms of each cell are sorted by their tops.
+
+<b>WARNING</b>: Don't forget to free the grid using free_prism_grid()!
+
+@param model the prisms
+@param size number of prisms
+
+@return pointer to the new grid. NULL if the model is not a regular grid (logs
+        the reason) or there wasn't enough memory.
+*/
+extern PRISM_GRID * prism_grid_from_model(PRISM *model, int size);
+
+
+/** Free a grid allocated with prism_grid_from_model().
+
+@param grid the grid
+*/
+extern void free_prism_grid(PRISM_GRID *grid);
+
+
+/** Calculate gz and gzz of a prism grid with the Parker expansion.
+
+The computation points are the centers of the cells at the same height. The
+x coordinate of point (i, j) is x1 + (i + 0.5)*dx, the y coordinate is
+y1 + (j + 0.5)*dy.
+
+@param grid the prisms
+@param height height of the computation points (ie, z = -height). Must be
+              above the tops of all prisms.
+@param nterms number of terms of the expansion of each interface (>= 1)
+@param padding the grids are padded with zeros to at least this many times
+               their size (>= 1). 2 is usual, 4 is more accurate for thick
+               models but takes 4 times more memory.
+@param gz nx*ny array to return gz in mGal at point (i, j) in index i*ny + j.
+          Can be NULL.
+@param gzz nx*ny array to return gzz in Eotvos (same order as gz). Can be
+           NULL.
+
+@return 0 if all went well. 1 if the points are not above all the prisms,
+        the arguments are invalid or there wasn't enough memory (logs the
+        error).
+*/
+extern int parker_gz_gzz(PRISM_GRID *grid, double height, int nterms,
+                         int padding, double *gz, double *gzz);
+
+#endif
@@ -3,10 +3,24 @@ Input and output parsing tools.
 */
 
 
+/* Needed for mmap, fileno and pthreads */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <limits.h>
 #include <time.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #define PARSERS_MMAP
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <pthread.h>
+#endif
 #include "logger.h"
 #include "version.h"
 #include "parsers.h"
@@ -18,12 +32,20 @@ Input and output parsing tools.
 int parse_basic_args(int argc, char **argv, const char *progname,
                      BASIC_ARGS *args, void (*print_help)(void))
 {
-    int bad_args = 0, parsed_args = 0, total_args = 1, i;
+    int bad_args = 0, parsed_args = 0, total_args = 1, parsed_precision = 0,
+        parsed_threads = 0, parsed_cutoff = 0, i, nchar, nread;
     char *params;
 
     /* Default values for options */
     args->verbose = 0;
     args->logtofile = 0;
+    args->binary = 0;
+    args->precision = 15;
+    args->grid.parsed = 0;
+    args->nthreads = 0; /* zero means one thread per processor */
+    args->components = NULL;
+    args->cutoff = 0; /* zero means use the whole model */
+    args->farfield = 0;
     /* Parse arguments */
     for(i = 1; i < argc; i++)
     {
@@ -79,18 +101,114 @@ int parse_basic_args(int argc, char **argv, const char *progname,
                 case '-':
                 {
                     params = &argv[i][2];
-                    if(strcmp(params, "version"))
+                    if(strcmp(params, "version") == 0)
+                    {
+                        print_version(progname);
+                        return 2;
+                    }
+                    else if(strcmp(params, "binary") == 0 && !args->binary)
+                    {
+                        args->binary = 1;
+                    }
+                    else if(strcmp(params, "far-field") == 0 &&
+                            !args->farfield)
+                    {
+                        args->farfield = 1;
+                    }
+                    else
                     {
                         log_error("invalid argument '%s'", argv[i]);
                         bad_args++;
                     }
+                    break;
+                }
+                case 'p':
+                {
+                    if(parsed_precision)
+                    {
+                        log_error("repeated option -p");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->precision), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->precision < 1 || args->precision > 17)
+                    {
+                        log_error("bad input argument '%s'. Must be 1 to 17 "
+                                  "digits", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_precision = 1;
+                    break;
+                }
+                case 'j':
+                {
+                    if(parsed_threads)
+                    {
+                        log_error("repeated option -j");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->nthreads), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->nthreads < 1)
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_threads = 1;
+                    break;
+                }
+                case 'c':
+                {
+                    if(parsed_cutoff)
+                    {
+                        log_error("repeated option -c");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf%n", &(args->cutoff), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->cutoff <= 0)
+                    {
+                        log_error("bad input argument '%s'. Must be a "
+                                  "positive distance", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_cutoff = 1;
+                    break;
+                }
+                case 's':
+                {
+                    if(args->components != NULL)
+                    {
+                        log_error("repeated option -s");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    if(strlen(params) == 0)
+                    {
+                        log_error("bad input argument -s. Missing components.");
+                        bad_args++;
+                    }
                     else
                     {
-                        print_version(progname);
-                        return 2;
+                        args->components = params;
                     }
                     break;
                 }
+                case 'r':
+                case 'b':
+                case 'z':
+                    bad_args += parse_points_grid_arg(argv[i], &args->grid);
+                    break;
                 default:
                     log_error("invalid argument '%s'", argv[i]);
                     bad_args++;
@@ -112,6 +230,12 @@ int parse_basic_args(int argc, char **argv, const char *progname,
             }
         }
     }
+    bad_args += check_points_grid_args(&args->grid);
+    if(args->farfield && !parsed_cutoff)
+    {
+        log_error("option --far-field needs a cutoff distance (option -c)");
+        bad_args++;
+    }
     /* Check if parsing went well */
     if(parsed_args > total_args)
     {
@@ -254,18 +378,20 @@ int parse_tess2prism_args(int argc, char **argv, const char *progname,
 }
 
 
-/* Parse command line arguments for tessmass program */
-int parse_tessmass_args(int argc, char **argv, const char *progname,
-                        TESSMASS_ARGS *args, void (*print_help)(void))
+/* Parse command line arguments for prismfft program */
+int parse_prismfft_args(int argc, char **argv, const char *progname,
+                        PRISMFFT_ARGS *args, void (*print_help)(void))
 {
-    int bad_args = 0, parsed_args = 0, total_args = 1, parsed_r = 0, i, nchar,
-        nread;
+    int bad_args = 0, parsed_args = 0, total_args = 1, parsed_z = 0,
+        parsed_t = 0, parsed_e = 0, parsed_precision = 0, i, nchar, nread;
     char *params;
 
     /* Default values for options */
     args->verbose = 0;
     args->logtofile = 0;
-    args->use_range = 0;
+    args->nterms = 4;
+    args->padding = 2;
+    args->precision = 15;
     /* Parse arguments */
     for(i = 1; i < argc; i++)
     {
@@ -297,7 +423,6 @@ int parse_tessmass_args(int argc, char **argv, const char *progname,
                     }
                     args->verbose = 1;
                     break;
-
                 case 'l':
                 {
                     if(args->logtofile)
@@ -322,37 +447,98 @@ int parse_tessmass_args(int argc, char **argv, const char *progname,
                 case '-':
                 {
                     params = &argv[i][2];
-                    if(strcmp(params, "version"))
+                    if(strcmp(params, "version") == 0)
                     {
-                        log_error("invalid argument '%s'", argv[i]);
-                        bad_args++;
+                        print_version(progname);
+                        return 2;
                     }
                     else
                     {
-                        print_version(progname);
-                        return 2;
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
                     }
                     break;
                 }
-                case 'r':
+                case 'z':
                 {
-                    if(parsed_r)
+                    if(parsed_z)
                     {
-                        log_error("repeated argument -r");
+                        log_error("repeated argument -z");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
                     nchar = 0;
-                    nread = sscanf(params, "%lf/%lf%n", &(args->low_dens),
-                                   &(args->high_dens), &nchar);
-                    if(nread != 2 || *(params + nchar) != '\0')
+                    nread = sscanf(params, "%lf%n", &(args->height), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0')
                     {
                         log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
                     }
-                    parsed_r = 1;
-                    args->use_range = 1;
+                    parsed_z = 1;
+                    break;
+                }
+                case 't':
+                {
+                    if(parsed_t)
+                    {
+                        log_error("repeated argument -t");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->nterms), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->nterms < 1)
+                    {
+                        log_error("bad input argument '%s'. Must be at least "
+                                  "1 term", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_t = 1;
+                    break;
+                }
+                case 'e':
+                {
+                    if(parsed_e)
+                    {
+                        log_error("repeated argument -e");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->padding), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->padding < 1)
+                    {
+                        log_error("bad input argument '%s'. Must be at least "
+                                  "1", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_e = 1;
+                    break;
+                }
+                case 'p':
+                {
+                    if(parsed_precision)
+                    {
+                        log_error("repeated option -p");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->precision), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->precision < 1 || args->precision > 17)
+                    {
+                        log_error("bad input argument '%s'. Must be 1 to 17 "
+                                  "digits", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_precision = 1;
                     break;
                 }
                 default:
@@ -377,10 +563,10 @@ int parse_tessmass_args(int argc, char **argv, const char *progname,
         }
     }
     /* Check if parsing went well */
-    if(parsed_args > total_args)
+    if(!parsed_z)
     {
-        log_error("%s: too many input arguments. given %d, max %d.",
-                    progname, parsed_args, total_args);
+        log_error("missing height of the computation points (-z)");
+        bad_args++;
     }
     if(bad_args > 0)
     {
@@ -395,18 +581,19 @@ int parse_tessmass_args(int argc, char **argv, const char *progname,
 }
 
 
-/* Parse command line arguments for tessmodgen program */
-int parse_tessmodgen_args(int argc, char **argv, const char *progname,
-                          TESSMODGEN_ARGS *args, void (*print_help)(void))
+/* Parse command line arguments for tess2tiles program */
+int parse_tess2tiles_args(int argc, char **argv, const char *progname,
+                          TESS2TILES_ARGS *args, void (*print_help)(void))
 {
-    int bad_args = 0, parsed_args = 0, total_args = 2, parsed_s = 0,
-        parsed_z = 0, parsed_d = 0, i, nchar, nread;
+    int bad_args = 0, parsed_args = 0, total_args = 2, parsed_s = 0, i, nchar,
+        nread;
     char *params;
 
     /* Default values for options */
     args->verbose = 0;
     args->logtofile = 0;
-    args->fix_density = 0;
+    args->tilesize = 10;
+    args->sort_model = 0;
     /* Parse arguments */
     for(i = 1; i < argc; i++)
     {
@@ -462,77 +649,40 @@ int parse_tessmodgen_args(int argc, char **argv, const char *progname,
                 case '-':
                 {
                     params = &argv[i][2];
-                    if(strcmp(params, "version"))
-                    {
-                        log_error("invalid argument '%s'", argv[i]);
-                        bad_args++;
-                    }
-                    else
+                    if(strcmp(params, "version") == 0)
                     {
                         print_version(progname);
                         return 2;
                     }
-                    break;
-                }
-                case 's':
-                {
-                    if(parsed_s)
-                    {
-                        log_error("repeated argument -s");
-                        bad_args++;
-                        break;
-                    }
-                    params = &argv[i][2];
-                    nchar = 0;
-                    nread = sscanf(params, "%lf/%lf%n", &(args->dlon),
-                                   &(args->dlat), &nchar);
-                    if(nread != 2 || *(params + nchar) != '\0')
-                    {
-                        log_error("bad input argument '%s'", argv[i]);
-                        bad_args++;
-                    }
-                    parsed_s = 1;
-                    parsed_args++;
-                    break;
-                }
-                case 'z':
-                {
-                    if(parsed_z)
+                    else if(strcmp(params, "sort") == 0 && !args->sort_model)
                     {
-                        log_error("repeated argument -z");
-                        bad_args++;
-                        break;
+                        args->sort_model = 1;
                     }
-                    params = &argv[i][2];
-                    nchar = 0;
-                    nread = sscanf(params, "%lf%n", &(args->ref), &nchar);
-                    if(nread != 1 || *(params + nchar) != '\0')
+                    else
                     {
-                        log_error("bad input argument '%s'", argv[i]);
+                        log_error("invalid argument '%s'", argv[i]);
                         bad_args++;
                     }
-                    parsed_z = 1;
-                    parsed_args++;
                     break;
                 }
-                case 'd':
+                case 's':
                 {
-                    if(parsed_d)
+                    if(parsed_s)
                     {
-                        log_error("repeated argument -d");
+                        log_error("repeated argument -s");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
                     nchar = 0;
-                    nread = sscanf(params, "%lf%n", &(args->dens), &nchar);
-                    if(nread != 1 || *(params + nchar) != '\0')
+                    nread = sscanf(params, "%lf%n", &(args->tilesize), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->tilesize <= 0)
                     {
                         log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
                     }
-                    parsed_d = 1;
-                    args->fix_density = 1;
+                    parsed_s = 1;
                     break;
                 }
                 default:
@@ -543,8 +693,15 @@ int parse_tessmodgen_args(int argc, char **argv, const char *progname,
         }
         else
         {
-            log_error("invalid argument '%s'", argv[i]);
-            bad_args++;
+            if(parsed_args == 0)
+            {
+                args->inputfname = argv[i];
+            }
+            else if(parsed_args == 1)
+            {
+                args->outputfname = argv[i];
+            }
+            parsed_args++;
         }
     }
     /* Check if parsing went well */
@@ -552,8 +709,7 @@ int parse_tessmodgen_args(int argc, char **argv, const char *progname,
     {
         if(parsed_args < total_args)
         {
-            log_error("%s: missing input arguments. given %d out of %d.",
-                      progname, parsed_args, total_args);
+            log_error("%s: missing input and/or output file.", progname);
         }
         if(parsed_args > total_args)
         {
@@ -570,17 +726,18 @@ int parse_tessmodgen_args(int argc, char **argv, const char *progname,
 }
 
 
-/* Parse command line arguments for tesslayers program */
-int parse_tesslayers_args(int argc, char **argv, const char *progname,
-                          TESSLAYERS_ARGS *args, void (*print_help)(void))
+/* Parse command line arguments for tessmass program */
+int parse_tessmass_args(int argc, char **argv, const char *progname,
+                        TESSMASS_ARGS *args, void (*print_help)(void))
 {
-    int bad_args = 0, parsed_args = 0, total_args = 1, parsed_s = 0,
-        i, nchar, nread;
+    int bad_args = 0, parsed_args = 0, total_args = 1, parsed_r = 0, i, nchar,
+        nread;
     char *params;
 
     /* Default values for options */
     args->verbose = 0;
     args->logtofile = 0;
+    args->use_range = 0;
     /* Parse arguments */
     for(i = 1; i < argc; i++)
     {
@@ -612,6 +769,7 @@ int parse_tesslayers_args(int argc, char **argv, const char *progname,
                     }
                     args->verbose = 1;
                     break;
+
                 case 'l':
                 {
                     if(args->logtofile)
@@ -648,25 +806,25 @@ int parse_tesslayers_args(int argc, char **argv, const char *progname,
                     }
                     break;
                 }
-                case 's':
+                case 'r':
                 {
-                    if(parsed_s)
+                    if(parsed_r)
                     {
-                        log_error("repeated argument -s");
+                        log_error("repeated argument -r");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
                     nchar = 0;
-                    nread = sscanf(params, "%lf/%lf%n", &(args->dlon),
-                                   &(args->dlat), &nchar);
+                    nread = sscanf(params, "%lf/%lf%n", &(args->low_dens),
+                                   &(args->high_dens), &nchar);
                     if(nread != 2 || *(params + nchar) != '\0')
                     {
                         log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
                     }
-                    parsed_s = 1;
-                    parsed_args++;
+                    parsed_r = 1;
+                    args->use_range = 1;
                     break;
                 }
                 default:
@@ -677,49 +835,50 @@ int parse_tesslayers_args(int argc, char **argv, const char *progname,
         }
         else
         {
-            log_error("invalid argument '%s'", argv[i]);
-            bad_args++;
+            if(parsed_args == 0)
+            {
+                args->inputfname = argv[i];
+                parsed_args++;
+            }
+            else
+            {
+                log_error("invalid argument '%s'. Already given model file %s",
+                          argv[i], args->inputfname);
+                bad_args++;
+            }
         }
     }
     /* Check if parsing went well */
-    if(bad_args > 0 || parsed_args != total_args)
+    if(parsed_args > total_args)
     {
-        if(parsed_args < total_args)
-        {
-            log_error("%s: missing input arguments. given %d out of %d.",
-                      progname, parsed_args, total_args);
-        }
-        if(parsed_args > total_args)
-        {
-            log_error("%s: too many input arguments. given %d, max %d.",
-                      progname, parsed_args, total_args);
-        }
-        if(bad_args > 0)
-        {
-            log_error("%d bad input argument(s)", bad_args);
-        }
+        log_error("%s: too many input arguments. given %d, max %d.",
+                    progname, parsed_args, total_args);
+    }
+    if(bad_args > 0)
+    {
+        log_error("%d bad input argument(s)", bad_args);
         return 1;
     }
+    if(parsed_args < total_args)
+    {
+        return 3;
+    }
     return 0;
 }
 
 
-/* Parse command line arguments for tessg* programs */
-int parse_tessg_args(int argc, char **argv, const char *progname,
-                     TESSG_ARGS *args, void (*print_help)(const char *))
+/* Parse command line arguments for tessmodgen program */
+int parse_tessmodgen_args(int argc, char **argv, const char *progname,
+                          TESSMODGEN_ARGS *args, void (*print_help)(void))
 {
-    int bad_args = 0, parsed_args = 0, total_args = 1,  parsed_order = 0,
-        parsed_ratio = 0, i, nchar, nread;
+    int bad_args = 0, parsed_args = 0, total_args = 2, parsed_s = 0,
+        parsed_z = 0, parsed_d = 0, i, nchar, nread;
     char *params;
 
     /* Default values for options */
     args->verbose = 0;
     args->logtofile = 0;
-    args->lon_order = 2;
-    args->lat_order = 2;
-    args->r_order = 2;
-    args->adaptative = 1;
-    args->ratio = 0; /* zero means use the default for the program */
+    args->fix_density = 0;
     /* Parse arguments */
     for(i = 1; i < argc; i++)
     {
@@ -734,7 +893,7 @@ int parse_tessg_args(int argc, char **argv, const char *progname,
                         bad_args++;
                         break;
                     }
-                    print_help(progname);
+                    print_help();
                     return 2;
                 case 'v':
                     if(argv[i][2] != '\0')
@@ -787,58 +946,65 @@ int parse_tessg_args(int argc, char **argv, const char *progname,
                     }
                     break;
                 }
-                case 'a':
-                    if(argv[i][2] != '\0')
+                case 's':
+                {
+                    if(parsed_s)
                     {
-                        log_error("invalid argument '%s'", argv[i]);
+                        log_error("repeated argument -s");
                         bad_args++;
                         break;
                     }
-                    if(!args->adaptative)
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf/%lf%n", &(args->dlon),
+                                   &(args->dlat), &nchar);
+                    if(nread != 2 || *(params + nchar) != '\0')
                     {
-                        log_error("repeated option -a");
+                        log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
-                        break;
                     }
-                    args->adaptative = 0;
+                    parsed_s = 1;
+                    parsed_args++;
                     break;
-                case 'o':
+                }
+                case 'z':
                 {
-                    if(parsed_order)
+                    if(parsed_z)
                     {
-                        log_error("repeated option -o");
+                        log_error("repeated argument -z");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
                     nchar = 0;
-                    nread = sscanf(params, "%d/%d/%d%n", &(args->lon_order),
-                                &(args->lat_order), &(args->r_order), &nchar);
-                    if(nread != 3 || *(params + nchar) != '\0')
+                    nread = sscanf(params, "%lf%n", &(args->ref), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0')
                     {
                         log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
                     }
-                    parsed_order = 1;
+                    parsed_z = 1;
+                    parsed_args++;
                     break;
                 }
-                case 't':
+                case 'd':
                 {
-                    if(parsed_ratio)
+                    if(parsed_d)
                     {
-                        log_error("repeated option -t");
+                        log_error("repeated argument -d");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
                     nchar = 0;
-                    nread = sscanf(params, "%lf%n", &(args->ratio), &nchar);
+                    nread = sscanf(params, "%lf%n", &(args->dens), &nchar);
                     if(nread != 1 || *(params + nchar) != '\0')
                     {
                         log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
                     }
-                    parsed_ratio = 1;
+                    parsed_d = 1;
+                    args->fix_density = 1;
                     break;
                 }
                 default:
@@ -849,17 +1015,8 @@ int parse_tessg_args(int argc, char **argv, const char *progname,
         }
         else
         {
-            if(parsed_args == 0)
-            {
-                args->modelfname = argv[i];
-                parsed_args++;
-            }
-            else
-            {
-                log_error("invalid argument '%s'. Already given model file %s",
-                          argv[i], args->modelfname);
-                bad_args++;
-            }
+            log_error("invalid argument '%s'", argv[i]);
+            bad_args++;
         }
     }
     /* Check if parsing went well */
@@ -867,7 +1024,7 @@ int parse_tessg_args(int argc, char **argv, const char *progname,
     {
         if(parsed_args < total_args)
         {
-            log_error("%s: missing input file.",
+            log_error("%s: missing input arguments. given %d out of %d.",
                       progname, parsed_args, total_args);
         }
         if(parsed_args > total_args)
@@ -885,13 +1042,13 @@ int parse_tessg_args(int argc, char **argv, const char *progname,
 }
 
 
-/* Parse command line arguments for tessgrd program */
-int parse_tessgrd_args(int argc, char **argv, TESSGRD_ARGS *args,
-                       void (*print_help)(void))
+/* Parse command line arguments for tesslayers program */
+int parse_tesslayers_args(int argc, char **argv, const char *progname,
+                          TESSLAYERS_ARGS *args, void (*print_help)(void))
 {
-    int bad_args = 0, parsed_args = 0, total_args = 3, parsed_r = 0,
-        parsed_b = 0, parsed_z = 0, i, nchar, nread;
-    char progname[] = "tessgrd", *params;
+    int bad_args = 0, parsed_args = 0, total_args = 1, parsed_s = 0,
+        i, nchar, nread;
+    char *params;
 
     /* Default values for options */
     args->verbose = 0;
@@ -927,7 +1084,6 @@ int parse_tessgrd_args(int argc, char **argv, TESSGRD_ARGS *args,
                     }
                     args->verbose = 1;
                     break;
-
                 case 'l':
                 {
                     if(args->logtofile)
@@ -964,157 +1120,1432 @@ int parse_tessgrd_args(int argc, char **argv, TESSGRD_ARGS *args,
                     }
                     break;
                 }
-                case 'r':
+                case 's':
                 {
-                    if(parsed_r)
+                    if(parsed_s)
                     {
-                        log_error("repeated argument -r");
+                        log_error("repeated argument -s");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
                     nchar = 0;
-                    nread = sscanf(params, "%lf/%lf/%lf/%lf%n", &(args->w),
-                                   &(args->e), &(args->s), &(args->n), &nchar);
-                    if(nread != 4 || *(params + nchar) != '\0')
+                    nread = sscanf(params, "%lf/%lf%n", &(args->dlon),
+                                   &(args->dlat), &nchar);
+                    if(nread != 2 || *(params + nchar) != '\0')
                     {
                         log_error("bad input argument '%s'", argv[i]);
                         bad_args++;
                     }
+                    parsed_s = 1;
                     parsed_args++;
-                    parsed_r = 1;
                     break;
                 }
-                case 'b':
-                {
-                    if(parsed_b)
+                default:
+                    log_error("invalid argument '%s'", argv[i]);
+                    bad_args++;
+                    break;
+            }
+        }
+        else
+        {
+            log_error("invalid argument '%s'", argv[i]);
+            bad_args++;
+        }
+    }
+    /* Check if parsing went well */
+    if(bad_args > 0 || parsed_args != total_args)
+    {
+        if(parsed_args < total_args)
+        {
+            log_error("%s: missing input arguments. given %d out of %d.",
+                      progname, parsed_args, total_args);
+        }
+        if(parsed_args > total_args)
+        {
+            log_error("%s: too many input arguments. given %d, max %d.",
+                      progname, parsed_args, total_args);
+        }
+        if(bad_args > 0)
+        {
+            log_error("%d bad input argument(s)", bad_args);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Parse command line arguments for tessg* programs */
+int parse_tessg_args(int argc, char **argv, const char *progname,
+                     TESSG_ARGS *args, void (*print_help)(const char *))
+{
+    int bad_args = 0, parsed_args = 0, total_args = 1,  parsed_order = 0,
+        parsed_ratio = 0, parsed_lod = 0, parsed_cutoff = 0,
+        parsed_precision = 0, parsed_threads = 0, i, nchar, nread;
+    char *params;
+
+    /* Default values for options */
+    args->verbose = 0;
+    args->logtofile = 0;
+    args->binary = 0;
+    args->lon_order = 2;
+    args->lat_order = 2;
+    args->r_order = 2;
+    args->adaptative = 1;
+    args->ratio = 0; /* zero means use the default for the program */
+    args->grid_model = 0;
+    args->lod_ratio = 0; /* zero means don't use a multi-resolution pyramid */
+    args->cutoff = 0; /* zero means use the whole model */
+    args->precision = 15;
+    args->nthreads = 0; /* zero means one thread per processor */
+    args->grid.parsed = 0; /* zero means read the points from stdin */
+    args->resultstofile = 0;
+    args->sort_points = 0;
+    args->sort_model = 0;
+    /* Parse arguments */
+    for(i = 1; i < argc; i++)
+    {
+        if(argv[i][0] == '-')
+        {
+            switch(argv[i][1])
+            {
+                case 'h':
+                    if(argv[i][2] != '\0')
                     {
-                        log_error("repeated argument -b");
+                        log_error("invalid argument '%s'", argv[i]);
                         bad_args++;
                         break;
                     }
-                    params = &argv[i][2];
-                    nchar = 0;
-                    nread = sscanf(params, "%d/%d%n", &(args->nlon),
-                                   &(args->nlat), &nchar);
-                    if(nread != 2 || *(params + nchar) != '\0')
+                    print_help(progname);
+                    return 2;
+                case 'v':
+                    if(argv[i][2] != '\0')
                     {
-                        log_error("bad input argument '%s'", argv[i]);
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
+                        break;
+                    }
+                    if(args->verbose)
+                    {
+                        log_error("repeated option -v");
                         bad_args++;
+                        break;
                     }
-                    parsed_args++;
-                    parsed_b = 1;
+                    args->verbose = 1;
                     break;
-                }
-                case 'z':
+                case 'l':
                 {
-                    if(parsed_z)
+                    if(args->logtofile)
                     {
-                        log_error("repeated argument -z");
+                        log_error("repeated option -l");
                         bad_args++;
                         break;
                     }
                     params = &argv[i][2];
-                    nchar = 0;
-                    nread = sscanf(params, "%lf%n", &(args->height), &nchar);
-                    if(nread != 1 || *(params + nchar) != '\0')
+                    if(strlen(params) == 0)
                     {
-                        log_error("bad input argument '%s'", argv[i]);
+                        log_error("bad input argument -l. Missing filename.");
                         bad_args++;
                     }
-                    parsed_args++;
-                    parsed_z = 1;
+                    else
+                    {
+                        args->logtofile = 1;
+                        args->logfname = params;
+                    }
                     break;
                 }
-                default:
-                    log_error("invalid argument '%s'", argv[i]);
-                    bad_args++;
+                case '-':
+                {
+                    params = &argv[i][2];
+                    if(strcmp(params, "version") == 0)
+                    {
+                        print_version(progname);
+                        return 2;
+                    }
+                    else if(strcmp(params, "binary") == 0 && !args->binary)
+                    {
+                        args->binary = 1;
+                    }
+                    else if(strcmp(params, "sort") == 0 && !args->sort_points)
+                    {
+                        args->sort_points = 1;
+                    }
+                    else if(strcmp(params, "sort-model") == 0 &&
+                            !args->sort_model)
+                    {
+                        args->sort_model = 1;
+                    }
+                    else
+                    {
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
+                    }
                     break;
+                }
+                case 'a':
+                    if(argv[i][2] != '\0')
+                    {
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
+                        break;
+                    }
+                    if(!args->adaptative)
+                    {
+                        log_error("repeated option -a");
+                        bad_args++;
+                        break;
+                    }
+                    args->adaptative = 0;
+                    break;
+                case 'o':
+                {
+                    if(parsed_order)
+                    {
+                        log_error("repeated option -o");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d/%d/%d%n", &(args->lon_order),
+                                &(args->lat_order), &(args->r_order), &nchar);
+                    if(nread != 3 || *(params + nchar) != '\0')
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_order = 1;
+                    break;
+                }
+                case 't':
+                {
+                    if(parsed_ratio)
+                    {
+                        log_error("repeated option -t");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf%n", &(args->ratio), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0')
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_ratio = 1;
+                    break;
+                }
+                case 'g':
+                {
+                    if(args->grid_model)
+                    {
+                        log_error("repeated option -g");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf/%lf%n", &(args->grid_dlon),
+                                   &(args->grid_dlat), &nchar);
+                    if(nread != 2 || *(params + nchar) != '\0' ||
+                       args->grid_dlon <= 0 || args->grid_dlat <= 0)
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    args->grid_model = 1;
+                    break;
+                }
+                case 'd':
+                {
+                    if(parsed_lod)
+                    {
+                        log_error("repeated option -d");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf%n", &(args->lod_ratio), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->lod_ratio <= 0)
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_lod = 1;
+                    break;
+                }
+                case 'c':
+                {
+                    if(parsed_cutoff)
+                    {
+                        log_error("repeated option -c");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf%n", &(args->cutoff), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->cutoff <= 0)
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_cutoff = 1;
+                    break;
+                }
+                case 'p':
+                {
+                    if(parsed_precision)
+                    {
+                        log_error("repeated option -p");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->precision), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->precision < 1 || args->precision > 17)
+                    {
+                        log_error("bad input argument '%s'. Must be 1 to 17 "
+                                  "digits", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_precision = 1;
+                    break;
+                }
+                case 'j':
+                {
+                    if(parsed_threads)
+                    {
+                        log_error("repeated option -j");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->nthreads), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->nthreads < 1)
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_threads = 1;
+                    break;
+                }
+                case 'f':
+                {
+                    if(args->resultstofile)
+                    {
+                        log_error("repeated option -f");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    if(strlen(params) == 0)
+                    {
+                        log_error("bad input argument -f. Missing filename.");
+                        bad_args++;
+                    }
+                    else
+                    {
+                        args->resultstofile = 1;
+                        args->resultsfname = params;
+                    }
+                    break;
+                }
+                case 'r':
+                case 'b':
+                case 'z':
+                    bad_args += parse_points_grid_arg(argv[i], &args->grid);
+                    break;
+                default:
+                    log_error("invalid argument '%s'", argv[i]);
+                    bad_args++;
+                    break;
+            }
+        }
+        else
+        {
+            if(parsed_args == 0)
+            {
+                args->modelfname = argv[i];
+                parsed_args++;
+            }
+            else
+            {
+                log_error("invalid argument '%s'. Already given model file %s",
+                          argv[i], args->modelfname);
+                bad_args++;
+            }
+        }
+    }
+    if(parsed_lod && args->grid_model && !args->adaptative)
+    {
+        log_error("option -d can't be used with -g and -a");
+        bad_args++;
+    }
+    if(parsed_cutoff && args->grid_model)
+    {
+        log_error("option -c can't be used with -g");
+        bad_args++;
+    }
+    if(args->sort_model && args->grid_model)
+    {
+        log_error("option --sort-model can't be used with -g");
+        bad_args++;
+    }
+    bad_args += check_points_grid_args(&args->grid);
+    /* Check if parsing went well */
+    if(bad_args > 0 || parsed_args != total_args)
+    {
+        if(parsed_args < total_args)
+        {
+            log_error("%s: missing input file.",
+                      progname, parsed_args, total_args);
+        }
+        if(parsed_args > total_args)
+        {
+            log_error("%s: too many input arguments. given %d, max %d.",
+                      progname, parsed_args, total_args);
+        }
+        if(bad_args > 0)
+        {
+            log_error("%d bad input argument(s)", bad_args);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Parse one of the options -r, -b and -z that define a grid of computation
+points */
+int parse_points_grid_arg(const char *arg, POINTS_GRID_ARGS *grid)
+{
+    const char *params = &arg[2];
+    int flag, nread, nchar = 0;
+
+    flag = arg[1] == 'r' ? 1 : (arg[1] == 'b' ? 2 : 4);
+    if(grid->parsed & flag)
+    {
+        log_error("repeated option -%c", arg[1]);
+        return 1;
+    }
+    grid->parsed |= flag;
+    if(flag == 1)
+    {
+        nread = sscanf(params, "%lf/%lf/%lf/%lf%n", &(grid->w), &(grid->e),
+                       &(grid->s), &(grid->n), &nchar);
+        if(nread != 4 || *(params + nchar) != '\0' || grid->w > grid->e ||
+           grid->s > grid->n)
+        {
+            log_error("bad input argument '%s'", arg);
+            return 1;
+        }
+    }
+    else if(flag == 2)
+    {
+        nread = sscanf(params, "%d/%d%n", &(grid->nlon), &(grid->nlat),
+                       &nchar);
+        if(nread != 2 || *(params + nchar) != '\0' || grid->nlon < 1 ||
+           grid->nlat < 1)
+        {
+            log_error("bad input argument '%s'", arg);
+            return 1;
+        }
+    }
+    else
+    {
+        nread = sscanf(params, "%lf%n", &(grid->height), &nchar);
+        if(nread != 1 || *(params + nchar) != '\0')
+        {
+            log_error("bad input argument '%s'", arg);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* Check that the options -r, -b and -z are either all given or not at all */
+int check_points_grid_args(const POINTS_GRID_ARGS *grid)
+{
+    if(grid->parsed != 0 && grid->parsed != 7)
+    {
+        log_error("options -r, -b and -z must be used together");
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Get the coordinates of a point of a grid given with -r, -b and -z */
+void points_grid_point(const POINTS_GRID_ARGS *grid, long i, double *point)
+{
+    int ilon = (int)(i % grid->nlon), ilat = (int)(i/grid->nlon);
+
+    /* Use the borders for the first and last points so that rounding doesn't
+     * move them */
+    if(ilon == 0)
+    {
+        point[0] = grid->w;
+    }
+    else if(ilon == grid->nlon - 1)
+    {
+        point[0] = grid->e;
+    }
+    else
+    {
+        point[0] = grid->w + ilon*((grid->e - grid->w)/(grid->nlon - 1));
+    }
+    if(ilat == 0)
+    {
+        point[1] = grid->s;
+    }
+    else if(ilat == grid->nlat - 1)
+    {
+        point[1] = grid->n;
+    }
+    else
+    {
+        point[1] = grid->s + ilat*((grid->n - grid->s)/(grid->nlat - 1));
+    }
+    point[2] = grid->height;
+}
+
+
+/* Parse command line arguments for tessgrd program */
+int parse_tessgrd_args(int argc, char **argv, TESSGRD_ARGS *args,
+                       void (*print_help)(void))
+{
+    int bad_args = 0, parsed_args = 0, total_args = 3, parsed_r = 0,
+        parsed_b = 0, parsed_z = 0, parsed_precision = 0, i, nchar, nread;
+    char progname[] = "tessgrd", *params;
+
+    /* Default values for options */
+    args->verbose = 0;
+    args->logtofile = 0;
+    args->precision = 15;
+    /* Parse arguments */
+    for(i = 1; i < argc; i++)
+    {
+        if(argv[i][0] == '-')
+        {
+            switch(argv[i][1])
+            {
+                case 'h':
+                    if(argv[i][2] != '\0')
+                    {
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
+                        break;
+                    }
+                    print_help();
+                    return 2;
+                case 'v':
+                    if(argv[i][2] != '\0')
+                    {
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
+                        break;
+                    }
+                    if(args->verbose)
+                    {
+                        log_error("repeated option -v");
+                        bad_args++;
+                        break;
+                    }
+                    args->verbose = 1;
+                    break;
+
+                case 'l':
+                {
+                    if(args->logtofile)
+                    {
+                        log_error("repeated option -l");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    if(strlen(params) == 0)
+                    {
+                        log_error("bad input argument -l. Missing filename.");
+                        bad_args++;
+                    }
+                    else
+                    {
+                        args->logtofile = 1;
+                        args->logfname = params;
+                    }
+                    break;
+                }
+                case '-':
+                {
+                    params = &argv[i][2];
+                    if(strcmp(params, "version"))
+                    {
+                        log_error("invalid argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    else
+                    {
+                        print_version(progname);
+                        return 2;
+                    }
+                    break;
+                }
+                case 'r':
+                {
+                    if(parsed_r)
+                    {
+                        log_error("repeated argument -r");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf/%lf/%lf/%lf%n", &(args->w),
+                                   &(args->e), &(args->s), &(args->n), &nchar);
+                    if(nread != 4 || *(params + nchar) != '\0')
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_args++;
+                    parsed_r = 1;
+                    break;
+                }
+                case 'b':
+                {
+                    if(parsed_b)
+                    {
+                        log_error("repeated argument -b");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d/%d%n", &(args->nlon),
+                                   &(args->nlat), &nchar);
+                    if(nread != 2 || *(params + nchar) != '\0')
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_args++;
+                    parsed_b = 1;
+                    break;
+                }
+                case 'z':
+                {
+                    if(parsed_z)
+                    {
+                        log_error("repeated argument -z");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%lf%n", &(args->height), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0')
+                    {
+                        log_error("bad input argument '%s'", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_args++;
+                    parsed_z = 1;
+                    break;
+                }
+                case 'p':
+                {
+                    if(parsed_precision)
+                    {
+                        log_error("repeated option -p");
+                        bad_args++;
+                        break;
+                    }
+                    params = &argv[i][2];
+                    nchar = 0;
+                    nread = sscanf(params, "%d%n", &(args->precision), &nchar);
+                    if(nread != 1 || *(params + nchar) != '\0' ||
+                       args->precision < 1 || args->precision > 17)
+                    {
+                        log_error("bad input argument '%s'. Must be 1 to 17 "
+                                  "digits", argv[i]);
+                        bad_args++;
+                    }
+                    parsed_precision = 1;
+                    break;
+                }
+                default:
+                    log_error("invalid argument '%s'", argv[i]);
+                    bad_args++;
+                    break;
+            }
+        }
+        else
+        {
+            log_error("invalid argument '%s'", argv[i]);
+            bad_args++;
+        }
+    }
+    /* Check if parsing went well */
+    if(bad_args > 0 || parsed_args != total_args)
+    {
+        if(parsed_args < total_args)
+        {
+            log_error("%s: missing input arguments. given %d out of %d.",
+                      progname, parsed_args, total_args);
+        }
+        if(parsed_args > total_args)
+        {
+            log_error("%s: too many input arguments. given %d, max %d.",
+                      progname, parsed_args, total_args);
+        }
+        if(bad_args > 0)
+        {
+            log_error("%d bad input argument(s)", bad_args);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Strip trailing spaces and newlines from the end of a string */
+void strstrip(char *str)
+{
+    int i;
+    for(i = strlen(str) - 1; i >= 0; i--)
+    {
+        if(str[i] != ' ' && str[i] != '\n' && str[i] != '\r' && str[i] != '\0')
+            break;
+    }
+    str[i + 1] = '\0';
+}
+
+
+/* The exact conversions of scan_doubles and format_double need double
+ * precision arithmetic. With x87 extended precision (32 bit x86), the numbers
+ * are always converted by strtod and sprintf. */
+#if defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ != 0
+    #define PARSERS_NO_FAST_DOUBLES
+#endif
+
+/* Exact powers of 10 used by scan_doubles and format_double */
+static const double scan_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+    1e20, 1e21, 1e22};
+
+
+/* Read a single number from a string (after skipping white space). Returns
+the number of characters used or 0 if there is no number. */
+static int scan_double(const char *str, double *value)
+{
+    const char *c = str, *start, *digits;
+    double mantissa = 0;
+    int ndigits = 0, nsignificant = 0, fracdigits = 0, exponent = 0,
+        expsign = 1, negative = 0;
+    char *end;
+
+    while(isspace((unsigned char)*c))
+    {
+        c++;
+    }
+    start = c;
+    if(*c == '-' || *c == '+')
+    {
+        negative = (*c == '-');
+        c++;
+    }
+    /* Accumulate the digits in a double. Is exact up to 15 digits */
+    for(; *c >= '0' && *c <= '9'; c++, ndigits++)
+    {
+        if(nsignificant != 0 || *c != '0')
+        {
+            mantissa = 10*mantissa + (*c - '0');
+            nsignificant++;
+        }
+    }
+    if(*c == '.')
+    {
+        for(c++; *c >= '0' && *c <= '9'; c++, ndigits++, fracdigits++)
+        {
+            if(nsignificant != 0 || *c != '0')
+            {
+                mantissa = 10*mantissa + (*c - '0');
+                nsignificant++;
+            }
+        }
+    }
+    if(ndigits != 0 && (*c == 'e' || *c == 'E'))
+    {
+        digits = c + 1;
+        if(*digits == '-' || *digits == '+')
+        {
+            expsign = (*digits == '-') ? -1 : 1;
+            digits++;
+        }
+        /* An 'e' without digits isn't part of the number (same as strtod) */
+        if(*digits >= '0' && *digits <= '9')
+        {
+            for(c = digits; *c >= '0' && *c <= '9'; c++)
+            {
+                if(exponent < 10000)
+                {
+                    exponent = 10*exponent + (*c - '0');
+                }
+            }
+        }
+    }
+    exponent = expsign*exponent - fracdigits;
+    /* The mantissa and the power of 10 are exact, so the single rounding of
+     * the product or division gives the correctly rounded number. inf, nan,
+     * hexadecimal numbers, more than 15 digits and large exponents are left
+     * to strtod. */
+#ifndef PARSERS_NO_FAST_DOUBLES
+    if(ndigits != 0 && nsignificant <= 15 && exponent >= -22 &&
+       exponent <= 22 && *c != 'x' && *c != 'X')
+    {
+        if(exponent < 0)
+        {
+            mantissa /= scan_pow10[-exponent];
+        }
+        else
+        {
+            mantissa *= scan_pow10[exponent];
+        }
+        *value = negative ? -mantissa : mantissa;
+        return (int)(c - str);
+    }
+#endif
+    *value = strtod(start, &end);
+    if(end == start)
+    {
+        return 0;
+    }
+    return (int)(end - str);
+}
+
+
+/* Read numbers separated by white space from a string */
+int scan_doubles(const char *str, double *values, int n, int *nchars)
+{
+    int i, used, pos = 0;
+
+    for(i = 0; i < n; i++)
+    {
+        used = scan_double(str + pos, &values[i]);
+        if(used == 0)
+        {
+            break;
+        }
+        pos += used;
+    }
+    *nchars = pos;
+    return i;
+}
+
+
+/* Calculate the product a*b exactly as the sum prod + err (Dekker's
+algorithm) */
+static void exact_product(double a, double b, double *prod, double *err)
+{
+    double c, ahi, alo, bhi, blo;
+
+    *prod = a*b;
+    c = 134217729.0*a;
+    ahi = c - (c - a);
+    alo = a - ahi;
+    c = 134217729.0*b;
+    bhi = c - (c - b);
+    blo = b - bhi;
+    *err = ((ahi*bhi - *prod) + ahi*blo + alo*bhi) + alo*blo;
+}
+
+
+/* Write the decimal digits of an integer number (< 1e16) stored in a double.
+Returns the number of digits written. */
+static int write_digits(char *str, double number)
+{
+    unsigned long high, low;
+    double highpart, lowpart;
+    char tmp[20];
+    int ndigits = 0, i;
+
+    /* Split in 2 parts of 8 digits so that they fit in an unsigned long */
+    highpart = floor(number/1e8);
+    lowpart = number - 1e8*highpart;
+    if(lowpart < 0)
+    {
+        highpart -= 1;
+        lowpart += 1e8;
+    }
+    else if(lowpart >= 1e8)
+    {
+        highpart += 1;
+        lowpart -= 1e8;
+    }
+    high = (unsigned long)highpart;
+    low = (unsigned long)lowpart;
+    do
+    {
+        tmp[ndigits++] = (char)('0' + low%10);
+        low /= 10;
+    } while(low != 0 || (high != 0 && ndigits < 8));
+    while(high != 0)
+    {
+        tmp[ndigits++] = (char)('0' + high%10);
+        high /= 10;
+    }
+    for(i = 0; i < ndigits; i++)
+    {
+        str[i] = tmp[ndigits - 1 - i];
+    }
+    return ndigits;
+}
+
+
+/* Format a number like sprintf(str, "%.*g", digits, value) */
+int format_double(char *str, double value, int digits)
+{
+    double number, prod, err, rest = 0, limit;
+    char mantissa[20];
+    int exponent, scale = -1, ndigits, len = 0, i, tries;
+
+    if(digits < 1)
+    {
+        digits = 1;
+    }
+#ifndef PARSERS_NO_FAST_DOUBLES
+    /* Zero, inf and nan are left to sprintf */
+    if(digits <= 15 && value != 0 && value - value == 0)
+    {
+        number = value < 0 ? -value : value;
+        exponent = (int)floor(log10(number));
+        limit = scan_pow10[digits];
+        /* The estimate of the exponent can be off by one */
+        for(tries = 0; tries < 3; tries++)
+        {
+            scale = digits - 1 - exponent;
+            if(scale < 0 || scale > 22)
+            {
+                break;
+            }
+            /* number*10^scale = prod + err exactly. Round it to an integer
+             * (half to even, like printf) */
+            exact_product(number, scan_pow10[scale], &prod, &err);
+            if(prod >= limit)
+            {
+                exponent++;
+                continue;
+            }
+            if(prod < scan_pow10[digits - 1])
+            {
+                exponent--;
+                continue;
+            }
+            rest = floor(prod);
+            /* Both subtractions are exact. err is smaller than the spacing
+             * of the doubles around prod, so it only matters in a tie. */
+            prod = (prod - rest) - 0.5;
+            if(prod > 0 || (prod == 0 &&
+               (err > 0 || (err == 0 && fmod(rest, 2) != 0))))
+            {
+                rest += 1;
+            }
+            if(rest >= limit)
+            {
+                rest /= 10;
+                exponent++;
+            }
+            break;
+        }
+        if(tries < 3 && scale >= 0 && scale <= 22)
+        {
+            if(value < 0)
+            {
+                str[len++] = '-';
+            }
+            ndigits = write_digits(mantissa, rest);
+            /* Remove the trailing zeros */
+            while(ndigits > 1 && mantissa[ndigits - 1] == '0')
+            {
+                ndigits--;
+            }
+            if(exponent < -4 || exponent >= digits)
+            {
+                str[len++] = mantissa[0];
+                if(ndigits > 1)
+                {
+                    str[len++] = '.';
+                    for(i = 1; i < ndigits; i++)
+                    {
+                        str[len++] = mantissa[i];
+                    }
+                }
+                str[len++] = 'e';
+                str[len++] = exponent < 0 ? '-' : '+';
+                if(exponent < 0)
+                {
+                    exponent = -exponent;
+                }
+                if(exponent >= 100)
+                {
+                    str[len++] = (char)('0' + exponent/100);
+                }
+                str[len++] = (char)('0' + (exponent/10)%10);
+                str[len++] = (char)('0' + exponent%10);
+            }
+            else if(exponent < 0)
+            {
+                str[len++] = '0';
+                str[len++] = '.';
+                for(i = exponent + 1; i < 0; i++)
+                {
+                    str[len++] = '0';
+                }
+                for(i = 0; i < ndigits; i++)
+                {
+                    str[len++] = mantissa[i];
+                }
+            }
+            else
+            {
+                for(i = 0; i <= exponent; i++)
+                {
+                    str[len++] = i < ndigits ? mantissa[i] : '0';
+                }
+                if(ndigits > exponent + 1)
+                {
+                    str[len++] = '.';
+                    for(i = exponent + 1; i < ndigits; i++)
+                    {
+                        str[len++] = mantissa[i];
+                    }
+                }
+            }
+            str[len] = '\0';
+            return len;
+        }
+    }
+#endif
+    return sprintf(str, "%.*g", digits, value);
+}
+
+
+/* Format numbers separated by spaces into a string. */
+int format_doubles(char *str, const double *values, int n, int digits)
+{
+    int i, len = 0;
+
+    str[0] = '\0';
+    for(i = 0; i < n; i++)
+    {
+        if(i != 0)
+        {
+            str[len++] = ' ';
+        }
+        len += format_double(str + len, values[i], digits);
+    }
+    return len;
+}
+
+
+/* Print numbers separated by spaces and a newline to a stream */
+void print_doubles(FILE *stream, const char *prefix, const double *values,
+                   int n, int digits)
+{
+    char str[50];
+    int i;
+
+    if(prefix != NULL)
+    {
+        fputs(prefix, stream);
+    }
+    for(i = 0; i < n; i++)
+    {
+        if(prefix != NULL || i != 0)
+        {
+            putc(' ', stream);
+        }
+        format_double(str, values[i], digits);
+        fputs(str, stream);
+    }
+    putc('\n', stream);
+}
+
+
+/* Read a single tesseroid from a string */
+int gets_tess(const char *str, TESSEROID *tess)
+{
+    double values[7], w, e, s, n, top, bot, dens;
+    int nread, nchars;
+
+    nread = scan_doubles(str, values, 7, &nchars);
+    if(nread != 7 || str[nchars] != '\0')
+    {
+        /* Something wrong with the tesseroid string */
+        return 1;
+    }
+    w = values[0];
+    e = values[1];
+    s = values[2];
+    n = values[3];
+    top = values[4];
+    bot = values[5];
+    dens = values[6];
+    if((w > e) || (s > n) || (top < bot))
+    {
+        /* Model bounds in wrong order */
+        return 2;
+    }
+    if((w == e) || (s == n) || (top == bot))
+    {
+        /* Tesseroid has zero volume */
+        return 3;
+    }
+    tess->w = w;
+    tess->e = e;
+    tess->s = s;
+    tess->n = n;
+    tess->r1 = MEAN_EARTH_RADIUS + bot;
+    tess->r2 = MEAN_EARTH_RADIUS + top;
+    tess->density = dens;
+    return 0;
+}
+
+
+#ifdef PARSERS_MMAP
+/* Each thread parses chunks of at least this many bytes of a model file */
+#define MODEL_CHUNK_SIZE 1048576
+/* Maximum number of threads used to parse a model file */
+#define MODEL_MAX_THREADS 64
+
+/* A part of a memory mapped model file parsed by a single thread */
+typedef struct model_chunk_struct
+{
+    const char *start; /* first character of the chunk (start of a line) */
+    const char *end; /* one past the last character of the chunk */
+    size_t itemsize; /* size of the elements of the model (in bytes) */
+    int (*parse)(const char *, void *); /* reads an element from a line */
+    char *items; /* the elements read */
+    size_t nitems; /* number of elements read */
+    size_t capacity; /* number of elements that fit in items */
+    long nlines; /* number of lines in the chunk */
+    long *errlines; /* line (in the chunk) of the lines that failed */
+    int *errcodes; /* code returned by parse for the lines that failed */
+    size_t nerrors; /* number of lines that failed */
+    size_t errcapacity; /* number of errors that fit in errlines */
+    int nomemory; /* flag for errors allocating memory */
+} MODEL_CHUNK;
+
+
+/* Store the line number and code of a line that failed to parse */
+static void add_chunk_error(MODEL_CHUNK *chunk, long line, int code)
+{
+    long *lines;
+    int *codes;
+
+    if(chunk->nerrors == chunk->errcapacity)
+    {
+        chunk->errcapacity = chunk->errcapacity == 0 ? 16 :
+                             2*chunk->errcapacity;
+        lines = (long *)realloc(chunk->errlines,
+                                chunk->errcapacity*sizeof(long));
+        if(lines == NULL)
+        {
+            chunk->nomemory = 1;
+            return;
+        }
+        chunk->errlines = lines;
+        codes = (int *)realloc(chunk->errcodes,
+                               chunk->errcapacity*sizeof(int));
+        if(codes == NULL)
+        {
+            chunk->nomemory = 1;
+            return;
+        }
+        chunk->errcodes = codes;
+    }
+    chunk->errlines[chunk->nerrors] = line;
+    chunk->errcodes[chunk->nerrors] = code;
+    chunk->nerrors++;
+}
+
+
+/* Parse the lines of a chunk. Runs in its own thread. */
+static void * parse_model_chunk(void *arg)
+{
+    MODEL_CHUNK *chunk = (MODEL_CHUNK *)arg;
+    const char *line, *lineend;
+    char sbuff[10000], *tmp;
+    size_t len;
+    int code;
+
+    for(line = chunk->start; line < chunk->end && !chunk->nomemory;
+        line = lineend + 1)
+    {
+        lineend = (const char *)memchr(line, '\n', chunk->end - line);
+        if(lineend == NULL)
+        {
+            lineend = chunk->end;
+        }
+        chunk->nlines++;
+        len = lineend - line;
+        /* Check for comments and blank lines */
+        if(len == 0 || line[0] == '#' || line[0] == '\r')
+        {
+            continue;
+        }
+        if(len >= sizeof(sbuff))
+        {
+            add_chunk_error(chunk, chunk->nlines, 1);
+            continue;
+        }
+        if(chunk->nitems == chunk->capacity)
+        {
+            chunk->capacity = chunk->capacity == 0 ? 1024 : 2*chunk->capacity;
+            tmp = (char *)realloc(chunk->items,
+                                  chunk->capacity*chunk->itemsize);
+            if(tmp == NULL)
+            {
+                chunk->nomemory = 1;
+                break;
+            }
+            chunk->items = tmp;
+        }
+        memcpy(sbuff, line, len);
+        sbuff[len] = '\0';
+        /* Remove any trailing spaces or newlines */
+        strstrip(sbuff);
+        code = chunk->parse(sbuff,
+                            chunk->items + chunk->nitems*chunk->itemsize);
+        if(code != 0)
+        {
+            add_chunk_error(chunk, chunk->nlines, code);
+            continue;
+        }
+        chunk->nitems++;
+    }
+    return NULL;
+}
+#endif
+
+
+/* Read a model from a memory mapped file using several threads. Returns 0 if
+the file can't be memory mapped (isn't a regular file or was already read
+from). The model is returned in 'model' (NULL if there was an error or the
+model is empty). Models with more than 'maxsize' elements are an error. */
+static int read_mapped_model(FILE *modelfile, size_t itemsize,
+    int (*parse)(const char *, void *), int (*report)(long, int),
+    long maxsize, void **model, long *size)
+{
+#ifdef PARSERS_MMAP
+    MODEL_CHUNK chunks[MODEL_MAX_THREADS];
+    pthread_t threads[MODEL_MAX_THREADS];
+    int started[MODEL_MAX_THREADS];
+    struct stat info;
+    const char *data, *cut;
+    char *items;
+    size_t datasize, nitems, e;
+    long lines;
+    int nchunks, k, fatal = 0;
+
+    *model = NULL;
+    if(ftell(modelfile) != 0 || fstat(fileno(modelfile), &info) != 0 ||
+       !S_ISREG(info.st_mode) || info.st_size == 0)
+    {
+        return 0;
+    }
+    datasize = (size_t)info.st_size;
+    data = (const char *)mmap(NULL, datasize, PROT_READ, MAP_PRIVATE,
+                              fileno(modelfile), 0);
+    if((void *)data == MAP_FAILED)
+    {
+        return 0;
+    }
+    posix_madvise((void *)data, datasize, POSIX_MADV_SEQUENTIAL);
+    /* Split the file in chunks that start at the beginning of a line */
+    nchunks = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if((size_t)nchunks > datasize/MODEL_CHUNK_SIZE + 1)
+    {
+        nchunks = (int)(datasize/MODEL_CHUNK_SIZE + 1);
+    }
+    if(nchunks > MODEL_MAX_THREADS)
+    {
+        nchunks = MODEL_MAX_THREADS;
+    }
+    if(nchunks < 1)
+    {
+        nchunks = 1;
+    }
+    cut = data;
+    for(k = 0; k < nchunks; k++)
+    {
+        chunks[k].start = cut;
+        if(k == nchunks - 1)
+        {
+            cut = data + datasize;
+        }
+        else
+        {
+            cut = data + (datasize/nchunks)*(k + 1);
+            if(cut < chunks[k].start)
+            {
+                cut = chunks[k].start;
             }
+            cut = (const char *)memchr(cut, '\n', data + datasize - cut);
+            cut = cut == NULL ? data + datasize : cut + 1;
+        }
+        chunks[k].end = cut;
+        chunks[k].itemsize = itemsize;
+        chunks[k].parse = parse;
+        chunks[k].items = NULL;
+        chunks[k].nitems = 0;
+        chunks[k].capacity = 0;
+        chunks[k].nlines = 0;
+        chunks[k].errlines = NULL;
+        chunks[k].errcodes = NULL;
+        chunks[k].nerrors = 0;
+        chunks[k].errcapacity = 0;
+        chunks[k].nomemory = 0;
+    }
+    /* The first chunk is parsed by this thread */
+    for(k = 1; k < nchunks; k++)
+    {
+        started[k] = pthread_create(&threads[k], NULL, parse_model_chunk,
+                                    &chunks[k]) == 0;
+    }
+    parse_model_chunk(&chunks[0]);
+    for(k = 1; k < nchunks; k++)
+    {
+        if(started[k])
+        {
+            pthread_join(threads[k], NULL);
         }
         else
         {
-            log_error("invalid argument '%s'", argv[i]);
-            bad_args++;
+            parse_model_chunk(&chunks[k]);
         }
     }
-    /* Check if parsing went well */
-    if(bad_args > 0 || parsed_args != total_args)
+    munmap((void *)data, datasize);
+    /* Report the errors in the order of the lines of the file */
+    nitems = 0;
+    lines = 0;
+    for(k = 0; k < nchunks; k++)
     {
-        if(parsed_args < total_args)
+        if(chunks[k].nomemory)
         {
-            log_error("%s: missing input arguments. given %d out of %d.",
-                      progname, parsed_args, total_args);
+            log_error("problem allocating memory to load the model.");
+            fatal = 1;
         }
-        if(parsed_args > total_args)
+        for(e = 0; e < chunks[k].nerrors; e++)
         {
-            log_error("%s: too many input arguments. given %d, max %d.",
-                      progname, parsed_args, total_args);
+            if(report(lines + chunks[k].errlines[e], chunks[k].errcodes[e]))
+            {
+                fatal = 1;
+            }
         }
-        if(bad_args > 0)
+        lines += chunks[k].nlines;
+        nitems += chunks[k].nitems;
+    }
+    if(nitems > (size_t)maxsize)
+    {
+        log_error("model with %lu elements is too big. Max = %ld.",
+                  (unsigned long)nitems, maxsize);
+        fatal = 1;
+    }
+    else
+    {
+        *size = (long)nitems;
+    }
+    /* Join the chunks in order in the array of the first. Nothing is
+     * allocated for an empty model. */
+    items = NULL;
+    if(!fatal && nitems > 0)
+    {
+        items = (char *)realloc(chunks[0].items, nitems*itemsize);
+        if(items == NULL)
         {
-            log_error("%d bad input argument(s)", bad_args);
+            log_error("problem allocating memory to load the model.");
         }
-        return 1;
+        else
+        {
+            chunks[0].items = NULL;
+            nitems = chunks[0].nitems;
+            for(k = 1; k < nchunks; k++)
+            {
+                memcpy(items + nitems*itemsize, chunks[k].items,
+                       chunks[k].nitems*itemsize);
+                nitems += chunks[k].nitems;
+            }
+        }
+    }
+    for(k = 0; k < nchunks; k++)
+    {
+        free(chunks[k].items);
+        free(chunks[k].errlines);
+        free(chunks[k].errcodes);
     }
+    *model = items;
+    return 1;
+#else
+    *model = NULL;
     return 0;
+#endif
 }
 
 
-/* Strip trailing spaces and newlines from the end of a string */
-void strstrip(char *str)
+/* Read a tesseroid from a line of a memory mapped model file */
+static int parse_tess_line(const char *str, void *tess)
 {
-    int i;
-    for(i = strlen(str) - 1; i >= 0; i--)
-    {
-        if(str[i] != ' ' && str[i] != '\n' && str[i] != '\r' && str[i] != '\0')
-            break;
-    }
-    str[i + 1] = '\0';
+    return gets_tess(str, (TESSEROID *)tess);
 }
 
 
-/* Read a single tesseroid from a string */
-int gets_tess(const char *str, TESSEROID *tess)
+/* Log the error of a line of a tesseroid model file. Returns 1 if the model
+can't be used. */
+static int report_tess_error(long line, int code)
 {
-    double w, e, s, n, top, bot, dens;
-    int nread, nchars;
-
-    nread = sscanf(str, "%lf %lf %lf %lf %lf %lf %lf%n", &w, &e, &s,
-                    &n, &top, &bot, &dens, &nchars);
-    if(nread != 7 || str[nchars] != '\0')
+    if(code == 2)
     {
-        /* Something wrong with the tesseroid string */
+        log_error("invalid tesseroid dimensions at line %ld. Must be w < e, s < n, top > bottom.", line);
         return 1;
     }
-    if((w > e) || (s > n) || (top < bot))
-    {
-        /* Model bounds in wrong order */
-        return 2;
-    }
-    if((w == e) || (s == n) || (top == bot))
+    if(code == 3)
     {
-        /* Tesseroid has zero volume */
-        return 3;
+        log_warning("ignoring tesseroid with zero volume at line %ld. This should not impact the computations.", line);
+        return 0;
     }
-    tess->w = w;
-    tess->e = e;
-    tess->s = s;
-    tess->n = n;
-    tess->r1 = MEAN_EARTH_RADIUS + bot;
-    tess->r2 = MEAN_EARTH_RADIUS + top;
-    tess->density = dens;
-    return 0;
+    log_error("bad/invalid tesseroid at line %ld.", line);
+    return 1;
 }
 
 
 /* Read tesseroids from an open file and store them in an array */
-TESSEROID * read_tess_model(FILE *modelfile, int *size)
+TESSEROID * read_tess_model(FILE *modelfile, long *size)
 {
     TESSEROID *model, *tmp;
-    int buffsize = 100, line, badinput = 0, error_exit = 0, gets_error;
+    long buffsize = 100, line;
+    int badinput = 0, error_exit = 0, gets_error;
     char sbuff[10000];
+    void *mapped;
 
+    *size = 0;
+    /* Large files are parsed in parallel if possible */
+    if(read_mapped_model(modelfile, sizeof(TESSEROID), &parse_tess_line,
+                         &report_tess_error, LONG_MAX, &mapped, size))
+    {
+        return (TESSEROID *)mapped;
+    }
     /* Start with a single buffer allocation and expand later if necessary */
     model = (TESSEROID *)malloc(buffsize*sizeof(TESSEROID));
     if(model == NULL)
@@ -1129,7 +2560,7 @@ TESSEROID * read_tess_model(FILE *modelfile, int *size)
         {
             if(ferror(modelfile))
             {
-                log_error("problem encountered reading line %d.", line);
+                log_error("problem encountered reading line %ld.", line);
                 error_exit = 1;
                 break;
             }
@@ -1160,19 +2591,19 @@ TESSEROID * read_tess_model(FILE *modelfile, int *size)
             gets_error = gets_tess(sbuff, &model[*size]);
             if(gets_error == 1)
             {
-                log_error("bad/invalid tesseroid at line %d.", line);
+                log_error("bad/invalid tesseroid at line %ld.", line);
                 badinput = 1;
                 continue;
             }
             if(gets_error == 2)
             {
-                log_error("invalid tesseroid dimensions at line %d. Must be w < e, s < n, top > bottom.", line);
+                log_error("invalid tesseroid dimensions at line %ld. Must be w < e, s < n, top > bottom.", line);
                 badinput = 1;
                 continue;
             }
             if(gets_error == 3)
             {
-                log_warning("ignoring tesseroid with zero volume at line %d. This should not impact the computations.", line);
+                log_warning("ignoring tesseroid with zero volume at line %ld. This should not impact the computations.", line);
                 continue;
             }
             (*size)++;
@@ -1204,11 +2635,10 @@ TESSEROID * read_tess_model(FILE *modelfile, int *size)
 /* Read a single rectangular prism from a string */
 int gets_prism(const char *str, PRISM *prism)
 {
-    double x1, x2, y1, y2, z1, z2, dens;
+    double values[7];
     int nread, nchars;
 
-    nread = sscanf(str, "%lf %lf %lf %lf %lf %lf %lf%n", &x1, &x2, &y1, &y2,
-                   &z1, &z2, &dens, &nchars);
+    nread = scan_doubles(str, values, 7, &nchars);
     /* Check if there are extra characters in the line. This indicates
      * that the model is wrong or was generated by tess2prism without the
      * --flatten flag */
@@ -1216,13 +2646,13 @@ int gets_prism(const char *str, PRISM *prism)
     {
         return 1;
     }
-    prism->x1 = x1;
-    prism->x2 = x2;
-    prism->y1 = y1;
-    prism->y2 = y2;
-    prism->z1 = z1;
-    prism->z2 = z2;
-    prism->density = dens;
+    prism->x1 = values[0];
+    prism->x2 = values[1];
+    prism->y1 = values[2];
+    prism->y2 = values[3];
+    prism->z1 = values[4];
+    prism->z2 = values[5];
+    prism->density = values[6];
     return 0;
 }
 
@@ -1231,11 +2661,10 @@ int gets_prism(const char *str, PRISM *prism)
 from a string */
 int gets_prism_sph(const char *str, PRISM *prism)
 {
-    double dx, dy, dz, dens, lon, lat, r;
+    double values[7];
     int nread, nchars;
 
-    nread = sscanf(str, "%lf %lf %lf %lf %lf %lf %lf%n",
-                   &dx, &dy, &dz, &dens, &lon, &lat, &r, &nchars);
+    nread = scan_doubles(str, values, 7, &nchars);
     /* Check if there are extra characters in the line. This indicates
      * that the model is wrong or was generated by tess2prism without the
      * --flatten flag */
@@ -1243,27 +2672,60 @@ int gets_prism_sph(const char *str, PRISM *prism)
     {
         return 1;
     }
-    prism->x1 = -0.5*dx;
-    prism->x2 = 0.5*dx;
-    prism->y1 = -0.5*dy;
-    prism->y2 = 0.5*dy;
+    prism->x1 = -0.5*values[0];
+    prism->x2 = 0.5*values[0];
+    prism->y1 = -0.5*values[1];
+    prism->y2 = 0.5*values[1];
     prism->z1 = 0.;
-    prism->z2 = dz;
-    prism->density = dens;
-    prism->lon = lon;
-    prism->lat = lat;
-    prism->r = r;
+    prism->z2 = values[2];
+    prism->density = values[3];
+    prism->lon = values[4];
+    prism->lat = values[5];
+    prism->r = values[6];
     return 0;
 }
 
 
+/* Read a prism from a line of a memory mapped model file */
+static int parse_prism_line(const char *str, void *prism)
+{
+    return gets_prism(str, (PRISM *)prism);
+}
+
+
+/* Read a prism with its position from a line of a memory mapped model file */
+static int parse_prism_sph_line(const char *str, void *prism)
+{
+    return gets_prism_sph(str, (PRISM *)prism);
+}
+
+
+/* Log the error of a line of a prism model file */
+static int report_prism_error(long line, int code)
+{
+    log_warning("bad/invalid prism at line %ld", line);
+    return code != 0;
+}
+
+
 /* Read rectangular prisms from an open file and store them in an array. */
 PRISM * read_prism_model(FILE *modelfile, int pos, int *size)
 {
     PRISM *model, *tmp;
     int buffsize = 100, line, badinput = 0, error_exit = 0;
     char sbuff[10000];
+    void *mapped;
+    long nread = 0;
 
+    *size = 0;
+    /* Large files are parsed in parallel if possible */
+    if(read_mapped_model(modelfile, sizeof(PRISM),
+                         pos ? &parse_prism_sph_line : &parse_prism_line,
+                         &report_prism_error, INT_MAX, &mapped, &nread))
+    {
+        *size = (int)nread;
+        return (PRISM *)mapped;
+    }
     /* Start with a single buffer allocation and expand later if necessary */
     model = (PRISM *)malloc(buffsize*sizeof(PRISM));
     if(model == NULL)
@@ -1353,19 +2815,158 @@ PRISM * read_prism_model(FILE *modelfile, int pos, int *size)
 }
 
 
+/* Read a single sphere from a string */
+int gets_sphere(const char *str, SPHERE *sphere)
+{
+    double values[5];
+    int nread, nchars;
+
+    nread = scan_doubles(str, values, 5, &nchars);
+    if(nread != 5 || str[nchars] != '\0')
+    {
+        return 1;
+    }
+    if(values[3] <= 0)
+    {
+        return 2;
+    }
+    sphere->lonc = values[0];
+    sphere->latc = values[1];
+    sphere->rc = MEAN_EARTH_RADIUS + values[2];
+    sphere->r = values[3];
+    sphere->density = values[4];
+    return 0;
+}
+
+
+/* Read a sphere from a line of a memory mapped model file */
+static int parse_sphere_line(const char *str, void *sphere)
+{
+    return gets_sphere(str, (SPHERE *)sphere);
+}
+
+
+/* Log the error of a line of a sphere model file */
+static int report_sphere_error(long line, int code)
+{
+    if(code == 2)
+    {
+        log_error("invalid sphere at line %ld. The radius must be positive.",
+                  line);
+        return 1;
+    }
+    log_error("bad/invalid sphere at line %ld.", line);
+    return 1;
+}
+
+
+/* Read spheres from an open file and store them in an array. */
+SPHERE * read_sphere_model(FILE *modelfile, int *size)
+{
+    SPHERE *model, *tmp;
+    int buffsize = 100, line, badinput = 0, error_exit = 0, gets_error;
+    char sbuff[10000];
+    void *mapped;
+    long nread = 0;
+
+    *size = 0;
+    /* Large files are parsed in parallel if possible */
+    if(read_mapped_model(modelfile, sizeof(SPHERE), &parse_sphere_line,
+                         &report_sphere_error, INT_MAX, &mapped, &nread))
+    {
+        *size = (int)nread;
+        return (SPHERE *)mapped;
+    }
+    /* Start with a single buffer allocation and expand later if necessary */
+    model = (SPHERE *)malloc(buffsize*sizeof(SPHERE));
+    if(model == NULL)
+    {
+        log_error("problem allocating initial memory to load sphere model.");
+        return NULL;
+    }
+    for(line = 1; !feof(modelfile); line++)
+    {
+        if(fgets(sbuff, 10000, modelfile) == NULL)
+        {
+            if(ferror(modelfile))
+            {
+                log_error("problem encountered reading line %d.", line);
+                error_exit = 1;
+                break;
+            }
+        }
+        else
+        {
+            /* Check for comments and blank lines */
+            if(sbuff[0] == '#' || sbuff[0] == '\r' || sbuff[0] == '\n')
+            {
+                continue;
+            }
+            if(*size == buffsize)
+            {
+                buffsize += buffsize;
+                tmp = (SPHERE *)realloc(model, buffsize*sizeof(SPHERE));
+                if(tmp == NULL)
+                {
+                    /* Need to free because realloc leaves unchanged in case of
+                       error */
+                    free(model);
+                    log_error("problem expanding memory for sphere model. Model is too big.");
+                    return NULL;
+                }
+                model = tmp;
+            }
+            /* Remove any trailing spaces or newlines */
+            strstrip(sbuff);
+            gets_error = gets_sphere(sbuff, &model[*size]);
+            if(gets_error)
+            {
+                report_sphere_error(line, gets_error);
+                badinput = 1;
+                continue;
+            }
+            (*size)++;
+        }
+    }
+    if(badinput || error_exit)
+    {
+        free(model);
+        return NULL;
+    }
+    /* Adjust the size of the model */
+    if(*size != 0)
+    {
+        tmp = (SPHERE *)realloc(model, (*size)*sizeof(SPHERE));
+        if(tmp == NULL)
+        {
+            /* Need to free because realloc leaves unchanged in case of
+                error */
+            free(model);
+            log_error("problem freeing excess memory for sphere model.");
+            return NULL;
+        }
+        model = tmp;
+    }
+    return model;
+}
+
+
 /* Read the coordinates, height, thickness and densities of the layers */
 int gets_layers(const char *str, double dlon, double dlat,
     TESSEROID *tessbuff, int buffsize)
 {
     int nlayers, end, nchars, argsread;
-    double lon, lat, height, top, thickness, density;
+    double values[3], lon, lat, height, top, thickness, density;
 
-    argsread = sscanf(str, "%lf %lf %lf%n", &lon, &lat, &height, &nchars);
+    argsread = scan_doubles(str, values, 3, &nchars);
     if(argsread != 3)
     {
         log_error("failed to read lon, lat, and height");
         return -1;
     }
+    lon = values[0];
+    lat = values[1];
+    height = values[2];
     if(str[nchars] == '\0')
     {
         log_error("missing thickness and density values");
@@ -1381,13 +2982,14 @@ int gets_layers(const char *str, double dlon, double dlat,
             log_error("too many layers! Max = %d", buffsize);
             return -1;
         }
-        argsread = sscanf(str + end, "%lf %lf%n", &thickness, &density,
-                          &nchars);
+        argsread = scan_doubles(str + end, values, 2, &nchars);
         if(argsread != 2)
         {
             log_error("missing thickness or density value");
             return -1;
         }
+        thickness = values[0];
+        density = values[1];
         if(thickness < 0)
         {
             log_error("can't have negative thickness");
@@ -1408,3 +3010,157 @@ int gets_layers(const char *str, double dlon, double dlat,
     return nlayers;
 }
 
+
+/* Read a regular grid of stacked layers from an open file and store it as a
+grid model. */
+TESS_GRID * read_tess_grid(FILE *gridfile, double dlon, double dlat)
+{
+    #define LAYERSBUFFSIZE 1000
+    TESSEROID tessbuff[LAYERSBUFFSIZE];
+    TESS_GRID *grid = NULL;
+    double *points = NULL, *tmp, *point, minlon = 0, maxlon = 0, minlat = 0,
+           maxlat = 0;
+    int buffsize = 100, npoints = 0, stride = 0, nlayers = -1, line, l, i, j,
+        cell, nlon, nlat, error_exit = 0;
+    char sbuff[10000], *filled = NULL;
+
+    for(line = 1; !feof(gridfile); line++)
+    {
+        if(fgets(sbuff, 10000, gridfile) == NULL)
+        {
+            if(ferror(gridfile))
+            {
+                log_error("problem encountered reading line %d.", line);
+                error_exit = 1;
+                break;
+            }
+            continue;
+        }
+        /* Check for comments and blank lines */
+        if(sbuff[0] == '#' || sbuff[0] == '\r' || sbuff[0] == '\n')
+        {
+            continue;
+        }
+        strstrip(sbuff);
+        l = gets_layers(sbuff, dlon, dlat, tessbuff, LAYERSBUFFSIZE);
+        if(l == -1)
+        {
+            log_error("invalid input in line %d.", line);
+            error_exit = 1;
+            break;
+        }
+        if(nlayers == -1)
+        {
+            /* Store lon, lat, the interface radii and the densities */
+            nlayers = l;
+            stride = 2 + (nlayers + 1) + nlayers;
+            points = (double *)malloc(buffsize*stride*sizeof(double));
+            if(points == NULL)
+            {
+                log_error("problem allocating memory to load grid model.");
+                error_exit = 1;
+                break;
+            }
+        }
+        if(l != nlayers)
+        {
+            log_error("different number of layers in line %d than in previous lines",
+                      line);
+            error_exit = 1;
+            break;
+        }
+        if(npoints == buffsize)
+        {
+            buffsize += buffsize;
+            tmp = (double *)realloc(points, buffsize*stride*sizeof(double));
+            if(tmp == NULL)
+            {
+                log_error("problem expanding memory for grid model. Model is too big.");
+                error_exit = 1;
+                break;
+            }
+            points = tmp;
+        }
+        point = points + (size_t)npoints*stride;
+        point[0] = 0.5*(tessbuff[0].w + tessbuff[0].e);
+        point[1] = 0.5*(tessbuff[0].s + tessbuff[0].n);
+        point[2] = tessbuff[0].r2;
+        for(l = 0; l < nlayers; l++)
+        {
+            point[3 + l] = tessbuff[l].r1;
+            point[3 + nlayers + l] = tessbuff[l].density;
+        }
+        if(npoints == 0 || point[0] < minlon)
+            minlon = point[0];
+        if(npoints == 0 || point[0] > maxlon)
+            maxlon = point[0];
+        if(npoints == 0 || point[1] < minlat)
+            minlat = point[1];
+        if(npoints == 0 || point[1] > maxlat)
+            maxlat = point[1];
+        npoints++;
+    }
+    if(error_exit || npoints == 0)
+    {
+        if(npoints == 0 && !error_exit)
+        {
+            log_error("grid model is empty.");
+        }
+        free(points);
+        return NULL;
+    }
+    /* Put the points in the cells of the grid */
+    nlon = (int)((maxlon - minlon)/dlon + 0.5) + 1;
+    nlat = (int)((maxlat - minlat)/dlat + 0.5) + 1;
+    if(nlon*nlat != npoints)
+    {
+        log_error("grid model has %d points but should have %d x %d = %d. Is the grid spacing right?",
+                  npoints, nlon, nlat, nlon*nlat);
+        free(points);
+        return NULL;
+    }
+    grid = new_tess_grid(minlon - 0.5*dlon, minlat - 0.5*dlat, dlon, dlat,
+                         nlon, nlat, nlayers);
+    filled = (char *)calloc(npoints, sizeof(char));
+    if(grid == NULL || filled == NULL)
+    {
+        log_error("problem allocating memory for grid model.");
+        if(grid != NULL)
+            free_tess_grid(grid);
+        free(filled);
+        free(points);
+        return NULL;
+    }
+    for(cell = 0; cell < npoints; cell++)
+    {
+        point = points + (size_t)cell*stride;
+        i = (int)((point[0] - minlon)/dlon + 0.5);
+        j = (int)((point[1] - minlat)/dlat + 0.5);
+        if(filled[j*nlon + i])
+        {
+            log_error("repeated grid point lon=%g lat=%g.", point[0],
+                      point[1]);
+            error_exit = 1;
+            break;
+        }
+        filled[j*nlon + i] = 1;
+        for(l = 0; l <= nlayers; l++)
+        {
+            grid->radii[(size_t)(j*nlon + i)*(nlayers + 1) + l] = point[2 + l];
+        }
+        for(l = 0; l < nlayers; l++)
+        {
+            grid->density[(size_t)(j*nlon + i)*nlayers + l] =
+                point[3 + nlayers + l];
+        }
+    }
+    free(filled);
+    free(points);
+    if(error_exit)
+    {
+        free_tess_grid(grid);
+        return NULL;
+    }
+    return grid;
+    #undef LAYERSBUFFSIZE
+}
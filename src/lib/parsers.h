@@ -11,6 +11,22 @@ Input and output parsing tools.
 /* Need for the definition of FILE */
 #include <stdio.h>
 
+/** Regular grid of computation points given with options -r, -b and -z
+(same as the grid made by tessgrd) */
+typedef struct points_grid_args
+{
+    int parsed; /**< which of -r (1), -b (2) and -z (4) were given. 0 means
+                     the points are read from stdin */
+    double w; /**< western border of the grid */
+    double e; /**< eastern border of the grid */
+    double s; /**< southern border of the grid */
+    double n; /**< northern border of the grid */
+    int nlon; /**< number of grid points in the longitudinal direction */
+    int nlat; /**< number of grid points in the latitudinal direction */
+    double height; /**< height of the grid */
+} POINTS_GRID_ARGS;
+
+
 /** Store basic input arguments and option flags */
 typedef struct basic_args
 {
@@ -18,6 +34,18 @@ typedef struct basic_args
     int verbose; /**< flag to indicate if verbose printing is enabled */
     int logtofile; /**< flag to indicate if logging to a file is enabled */
     char *logfname; /**< name of the log file */
+    int binary; /**< flag to indicate if the computation points are read and
+                     written in binary (see binpoints.h) */
+    int precision; /**< number of significant digits of the output */
+    POINTS_GRID_ARGS grid; /**< grid of computation points */
+    int nthreads; /**< number of threads used for the calculation. 0 means
+                       use one per processor */
+    char *components; /**< comma separated names of the components to
+                           output. NULL means all of them */
+    double cutoff; /**< only use the prisms within this distance (in meters)
+                        of each computation point. 0 means use all */
+    int farfield; /**< flag to indicate that the prisms beyond the cutoff
+                       distance are approximated instead of left out */
 } BASIC_ARGS;
 
 
@@ -46,6 +74,34 @@ typedef struct tess2prism_args
 } TESS2PRISM_ARGS;
 
 
+/** Store input arguments and option flags for prismfft program */
+typedef struct prismfft_args
+{
+    char *inputfname; /**< name of the input file */
+    int verbose; /**< flag to indicate if verbose printing is enabled */
+    int logtofile; /**< flag to indicate if logging to a file is enabled */
+    char *logfname; /**< name of the log file */
+    double height; /**< height of the computation points */
+    int nterms; /**< number of terms of the Parker expansion */
+    int padding; /**< the grid is padded to this many times its size */
+    int precision; /**< number of significant digits of the output */
+} PRISMFFT_ARGS;
+
+
+/** Store input arguments and option flags for tess2tiles program */
+typedef struct tess2tiles_args
+{
+    char *inputfname; /**< name of the input file */
+    char *outputfname; /**< name of the output binary file */
+    int verbose; /**< flag to indicate if verbose printing is enabled */
+    int logtofile; /**< flag to indicate if logging to a file is enabled */
+    char *logfname; /**< name of the log file */
+    double tilesize; /**< size of the tiles in degrees */
+    int sort_model; /**< flag to indicate that the model is reordered along a
+                         Hilbert curve */
+} TESS2TILES_ARGS;
+
+
 /** Store input arguments and option flags for tessmodgen program */
 typedef struct tessmodgen_args
 {
@@ -84,6 +140,27 @@ typedef struct tessg_args
     int adaptative; /**< flat to indicate wether to use the adaptative size
                          of tesseroid algorithm */
     double ratio; /**< distance-size ratio used for recusive division */
+    int binary; /**< flag to indicate if the computation points are read and
+                     written in binary (see binpoints.h) */
+    int grid_model; /**< flag to indicate that the model file is a regular
+                         grid of layers (see read_tess_grid()) */
+    double grid_dlon; /**< grid spacing in longitude of the grid model */
+    double grid_dlat; /**< grid spacing in latitude of the grid model */
+    double lod_ratio; /**< distance-size ratio used for the coarse levels of
+                           the multi-resolution pyramid of a grid model */
+    double cutoff; /**< only use the tesseroids within this distance (in
+                        meters) of each computation point */
+    int precision; /**< number of significant digits of the output */
+    int nthreads; /**< number of threads used for the calculation. 0 means
+                       use one per processor */
+    POINTS_GRID_ARGS grid; /**< grid of computation points */
+    int resultstofile; /**< flag to indicate that the results are written to
+                            a binary result file (see create_binresults()) */
+    char *resultsfname; /**< name of the binary result file */
+    int sort_points; /**< flag to indicate that the computation points are
+                          calculated in the order of a Hilbert curve */
+    int sort_model; /**< flag to indicate that the model is reordered along a
+                         Hilbert curve */
 } TESSG_ARGS;
 
 
@@ -100,13 +177,17 @@ typedef struct tessgrd_args
     int verbose; /**< flag to indicate if verbose printing is enabled */
     int logtofile; /**< flag to indicate if logging to a file is enabled */
     char *logfname; /**< name of the log file */
+    int precision; /**< number of significant digits of the output */
 } TESSGRD_ARGS;
 
 
 /** Parse basic command line arguments for programs
 
 Basic arguments are: -h (for help msg), -v (for verbose), -l (for log file),
---version and an input file.
+--version, --binary (for binary computation points), -r/-b/-z (for a grid of
+computation points, see parse_points_grid_arg()), -j (for the number of
+threads), -s (for the output components), -c and --far-field (for the cutoff
+distance) and an input file.
 
 @param argc number of command line arguments
 @param argv command line arguments
@@ -163,6 +244,43 @@ extern int parse_tess2prism_args(int argc, char **argv, const char *progname,
                             TESS2PRISM_ARGS *args, void (*print_help)(void));
 
 
+/** Parse command line arguments for prismfft program
+
+@param argc number of command line arguments
+@param argv command line arguments
+@param progname name of the program
+@param args to return the parsed arguments
+@param print_help pointer to a function that prints the help message for the
+                  program
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there were bad arguments and program should exit
+    - 2: if printed help or version info and program should exit
+    - 3: if input file was missing (doesn't log an error)
+*/
+extern int parse_prismfft_args(int argc, char **argv, const char *progname,
+                               PRISMFFT_ARGS *args, void (*print_help)(void));
+
+
+/** Parse command line arguments for tess2tiles program
+
+@param argc number of command line arguments
+@param argv command line arguments
+@param progname name of the program
+@param args to return the parsed arguments
+@param print_help pointer to a function that prints the help message for the
+                  program
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there were bad arguments and program should exit
+    - 2: if printed help or version info and program should exit
+*/
+extern int parse_tess2tiles_args(int argc, char **argv, const char *progname,
+                            TESS2TILES_ARGS *args, void (*print_help)(void));
+
+
 /** Parse command line arguments for tessmodgen program
 
 @param argc number of command line arguments
@@ -217,6 +335,47 @@ extern int parse_tessg_args(int argc, char **argv, const char *progname,
                             TESSG_ARGS *args, void (*print_help)(const char *));
 
 
+/** Parse one of the options -r, -b and -z that define a grid of computation
+points
+
+The options have the same format as in tessgrd: -rW/E/S/N, -bNLON/NLAT and
+-zHEIGHT. Use check_points_grid_args() after parsing all arguments.
+
+logs the bad argument warnings using logger.h
+
+@param arg the command line argument (starting with -r, -b or -z)
+@param grid to return the parsed values
+
+@return 0 if all went well, 1 if the argument is bad or repeated
+*/
+extern int parse_points_grid_arg(const char *arg, POINTS_GRID_ARGS *grid);
+
+
+/** Check that the options -r, -b and -z are either all given or not at all
+
+logs the error using logger.h
+
+@param grid the parsed values
+
+@return 0 if all went well, 1 if some of the options are missing
+*/
+extern int check_points_grid_args(const POINTS_GRID_ARGS *grid);
+
+
+/** Get the coordinates of a point of a grid given with -r, -b and -z
+
+The points are ordered by rows of constant latitude, from south to north, and
+from west to east along each row. The first and last points of each row and
+column are on the borders of the grid.
+
+@param grid the grid
+@param i index of the point (from 0 to nlon*nlat - 1)
+@param point used to return the longitude, latitude and height of the point
+*/
+extern void points_grid_point(const POINTS_GRID_ARGS *grid, long i,
+                              double *point);
+
+
 /** Parse command line arguments for tessgrd program
 
 logs the bad argument warnings using logger.h
@@ -243,6 +402,70 @@ Done IN PLACE!
 extern void strstrip(char *str);
 
 
+/** Read numbers separated by white space from a string.
+
+Works like sscanf(str, "%lf %lf ...%n", ...) but is much faster for the
+common decimal formats (like 1.5, -20 and 6.67e-11). Numbers with up to 15
+significant digits and small exponents are converted exactly in this function.
+Other numbers (more digits, inf, nan, hexadecimal) are converted with strtod.
+The results are the same as strtod in the "C" locale. The decimal point is
+always '.'.
+
+@param str string with the numbers
+@param values used to return the numbers read
+@param n maximum number of values to read
+@param nchars used to return the number of characters used from str
+
+@return the number of values read
+*/
+extern int scan_doubles(const char *str, double *values, int n, int *nchars);
+
+
+/** Format a number as text.
+
+Gives the same text as sprintf(str, "%.*g", digits, value) but is several
+times faster for up to 15 digits. The decimal point is always '.'.
+
+@param str used to return the text. Needs space for at least 25 characters
+           (the longest text is like -1.2345678901234567e-308)
+@param value the number
+@param digits number of significant digits (precision), up to 17
+
+@return the number of characters written (without the final '\0')
+*/
+extern int format_double(char *str, double value, int digits);
+
+
+/** Format numbers separated by spaces into a string.
+
+Uses format_double() to format the numbers.
+
+@param str string with room for at least 25 characters per number (see
+           format_double())
+@param values the numbers to format
+@param n how many numbers to format
+@param digits number of significant digits (precision), up to 17
+
+@return the number of characters written (without the final '\0')
+*/
+extern int format_doubles(char *str, const double *values, int n, int digits);
+
+
+/** Print numbers separated by spaces and end the line.
+
+Uses format_double() to format the numbers.
+
+@param stream open FILE for writing
+@param prefix string printed before the numbers (followed by a space). Use NULL
+              to print only the numbers.
+@param values the numbers to print
+@param n how many numbers to print
+@param digits number of significant digits (precision)
+*/
+extern void print_doubles(FILE *stream, const char *prefix,
+                          const double *values, int n, int digits);
+
+
 /** Read a single tesseroid from a string
 
 @param str string with the tesseroid parameters
@@ -255,14 +478,19 @@ extern int gets_tess(const char *str, TESSEROID *tess);
 
 /** Read tesseroids from an open file and store them in an array.
 
+If the file is a regular file that hasn't been read yet, it is memory mapped
+and split in chunks (at the start of lines) that are parsed by several
+threads. Otherwise, the file is read line by line.
+
 Allocates memory. Don't forget to free 'model'!
 
 @param modelfile open FILE for reading with the tesseroid model
 @param size used to return the size of the model read
 
-@return pointer to array with the model. NULL if there was an error
+@return pointer to array with the model. NULL if there was an error. May be
+        NULL if the model is empty (size 0).
 */
-extern TESSEROID * read_tess_model(FILE *modelfile, int *size);
+extern TESSEROID * read_tess_model(FILE *modelfile, long *size);
 
 
 /** Read a single rectangular prism from a string
@@ -288,6 +516,8 @@ extern int gets_prism_sph(const char *str, PRISM *prism);
 
 /** Read rectangular prisms from an open file and store them in an array.
 
+Large files are parsed in parallel like in read_tess_model().
+
 Allocates memory. Don't forget to free 'model'!
 
 @param modelfile open FILE for reading with the model
@@ -295,11 +525,44 @@ Allocates memory. Don't forget to free 'model'!
 well
 @param size used to return the size of the model read
 
-@return pointer to array with the model. NULL if there was an error
+@return pointer to array with the model. NULL if there was an error. May be
+        NULL if the model is empty (size 0).
 */
 extern PRISM * read_prism_model(FILE *modelfile, int pos, int *size);
 
 
+/** Read a single sphere from a string
+
+The string has the longitude and latitude (in degrees) and the height (in
+meters, relative to the mean Earth radius) of the center of the sphere, its
+radius and its density:
+
+    lon lat height radius density
+
+@param str string with the sphere parameters
+@param sphere used to return the read sphere
+
+@return 0 if all went well, 1 if failed to read, 2 if the radius isn't
+        positive.
+*/
+extern int gets_sphere(const char *str, SPHERE *sphere);
+
+
+/** Read spheres from an open file and store them in an array.
+
+Large files are parsed in parallel like in read_tess_model().
+
+Allocates memory. Don't forget to free 'model'!
+
+@param modelfile open FILE for reading with the model
+@param size used to return the size of the model read
+
+@return pointer to array with the model. NULL if there was an error. May be
+        NULL if the model is empty (size 0).
+*/
+extern SPHERE * read_sphere_model(FILE *modelfile, int *size);
+
+
 /** Read the coordinates, height, thickness and densities of the layers and
 convert it to tesseroids.
 
@@ -313,4 +576,24 @@ convert it to tesseroids.
 */
 extern int gets_layers(const char *str, double dlon, double dlat,
     TESSEROID *tessbuff, int buffsize);
+
+
+/** Read a regular grid of stacked layers from an open file and store it as a
+grid model.
+
+The file has the same format as the input of tesslayers, i.e., in columns:
+lon lat height thickness1 dens1 thickness2 dens2 ...
+lon and lat are the center of the grid cells. All grid points must have the
+same number of layers and the grid must be complete (no missing points), but
+the points can be in any order.
+
+Allocates memory. Don't forget to free the grid with free_tess_grid()!
+
+@param gridfile open FILE for reading with the grid
+@param dlon the grid spacing (size of the cells) in the longitudinal direction
+@param dlat the grid spacing (size of the cells) in the latitudinal direction
+
+@return pointer to the grid model. NULL if there was an error
+*/
+extern TESS_GRID * read_tess_grid(FILE *gridfile, double dlon, double dlat);
 #endif
@@ -0,0 +1,330 @@
+/*
+Spatial index of prism models.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include "constants.h"
+#include "geometry.h"
+#include "prism_index.h"
+
+
+/* Minimum average number of prisms in each bucket */
+#define PRISM_INDEX_MIN_PRISMS 16
+
+
+/* Angular distance between two points on the sphere in degrees (haversine
+formula, which is accurate for small distances) */
+static double arc_distance(double lon1, double lat1, double lon2,
+                           double lat2)
+{
+    double d2r = PI/180., sdlat, sdlon, h;
+
+    sdlat = sin(0.5*d2r*(lat2 - lat1));
+    sdlon = sin(0.5*d2r*(lon2 - lon1));
+    h = sdlat*sdlat + cos(d2r*lat1)*cos(d2r*lat2)*sdlon*sdlon;
+    if(h > 1)
+    {
+        h = 1;
+    }
+    return 2*asin(sqrt(h))/d2r;
+}
+
+
+/* Horizontal position of a prism used to put it in a bucket */
+static void prism_position(const PRISM *prism, int spherical, double *a,
+                           double *b)
+{
+    if(spherical)
+    {
+        *a = prism->lon;
+        *b = prism->lat;
+    }
+    else
+    {
+        *a = 0.5*(prism->x1 + prism->x2);
+        *b = 0.5*(prism->y1 + prism->y2);
+    }
+}
+
+
+/* Find the center and the radius of a tile and the cube with its mass */
+static void prism_tile_geometry(const PRISM *model, int spherical,
+                                PRISM_TILE *tile)
+{
+    const PRISM *prism;
+    double d2r = PI/180., mina, maxa, minb, maxb, a1, a2, b1, b2, da, db, dist,
+           volume, mass, weight, sumw = 0, sumv = 0, summ = 0, cx = 0, cy = 0,
+           cz = 0, rc = 0, side, lon, lat;
+    int i;
+
+    mina = maxa = minb = maxb = 0;
+    for(i = 0; i < tile->size; i++)
+    {
+        prism = &model[tile->start + i];
+        if(spherical)
+        {
+            a1 = a2 = prism->lon;
+            b1 = b2 = prism->lat;
+        }
+        else
+        {
+            a1 = prism->x1;
+            a2 = prism->x2;
+            b1 = prism->y1;
+            b2 = prism->y2;
+        }
+        if(i == 0 || a1 < mina)
+            mina = a1;
+        if(i == 0 || a2 > maxa)
+            maxa = a2;
+        if(i == 0 || b1 < minb)
+            minb = b1;
+        if(i == 0 || b2 > maxb)
+            maxb = b2;
+    }
+    tile->a = 0.5*(mina + maxa);
+    tile->b = 0.5*(minb + maxb);
+    tile->radius = 0;
+    for(i = 0; i < tile->size; i++)
+    {
+        prism = &model[tile->start + i];
+        volume = (prism->x2 - prism->x1)*(prism->y2 - prism->y1)*
+                 (prism->z2 - prism->z1);
+        mass = prism->density*volume;
+        weight = fabs(mass);
+        sumv += volume;
+        summ += mass;
+        sumw += weight;
+        if(spherical)
+        {
+            dist = arc_distance(tile->a, tile->b, prism->lon, prism->lat) +
+                   0.5*sqrt(pow(prism->x2 - prism->x1, 2) +
+                            pow(prism->y2 - prism->y1, 2))/(d2r*prism->r);
+            /* The center of mass is found in geocentric coordinates */
+            rc += weight*(prism->r - 0.5*(prism->z1 + prism->z2));
+            cx += weight*cos(d2r*prism->lat)*cos(d2r*prism->lon);
+            cy += weight*cos(d2r*prism->lat)*sin(d2r*prism->lon);
+            cz += weight*sin(d2r*prism->lat);
+        }
+        else
+        {
+            da = fabs(prism->x1 - tile->a) > fabs(prism->x2 - tile->a) ?
+                 fabs(prism->x1 - tile->a) : fabs(prism->x2 - tile->a);
+            db = fabs(prism->y1 - tile->b) > fabs(prism->y2 - tile->b) ?
+                 fabs(prism->y1 - tile->b) : fabs(prism->y2 - tile->b);
+            dist = sqrt(da*da + db*db);
+            cx += weight*0.5*(prism->x1 + prism->x2);
+            cy += weight*0.5*(prism->y1 + prism->y2);
+            cz += weight*0.5*(prism->z1 + prism->z2);
+        }
+        if(dist > tile->radius)
+        {
+            tile->radius = dist;
+        }
+    }
+    tile->hasmass = summ != 0 && sumw > 0;
+    if(!tile->hasmass)
+    {
+        return;
+    }
+    /* The cube has the volume of the prisms but fits inside the tile */
+    side = pow(sumv, 1./3.);
+    if(spherical)
+    {
+        rc /= sumw;
+        if(side > d2r*tile->radius*rc && tile->radius > 0)
+        {
+            side = d2r*tile->radius*rc;
+        }
+        lon = atan2(cy, cx)/d2r;
+        lat = atan2(cz, sqrt(cx*cx + cy*cy))/d2r;
+        tile->far.x1 = -0.5*side;
+        tile->far.x2 = 0.5*side;
+        tile->far.y1 = -0.5*side;
+        tile->far.y2 = 0.5*side;
+        tile->far.z1 = 0;
+        tile->far.z2 = side;
+        tile->far.lon = lon;
+        tile->far.lat = lat;
+        tile->far.r = rc + 0.5*side;
+    }
+    else
+    {
+        if(side > tile->radius && tile->radius > 0)
+        {
+            side = tile->radius;
+        }
+        cx /= sumw;
+        cy /= sumw;
+        cz /= sumw;
+        tile->far.x1 = cx - 0.5*side;
+        tile->far.x2 = cx + 0.5*side;
+        tile->far.y1 = cy - 0.5*side;
+        tile->far.y2 = cy + 0.5*side;
+        tile->far.z1 = cz - 0.5*side;
+        tile->far.z2 = cz + 0.5*side;
+        tile->far.lon = 0;
+        tile->far.lat = 0;
+        tile->far.r = 0;
+    }
+    tile->far.density = summ/(side*side*side);
+}
+
+
+/* Build a spatial index of a prism model. */
+PRISM_INDEX * new_prism_index(PRISM *model, int size, int spherical,
+                              double tilesize)
+{
+    PRISM_INDEX *index;
+    PRISM *sorted;
+    double mina, maxa, minb, maxb, a, b, bucket, bucketa, bucketb;
+    int *buckets, *count, na, nb, i, k, t;
+
+    index = (PRISM_INDEX *)malloc(sizeof(PRISM_INDEX));
+    if(index == NULL)
+    {
+        return NULL;
+    }
+    index->spherical = spherical;
+    index->ntiles = 0;
+    index->tiles = NULL;
+    buckets = (int *)malloc(size*sizeof(int));
+    sorted = (PRISM *)malloc(size*sizeof(PRISM));
+    if(buckets == NULL || sorted == NULL)
+    {
+        free(buckets);
+        free(sorted);
+        free(index);
+        return NULL;
+    }
+    prism_position(&model[0], spherical, &mina, &minb);
+    maxa = mina;
+    maxb = minb;
+    for(i = 0; i < size; i++)
+    {
+        prism_position(&model[i], spherical, &a, &b);
+        if(a < mina)
+            mina = a;
+        if(a > maxa)
+            maxa = a;
+        if(b < minb)
+            minb = b;
+        if(b > maxb)
+            maxb = b;
+    }
+    bucket = spherical ? (tilesize/MEAN_EARTH_RADIUS)*180./PI : tilesize;
+    /* Don't make too many buckets for the number of prisms. The area is zero
+     * if the prisms are on a single line, so also limit the buckets along
+     * each dimension. */
+    if(bucket < sqrt((maxa - mina)*(maxb - minb)*PRISM_INDEX_MIN_PRISMS/size))
+    {
+        bucket = sqrt((maxa - mina)*(maxb - minb)*PRISM_INDEX_MIN_PRISMS/size);
+    }
+    bucketa = bucket;
+    bucketb = bucket;
+    if(bucketa < (maxa - mina)*PRISM_INDEX_MIN_PRISMS/size)
+    {
+        bucketa = (maxa - mina)*PRISM_INDEX_MIN_PRISMS/size;
+    }
+    if(bucketb < (maxb - minb)*PRISM_INDEX_MIN_PRISMS/size)
+    {
+        bucketb = (maxb - minb)*PRISM_INDEX_MIN_PRISMS/size;
+    }
+    if(bucketa <= 0)
+    {
+        bucketa = 1;
+    }
+    if(bucketb <= 0)
+    {
+        bucketb = 1;
+    }
+    /* At most size/16*3 + 1 buckets, but check anyway that they fit in an
+     * int */
+    count = NULL;
+    if(((maxa - mina)/bucketa + 1)*((maxb - minb)/bucketb + 1) < INT_MAX)
+    {
+        na = (int)((maxa - mina)/bucketa) + 1;
+        nb = (int)((maxb - minb)/bucketb) + 1;
+        count = (int *)calloc((size_t)na*nb + 1, sizeof(int));
+    }
+    if(count == NULL)
+    {
+        free(buckets);
+        free(sorted);
+        free(index);
+        return NULL;
+    }
+    /* Count the prisms in each bucket and then put them in place */
+    for(i = 0; i < size; i++)
+    {
+        prism_position(&model[i], spherical, &a, &b);
+        buckets[i] = (int)((b - minb)/bucketb)*na +
+                     (int)((a - mina)/bucketa);
+        if(count[buckets[i]] == 0)
+        {
+            index->ntiles++;
+        }
+        count[buckets[i]]++;
+    }
+    index->tiles = (PRISM_TILE *)malloc(index->ntiles*sizeof(PRISM_TILE));
+    if(index->tiles == NULL)
+    {
+        free(count);
+        free(buckets);
+        free(sorted);
+        free(index);
+        return NULL;
+    }
+    for(k = 0, t = 0, i = 0; k < na*nb; k++)
+    {
+        if(count[k] > 0)
+        {
+            index->tiles[t].start = i;
+            index->tiles[t].size = count[k];
+            t++;
+        }
+        i += count[k];
+        count[k] = i - count[k];
+    }
+    for(i = 0; i < size; i++)
+    {
+        sorted[count[buckets[i]]] = model[i];
+        count[buckets[i]]++;
+    }
+    memcpy(model, sorted, size*sizeof(PRISM));
+    free(count);
+    free(buckets);
+    free(sorted);
+    for(t = 0; t < index->ntiles; t++)
+    {
+        prism_tile_geometry(model, spherical, &index->tiles[t]);
+    }
+    return index;
+}
+
+
+/* Free the memory allocated by new_prism_index(). */
+void free_prism_index(PRISM_INDEX *index)
+{
+    free(index->tiles);
+    free(index);
+}
+
+
+/* Horizontal distance from a computation point to the closest possible prism
+of a tile. */
+double prism_tile_distance(const PRISM_TILE *tile, int spherical, double a,
+                           double b)
+{
+    if(spherical)
+    {
+        return (arc_distance(tile->a, tile->b, a, b) - tile->radius)*
+               (PI/180.)*MEAN_EARTH_RADIUS;
+    }
+    return sqrt((a - tile->a)*(a - tile->a) + (b - tile->b)*(b - tile->b)) -
+           tile->radius;
+}
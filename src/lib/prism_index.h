@@ -0,0 +1,92 @@
+/*
+Spatial index of prism models.
+
+The prisms are put in the buckets of a regular grid over their horizontal
+positions (the centers of the prisms in Cartesian coordinates or their
+longitudes and latitudes in spherical coordinates). The prisms of each
+non-empty bucket form a tile. The tiles that are far enough from a computation
+point can be left out of the calculation or replaced by a single prism with the
+mass of the tile at its center of mass (the far field).
+*/
+
+
+#ifndef _TESSEROIDS_PRISM_INDEX_H_
+#define _TESSEROIDS_PRISM_INDEX_H_
+
+
+/* Needed for definition of PRISM */
+#include "geometry.h"
+
+
+/** The prisms of a bucket of the index */
+typedef struct prism_tile_struct {
+    int start; /**< index of the first prism of the tile in the model */
+    int size; /**< number of prisms in the tile */
+    double a; /**< x (Cartesian) or longitude in degrees (spherical) of the
+                   center of the tile */
+    double b; /**< y (Cartesian) or latitude in degrees (spherical) of the
+                   center of the tile */
+    double radius; /**< all the prisms are within this horizontal distance of
+                        the center (in meters for Cartesian and degrees of
+                        arc for spherical) */
+    int hasmass; /**< if the mass of the tile is not zero */
+    PRISM far; /**< a cube with the mass of the tile, centered on the center
+                    of mass of the prisms (weighted by the absolute values of
+                    their masses). Only if hasmass */
+} PRISM_TILE;
+
+
+/** A model sorted into tiles (see new_prism_index()) */
+typedef struct prism_index_struct {
+    int spherical; /**< if the prisms are in spherical coordinates */
+    int ntiles; /**< number of tiles */
+    PRISM_TILE *tiles; /**< the tiles, in the order of their prisms */
+} PRISM_INDEX;
+
+
+/** Build a spatial index of a prism model.
+
+The prisms of the model are reordered so that the prisms of each tile are
+consecutive. The size of the buckets is at least tilesize but is increased so
+that there are on average at least 16 prisms in each bucket, in total and
+along each dimension (for prisms on a single line).
+
+<b>WARNING</b>: Don't forget to free the memory using free_prism_index()!
+
+@param model the prisms. Are reordered by tile.
+@param size number of prisms in the model
+@param spherical 1 if the prisms are in spherical coordinates (as read by
+                 read_prism_model() with pos = 1), 0 if in Cartesian
+@param tilesize minimum size of the buckets in meters (along the surface of
+                the mean Earth for spherical prisms)
+
+@return pointer to the index. NULL if there was an error allocating memory.
+*/
+extern PRISM_INDEX * new_prism_index(PRISM *model, int size, int spherical,
+                                     double tilesize);
+
+
+/** Free the memory allocated by new_prism_index().
+
+@param index pointer to the index
+*/
+extern void free_prism_index(PRISM_INDEX *index);
+
+
+/** Horizontal distance from a computation point to the closest possible prism
+of a tile.
+
+The distance is measured from the circle that contains the prisms of the tile.
+For spherical prisms, it is measured along the surface of the mean Earth.
+
+@param tile the tile
+@param spherical 1 if the prisms are in spherical coordinates
+@param a x (Cartesian) or longitude in degrees (spherical) of the point
+@param b y (Cartesian) or latitude in degrees (spherical) of the point
+
+@return the distance in meters. Negative if the point is inside the circle.
+*/
+extern double prism_tile_distance(const PRISM_TILE *tile, int spherical,
+                                  double a, double b);
+
+#endif
@@ -0,0 +1,507 @@
+/*
+Generic main function for the prism programs.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "logger.h"
+#include "version.h"
+#include "geometry.h"
+#include "constants.h"
+#include "grav_prism_soa.h"
+#include "grav_prism_sph.h"
+#include "parsers.h"
+#include "model_cache.h"
+#include "batch_calc.h"
+#include "prism_index.h"
+#include "prism_main.h"
+
+
+/* The model is split into chunks of at least this many prisms... */
+#define PRISM_CHUNK_SIZE 4096
+/* ...but into no more than this many chunks */
+#define PRISM_MAX_CHUNKS 64
+/* Size of the tiles of the model relative to the cutoff distance */
+#define PRISM_TILE_CUTOFF 0.5
+
+
+/* The model split into tiles and the tiles into chunks. It is shared by all
+threads. */
+typedef struct prism_calc_struct
+{
+    const PRISM_FIELD *field;
+    double cutoff; /* only the tiles within this distance of a point are
+                      calculated exactly. 0 to calculate all of them */
+    int farfield; /* if the tiles beyond the cutoff are replaced by the cubes
+                     with their mass */
+    int ntiles;
+    PRISM_TILE *tiles; /* without a cutoff, the tiles are just consecutive
+                          prisms */
+    int nchunks;
+    int chunks[PRISM_MAX_CHUNKS + 1]; /* first tile of each chunk */
+    PRISM_SOA **soa; /* each tile in Cartesian coordinates */
+    PRISM_SOA **farsoa; /* the cube of each tile in Cartesian coordinates */
+    PRISM *model; /* the prisms in spherical coordinates */
+    SPH_FRAME *frames; /* and their frames */
+    SPH_FRAME *farframes; /* the frames of the cubes of the tiles */
+} PRISM_CALC;
+
+
+/* Calculate all components of the field of a chunk of the model on the points
+of a batch. The tiles beyond the cutoff distance of a point are skipped or
+replaced by their cubes. */
+static void calc_prism_chunk(const void *model, int chunk, int npoints,
+                             const int *ispoint, const double *points,
+                             double *results)
+{
+    const PRISM_CALC *calc = (const PRISM_CALC *)model;
+    const PRISM_FIELD *field = calc->field;
+    const PRISM_TILE *tile;
+    const double *point;
+    SPH_FRAME pointframe;
+    double *res, tmp[PRISM_MAX_COMPONENTS], x, y, z, a, b;
+    int ncomp = field->ncomponents, k, t, i, c;
+
+    for(k = 0; k < npoints; k++)
+    {
+        if(!ispoint[k])
+        {
+            continue;
+        }
+        point = points + 3*k;
+        res = results + k*ncomp;
+        for(c = 0; c < ncomp; c++)
+        {
+            res[c] = 0;
+        }
+        if(field->spherical)
+        {
+            /* x, y and z are only used by the Cartesian kernels */
+            x = y = z = 0;
+            a = point[0];
+            b = point[1];
+            sph_frame(point[0], point[1], point[2] + MEAN_EARTH_RADIUS,
+                      &pointframe);
+        }
+        else
+        {
+            /* The points are y, x and height */
+            x = a = point[1];
+            y = b = point[0];
+            z = -point[2];
+        }
+        for(t = calc->chunks[chunk]; t < calc->chunks[chunk + 1]; t++)
+        {
+            tile = &calc->tiles[t];
+            if(calc->cutoff > 0 &&
+               prism_tile_distance(tile, field->spherical, a, b) >
+               calc->cutoff)
+            {
+                if(!calc->farfield || !tile->hasmass)
+                {
+                    continue;
+                }
+                if(field->soa != NULL)
+                {
+                    res[0] += field->soa(calc->farsoa[t], x, y, z);
+                    continue;
+                }
+                field->sph(tile->far, &calc->farframes[t], &pointframe, tmp);
+                for(c = 0; c < ncomp; c++)
+                {
+                    res[c] += tmp[c];
+                }
+                continue;
+            }
+            if(field->soa != NULL)
+            {
+                res[0] += field->soa(calc->soa[t], x, y, z);
+                continue;
+            }
+            for(i = tile->start; i < tile->start + tile->size; i++)
+            {
+                field->sph(calc->model[i], &calc->frames[i], &pointframe,
+                           tmp);
+                for(c = 0; c < ncomp; c++)
+                {
+                    res[c] += tmp[c];
+                }
+            }
+        }
+    }
+}
+
+
+/* Free the tiles of the model and everything made for the kernels */
+static void free_prism_calc(PRISM_CALC *calc)
+{
+    int t;
+
+    for(t = 0; t < calc->ntiles; t++)
+    {
+        if(calc->soa != NULL && calc->soa[t] != NULL)
+            free_prism_soa(calc->soa[t]);
+        if(calc->farsoa != NULL && calc->farsoa[t] != NULL)
+            free_prism_soa(calc->farsoa[t]);
+    }
+    free(calc->soa);
+    free(calc->farsoa);
+    free(calc->model);
+    free(calc->frames);
+    free(calc->farframes);
+    free(calc->tiles);
+}
+
+
+/* Split the model into tiles (the buckets of a spatial index if using a cutoff
+distance or consecutive prisms if not) and the tiles into chunks that can be
+calculated by different threads. The chunks don't depend on the number of
+threads, so neither do the results. Then store the prisms of each tile in the
+form used by the kernels. Frees the model (or keeps it in 'calc'). Returns 1 if
+there wasn't enough memory (logs the error). */
+static int split_prism_model(PRISM_CALC *calc, PRISM *model, int modelsize,
+                             double cutoff, int farfield)
+{
+    const PRISM_FIELD *field = calc->field;
+    PRISM_INDEX *index;
+    PRISM *far;
+    int t, c, nchunks, ncorners = 0, rc, error = 0;
+
+    calc->cutoff = cutoff;
+    calc->farfield = farfield;
+    calc->soa = NULL;
+    calc->farsoa = NULL;
+    calc->model = NULL;
+    calc->frames = NULL;
+    calc->farframes = NULL;
+    nchunks = (modelsize + PRISM_CHUNK_SIZE - 1)/PRISM_CHUNK_SIZE;
+    if(nchunks > PRISM_MAX_CHUNKS)
+    {
+        nchunks = PRISM_MAX_CHUNKS;
+    }
+    if(cutoff > 0)
+    {
+        index = new_prism_index(model, modelsize, field->spherical,
+                                PRISM_TILE_CUTOFF*cutoff);
+        if(index == NULL)
+        {
+            log_error("problem allocating memory for the spatial index");
+            free(model);
+            return 1;
+        }
+        calc->ntiles = index->ntiles;
+        calc->tiles = index->tiles;
+        index->tiles = NULL;
+        free_prism_index(index);
+    }
+    else
+    {
+        calc->ntiles = nchunks;
+        calc->tiles = (PRISM_TILE *)malloc(nchunks*sizeof(PRISM_TILE));
+        if(calc->tiles == NULL)
+        {
+            log_error("problem allocating memory for the prism model");
+            free(model);
+            return 1;
+        }
+        for(t = 0; t < nchunks; t++)
+        {
+            calc->tiles[t].start = (int)((double)modelsize*t/nchunks);
+            calc->tiles[t].size = (int)((double)modelsize*(t + 1)/nchunks) -
+                                  calc->tiles[t].start;
+            calc->tiles[t].hasmass = 0;
+        }
+    }
+    /* Chunks of consecutive tiles with about the same number of prisms */
+    if(nchunks > calc->ntiles)
+    {
+        nchunks = calc->ntiles;
+    }
+    calc->nchunks = nchunks;
+    calc->chunks[0] = 0;
+    for(c = 1; c < nchunks; c++)
+    {
+        t = calc->chunks[c - 1] + 1;
+        while(t < calc->ntiles - (nchunks - c) &&
+              calc->tiles[t].start < (double)modelsize*c/nchunks)
+        {
+            t++;
+        }
+        calc->chunks[c] = t;
+    }
+    calc->chunks[nchunks] = calc->ntiles;
+    if(cutoff > 0)
+    {
+        log_info("Model split into %d tile(s) in %d chunk(s)", calc->ntiles,
+                 nchunks);
+    }
+    else
+    {
+        log_info("Model split into %d chunk(s)", nchunks);
+    }
+
+    if(field->spherical)
+    {
+        /* The position and orientation of each prism are used for every
+         * computation point, so compute them only once */
+        calc->model = model;
+        calc->frames = prism_frames(model, modelsize);
+        error = calc->frames == NULL;
+        if(!error && farfield)
+        {
+            far = (PRISM *)malloc(calc->ntiles*sizeof(PRISM));
+            error = far == NULL;
+            for(t = 0; !error && t < calc->ntiles; t++)
+            {
+                far[t] = calc->tiles[t].far;
+            }
+            if(!error)
+            {
+                calc->farframes = prism_frames(far, calc->ntiles);
+                error = calc->farframes == NULL;
+            }
+            free(far);
+        }
+        if(error)
+        {
+            log_error("problem allocating memory for the prism frames");
+            free_prism_calc(calc);
+            return 1;
+        }
+        return 0;
+    }
+    /* The kernels run over each tile of the model stored as arrays. Prisms
+     * with common corners (like regular grids) evaluate the kernels once per
+     * corner. */
+    calc->soa = (PRISM_SOA **)calloc(calc->ntiles, sizeof(PRISM_SOA *));
+    calc->farsoa = (PRISM_SOA **)calloc(calc->ntiles, sizeof(PRISM_SOA *));
+    error = calc->soa == NULL || calc->farsoa == NULL;
+    for(t = 0; !error && t < calc->ntiles; t++)
+    {
+        calc->soa[t] = new_prism_soa(model + calc->tiles[t].start,
+                                     calc->tiles[t].size);
+        if(farfield && calc->tiles[t].hasmass)
+        {
+            calc->farsoa[t] = new_prism_soa(&calc->tiles[t].far, 1);
+            error = calc->farsoa[t] == NULL;
+        }
+        if(calc->soa[t] == NULL || error)
+        {
+            error = 1;
+            break;
+        }
+        rc = prism_soa_share_vertices(calc->soa[t]);
+        if(rc < 0)
+        {
+            log_warning("not enough memory to find the shared prism corners");
+        }
+        ncorners += calc->soa[t]->nvertices > 0 ? rc : 8*calc->tiles[t].size;
+    }
+    free(model);
+    if(error)
+    {
+        log_error("problem allocating memory for the prism model");
+        free_prism_calc(calc);
+        return 1;
+    }
+    if(ncorners < 8*modelsize)
+    {
+        log_info("Using %d shared corners instead of %d", ncorners,
+                 8*modelsize);
+    }
+    return 0;
+}
+
+
+/* Run the main for a generic prism program */
+int run_prism_main(int argc, char **argv, const char *progname,
+                   const PRISM_FIELD *field, void (*print_help)(void))
+{
+    BASIC_ARGS args;
+    PRISM_CALC calc;
+    BATCH_CALC batch;
+    BATCH_INPUT input;
+    BATCH_OUTPUT output;
+    PRISM *model;
+    int components[PRISM_MAX_COMPONENTS], modelsize, rc, error_exit = 0, k;
+    long points = 0;
+    FILE *logfile = NULL, *modelfile = NULL;
+    time_t rawtime;
+    clock_t tstart;
+    struct tm * timeinfo;
+
+    log_init(LOG_INFO);
+    rc = parse_basic_args(argc, argv, progname, &args, print_help);
+    if(rc == 3)
+    {
+        log_error("%s: missing input file", progname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+    if(rc == 2)
+    {
+        return 0;
+    }
+    calc.field = field;
+    batch.noutput = field->ncomponents;
+    for(k = 0; k < field->ncomponents; k++)
+    {
+        components[k] = k;
+    }
+    if(rc == 0 && args.components != NULL)
+    {
+        batch.noutput = find_components(args.components, field->names,
+                                        field->ncomponents, components);
+        rc = batch.noutput == 0;
+    }
+    if(rc == 1)
+    {
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+    /* Set the appropriate logging level and log to file if necessary */
+    if(!args.verbose)
+    {
+        log_init(LOG_WARNING);
+    }
+    if(args.logtofile)
+    {
+        logfile = fopen(args.logfname, "w");
+        if(logfile == NULL)
+        {
+            log_error("unable to create log file %s", args.logfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            return 1;
+        }
+        log_tofile(logfile, LOG_INFO);
+    }
+
+    /* Print standard verbose */
+    log_info("%s (Tesseroids project) %s", progname, tesseroids_version);
+    time(&rawtime);
+    timeinfo = localtime(&rawtime);
+    log_info("(local time) %s", asctime(timeinfo));
+
+    /* Read the model file */
+    log_info("Reading prism model from file %s", args.inputfname);
+    modelfile = fopen(args.inputfname, "r");
+    if(modelfile == NULL)
+    {
+        log_error("failed to open model file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    model = read_prism_model_cached(modelfile, args.inputfname,
+                                    field->spherical, &modelsize);
+    fclose(modelfile);
+    if(modelsize == 0)
+    {
+        log_error("prism file %s is empty", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        free(model);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    if(model == NULL)
+    {
+        log_error("failed to read model from file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Total of %d prism(s) read", modelsize);
+
+    /* Split the model into tiles and chunks and prepare them for the
+     * kernels */
+    if(split_prism_model(&calc, model, modelsize, args.cutoff,
+                         args.farfield))
+    {
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+
+    batch.model = &calc;
+    batch.nchunks = calc.nchunks;
+    batch.ncomponents = field->ncomponents;
+    batch.calc = calc_prism_chunk;
+    batch.components = components;
+
+    /* Where the points come from and where the results go. Print a header on
+     * the output with provenance information (binary output only has the
+     * header of the records). */
+    error_exit = open_batch_io(&args, batch.noutput, &input, &output);
+    if(!args.binary)
+    {
+        printf("# %s calculated%s with %s %s:\n", field->title,
+               field->spherical ? " in spherical coordinates" : "", progname,
+               tesseroids_version);
+        printf("#   local time: %s", asctime(timeinfo));
+        printf("#   model file: %s (%d prisms)\n", args.inputfname,
+               modelsize);
+        if(args.grid.parsed)
+        {
+            printf("#   grid of %d x %d points: %g W / %g E / %g S / %g N, "
+                   "height %g\n", args.grid.nlon, args.grid.nlat, args.grid.w,
+                   args.grid.e, args.grid.s, args.grid.n, args.grid.height);
+        }
+        if(args.cutoff > 0)
+        {
+            printf("#   Cutoff distance: %g m%s\n", args.cutoff,
+                   args.farfield ? " (far field approximated)" : "");
+        }
+        if(args.components != NULL)
+        {
+            printf("#   components:");
+            for(k = 0; k < batch.noutput; k++)
+            {
+                printf(" %s", field->names[components[k]]);
+            }
+            printf("\n");
+        }
+    }
+
+    /* Read each computation point and calculate */
+    if(!error_exit)
+    {
+        log_info("Calculating (this may take a while)...");
+        tstart = clock();
+        points = run_batch_calc(&batch, args.nthreads, &input, &output);
+        error_exit = input.error;
+    }
+    if(input.bad_input)
+    {
+        log_warning("Encountered %d bad computation points which were skipped",
+                    input.bad_input);
+    }
+    if(error_exit)
+    {
+        log_warning("Terminating due to error in input");
+        log_warning("Try '%s -h' for instructions", progname);
+    }
+    else
+    {
+        log_info("Calculated on %ld points in %.5g seconds", points,
+                 (double)(clock() - tstart)/CLOCKS_PER_SEC);
+    }
+    /* Clean up */
+    close_batch_io(&input);
+    free_prism_calc(&calc);
+    log_info("Done");
+    if(args.logtofile)
+        fclose(logfile);
+    return error_exit;
+}
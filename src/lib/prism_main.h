@@ -0,0 +1,70 @@
+/*
+Generic main function for the programs that calculate the fields of prism
+models: prismpot, prismg*, prismpots, prismgs and prismggts.
+
+The model is split into chunks of consecutive prisms that are calculated on
+batches of computation points by several threads (see batch_calc.h). The
+number of chunks only depends on the number of prisms, so the results are the
+same for any number of threads.
+
+With a cutoff distance (option -c), the chunks are made of the tiles of a
+spatial index of the model (see prism_index.h) and the tiles beyond the cutoff
+are left out or replaced by their far field.
+*/
+
+
+#ifndef _TESSEROIDS_PRISM_MAIN_H_
+#define _TESSEROIDS_PRISM_MAIN_H_
+
+
+/* For the definitions of PRISM and PRISM_SOA */
+#include "geometry.h"
+#include "grav_prism_soa.h"
+/* For the definition of SPH_FRAME */
+#include "grav_prism_sph.h"
+
+
+/** Maximum number of components of the field of a prism program */
+#define PRISM_MAX_COMPONENTS 6
+
+
+/** How a prism program calculates its field. Only one of soa and sph is used.
+*/
+typedef struct prism_field_struct
+{
+    const char *title; /**< what is calculated, for the output header (for
+                            example "Gravity vector") */
+    int spherical; /**< if the prisms are in spherical coordinates (the format
+                        of tess2prism) and the computation points are lon,
+                        lat and height. Otherwise, the prisms are in Cartesian
+                        coordinates and the points are y, x and height */
+    int ncomponents; /**< number of components of the field */
+    const char *names[PRISM_MAX_COMPONENTS]; /**< names of the components,
+                                                  used by option -s */
+    double (*soa)(PRISM_SOA *, double, double, double); /**< the field of a
+                    model in Cartesian coordinates on x, y and z (a single
+                    component) */
+    void (*sph)(PRISM, const SPH_FRAME *, const SPH_FRAME *, double *); /**<
+                    all components of the field of a prism in spherical
+                    coordinates, given the frames of the prism and of the
+                    point (see prism_frames() and sph_frame()) */
+} PRISM_FIELD;
+
+
+/** Run the main for a generic prism program
+
+Parses the arguments with parse_basic_args().
+
+@param argc number of command line arguments
+@param argv command line arguments
+@param progname name of the specific program
+@param field how to calculate the field of the program
+@param print_help pointer to a function that prints the help message for the
+                  program
+
+@return 0 is all went well. 1 if failed.
+*/
+extern int run_prism_main(int argc, char **argv, const char *progname,
+                          const PRISM_FIELD *field, void (*print_help)(void));
+
+#endif
@@ -7,8 +7,8 @@ Generic main function for the prismg* programs.
 #define _TESSEROIDS_PRISMG_MAIN_H_
 
 
-/* For the definitions of PRISM */
-#include "geometry.h"
+/* For the definitions of PRISM_SOA */
+#include "grav_prism_soa.h"
 
 
 /** Print the help message
@@ -21,11 +21,13 @@ extern void print_help();
 @param argc number of command line arguments
 @param argv command line arguments
 @param progname name of the specific program
-@param field pointer to function that calculates the field of a single prism
+@param field pointer to function that calculates the field of the whole
+             prism model
 
 @return 0 is all went well. 1 if failed.
 */
 extern int run_prismg_main(int argc, char **argv, const char *progname,
-                           double (*field)(PRISM, double, double, double));
+                           double (*field)(PRISM_SOA *, double, double,
+                                           double));
 
 #endif
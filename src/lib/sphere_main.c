@@ -0,0 +1,376 @@
+/*
+Generic main function for the sphere programs.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "logger.h"
+#include "version.h"
+#include "geometry.h"
+#include "constants.h"
+#include "grav_sphere_soa.h"
+#include "parsers.h"
+#include "model_cache.h"
+#include "batch_calc.h"
+#include "sphere_main.h"
+
+
+/* The model is split into chunks of at least this many spheres... */
+#define SPHERE_CHUNK_SIZE 16384
+/* ...but into no more than this many chunks */
+#define SPHERE_MAX_CHUNKS 64
+
+
+/* The model split into chunks. It is shared by all threads. */
+typedef struct sphere_calc_struct
+{
+    double (*field)(SPHERE_SOA *, double, double, double);
+    int nchunks;
+    SPHERE_SOA *chunks[SPHERE_MAX_CHUNKS];
+} SPHERE_CALC;
+
+
+static char sphere_progname[100];
+
+
+/* Print the help message  */
+static void print_sphere_help()
+{
+    printf("Usage: %s MODELFILE [OPTIONS]\n\n", sphere_progname);
+    if(strcmp(sphere_progname + 6, "pot") == 0)
+    {
+        printf("Calculate the potential due to a sphere model on\n");
+    }
+    else
+    {
+        printf("Calculate the %s component due to a sphere model on\n",
+               sphere_progname + 6);
+    }
+    printf("specified observation points.\n\n");
+    printf("Values are calculated in the local coordinate system of the\n");
+    printf("observation point: x-> North  y-> East  z-> Up (away from the\n");
+    printf("center of the Earth).\n");
+    printf("In order to maintain mainstream convention, component gz is\n");
+    printf("calculated with z-> Down.\n\n");
+    printf("All units either SI or degrees! Output is SI, mGal or Eotvos.\n\n");
+    printf("The spheres are calculated exactly (the same as point masses\n");
+    printf("outside of them). Use them for quick-look and equivalent\n");
+    printf("source models with many sources.\n\n");
+    printf("Input:\n");
+    printf("  Computation points passed through standard input (stdin).\n");
+    printf("  Reads 3 or more values per line and inteprets the first 3 as:\n");
+    printf("    longitude, latitude and height\n");
+    printf("  of a computation points. Height should be in meters.\n");
+    printf("  Other values in the line are ignored.\n");
+    printf("  Lines that start with # are ignored as comments.\n");
+    printf("  Lines should be no longer than 10000 (ten thousand) characters.");
+    printf("\n\n");
+    printf("Output:\n");
+    printf("  Printed to standard output (stdout) in the form:\n");
+    printf("    lon lat height ... result\n");
+    printf("  ... represents any values that were read from input and\n");
+    printf("  ignored. In other words, the result is appended to the last\n");
+    printf("  column of the input. Use this to pipe sphere* programs\n");
+    printf("  together.\n");
+    printf("  * Comments about the provenance of the data are inserted into\n");
+    printf("    the top of the output\n\n");
+    printf("MODELFILE: File containing the sphere model\n");
+    printf("  * Each sphere is specified by the position of its center, its\n");
+    printf("    radius and density\n");
+    printf("  * The file should contain one sphere per line\n");
+    printf("  * Each line should have the following column format:\n");
+    printf("      Lon Lat Height Radius Density\n");
+    printf("  * Lon and Lat are in decimal degrees. Height is the height of\n");
+    printf("    the center from the mean Earth radius. Use negative values\n");
+    printf("    if bellow the surface.\n");
+    printf("  * If a line starts with # it will be considered a comment and\n");
+    printf("    will be ignored.\n\n");
+    printf("Options:\n");
+    printf("  -rW/E/S/N    Calculate on a regular grid of points instead of\n");
+    printf("  -bNLON/NLAT  reading them from stdin. Same as the options of\n");
+    printf("  -zHEIGHT     tessgrd: the borders of the grid in degrees, the\n");
+    printf("               number of points in longitude and latitude and\n");
+    printf("               the height of the grid in meters.\n");
+    printf("  -pDIGITS     Number of significant digits of the results.\n");
+    printf("               From 1 to 17. Defaults to 15.\n");
+    printf("  -jTHREADS    Number of threads used for the calculation.\n");
+    printf("               Defaults to the number of processors. The\n");
+    printf("               threads calculate different points and\n");
+    printf("               different parts of the model. The output is in\n");
+    printf("               the order of the input and doesn't depend on\n");
+    printf("               the number of threads.\n");
+    printf("  --binary     Read the computation points from stdin and write\n");
+    printf("               the results to stdout in binary (see Binary\n");
+    printf("               input/output bellow).\n");
+    printf("  -h           Print instructions.\n");
+    printf("  --version    Print version and license information.\n");
+    printf("  -v           Enable verbose printing to stderr.\n");
+    printf("  -lFILENAME   Print log messages to file FILENAME.\n");
+    printf("\n");
+    printf("Binary input/output:\n");
+    printf("  With option --binary, the input and output are a header\n");
+    printf("  followed by records of NCOLS double precision numbers:\n");
+    printf("    * 8 characters: TESSPTS1\n");
+    printf("    * int: NCOLS\n");
+    printf("    * int: unused\n");
+    printf("  The first 3 numbers of an input record are lon, lat and\n");
+    printf("  height. The output records are the input records with the\n");
+    printf("  result appended (NCOLS + 1 numbers). The numbers use the byte\n");
+    printf("  order of the computer.\n");
+    printf("  With options -r, -b and -z, only the output is binary and its\n");
+    printf("  records are lon, lat, height and the result.\n");
+    printf("  If the binary input is invalid or ends in an incomplete\n");
+    printf("  record, the program stops with exit status 1.\n");
+    print_copyright();
+}
+
+
+/* Calculate the field of a chunk of the model on the points of a batch */
+static void calc_sphere_chunk(const void *model, int chunk, int npoints,
+                              const int *ispoint, const double *points,
+                              double *results)
+{
+    const SPHERE_CALC *calc = (const SPHERE_CALC *)model;
+    int k;
+
+    for(k = 0; k < npoints; k++)
+    {
+        if(ispoint[k])
+        {
+            results[k] = calc->field(calc->chunks[chunk], points[3*k],
+                                     points[3*k + 1],
+                                     points[3*k + 2] + MEAN_EARTH_RADIUS);
+        }
+    }
+}
+
+
+/* Free the chunks of the model */
+static void free_sphere_calc(SPHERE_CALC *calc)
+{
+    int c;
+
+    for(c = 0; c < calc->nchunks; c++)
+    {
+        if(calc->chunks[c] != NULL)
+            free_sphere_soa(calc->chunks[c]);
+    }
+}
+
+
+/* Split the model into chunks of consecutive spheres stored as arrays. The
+chunks don't depend on the number of threads, so neither do the results.
+Frees the model. Returns 1 if there wasn't enough memory (logs the error). */
+static int split_sphere_model(SPHERE_CALC *calc, SPHERE *model, int modelsize)
+{
+    int c, start, end, error = 0;
+
+    calc->nchunks = (modelsize + SPHERE_CHUNK_SIZE - 1)/SPHERE_CHUNK_SIZE;
+    if(calc->nchunks > SPHERE_MAX_CHUNKS)
+    {
+        calc->nchunks = SPHERE_MAX_CHUNKS;
+    }
+    for(c = 0; c < calc->nchunks; c++)
+    {
+        start = (int)((double)modelsize*c/calc->nchunks);
+        end = (int)((double)modelsize*(c + 1)/calc->nchunks);
+        calc->chunks[c] = error ? NULL :
+                          new_sphere_soa(model + start, end - start);
+        error = error || calc->chunks[c] == NULL;
+    }
+    free(model);
+    if(error)
+    {
+        log_error("problem allocating memory for the sphere model");
+        free_sphere_calc(calc);
+        return 1;
+    }
+    log_info("Model split into %d chunk(s)", calc->nchunks);
+    return 0;
+}
+
+
+/* Run the main for a generic sphere program */
+int run_sphere_main(int argc, char **argv, const char *progname,
+                    double (*field)(SPHERE_SOA *, double, double, double))
+{
+    BASIC_ARGS args;
+    SPHERE_CALC calc;
+    BATCH_CALC batch;
+    BATCH_INPUT input;
+    BATCH_OUTPUT output;
+    SPHERE *model;
+    const char *names[1];
+    int components[1] = {0}, modelsize, rc, error_exit = 0;
+    long points = 0;
+    FILE *logfile = NULL, *modelfile = NULL;
+    time_t rawtime;
+    clock_t tstart;
+    struct tm * timeinfo;
+
+    strcpy(sphere_progname, progname);
+    log_init(LOG_INFO);
+    rc = parse_basic_args(argc, argv, progname, &args, &print_sphere_help);
+    if(rc == 3)
+    {
+        log_error("%s: missing input file", progname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+    if(rc == 2)
+    {
+        return 0;
+    }
+    names[0] = progname + 6;
+    if(rc == 0 && args.components != NULL)
+    {
+        rc = find_components(args.components, names, 1, components) == 0;
+    }
+    if(rc == 0 && args.cutoff > 0)
+    {
+        log_error("%s: option -c is only supported by the prism programs",
+                  progname);
+        rc = 1;
+    }
+    if(rc == 1)
+    {
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+    /* Set the appropriate logging level and log to file if necessary */
+    if(!args.verbose)
+    {
+        log_init(LOG_WARNING);
+    }
+    if(args.logtofile)
+    {
+        logfile = fopen(args.logfname, "w");
+        if(logfile == NULL)
+        {
+            log_error("unable to create log file %s", args.logfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            return 1;
+        }
+        log_tofile(logfile, LOG_INFO);
+    }
+
+    /* Print standard verbose */
+    log_info("%s (Tesseroids project) %s", progname, tesseroids_version);
+    time(&rawtime);
+    timeinfo = localtime(&rawtime);
+    log_info("(local time) %s", asctime(timeinfo));
+
+    /* Read the model file */
+    log_info("Reading sphere model from file %s", args.inputfname);
+    modelfile = fopen(args.inputfname, "r");
+    if(modelfile == NULL)
+    {
+        log_error("failed to open model file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    model = read_sphere_model_cached(modelfile, args.inputfname, &modelsize);
+    fclose(modelfile);
+    if(modelsize == 0)
+    {
+        log_error("sphere file %s is empty", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        free(model);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    if(model == NULL)
+    {
+        log_error("failed to read model from file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Total of %d sphere(s) read", modelsize);
+
+    /* Split the model into chunks and prepare them for the kernels */
+    calc.field = field;
+    if(split_sphere_model(&calc, model, modelsize))
+    {
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    batch.model = &calc;
+    batch.nchunks = calc.nchunks;
+    batch.ncomponents = 1;
+    batch.calc = calc_sphere_chunk;
+    batch.noutput = 1;
+    batch.components = components;
+
+    /* Where the points come from and where the results go. Print a header on
+     * the output with provenance information (binary output only has the
+     * header of the records). */
+    error_exit = open_batch_io(&args, 1, &input, &output);
+    if(!args.binary)
+    {
+        if(strcmp(progname + 6, "pot") == 0)
+        {
+            printf("# Potential calculated with %s %s:\n", progname,
+                   tesseroids_version);
+        }
+        else
+        {
+            printf("# %s component calculated with %s %s:\n", progname + 6,
+                   progname, tesseroids_version);
+        }
+        printf("#   local time: %s", asctime(timeinfo));
+        printf("#   model file: %s (%d spheres)\n", args.inputfname,
+               modelsize);
+        if(args.grid.parsed)
+        {
+            printf("#   grid of %d x %d points: %g W / %g E / %g S / %g N, "
+                   "height %g\n", args.grid.nlon, args.grid.nlat, args.grid.w,
+                   args.grid.e, args.grid.s, args.grid.n, args.grid.height);
+        }
+    }
+
+    /* Read each computation point and calculate */
+    if(!error_exit)
+    {
+        log_info("Calculating (this may take a while)...");
+        tstart = clock();
+        points = run_batch_calc(&batch, args.nthreads, &input, &output);
+        error_exit = input.error;
+    }
+    if(input.bad_input)
+    {
+        log_warning("Encountered %d bad computation points which were skipped",
+                    input.bad_input);
+    }
+    if(error_exit)
+    {
+        log_warning("Terminating due to error in input");
+        log_warning("Try '%s -h' for instructions", progname);
+    }
+    else
+    {
+        log_info("Calculated on %ld points in %.5g seconds", points,
+                 (double)(clock() - tstart)/CLOCKS_PER_SEC);
+    }
+    /* Clean up */
+    close_batch_io(&input);
+    free_sphere_calc(&calc);
+    log_info("Done");
+    if(args.logtofile)
+        fclose(logfile);
+    return error_exit;
+}
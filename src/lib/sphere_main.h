@@ -0,0 +1,36 @@
+/*
+Generic main function for the programs that calculate the fields of sphere
+models: spherepot and sphereg*.
+
+The model is split into chunks of consecutive spheres that are calculated on
+batches of computation points by several threads (see batch_calc.h). The
+number of chunks only depends on the number of spheres, so the results are the
+same for any number of threads.
+*/
+
+
+#ifndef _TESSEROIDS_SPHERE_MAIN_H_
+#define _TESSEROIDS_SPHERE_MAIN_H_
+
+
+/* For the definition of SPHERE_SOA */
+#include "grav_sphere_soa.h"
+
+
+/** Run the main for a generic sphere program
+
+Parses the arguments with parse_basic_args().
+
+@param argc number of command line arguments
+@param argv command line arguments
+@param progname name of the specific program
+@param field pointer to function that calculates the field of the whole
+             sphere model
+
+@return 0 is all went well. 1 if failed.
+*/
+extern int run_sphere_main(int argc, char **argv, const char *progname,
+                           double (*field)(SPHERE_SOA *, double, double,
+                                           double));
+
+#endif
@@ -0,0 +1,459 @@
+/*
+Binary tesseroid model files organized in longitude/latitude tiles.
+*/
+
+
+/* Needed for mmap */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #define TESS_TILES_MMAP
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+#include "logger.h"
+#include "constants.h"
+#include "geometry.h"
+#include "glq.h"
+#include "grav_tess.h"
+#include "tess_tiles.h"
+
+
+/* Identifies the binary format in the start of the file */
+#define TESS_TILES_MAGIC "TESSTIL1"
+/* Size of the magic string and the 3 long header */
+#define TESS_TILES_HEADSIZE (8 + 3*sizeof(long))
+
+
+/* Write a tesseroid model to a binary file organized in tiles. */
+int write_tess_tiles(FILE *file, TESSEROID *model, long size,
+                     const long *order, double tilesize)
+{
+    TESSEROID *sorted;
+    TESS_TILE *tiles;
+    double lonc, latc, minlon, minlat, maxlon, maxlat;
+    long *tileof, *first, *columns, *positions, head[3], nx, ny, i, t, k,
+         ntiles, ncolumns, col;
+    int rc;
+
+    if(size <= 0 || tilesize <= 0)
+    {
+        return 1;
+    }
+    /* Find the regular grid of tiles that covers the centers */
+    minlon = maxlon = 0.5*(model[0].w + model[0].e);
+    minlat = maxlat = 0.5*(model[0].s + model[0].n);
+    for(i = 0; i < size; i++)
+    {
+        lonc = 0.5*(model[i].w + model[i].e);
+        latc = 0.5*(model[i].s + model[i].n);
+        if(lonc < minlon)
+            minlon = lonc;
+        if(lonc > maxlon)
+            maxlon = lonc;
+        if(latc < minlat)
+            minlat = latc;
+        if(latc > maxlat)
+            maxlat = latc;
+    }
+    nx = (long)((maxlon - minlon)/tilesize) + 1;
+    ny = (long)((maxlat - minlat)/tilesize) + 1;
+    tileof = (long *)malloc(size*sizeof(long));
+    sorted = (TESSEROID *)malloc(size*sizeof(TESSEROID));
+    columns = (long *)malloc((size + 1)*sizeof(long));
+    positions = (long *)malloc(size*sizeof(long));
+    first = (long *)calloc((size_t)nx*ny + 1, sizeof(long));
+    if(tileof == NULL || sorted == NULL || columns == NULL ||
+       positions == NULL || first == NULL)
+    {
+        free(tileof);
+        free(sorted);
+        free(columns);
+        free(positions);
+        free(first);
+        return 1;
+    }
+    /* Count the tesseroids in each tile of the grid to find where each tile
+     * starts */
+    for(i = 0; i < size; i++)
+    {
+        lonc = 0.5*(model[i].w + model[i].e);
+        latc = 0.5*(model[i].s + model[i].n);
+        tileof[i] = (long)((latc - minlat)/tilesize)*nx +
+                    (long)((lonc - minlon)/tilesize);
+        first[tileof[i] + 1]++;
+    }
+    ntiles = 0;
+    for(t = 0; t < nx*ny; t++)
+    {
+        if(first[t + 1] > 0)
+        {
+            ntiles++;
+        }
+        first[t + 1] += first[t];
+    }
+    /* Stable sort of the tesseroids by tile. Moves first[t] to the end of
+     * tile t, so shift it back afterwards. */
+    for(i = 0; i < size; i++)
+    {
+        sorted[first[tileof[i]]] = model[i];
+        positions[first[tileof[i]]] = order != NULL ? order[i] : i;
+        first[tileof[i]]++;
+    }
+    for(t = nx*ny; t > 0; t--)
+    {
+        first[t] = first[t - 1];
+    }
+    first[0] = 0;
+    free(tileof);
+    tiles = (TESS_TILE *)malloc(ntiles*sizeof(TESS_TILE));
+    if(tiles == NULL)
+    {
+        free(sorted);
+        free(columns);
+        free(positions);
+        free(first);
+        return 1;
+    }
+    /* Tesseroids of different tiles have different centers, so the columns
+     * don't cross tiles */
+    ncolumns = tess_find_columns(sorted, size, columns);
+    for(t = 0, k = 0, col = 0; t < nx*ny; t++)
+    {
+        if(first[t] == first[t + 1])
+        {
+            continue;
+        }
+        tiles[k].start = first[t];
+        tiles[k].size = first[t + 1] - first[t];
+        tiles[k].colstart = col;
+        while(col < ncolumns && columns[col] < first[t + 1])
+        {
+            col++;
+        }
+        tiles[k].ncolumns = col - tiles[k].colstart;
+        tiles[k].w = sorted[first[t]].w;
+        tiles[k].e = sorted[first[t]].e;
+        tiles[k].s = sorted[first[t]].s;
+        tiles[k].n = sorted[first[t]].n;
+        tiles[k].r1 = sorted[first[t]].r1;
+        tiles[k].r2 = sorted[first[t]].r2;
+        for(i = first[t]; i < first[t + 1]; i++)
+        {
+            if(sorted[i].w < tiles[k].w)
+                tiles[k].w = sorted[i].w;
+            if(sorted[i].e > tiles[k].e)
+                tiles[k].e = sorted[i].e;
+            if(sorted[i].s < tiles[k].s)
+                tiles[k].s = sorted[i].s;
+            if(sorted[i].n > tiles[k].n)
+                tiles[k].n = sorted[i].n;
+            if(sorted[i].r1 < tiles[k].r1)
+                tiles[k].r1 = sorted[i].r1;
+            if(sorted[i].r2 > tiles[k].r2)
+                tiles[k].r2 = sorted[i].r2;
+        }
+        tiles[k].mass = tess_total_mass(&sorted[first[t]], tiles[k].size);
+        k++;
+    }
+    head[0] = ntiles;
+    head[1] = size;
+    head[2] = ncolumns;
+    rc = fwrite(TESS_TILES_MAGIC, 1, 8, file) != 8 ||
+         fwrite(head, sizeof(long), 3, file) != 3 ||
+         fwrite(tiles, sizeof(TESS_TILE), ntiles, file) != (size_t)ntiles ||
+         fwrite(sorted, sizeof(TESSEROID), size, file) != (size_t)size ||
+         fwrite(columns, sizeof(long), ncolumns + 1, file) !=
+             (size_t)ncolumns + 1 ||
+         fwrite(positions, sizeof(long), size, file) != (size_t)size;
+    free(sorted);
+    free(columns);
+    free(positions);
+    free(first);
+    free(tiles);
+    return rc;
+}
+
+
+/* Check if a file is a binary tesseroid model organized in tiles. */
+int is_tess_tiles(const char *fname)
+{
+    FILE *file;
+    char magic[8];
+    int res = 0;
+
+    file = fopen(fname, "rb");
+    if(file == NULL)
+    {
+        return 0;
+    }
+    if(fread(magic, 1, 8, file) == 8 &&
+       strncmp(magic, TESS_TILES_MAGIC, 8) == 0)
+    {
+        res = 1;
+    }
+    fclose(file);
+    return res;
+}
+
+
+/* Check that the tiles and the columns of a binary model are inside the
+ * model. Returns 0 if they are, 1 if not. */
+static int check_tess_tiles(TESS_TILED_MODEL *tiled)
+{
+    TESS_TILE *tile;
+    long t, c;
+
+    if(tiled->columns[0] != 0 ||
+       tiled->columns[tiled->ncolumns] != tiled->size)
+    {
+        return 1;
+    }
+    for(c = 0; c < tiled->ncolumns; c++)
+    {
+        if(tiled->columns[c + 1] <= tiled->columns[c])
+        {
+            return 1;
+        }
+    }
+    for(t = 0; t < tiled->ntiles; t++)
+    {
+        tile = &tiled->tiles[t];
+        if(tile->start < 0 || tile->size < 0 ||
+           tile->start > tiled->size - tile->size ||
+           tile->colstart < 0 || tile->ncolumns < 0 ||
+           tile->colstart > tiled->ncolumns - tile->ncolumns)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* Open a binary tesseroid model file organized in tiles. */
+TESS_TILED_MODEL * open_tess_tiles(const char *fname)
+{
+    TESS_TILED_MODEL *tiled;
+    long head[3];
+    size_t expected;
+#ifdef TESS_TILES_MMAP
+    struct stat info;
+    int fd;
+#else
+    FILE *file;
+    long fsize;
+#endif
+
+    tiled = (TESS_TILED_MODEL *)malloc(sizeof(TESS_TILED_MODEL));
+    if(tiled == NULL)
+    {
+        log_error("problem allocating memory for the binary model");
+        return NULL;
+    }
+#ifdef TESS_TILES_MMAP
+    fd = open(fname, O_RDONLY);
+    if(fd == -1)
+    {
+        log_error("failed to open binary model file %s", fname);
+        free(tiled);
+        return NULL;
+    }
+    if(fstat(fd, &info) == -1 || info.st_size < (off_t)TESS_TILES_HEADSIZE)
+    {
+        log_error("invalid binary model file %s", fname);
+        close(fd);
+        free(tiled);
+        return NULL;
+    }
+    tiled->datasize = (size_t)info.st_size;
+    tiled->data = mmap(NULL, tiled->datasize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(tiled->data == MAP_FAILED)
+    {
+        log_error("failed to memory map binary model file %s", fname);
+        free(tiled);
+        return NULL;
+    }
+    tiled->mapped = 1;
+#else
+    file = fopen(fname, "rb");
+    if(file == NULL)
+    {
+        log_error("failed to open binary model file %s", fname);
+        free(tiled);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    fsize = ftell(file);
+    rewind(file);
+    if(fsize < (long)TESS_TILES_HEADSIZE)
+    {
+        log_error("invalid binary model file %s", fname);
+        fclose(file);
+        free(tiled);
+        return NULL;
+    }
+    tiled->datasize = (size_t)fsize;
+    tiled->data = malloc(tiled->datasize);
+    if(tiled->data == NULL ||
+       fread(tiled->data, 1, tiled->datasize, file) != tiled->datasize)
+    {
+        log_error("failed to read binary model file %s", fname);
+        fclose(file);
+        free(tiled->data);
+        free(tiled);
+        return NULL;
+    }
+    fclose(file);
+    tiled->mapped = 0;
+#endif
+    memcpy(head, (char *)tiled->data + 8, 3*sizeof(long));
+    tiled->ntiles = head[0];
+    tiled->size = head[1];
+    tiled->ncolumns = head[2];
+    /* Bound each count by the file size before multiplying so that the
+     * expected size can't overflow */
+    expected = 0;
+    if(tiled->ntiles > 0 && tiled->size > 0 && tiled->ncolumns > 0 &&
+       (size_t)tiled->ntiles <= tiled->datasize/sizeof(TESS_TILE) &&
+       (size_t)tiled->size <= tiled->datasize/sizeof(TESSEROID) &&
+       (size_t)tiled->ncolumns <= tiled->datasize/sizeof(long))
+    {
+        expected = TESS_TILES_HEADSIZE +
+                   (size_t)tiled->ntiles*sizeof(TESS_TILE) +
+                   (size_t)tiled->size*sizeof(TESSEROID) +
+                   ((size_t)tiled->ncolumns + 1)*sizeof(long) +
+                   (size_t)tiled->size*sizeof(long);
+    }
+    if(strncmp((char *)tiled->data, TESS_TILES_MAGIC, 8) != 0 ||
+       expected != tiled->datasize)
+    {
+        log_error("invalid binary model file %s", fname);
+        close_tess_tiles(tiled);
+        return NULL;
+    }
+    tiled->tiles = (TESS_TILE *)((char *)tiled->data + TESS_TILES_HEADSIZE);
+    tiled->model = (TESSEROID *)(tiled->tiles + tiled->ntiles);
+    tiled->columns = (long *)(tiled->model + tiled->size);
+    tiled->order = tiled->columns + tiled->ncolumns + 1;
+    if(check_tess_tiles(tiled))
+    {
+        log_error("invalid binary model file %s", fname);
+        close_tess_tiles(tiled);
+        return NULL;
+    }
+    return tiled;
+}
+
+
+/* Close a binary tesseroid model opened with open_tess_tiles(). */
+void close_tess_tiles(TESS_TILED_MODEL *tiled)
+{
+#ifdef TESS_TILES_MMAP
+    munmap(tiled->data, tiled->datasize);
+#else
+    free(tiled->data);
+#endif
+    free(tiled);
+}
+
+
+/* Calculates the field of a binary tesseroid model organized in tiles. */
+double calc_tess_tiles(TESS_TILED_MODEL *tiled, double lonp, double latp,
+    double rp, const GLQ *glq_lon, const GLQ *glq_lat, const GLQ *glq_r,
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double (*column_field)(TESSEROID *, int, double, double, double,
+                           const GLQ *, const GLQ *, const GLQ *),
+    int adaptative, double ratio, double far_ratio)
+{
+    double res, distance, lont, latt, rt, d2r = PI/180., coslatp, sinlatp,
+           sinlatt, coslatt, L, Llon, Llat;
+    long t;
+    TESS_TILE *tile;
+    TESSEROID aggregate;
+
+    #define SQ(x) (x)*(x)
+    coslatp = cos(d2r*latp);
+    sinlatp = sin(d2r*latp);
+    res = 0;
+    for(t = 0; t < tiled->ntiles; t++)
+    {
+        tile = &tiled->tiles[t];
+        if(far_ratio != 0)
+        {
+            lont = d2r*0.5*(tile->w + tile->e);
+            latt = d2r*0.5*(tile->s + tile->n);
+            sinlatt = sin(latt);
+            coslatt = cos(latt);
+            rt = 0.5*(tile->r1 + tile->r2);
+            distance = sqrt(SQ(rp) + SQ(rt) - 2*rp*rt*(sinlatp*sinlatt +
+                            coslatp*coslatt*cos(d2r*lonp - lont)));
+            Llon = tile->r2*acos(SQ(sinlatt) +
+                                 SQ(coslatt)*cos(d2r*(tile->e - tile->w)));
+            Llat = tile->r2*acos(sin(d2r*tile->n)*sin(d2r*tile->s) +
+                                 cos(d2r*tile->n)*cos(d2r*tile->s));
+            L = tile->r2 - tile->r1;
+            if(Llon > L)
+                L = Llon;
+            if(Llat > L)
+                L = Llat;
+            if(distance >= far_ratio*L)
+            {
+                /* Use a single tesseroid with the mass of the tile */
+                aggregate.w = tile->w;
+                aggregate.e = tile->e;
+                aggregate.s = tile->s;
+                aggregate.n = tile->n;
+                aggregate.r1 = tile->r1;
+                aggregate.r2 = tile->r2;
+                aggregate.density = tile->mass/tess_volume(aggregate);
+                if(adaptative)
+                {
+                    res += calc_tess_model_adapt(&aggregate, 1, lonp, latp,
+                                rp, glq_lon, glq_lat, glq_r, field, ratio);
+                }
+                else
+                {
+                    res += calc_tess_model(&aggregate, 1, lonp, latp, rp,
+                                glq_lon, glq_lat, glq_r, field);
+                }
+                continue;
+            }
+        }
+        if(tiled->ncolumns < tiled->size && adaptative)
+        {
+            res += calc_tess_model_columns_adapt(tiled->model,
+                        &tiled->columns[tile->colstart], tile->ncolumns, lonp,
+                        latp, rp, glq_lon, glq_lat, glq_r, column_field,
+                        ratio);
+        }
+        else if(tiled->ncolumns < tiled->size)
+        {
+            res += calc_tess_model_columns(tiled->model,
+                        &tiled->columns[tile->colstart], tile->ncolumns, lonp,
+                        latp, rp, glq_lon, glq_lat, glq_r, column_field);
+        }
+        else if(adaptative)
+        {
+            res += calc_tess_model_adapt(&tiled->model[tile->start],
+                        tile->size, lonp, latp, rp, glq_lon, glq_lat, glq_r,
+                        field, ratio);
+        }
+        else
+        {
+            res += calc_tess_model(&tiled->model[tile->start], tile->size,
+                        lonp, latp, rp, glq_lon, glq_lat, glq_r, field);
+        }
+    }
+    #undef SQ
+    return res;
+}
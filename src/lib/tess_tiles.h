@@ -0,0 +1,162 @@
+/*
+Binary tesseroid model files organized in longitude/latitude tiles.
+
+The tesseroids are grouped in tiles by the position of their centers. Each
+tile has a header with the bounding box and the total mass of its tesseroids.
+The file is memory mapped when opened (where supported), so only the tiles
+that are actually used in a calculation are read from disk. Tiles that are far
+from a computation point can be replaced by a single tesseroid with the
+bounding box and the mass of the tile.
+
+File format (native byte order and sizes of long and double):
+
+    - 8 bytes with the string TESSTIL1
+    - long: number of tiles
+    - long: number of tesseroids
+    - long: number of vertical columns of tesseroids (see tess_find_columns())
+    - the TESS_TILE header of each tile
+    - the TESSEROID structures, sorted by tile
+    - the index of the first tesseroid of each column plus the total number
+      of tesseroids (long)
+    - the position in the model file of each tesseroid (long)
+
+Use tess2tiles to convert a tesseroid model file into this format.
+*/
+
+#ifndef _TESSEROIDS_TESS_TILES_H_
+#define _TESSEROIDS_TESS_TILES_H_
+
+
+#include <stdio.h>
+/* Needed for definition of TESSEROID */
+#include "geometry.h"
+/* Needed for definition of GLQ */
+#include "glq.h"
+
+
+/** Header of a tile of a binary tesseroid model */
+typedef struct tess_tile_struct {
+    double w; /**< western border of the bounding box of the tile */
+    double e; /**< eastern border of the bounding box of the tile */
+    double s; /**< southern border of the bounding box of the tile */
+    double n; /**< northern border of the bounding box of the tile */
+    double r1; /**< smallest radius of the tesseroids of the tile */
+    double r2; /**< largest radius of the tesseroids of the tile */
+    double mass; /**< total mass of the tesseroids of the tile */
+    long start; /**< index of the first tesseroid of the tile */
+    long size; /**< number of tesseroids in the tile */
+    long colstart; /**< index of the first column of the tile */
+    long ncolumns; /**< number of columns in the tile */
+} TESS_TILE;
+
+
+/** A binary tesseroid model opened with open_tess_tiles() */
+typedef struct tess_tiled_model_struct {
+    long ntiles; /**< number of tiles */
+    long size; /**< total number of tesseroids */
+    long ncolumns; /**< total number of vertical columns */
+    TESS_TILE *tiles; /**< the headers of the tiles */
+    TESSEROID *model; /**< the tesseroids, sorted by tile */
+    long *columns; /**< index of the first tesseroid of each column plus the
+                        total number of tesseroids */
+    long *order; /**< position in the model file of each tesseroid */
+    void *data; /**< the contents of the file */
+    size_t datasize; /**< size of the file in bytes */
+    int mapped; /**< flag to indicate if data is memory mapped */
+} TESS_TILED_MODEL;
+
+
+/** Write a tesseroid model to a binary file organized in tiles.
+
+The tesseroids are put in the tile that contains their center. The order of
+the tesseroids inside a tile is the same as in the model, so the vertical
+columns of the model (see tess_find_columns()) are kept. Reorder the model
+along a Hilbert curve first (see hilbert_sort_tess()) to have the columns of
+each tile in the order of the curve.
+
+The file also stores the position in the model file of each tesseroid.
+
+@param file open FILE for writing in binary mode
+@param model TESSEROID array defining the model
+@param size number of tesseroids in the model
+@param order position in the model file of each tesseroid of the model (for
+             reordered models). NULL if the model is in the order of the file.
+@param tilesize size of the tiles in degrees
+
+@return Return code:
+    - 0: if all went well
+    - 1: if there was an error allocating memory or writing the file
+*/
+extern int write_tess_tiles(FILE *file, TESSEROID *model, long size,
+                            const long *order, double tilesize);
+
+
+/** Check if a file is a binary tesseroid model organized in tiles.
+
+@param fname name of the file
+
+@return 1 if the file starts with the binary format identifier, 0 otherwise
+*/
+extern int is_tess_tiles(const char *fname);
+
+
+/** Open a binary tesseroid model file organized in tiles.
+
+The file is memory mapped if the system supports it. Otherwise, it is read
+into memory. Fails if the size of the file doesn't match its header or if the
+tesseroids and columns of a tile are outside of the model.
+
+<b>WARNING</b>: Don't forget to close the model using close_tess_tiles()!
+
+@param fname name of the file
+
+@return pointer to the model. NULL if there was an error
+*/
+extern TESS_TILED_MODEL * open_tess_tiles(const char *fname);
+
+
+/** Close a binary tesseroid model opened with open_tess_tiles().
+
+@param tiled pointer to the model
+*/
+extern void close_tess_tiles(TESS_TILED_MODEL *tiled);
+
+
+/** Calculates the field of a binary tesseroid model organized in tiles.
+
+If far_ratio is not zero, the tiles whose distance to the computation point is
+at least far_ratio times their size are replaced by a single tesseroid with the
+bounding box and the mass of the tile. Only the tesseroids of the other tiles
+are read from the file.
+
+Uses the column field function if the model has vertical columns (see
+calc_tess_model_columns()) and the tesseroid field function otherwise.
+
+@param tiled the binary tesseroid model
+@param lonp longitude of the computation point P
+@param latp latitude of the computation point P
+@param rp radial coordinate of the computation point P
+@param glq_lon pointer to GLQ structure used for the longitudinal integration
+@param glq_lat pointer to GLQ structure used for the latitudinal integration
+@param glq_r pointer to GLQ structure used for the radial integration
+@param field pointer to one of the tesseroid field calculating functions
+@param column_field pointer to one of the column field calculating functions
+@param adaptative flag to indicate wether to use the adaptative size of
+                  tesseroid algorithm
+@param ratio distance-to-size ratio for doing adaptative resizing
+@param far_ratio distance-to-size ratio for replacing a tile by a single
+                 tesseroid. 0 to never replace the tiles.
+
+@return the sum of the fields of all the tiles
+*/
+extern double calc_tess_tiles(TESS_TILED_MODEL *tiled, double lonp,
+    double latp, double rp, const GLQ *glq_lon, const GLQ *glq_lat,
+    const GLQ *glq_r,
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double (*column_field)(TESSEROID *, int, double, double, double,
+                           const GLQ *, const GLQ *, const GLQ *),
+    int adaptative, double ratio, double far_ratio);
+
+
+#endif
@@ -3,10 +3,18 @@ Generic main function for the tessg* programs.
 */
 
 
+/* Needed for pthreads and sysconf */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #define TESSG_THREADS
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
 #include "logger.h"
 #include "version.h"
 #include "grav_tess.h"
@@ -14,6 +22,10 @@ Generic main function for the tessg* programs.
 #include "constants.h"
 #include "geometry.h"
 #include "parsers.h"
+#include "model_cache.h"
+#include "tess_tiles.h"
+#include "binpoints.h"
+#include "hilbert.h"
 #include "tessg_main.h"
 
 
@@ -73,7 +85,8 @@ void print_tessg_help(const char *progname)
     printf("    deep structures, and positive if above the surface, for\n");
     printf("    example when modeling topography.\n");
     printf("  * If a line starts with # it will be considered a comment and\n");
-    printf("    will be ignored.\n\n");
+    printf("    will be ignored.\n");
+    printf("  * Can also be a binary model file created by tess2tiles.\n\n");
     printf("Options:\n");
     printf("  -a             Disable the automatic subdividing of\n");
     printf("                 tesseroids. Subdividing is done to ensure the\n");
@@ -87,28 +100,1102 @@ void print_tessg_help(const char *progname)
     printf("                 respectively. Defaults to 2/2/2.\n");
     printf("                 Subdividing of tesseroids works best with the\n");
     printf("                 default order.\n");
+    printf("  -gDLON/DLAT    The model file is a regular grid of stacked\n");
+    printf("                 layers with grid spacing DLON/DLAT, in the\n");
+    printf("                 same format as the input of tesslayers:\n");
+    printf("                   lon lat height thickness1 dens1 ...\n");
+    printf("                 The tesseroids of each grid cell are\n");
+    printf("                 generated during the calculation instead of\n");
+    printf("                 being stored, which uses less memory.\n");
+    printf("                 All grid points must have the same number of\n");
+    printf("                 layers.\n");
+    printf("  -dRATIO        Use a multi-resolution pyramid of the grid\n");
+    printf("                 model (requires -g). Cells far from the\n");
+    printf("                 computation point are replaced by coarser\n");
+    printf("                 cells with the same mass if the distance is\n");
+    printf("                 at least RATIO times the size of the coarse\n");
+    printf("                 cell. Larger RATIO is more accurate but\n");
+    printf("                 slower.\n");
+    printf("                 For binary model files (see tess2tiles),\n");
+    printf("                 replace the tiles that are at least RATIO\n");
+    printf("                 times their size away by a single tesseroid\n");
+    printf("                 with the mass of the tile.\n");
+    printf("  -cRADIUS       Only use the tesseroids whose center is within\n");
+    printf("                 RADIUS meters (along the surface of the mean\n");
+    printf("                 Earth) of each computation point. Can't be\n");
+    printf("                 used with -g.\n");
+    printf("  -pDIGITS       Number of significant digits of the results.\n");
+    printf("                 From 1 to 17. Defaults to 15.\n");
+    printf("  -rW/E/S/N      Calculate on a regular grid of points instead\n");
+    printf("  -bNLON/NLAT    of reading them from stdin. Same as the options\n");
+    printf("  -zHEIGHT       of tessgrd: the borders of the grid in degrees,\n");
+    printf("                 the number of points in longitude and latitude\n");
+    printf("                 and the height of the grid in meters. The\n");
+    printf("                 output is the same as piping the output of\n");
+    printf("                 tessgrd into this program.\n");
+    printf("  -jTHREADS      Number of threads used for the calculation.\n");
+    printf("                 Defaults to the number of processors. The\n");
+    printf("                 input is read and the output written by\n");
+    printf("                 separate threads, so the order of the output\n");
+    printf("                 is the same as the input.\n");
+    printf("  --binary       Read the computation points from stdin and\n");
+    printf("                 write the results to stdout in binary (see\n");
+    printf("                 Binary input/output bellow).\n");
+    printf("  -fFILENAME     Write the results to the binary file FILENAME\n");
+    printf("                 instead of stdout. The result of each point\n");
+    printf("                 has a fixed place in the file (given by the\n");
+    printf("                 position of the point in the input), so the\n");
+    printf("                 threads write their results directly to the\n");
+    printf("                 file, in any order. See Binary input/output\n");
+    printf("                 bellow. Use tessbin2txt to convert the file\n");
+    printf("                 to text.\n");
+    printf("  --sort         Read all computation points first and calculate\n");
+    printf("                 on them in the order of a Hilbert curve through\n");
+    printf("                 their longitudes and latitudes. Consecutive\n");
+    printf("                 calculations are then close to each other,\n");
+    printf("                 which is faster for scattered points. The\n");
+    printf("                 output is in the order of the input.\n");
+    printf("  --sort-model   Reorder the tesseroids of the model along a\n");
+    printf("                 Hilbert curve through their centers, keeping\n");
+    printf("                 the vertical columns together. Tesseroids that\n");
+    printf("                 are close in space are then also close in\n");
+    printf("                 memory. The numbers of the tesseroids in the\n");
+    printf("                 error messages refer to the reordered model.\n");
     printf("  -h             Print instructions.\n");
     printf("  --version      Print version and license information.\n");
     printf("  -v             Enable verbose printing to stderr.\n");
     printf("  -lFILENAME     Print log messages to file FILENAME.\n");
+    printf("\n");
+    printf("Binary input/output:\n");
+    printf("  With option --binary, the input and output are a header\n");
+    printf("  followed by records of NCOLS double precision numbers:\n");
+    printf("    * 8 characters: TESSPTS1\n");
+    printf("    * int: NCOLS\n");
+    printf("    * int: unused\n");
+    printf("  The first 3 numbers of an input record are lon, lat and\n");
+    printf("  height. The output records are the input records with the\n");
+    printf("  result appended (NCOLS + 1 numbers). Use this to pipe tessg*\n");
+    printf("  programs together without converting to text. The numbers\n");
+    printf("  use the byte order of the computer.\n");
+    printf("  With options -r, -b and -z, only the output is binary and its\n");
+    printf("  records are lon, lat, height and the result.\n");
+    printf("  The file written with option -f has the same format. For text\n");
+    printf("  input, its records are lon, lat, height and the result of each\n");
+    printf("  point (comments and bad lines are left out).\n");
+    printf("  If the binary input is invalid or ends in an incomplete\n");
+    printf("  record, or if the file of option -f can't be written, the\n");
+    printf("  program stops with exit status 1.\n");
     print_copyright();
 }
 
 
+/* Number of input lines (or binary records) in each batch of points */
+#define TESSG_BATCH_SIZE 128
+/* Number of batches in the pipeline for each calculating thread */
+#define TESSG_BATCHES_PER_THREAD 4
+/* Maximum number of calculating threads */
+#define TESSG_MAX_THREADS 256
+/* Stack size of the calculating threads. The adaptative calculations keep
+ * their stacks of tesseroids in the thread stack. */
+#define TESSG_STACK_SIZE 8388608
+/* Maximum size of an input line */
+#define TESSG_LINE_SIZE 10000
+
+
+/* What a thread needs to calculate the field on a point. The model and the GLQ
+structures (only their unit rules are used) are shared by all threads. The
+buffers belong to a single thread because they are modified during the
+calculation. */
+typedef struct tessg_calc_struct
+{
+    TESSG_ARGS *args;
+    TESSEROID *model;
+    long modelsize;
+    long *columns;
+    long ncolumns;
+    TESS_GRID *grid;
+    TESS_PYRAMID *pyramid;
+    TESS_INDEX *index;
+    TESS_TILED_MODEL *tiled;
+    double cutoff;
+    double ratio;
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *);
+    double (*column_field)(TESSEROID *, int, double, double, double,
+                           const GLQ *, const GLQ *, const GLQ *);
+    const GLQ *glq_lon;
+    const GLQ *glq_lat;
+    const GLQ *glq_r;
+    TESSEROID *column; /* tesseroids of a cell of the grid model */
+    long *found; /* columns found in the spatial index */
+} TESSG_CALC;
+
+
+/* A batch of consecutive input lines (or binary records) */
+typedef struct tessg_batch_struct
+{
+    long seq; /* position of the batch in the input */
+    long first; /* index of the first point of the batch in the input */
+    int size; /* number of lines (or records) in the batch */
+    int *ispoint; /* if each line is a point or a comment to be echoed */
+    size_t *lines; /* where each line starts in 'text' */
+    char *text; /* the lines read, without the \n for points */
+    size_t textsize;
+    size_t textcapacity;
+    double *points; /* lon, lat and height of each point */
+    double *results; /* the result on each point */
+    double *records; /* binary output records (input record + result) */
+} TESSG_BATCH;
+
+
+/* Where the results go */
+typedef struct tessg_output_struct
+{
+    int ncols; /* number of values in the binary input records. 0 for text */
+    int precision; /* number of significant digits of text output */
+    BINRESULTS *results; /* binary result file. NULL to write to stdout */
+    double *values; /* array for the result of each point (by its index).
+                       NULL to write to stdout or the result file */
+} TESSG_OUTPUT;
+
+
+/* Where the computation points are read from */
+typedef struct tessg_input_struct
+{
+    const POINTS_GRID_ARGS *grid; /* grid of points. NULL if reading stdin */
+    const double *sorted; /* lon, lat and height of points that were already
+                             read. NULL if not used */
+    long nsorted; /* number of points in 'sorted' */
+    long next; /* index of the next point of the grid or of 'sorted' */
+    int endrow; /* if a row of the grid just ended */
+    BINPOINTS *binin; /* binary input. NULL if reading text */
+    int line; /* number of text lines read */
+    long npoints; /* number of points read */
+    int bad_input; /* number of bad lines skipped */
+    int eof; /* if there is nothing left to read */
+    int error; /* if there was an error reading */
+} TESSG_INPUT;
+
+
+/* Calculate the field of the model on a point */
+static double calc_tessg_point(TESSG_CALC *calc, double lon, double lat,
+                               double height)
+{
+    TESSG_ARGS *args = calc->args;
+    double res, r = height + MEAN_EARTH_RADIUS;
+    long nfound, c, i;
+
+    if(calc->pyramid != NULL)
+    {
+        return calc_tess_pyramid_adapt(calc->pyramid, calc->column, lon, lat,
+                    r, calc->glq_lon, calc->glq_lat, calc->glq_r,
+                    calc->column_field, calc->ratio, args->lod_ratio);
+    }
+    if(calc->grid != NULL)
+    {
+        if(args->adaptative)
+        {
+            return calc_tess_grid_adapt(calc->grid, calc->column, lon, lat, r,
+                        calc->glq_lon, calc->glq_lat, calc->glq_r,
+                        calc->column_field, calc->ratio);
+        }
+        return calc_tess_grid(calc->grid, calc->column, lon, lat, r,
+                    calc->glq_lon, calc->glq_lat, calc->glq_r,
+                    calc->column_field);
+    }
+    if(calc->tiled != NULL)
+    {
+        return calc_tess_tiles(calc->tiled, lon, lat, r, calc->glq_lon,
+                    calc->glq_lat, calc->glq_r, calc->field,
+                    calc->column_field, args->adaptative, calc->ratio,
+                    args->lod_ratio);
+    }
+    if(calc->index != NULL)
+    {
+        nfound = tess_index_query(calc->index, lon, lat, calc->cutoff,
+                                  calc->found);
+        res = 0;
+        for(i = 0; i < nfound; i++)
+        {
+            c = calc->found[i];
+            if(calc->ncolumns < calc->modelsize && args->adaptative)
+            {
+                res += calc_tess_model_columns_adapt(calc->model,
+                            &calc->columns[c], 1, lon, lat, r, calc->glq_lon,
+                            calc->glq_lat, calc->glq_r, calc->column_field,
+                            calc->ratio);
+            }
+            else if(calc->ncolumns < calc->modelsize)
+            {
+                res += calc_tess_model_columns(calc->model, &calc->columns[c],
+                            1, lon, lat, r, calc->glq_lon, calc->glq_lat,
+                            calc->glq_r, calc->column_field);
+            }
+            else if(args->adaptative)
+            {
+                res += calc_tess_model_adapt(&calc->model[calc->columns[c]], 1,
+                            lon, lat, r, calc->glq_lon, calc->glq_lat,
+                            calc->glq_r, calc->field, calc->ratio);
+            }
+            else
+            {
+                res += calc_tess_model(&calc->model[calc->columns[c]], 1, lon,
+                            lat, r, calc->glq_lon, calc->glq_lat, calc->glq_r,
+                            calc->field);
+            }
+        }
+        return res;
+    }
+    if(calc->ncolumns < calc->modelsize)
+    {
+        if(args->adaptative)
+        {
+            return calc_tess_model_columns_adapt(calc->model, calc->columns,
+                        calc->ncolumns, lon, lat, r, calc->glq_lon,
+                        calc->glq_lat, calc->glq_r, calc->column_field,
+                        calc->ratio);
+        }
+        return calc_tess_model_columns(calc->model, calc->columns,
+                    calc->ncolumns, lon, lat, r, calc->glq_lon, calc->glq_lat,
+                    calc->glq_r, calc->column_field);
+    }
+    if(args->adaptative)
+    {
+        return calc_tess_model_adapt(calc->model, calc->modelsize, lon, lat, r,
+                    calc->glq_lon, calc->glq_lat, calc->glq_r, calc->field,
+                    calc->ratio);
+    }
+    return calc_tess_model(calc->model, calc->modelsize, lon, lat, r,
+                calc->glq_lon, calc->glq_lat, calc->glq_r, calc->field);
+}
+
+
+/* Make a copy of 'calc' with its own buffers for use by another thread.
+Returns 1 if there wasn't enough memory. */
+static int copy_tessg_calc(const TESSG_CALC *calc, TESSG_CALC *copy)
+{
+    *copy = *calc;
+    copy->column = NULL;
+    copy->found = NULL;
+    if(calc->grid != NULL)
+    {
+        copy->column = (TESSEROID *)malloc(
+            calc->grid->nlayers*sizeof(TESSEROID));
+    }
+    if(calc->index != NULL)
+    {
+        copy->found = (long *)malloc(calc->ncolumns*sizeof(long));
+    }
+    if((calc->grid != NULL && copy->column == NULL) ||
+       (calc->index != NULL && copy->found == NULL))
+    {
+        free(copy->column);
+        free(copy->found);
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Free the buffers of a copy made by copy_tessg_calc() */
+static void free_tessg_calc(TESSG_CALC *copy)
+{
+    free(copy->column);
+    free(copy->found);
+}
+
+
+/* Free a batch of points */
+static void free_tessg_batch(TESSG_BATCH *batch)
+{
+    if(batch == NULL)
+    {
+        return;
+    }
+    free(batch->ispoint);
+    free(batch->lines);
+    free(batch->text);
+    free(batch->points);
+    free(batch->results);
+    free(batch->records);
+    free(batch);
+}
+
+
+/* Allocate a batch of points for the output. Returns NULL if there isn't
+enough memory. */
+static TESSG_BATCH * new_tessg_batch(const TESSG_OUTPUT *output)
+{
+    int ncols = output->ncols;
+
+    TESSG_BATCH *batch;
+
+    batch = (TESSG_BATCH *)malloc(sizeof(TESSG_BATCH));
+    if(batch == NULL)
+    {
+        return NULL;
+    }
+    batch->seq = 0;
+    batch->size = 0;
+    batch->textsize = 0;
+    batch->textcapacity = 2*TESSG_LINE_SIZE;
+    batch->ispoint = (int *)malloc(TESSG_BATCH_SIZE*sizeof(int));
+    batch->lines = (size_t *)malloc(TESSG_BATCH_SIZE*sizeof(size_t));
+    batch->points = (double *)malloc(3*TESSG_BATCH_SIZE*sizeof(double));
+    batch->results = (double *)malloc(TESSG_BATCH_SIZE*sizeof(double));
+    batch->text = NULL;
+    batch->records = NULL;
+    /* Text input written to a result file has records of lon, lat, height
+     * and result */
+    if(ncols > 0 || output->results != NULL)
+    {
+        batch->records = (double *)malloc(
+            ((ncols > 0 ? ncols : 3) + 1)*TESSG_BATCH_SIZE*sizeof(double));
+    }
+    if(ncols == 0)
+    {
+        batch->text = (char *)malloc(batch->textcapacity);
+    }
+    if(batch->ispoint == NULL || batch->lines == NULL ||
+       batch->points == NULL || batch->results == NULL ||
+       ((ncols > 0 || output->results != NULL) && batch->records == NULL) ||
+       (ncols == 0 && batch->text == NULL))
+    {
+        free_tessg_batch(batch);
+        return NULL;
+    }
+    return batch;
+}
+
+
+/* Make room for another line in the text of a batch. Returns where the line
+should go or NULL if there isn't enough memory. */
+static char * tessg_batch_line(TESSG_BATCH *batch)
+{
+    char *text;
+
+    if(batch->textcapacity - batch->textsize < TESSG_LINE_SIZE)
+    {
+        text = (char *)realloc(batch->text, 2*batch->textcapacity);
+        if(text == NULL)
+        {
+            log_error("problem allocating memory for the computation points");
+            return NULL;
+        }
+        batch->text = text;
+        batch->textcapacity *= 2;
+    }
+    return batch->text + batch->textsize;
+}
+
+
+/* Read the next batch of points (or make them if using a grid). Comments and
+blank lines are kept in the batch so that they are echoed in the same place of
+the output. Bad lines are skipped. Returns the number of lines (or records) in
+the batch. */
+static int read_tessg_batch(TESSG_INPUT *input, const TESSG_OUTPUT *output,
+                            TESSG_BATCH *batch)
+{
+    const double *record;
+    double *point;
+    char *buff = NULL;
+    int ncols, nchars;
+
+    batch->size = 0;
+    batch->textsize = 0;
+    batch->first = input->npoints;
+    while(batch->size < TESSG_BATCH_SIZE && !input->eof)
+    {
+        point = batch->points + 3*batch->size;
+        batch->ispoint[batch->size] = 1;
+        if(input->sorted != NULL)
+        {
+            if(input->next == input->nsorted)
+            {
+                input->eof = 1;
+                break;
+            }
+            memcpy(point, input->sorted + 3*input->next, 3*sizeof(double));
+            input->next++;
+            input->npoints++;
+            batch->size++;
+            continue;
+        }
+        if(input->binin != NULL)
+        {
+            record = read_binpoint(input->binin);
+            if(record == NULL)
+            {
+                input->error = input->binin->error;
+                input->eof = 1;
+                break;
+            }
+            ncols = input->binin->ncols;
+            memcpy(batch->records + (ncols + 1)*batch->size, record,
+                   ncols*sizeof(double));
+            memcpy(point, record, 3*sizeof(double));
+            input->npoints++;
+            batch->size++;
+            continue;
+        }
+        if(batch->text != NULL)
+        {
+            buff = tessg_batch_line(batch);
+            if(buff == NULL)
+            {
+                input->error = 1;
+                input->eof = 1;
+                break;
+            }
+        }
+        if(input->grid != NULL)
+        {
+            /* Put a blank line after each row of the grid, like tessgrd */
+            if(input->endrow && batch->text != NULL)
+            {
+                input->endrow = 0;
+                strcpy(buff, "\n");
+                batch->ispoint[batch->size] = 0;
+            }
+            else if(input->next == (long)input->grid->nlon*input->grid->nlat)
+            {
+                input->eof = 1;
+                break;
+            }
+            else
+            {
+                points_grid_point(input->grid, input->next, point);
+                input->next++;
+                input->endrow = input->next % input->grid->nlon == 0;
+                input->npoints++;
+                if(batch->text == NULL)
+                {
+                    memcpy(batch->records + 4*batch->size, point,
+                           3*sizeof(double));
+                    batch->size++;
+                    continue;
+                }
+                format_doubles(buff, point, 3, output->precision);
+            }
+        }
+        else
+        {
+            if(fgets(buff, TESSG_LINE_SIZE, stdin) == NULL)
+            {
+                input->eof = 1;
+                break;
+            }
+            input->line++;
+            /* Check for comments and blank lines */
+            if(buff[0] == '#' || buff[0] == '\r' || buff[0] == '\n')
+            {
+                batch->ispoint[batch->size] = 0;
+            }
+            else
+            {
+                /* Need to remove \n and \r from end of buff first to print
+                   the result in the end */
+                strstrip(buff);
+                if(scan_doubles(buff, point, 3, &nchars) != 3)
+                {
+                    log_warning("bad/invalid computation point at line %d:",
+                                input->line);
+                    log_warning("  '%s'", buff);
+                    log_warning("skipping this line and continuing");
+                    input->bad_input++;
+                    continue;
+                }
+                input->npoints++;
+            }
+        }
+        batch->lines[batch->size] = batch->textsize;
+        batch->textsize += strlen(buff) + 1;
+        batch->size++;
+    }
+    return batch->size;
+}
+
+
+/* Calculate the field on the points of a batch */
+static void calc_tessg_batch(TESSG_CALC *calc, TESSG_BATCH *batch)
+{
+    double *point;
+    int k;
+
+    for(k = 0; k < batch->size; k++)
+    {
+        if(batch->ispoint[k])
+        {
+            point = batch->points + 3*k;
+            batch->results[k] = calc_tessg_point(calc, point[0], point[1],
+                                                 point[2]);
+        }
+    }
+}
+
+
+/* Write the results of a batch to stdout or to their place in the binary
+result file (or the array of results). Returns the number of points written.
+*/
+static int write_tessg_batch(TESSG_BATCH *batch, const TESSG_OUTPUT *output)
+{
+    double *record;
+    int ncols = output->ncols, k, points = 0;
+
+    if(output->values != NULL)
+    {
+        memcpy(output->values + batch->first, batch->results,
+               batch->size*sizeof(double));
+        return batch->size;
+    }
+    if(ncols > 0)
+    {
+        for(k = 0; k < batch->size; k++)
+        {
+            batch->records[(ncols + 1)*k + ncols] = batch->results[k];
+        }
+        if(output->results != NULL)
+        {
+            write_binresults(output->results, batch->first, batch->records,
+                             batch->size);
+        }
+        else
+        {
+            fwrite(batch->records, (ncols + 1)*sizeof(double), batch->size,
+                   stdout);
+        }
+        return batch->size;
+    }
+    for(k = 0; k < batch->size; k++)
+    {
+        if(!batch->ispoint[k])
+        {
+            if(output->results == NULL)
+            {
+                fputs(batch->text + batch->lines[k], stdout);
+            }
+            continue;
+        }
+        if(output->results != NULL)
+        {
+            /* Only the points go into the result file */
+            record = batch->records + 4*points;
+            memcpy(record, batch->points + 3*k, 3*sizeof(double));
+            record[3] = batch->results[k];
+        }
+        else
+        {
+            print_doubles(stdout, batch->text + batch->lines[k],
+                          &batch->results[k], 1, output->precision);
+        }
+        points++;
+    }
+    if(output->results != NULL && points > 0)
+    {
+        write_binresults(output->results, batch->first, batch->records,
+                         points);
+    }
+    return points;
+}
+
+
+/* Read, calculate and write the points one batch at a time. Returns the
+number of points calculated. */
+static long run_tessg_serial(TESSG_CALC *calc, TESSG_INPUT *input,
+                             const TESSG_OUTPUT *output)
+{
+    TESSG_BATCH *batch;
+    long points = 0;
+
+    batch = new_tessg_batch(output);
+    if(batch == NULL)
+    {
+        log_error("problem allocating memory for the computation points");
+        input->error = 1;
+        return 0;
+    }
+    while(read_tessg_batch(input, output, batch) > 0)
+    {
+        calc_tessg_batch(calc, batch);
+        points += write_tessg_batch(batch, output);
+    }
+    free_tessg_batch(batch);
+    return points;
+}
+
+
+#ifdef TESSG_THREADS
+/* Queue of batches passed between the threads of the pipeline. There are never
+more batches than the capacity, so adding doesn't have to wait. */
+typedef struct tessg_queue_struct
+{
+    TESSG_BATCH **items;
+    int capacity;
+    int first;
+    int count;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+} TESSG_QUEUE;
+
+
+/* The pipeline: one thread reads the batches, several threads calculate them
+and the main thread writes them in the order of the input. Results that go to
+a binary result file (or an array) are written by the calculating threads
+instead, each batch in its own place in the file. */
+typedef struct tessg_pipeline_struct
+{
+    TESSG_QUEUE empty; /* batches free to be read into */
+    TESSG_QUEUE read; /* batches waiting to be calculated */
+    TESSG_QUEUE done; /* batches waiting to be written */
+    TESSG_INPUT *input;
+    const TESSG_OUTPUT *output;
+    int nworkers;
+} TESSG_PIPELINE;
+
+
+/* A calculating thread */
+typedef struct tessg_worker_struct
+{
+    TESSG_PIPELINE *pipeline;
+    TESSG_CALC *calc;
+} TESSG_WORKER;
+
+
+/* Initialize a queue. Returns 1 if there wasn't enough memory. */
+static int init_tessg_queue(TESSG_QUEUE *queue, int capacity)
+{
+    queue->items = (TESSG_BATCH **)malloc(capacity*sizeof(TESSG_BATCH *));
+    if(queue->items == NULL)
+    {
+        return 1;
+    }
+    queue->capacity = capacity;
+    queue->first = 0;
+    queue->count = 0;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->ready, NULL);
+    return 0;
+}
+
+
+/* Free the memory of a queue */
+static void free_tessg_queue(TESSG_QUEUE *queue)
+{
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->ready);
+    free(queue->items);
+}
+
+
+/* Add a batch to the end of a queue. NULL means that no more batches will
+come. */
+static void tessg_queue_push(TESSG_QUEUE *queue, TESSG_BATCH *batch)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->items[(queue->first + queue->count) % queue->capacity] = batch;
+    queue->count++;
+    pthread_cond_signal(&queue->ready);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+/* Remove the batch in the start of a queue. Waits if the queue is empty. */
+static TESSG_BATCH * tessg_queue_pop(TESSG_QUEUE *queue)
+{
+    TESSG_BATCH *batch;
+
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0)
+    {
+        pthread_cond_wait(&queue->ready, &queue->lock);
+    }
+    batch = queue->items[queue->first];
+    queue->first = (queue->first + 1) % queue->capacity;
+    queue->count--;
+    pthread_mutex_unlock(&queue->lock);
+    return batch;
+}
+
+
+/* Thread that reads the batches of points */
+static void * tessg_reader(void *arg)
+{
+    TESSG_PIPELINE *pipeline = (TESSG_PIPELINE *)arg;
+    TESSG_BATCH *batch;
+    long seq;
+    int k;
+
+    for(seq = 0; !pipeline->input->eof; seq++)
+    {
+        batch = tessg_queue_pop(&pipeline->empty);
+        batch->seq = seq;
+        if(read_tessg_batch(pipeline->input, pipeline->output, batch) == 0)
+        {
+            tessg_queue_push(&pipeline->empty, batch);
+            break;
+        }
+        tessg_queue_push(&pipeline->read, batch);
+    }
+    /* Tell each calculating thread to stop */
+    for(k = 0; k < pipeline->nworkers; k++)
+    {
+        tessg_queue_push(&pipeline->read, NULL);
+    }
+    return NULL;
+}
+
+
+/* Thread that calculates the batches of points */
+static void * tessg_worker(void *arg)
+{
+    TESSG_WORKER *worker = (TESSG_WORKER *)arg;
+    TESSG_PIPELINE *pipeline = worker->pipeline;
+    TESSG_BATCH *batch;
+
+    for(;;)
+    {
+        batch = tessg_queue_pop(&pipeline->read);
+        if(batch != NULL)
+        {
+            calc_tessg_batch(worker->calc, batch);
+        }
+        if(batch != NULL && (pipeline->output->results != NULL ||
+                             pipeline->output->values != NULL))
+        {
+            write_tessg_batch(batch, pipeline->output);
+            tessg_queue_push(&pipeline->empty, batch);
+            continue;
+        }
+        tessg_queue_push(&pipeline->done, batch);
+        if(batch == NULL)
+        {
+            return NULL;
+        }
+    }
+}
+
+
+/* Read, calculate and write the points using a pipeline of threads. Each
+thread in 'calcs' calculates whole batches. Returns the number of points
+calculated or -1 if the threads couldn't be started (before reading any
+input). */
+static long run_tessg_pipeline(TESSG_CALC *calcs, int nthreads,
+                               TESSG_INPUT *input, const TESSG_OUTPUT *output)
+{
+    TESSG_PIPELINE pipeline;
+    TESSG_WORKER workers[TESSG_MAX_THREADS];
+    pthread_t threads[TESSG_MAX_THREADS], reader;
+    pthread_attr_t attr;
+    TESSG_BATCH **pending = NULL, *batch;
+    long next = 0, points = 0;
+    int nbatches, capacity, nstarted = 0, finished, k, rc = 0;
+
+    nbatches = TESSG_BATCHES_PER_THREAD*nthreads;
+    capacity = nbatches + nthreads;
+    if(init_tessg_queue(&pipeline.empty, capacity))
+    {
+        return -1;
+    }
+    if(init_tessg_queue(&pipeline.read, capacity))
+    {
+        free_tessg_queue(&pipeline.empty);
+        return -1;
+    }
+    if(init_tessg_queue(&pipeline.done, capacity))
+    {
+        free_tessg_queue(&pipeline.empty);
+        free_tessg_queue(&pipeline.read);
+        return -1;
+    }
+    pipeline.input = input;
+    pipeline.output = output;
+    /* Batches waiting for the ones before them to be written */
+    pending = (TESSG_BATCH **)calloc(nbatches, sizeof(TESSG_BATCH *));
+    rc = pending == NULL;
+    for(k = 0; k < nbatches && !rc; k++)
+    {
+        batch = new_tessg_batch(output);
+        if(batch == NULL)
+        {
+            rc = 1;
+            break;
+        }
+        tessg_queue_push(&pipeline.empty, batch);
+    }
+    if(!rc)
+    {
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, TESSG_STACK_SIZE);
+        for(nstarted = 0; nstarted < nthreads; nstarted++)
+        {
+            workers[nstarted].pipeline = &pipeline;
+            workers[nstarted].calc = &calcs[nstarted];
+            if(pthread_create(&threads[nstarted], &attr, tessg_worker,
+                              &workers[nstarted]) != 0)
+            {
+                break;
+            }
+        }
+        pipeline.nworkers = nstarted;
+        rc = nstarted == 0 ||
+             pthread_create(&reader, NULL, tessg_reader, &pipeline) != 0;
+        pthread_attr_destroy(&attr);
+    }
+    if(rc)
+    {
+        /* Stop the calculating threads that were started */
+        for(k = 0; k < nstarted; k++)
+        {
+            tessg_queue_push(&pipeline.read, NULL);
+        }
+        for(k = 0; k < nstarted; k++)
+        {
+            pthread_join(threads[k], NULL);
+        }
+        points = -1;
+    }
+    else
+    {
+        log_info("Calculating with %d thread(s)", nstarted);
+        /* Write the batches in order as they are calculated */
+        for(finished = 0; finished < nstarted; )
+        {
+            batch = tessg_queue_pop(&pipeline.done);
+            if(batch == NULL)
+            {
+                finished++;
+                continue;
+            }
+            pending[batch->seq % nbatches] = batch;
+            while(pending[next % nbatches] != NULL)
+            {
+                batch = pending[next % nbatches];
+                pending[next % nbatches] = NULL;
+                points += write_tessg_batch(batch, output);
+                tessg_queue_push(&pipeline.empty, batch);
+                next++;
+            }
+        }
+        pthread_join(reader, NULL);
+        for(k = 0; k < nstarted; k++)
+        {
+            pthread_join(threads[k], NULL);
+        }
+        if(output->results != NULL || output->values != NULL)
+        {
+            points = input->npoints;
+        }
+    }
+    while(pipeline.empty.count > 0)
+    {
+        free_tessg_batch(tessg_queue_pop(&pipeline.empty));
+    }
+    free(pending);
+    free_tessg_queue(&pipeline.empty);
+    free_tessg_queue(&pipeline.read);
+    free_tessg_queue(&pipeline.done);
+    return points;
+}
+#endif
+
+
+/* Calculate on all points of the input, using 'nthreads' threads (one
+element of 'calcs' for each). Returns the number of points calculated. */
+static long run_tessg_points(TESSG_CALC *calcs, int nthreads,
+                             TESSG_INPUT *input, const TESSG_OUTPUT *output)
+{
+    long points = -1;
+
+#ifdef TESSG_THREADS
+    if(nthreads > 1)
+    {
+        points = run_tessg_pipeline(calcs, nthreads, input, output);
+        if(points < 0)
+        {
+            log_warning("failed to start the calculating threads. "
+                        "Calculating with a single thread");
+        }
+    }
+#endif
+    if(points < 0)
+    {
+        points = run_tessg_serial(calcs, input, output);
+    }
+    return points;
+}
+
+
+/* Read all points, calculate on them in the order of a Hilbert curve through
+their longitudes and latitudes and write the results in the order of the
+input. Consecutive calculations are then close to each other even if the input
+is scattered. Returns the number of points calculated. */
+static long run_tessg_sorted(TESSG_CALC *calcs, int nthreads,
+                             TESSG_INPUT *input, const TESSG_OUTPUT *output)
+{
+    TESSG_BATCH **batches = NULL, **newbatches, *batch;
+    TESSG_INPUT sorted_input;
+    TESSG_OUTPUT sorted_output;
+    double *points = NULL, *sorted = NULL, *values = NULL, *inorder = NULL;
+    char *text;
+    long *order = NULL;
+    long npoints, written = 0, i, n;
+    int nbatches = 0, capacity = 0, k;
+
+    /* Read the whole input */
+    for(;;)
+    {
+        if(nbatches == capacity)
+        {
+            capacity = capacity == 0 ? 64 : 2*capacity;
+            newbatches = (TESSG_BATCH **)realloc(batches,
+                capacity*sizeof(TESSG_BATCH *));
+            if(newbatches == NULL)
+            {
+                break;
+            }
+            batches = newbatches;
+        }
+        batch = new_tessg_batch(output);
+        if(batch == NULL)
+        {
+            input->error = 1;
+            break;
+        }
+        if(read_tessg_batch(input, output, batch) == 0)
+        {
+            free_tessg_batch(batch);
+            break;
+        }
+        /* Give back the memory for lines that will not be read */
+        if(batch->text != NULL)
+        {
+            text = (char *)realloc(batch->text, batch->textsize);
+            if(text != NULL)
+            {
+                batch->text = text;
+                batch->textcapacity = batch->textsize;
+            }
+        }
+        batches[nbatches] = batch;
+        nbatches++;
+    }
+    npoints = input->npoints;
+    if(!input->eof || input->error || npoints == 0)
+    {
+        input->error = !input->eof || input->error;
+    }
+    else
+    {
+        points = (double *)malloc(3*npoints*sizeof(double));
+        sorted = (double *)malloc(3*npoints*sizeof(double));
+        values = (double *)malloc(npoints*sizeof(double));
+        inorder = (double *)malloc(npoints*sizeof(double));
+        order = (long *)malloc(npoints*sizeof(long));
+        input->error = points == NULL || sorted == NULL || values == NULL ||
+                       inorder == NULL || order == NULL;
+    }
+    if(input->error)
+    {
+        log_error("problem allocating memory to sort the computation points");
+    }
+    if(!input->error && npoints > 0)
+    {
+        for(n = 0, i = 0; i < nbatches; i++)
+        {
+            for(k = 0; k < batches[i]->size; k++)
+            {
+                if(batches[i]->ispoint[k])
+                {
+                    memcpy(points + 3*n, batches[i]->points + 3*k,
+                           3*sizeof(double));
+                    n++;
+                }
+            }
+        }
+        input->error = hilbert_sort(points, 3, npoints, order);
+        if(input->error)
+        {
+            log_error("problem allocating memory to sort the computation "
+                      "points");
+        }
+    }
+    if(!input->error && npoints > 0)
+    {
+        log_info("Calculating on %ld points in the order of a Hilbert curve",
+                 npoints);
+        for(i = 0; i < npoints; i++)
+        {
+            memcpy(sorted + 3*i, points + 3*order[i], 3*sizeof(double));
+        }
+        memset(&sorted_input, 0, sizeof(TESSG_INPUT));
+        sorted_input.sorted = sorted;
+        sorted_input.nsorted = npoints;
+        sorted_output.ncols = 0;
+        sorted_output.precision = output->precision;
+        sorted_output.results = NULL;
+        sorted_output.values = values;
+        run_tessg_points(calcs, nthreads, &sorted_input, &sorted_output);
+        input->error = sorted_input.error;
+    }
+    if(!input->error)
+    {
+        /* Put the results back in the order of the input and write them */
+        for(i = 0; i < npoints; i++)
+        {
+            inorder[order[i]] = values[i];
+        }
+        for(n = 0, i = 0; i < nbatches; i++)
+        {
+            for(k = 0; k < batches[i]->size; k++)
+            {
+                if(batches[i]->ispoint[k])
+                {
+                    batches[i]->results[k] = inorder[n];
+                    n++;
+                }
+            }
+            written += write_tessg_batch(batches[i], output);
+        }
+    }
+    for(i = 0; i < nbatches; i++)
+    {
+        free_tessg_batch(batches[i]);
+    }
+    free(batches);
+    free(points);
+    free(sorted);
+    free(values);
+    free(inorder);
+    free(order);
+    return written;
+}
+
+
 /* Run the main for a generic tessg* program */
 int run_tessg_main(int argc, char **argv, const char *progname,
-    double (*field)(TESSEROID, double, double, double, GLQ, GLQ, GLQ),
+    double (*field)(TESSEROID, double, double, double, const GLQ *,
+                    const GLQ *, const GLQ *),
+    double (*column_field)(TESSEROID *, int, double, double, double,
+                           const GLQ *, const GLQ *, const GLQ *),
     double ratio)
 {
     TESSG_ARGS args;
     GLQ *glq_lon, *glq_lat, *glq_r;
-    TESSEROID *model;
-    int modelsize, rc, line, points = 0, error_exit = 0, bad_input = 0;
-    char buff[10000];
-    double lon, lat, height, res;
+    TESSEROID *model = NULL, *column = NULL;
+    TESS_GRID *grid = NULL;
+    TESS_PYRAMID *pyramid = NULL;
+    TESS_INDEX *index = NULL;
+    TESS_TILED_MODEL *tiled = NULL;
+    TESSG_INPUT input;
+    TESSG_OUTPUT output;
+    TESSG_CALC calc, *calcs = NULL;
+    long modelsize, *columns = NULL, ncolumns = 0, *found = NULL,
+         *order = NULL, points = 0;
+    int rc, error_exit = 0, output_error = 0, nthreads = 1, k;
+    double cutoff = 0;
     FILE *logfile = NULL, *modelfile = NULL;
     time_t rawtime;
-    clock_t tstart;
+    clock_t tstart = clock();
     struct tm * timeinfo;
 
     log_init(LOG_INFO);
@@ -176,117 +1263,454 @@ int run_tessg_main(int argc, char **argv, const char *progname,
     }
 
     /* Read the tesseroid model file */
-    log_info("Reading tesseroid model from file %s", args.modelfname);
-    modelfile = fopen(args.modelfname, "r");
-    if(modelfile == NULL)
+    if(!args.grid_model && is_tess_tiles(args.modelfname))
     {
-        log_error("failed to open model file %s", args.modelfname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        if(args.logtofile)
-            fclose(logfile);
-        return 1;
+        log_info("Opening binary tesseroid model from file %s",
+                 args.modelfname);
+        tiled = open_tess_tiles(args.modelfname);
+        if(tiled == NULL)
+        {
+            log_error("failed to open binary model file %s",
+                      args.modelfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            if(args.logtofile)
+                fclose(logfile);
+            return 1;
+        }
+        modelsize = tiled->size;
+        log_info("Total of %ld tesseroid(s) in %ld tile(s)", modelsize,
+                 tiled->ntiles);
+        if(args.cutoff != 0 || args.sort_model)
+        {
+            if(args.cutoff != 0)
+            {
+                log_error("option -c can't be used with a binary model file");
+            }
+            if(args.sort_model)
+            {
+                log_error("option --sort-model can't be used with a binary "
+                          "model file. Use tess2tiles --sort instead.");
+            }
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            close_tess_tiles(tiled);
+            if(args.logtofile)
+                fclose(logfile);
+            return 1;
+        }
+        if(args.lod_ratio != 0)
+        {
+            log_info("Distance-size ratio for the tile aggregates: %g",
+                     args.lod_ratio);
+        }
     }
-    model = read_tess_model(modelfile, &modelsize);
-    fclose(modelfile);
-    if(modelsize == 0)
+    else
     {
-        log_error("tesseroid file %s is empty", args.modelfname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        if(args.logtofile)
-            fclose(logfile);
-        return 1;
+        log_info("Reading tesseroid model from file %s", args.modelfname);
+        modelfile = fopen(args.modelfname, "r");
+        if(modelfile == NULL)
+        {
+            log_error("failed to open model file %s", args.modelfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            if(args.logtofile)
+                fclose(logfile);
+            return 1;
+        }
+        if(args.grid_model)
+        {
+            grid = read_tess_grid(modelfile, args.grid_dlon, args.grid_dlat);
+            fclose(modelfile);
+            if(grid == NULL)
+            {
+                log_error("failed to read grid model from file %s",
+                          args.modelfname);
+                log_warning("Terminating due to bad input");
+                log_warning("Try '%s -h' for instructions", progname);
+                if(args.logtofile)
+                    fclose(logfile);
+                return 1;
+            }
+            modelsize = (long)grid->nlon*grid->nlat*grid->nlayers;
+            log_info("Grid model of %d x %d points with %d layer(s)",
+                     grid->nlon, grid->nlat, grid->nlayers);
+            /* Buffer for the tesseroids of each cell of the grid */
+            column = (TESSEROID *)malloc(grid->nlayers*sizeof(TESSEROID));
+            if(column == NULL)
+            {
+                log_error("problem allocating memory for the grid model");
+                free_tess_grid(grid);
+                if(args.logtofile)
+                    fclose(logfile);
+                return 1;
+            }
+            if(args.lod_ratio != 0)
+            {
+                pyramid = new_tess_pyramid(grid, 32);
+                if(pyramid == NULL)
+                {
+                    log_error("problem allocating memory for the "
+                              "multi-resolution pyramid");
+                    free_tess_grid(grid);
+                    free(column);
+                    if(args.logtofile)
+                        fclose(logfile);
+                    return 1;
+                }
+                log_info("Multi-resolution pyramid with %d level(s)",
+                         pyramid->nlevels);
+                log_info("Distance-size ratio for the coarse levels: %g",
+                         args.lod_ratio);
+            }
+        }
+        else
+        {
+            model = read_tess_model_cached(modelfile, args.modelfname,
+                                           args.sort_model ? &order : NULL,
+                                           &modelsize);
+            fclose(modelfile);
+            /* Nothing is reported about single tesseroids in terms of the
+             * model file, so the positions aren't needed */
+            free(order);
+            if(modelsize == 0)
+            {
+                log_error("tesseroid file %s is empty", args.modelfname);
+                log_warning("Terminating due to bad input");
+                log_warning("Try '%s -h' for instructions", progname);
+                free(model);
+                if(args.logtofile)
+                    fclose(logfile);
+                return 1;
+            }
+            if(model == NULL)
+            {
+                log_error("failed to read model from file %s", args.modelfname);
+                log_warning("Terminating due to bad input");
+                log_warning("Try '%s -h' for instructions", progname);
+                if(args.logtofile)
+                    fclose(logfile);
+                return 1;
+            }
+            log_info("Total of %ld tesseroid(s) read", modelsize);
+            if(args.sort_model)
+            {
+                log_info("Reordered the model along a Hilbert curve");
+            }
+            if(args.lod_ratio != 0)
+            {
+                log_error("option -d needs -g or a binary model file");
+                log_warning("Terminating due to bad input");
+                log_warning("Try '%s -h' for instructions", progname);
+                free(model);
+                if(args.logtofile)
+                    fclose(logfile);
+                return 1;
+            }
+
+            /* Find the vertical columns (stacked layers) of the model so that
+             * the horizontal part of the integration is shared by their
+             * tesseroids */
+            columns = (long *)malloc((modelsize + 1)*sizeof(long));
+            if(columns == NULL)
+            {
+                log_error("problem allocating memory for the columns of the "
+                          "model");
+                free(model);
+                if(args.logtofile)
+                    fclose(logfile);
+                return 1;
+            }
+            ncolumns = tess_find_columns(model, modelsize, columns);
+            log_info("Total of %ld vertical column(s) of tesseroids",
+                     ncolumns);
+
+            /* Index the columns to find the ones within the cutoff distance of
+             * each point */
+            if(args.cutoff != 0)
+            {
+                cutoff = (args.cutoff/MEAN_EARTH_RADIUS)*180./PI;
+                index = new_tess_index(model, columns, ncolumns, cutoff);
+                found = (long *)malloc(ncolumns*sizeof(long));
+                if(index == NULL || found == NULL)
+                {
+                    log_error("problem allocating memory for the spatial "
+                              "index");
+                    if(index != NULL)
+                        free_tess_index(index);
+                    free(found);
+                    free(model);
+                    free(columns);
+                    if(args.logtofile)
+                        fclose(logfile);
+                    return 1;
+                }
+                log_info("Using only tesseroids within %g m (%g degrees)",
+                         args.cutoff, cutoff);
+                log_info("Spatial index with %d x %d buckets of %g degrees",
+                         index->nlon, index->nlat, index->dlon);
+            }
+        }
     }
-    if(model == NULL)
+
+    /* Write the output in large blocks */
+    setvbuf(stdout, NULL, _IOFBF, 65536);
+    /* Print a header on the output with provenance information. Binary
+     * output only has the header of the records. */
+    input.grid = args.grid.parsed ? &args.grid : NULL;
+    input.sorted = NULL;
+    input.nsorted = 0;
+    input.next = 0;
+    input.endrow = 0;
+    input.binin = NULL;
+    input.line = 0;
+    input.npoints = 0;
+    input.bad_input = 0;
+    input.eof = 0;
+    input.error = 0;
+    output.ncols = 0;
+    output.precision = args.precision;
+    output.results = NULL;
+    output.values = NULL;
+    if(input.grid != NULL && (args.binary || args.resultstofile))
     {
-        log_error("failed to read model from file %s", args.modelfname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        if(args.logtofile)
-            fclose(logfile);
-        return 1;
+        output.ncols = 3;
     }
-    log_info("Total of %d tesseroid(s) read", modelsize);
-
-    /* Print a header on the output with provenance information */
-    if(strcmp(progname + 4, "pot") == 0)
+    else if(args.binary)
     {
-        printf("# Potential calculated with %s %s:\n", progname,
-               tesseroids_version);
+        input.binin = open_binpoints(stdin);
+        if(input.binin == NULL || input.binin->ncols < 3)
+        {
+            log_error("invalid binary input. Needs at least 3 values per "
+                      "record");
+            error_exit = 1;
+        }
+        else
+        {
+            output.ncols = input.binin->ncols;
+        }
+    }
+    if(args.resultstofile)
+    {
+        /* The results go to their place in the result file, so nothing is
+         * printed */
+        if(!error_exit)
+        {
+            log_info("Writing the results to binary file %s",
+                     args.resultsfname);
+            output.results = create_binresults(args.resultsfname,
+                output.ncols > 0 ? output.ncols + 1 : 4,
+                input.grid != NULL ? (long)args.grid.nlon*args.grid.nlat : 0);
+            output_error = output.results == NULL;
+        }
+    }
+    else if(args.binary)
+    {
+        if(!error_exit)
+        {
+            write_binpoints_header(stdout, output.ncols + 1);
+        }
     }
     else
     {
-        printf("# %s component calculated with %s %s:\n", progname+4, progname,
-               tesseroids_version);
+        if(strcmp(progname + 4, "pot") == 0)
+        {
+            printf("# Potential calculated with %s %s:\n", progname,
+                   tesseroids_version);
+        }
+        else
+        {
+            printf("# %s component calculated with %s %s:\n", progname+4,
+                   progname, tesseroids_version);
+        }
+        printf("#   local time: %s", asctime(timeinfo));
+        if(args.grid_model)
+        {
+            printf("#   model file: %s (grid of %d x %d points with %d "
+                   "layers)\n", args.modelfname, grid->nlon, grid->nlat,
+                   grid->nlayers);
+            if(pyramid != NULL)
+            {
+                printf("#   Multi-resolution pyramid: %d levels, "
+                       "distance-size ratio %g\n", pyramid->nlevels,
+                       args.lod_ratio);
+            }
+        }
+        else if(tiled != NULL)
+        {
+            printf("#   model file: %s (binary, %ld tesseroids in %ld tiles)\n",
+                   args.modelfname, modelsize, tiled->ntiles);
+            if(args.lod_ratio != 0)
+            {
+                printf("#   Distance-size ratio for the tile aggregates: %g\n",
+                       args.lod_ratio);
+            }
+        }
+        else
+        {
+            printf("#   model file: %s (%ld tesseroids)\n", args.modelfname,
+                   modelsize);
+            if(index != NULL)
+            {
+                printf("#   Cutoff distance: %g m\n", args.cutoff);
+            }
+        }
+        if(input.grid != NULL)
+        {
+            printf("#   grid of %d x %d points: %g W / %g E / %g S / %g N, "
+                   "height %g\n", args.grid.nlon, args.grid.nlat, args.grid.w,
+                   args.grid.e, args.grid.s, args.grid.n, args.grid.height);
+        }
+        printf("#   GLQ order: %d lon / %d lat / %d r\n", args.lon_order,
+               args.lat_order, args.r_order);
+        printf("#   Use recursive division of tesseroids: %s\n",
+               args.adaptative ? "True" : "False");
+        printf("#   Distance-size ratio for recusive division: %g\n", ratio);
     }
-    printf("#   local time: %s", asctime(timeinfo));
-    printf("#   model file: %s (%d tesseroids)\n", args.modelfname, modelsize);
-    printf("#   GLQ order: %d lon / %d lat / %d r\n", args.lon_order,
-           args.lat_order, args.r_order);
-    printf("#   Use recursive division of tesseroids: %s\n",
-           args.adaptative ? "True" : "False");
-    printf("#   Distance-size ratio for recusive division: %g\n", ratio);
 
-    /* Read each computation point from stdin and calculate */
-    log_info("Calculating (this may take a while)...");
-    tstart = clock();
-    for(line = 1; fgets(buff, 10000, stdin) != NULL; line++)
+    /* Everything the threads need to calculate. Each thread has its own
+     * buffers. */
+    calc.args = &args;
+    calc.model = model;
+    calc.modelsize = modelsize;
+    calc.columns = columns;
+    calc.ncolumns = ncolumns;
+    calc.grid = grid;
+    calc.pyramid = pyramid;
+    calc.index = index;
+    calc.tiled = tiled;
+    calc.cutoff = cutoff;
+    calc.ratio = ratio;
+    calc.field = field;
+    calc.column_field = column_field;
+    calc.glq_lon = glq_lon;
+    calc.glq_lat = glq_lat;
+    calc.glq_r = glq_r;
+    calc.column = column;
+    calc.found = found;
+#ifdef TESSG_THREADS
+    nthreads = args.nthreads;
+    if(nthreads == 0)
+    {
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if(nthreads > TESSG_MAX_THREADS)
+    {
+        nthreads = TESSG_MAX_THREADS;
+    }
+    if(nthreads < 1)
     {
-        /* Check for comments and blank lines */
-        if(buff[0] == '#' || buff[0] == '\r' || buff[0] == '\n')
+        nthreads = 1;
+    }
+    if(nthreads > 1)
+    {
+        calcs = (TESSG_CALC *)malloc(nthreads*sizeof(TESSG_CALC));
+        if(calcs == NULL)
         {
-            printf("%s", buff);
-            continue;
+            nthreads = 1;
         }
-        /* Need to remove \n and \r from end of buff first to print the
-           result in the end */
-        strstrip(buff);
-        if(sscanf(buff, "%lf %lf %lf", &lon, &lat, &height) != 3)
+        else
         {
-            log_warning("bad/invalid computation point at line %d:", line);
-            log_warning("  '%s'", buff);
-            log_warning("skipping this line and continuing");
-            bad_input++;
-            continue;
+            calcs[0] = calc;
+            for(k = 1; k < nthreads; k++)
+            {
+                if(copy_tessg_calc(&calc, &calcs[k]))
+                {
+                    log_warning("not enough memory for %d threads. Using %d",
+                                nthreads, k);
+                    nthreads = k;
+                    break;
+                }
+            }
         }
-        if(args.adaptative)
+    }
+#else
+    if(args.nthreads > 1)
+    {
+        log_warning("threads aren't supported on this system. "
+                    "Calculating with a single thread");
+    }
+#endif
+
+    /* Read each computation point from stdin and calculate */
+    if(!error_exit && !output_error)
+    {
+        log_info("Calculating (this may take a while)...");
+        tstart = clock();
+        if(args.sort_points)
         {
-            res = calc_tess_model_adapt(model, modelsize, lon, lat,
-                                        height + MEAN_EARTH_RADIUS, glq_lon,
-                                        glq_lat, glq_r, field, ratio);
+            points = run_tessg_sorted(calcs != NULL ? calcs : &calc, nthreads,
+                                      &input, &output);
         }
         else
         {
-            res = calc_tess_model(model, modelsize, lon, lat,
-                                  height + MEAN_EARTH_RADIUS, glq_lon,
-                                  glq_lat, glq_r, field);
+            points = run_tessg_points(calcs != NULL ? calcs : &calc, nthreads,
+                                      &input, &output);
         }
-        printf("%s %.15g\n", buff, res);
-        points++;
+        error_exit = input.error;
     }
-    if(bad_input)
+    if(output.results != NULL &&
+       close_binresults(output.results, input.npoints) != 0)
+    {
+        output_error = 1;
+    }
+    if(input.bad_input)
     {
         log_warning("Encountered %d bad computation points which were skipped",
-                    bad_input);
+                    input.bad_input);
     }
     if(error_exit)
     {
         log_warning("Terminating due to error in input");
         log_warning("Try '%s -h' for instructions", progname);
     }
+    else if(output_error)
+    {
+        log_warning("Terminating due to error in output");
+    }
     else
     {
-        log_info("Calculated on %d points in %.5g seconds", points,
+        log_info("Calculated on %ld points in %.5g seconds", points,
                  (double)(clock() - tstart)/CLOCKS_PER_SEC);
     }
     /* Clean up */
+    if(pyramid != NULL)
+    {
+        free_tess_pyramid(pyramid);
+    }
+    if(index != NULL)
+    {
+        free_tess_index(index);
+        free(found);
+    }
+    if(tiled != NULL)
+    {
+        close_tess_tiles(tiled);
+    }
+    if(input.binin != NULL)
+    {
+        close_binpoints(input.binin);
+    }
+    if(calcs != NULL)
+    {
+        for(k = 1; k < nthreads; k++)
+        {
+            free_tessg_calc(&calcs[k]);
+        }
+        free(calcs);
+    }
+    if(args.grid_model)
+    {
+        free_tess_grid(grid);
+        free(column);
+    }
     free(model);
+    free(columns);
     glq_free(glq_lon);
     glq_free(glq_lat);
     glq_free(glq_r);
     log_info("Done");
     if(args.logtofile)
         fclose(logfile);
-    return 0;
+    return error_exit || output_error;
 }
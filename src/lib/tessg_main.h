@@ -25,12 +25,17 @@ extern void print_tessg_help(const char *progname);
 @param argv command line arguments
 @param progname name of the specific program
 @param field pointer to function that calculates the field of a single tesseroid
+@param column_field pointer to function that calculates the field of a column
+                    of tesseroids (used when the model has stacked layers)
 @param ratio distance-to-size ratio for doing adaptative resizing
 
 @return 0 is all went well. 1 if failed.
 */
 extern int run_tessg_main(int argc, char **argv, const char *progname,
-   double (*field)(TESSEROID, double, double, double, GLQ, GLQ, GLQ),
+   double (*field)(TESSEROID, double, double, double, const GLQ *,
+                   const GLQ *, const GLQ *),
+   double (*column_field)(TESSEROID *, int, double, double, double,
+                          const GLQ *, const GLQ *, const GLQ *),
    double ratio);
 
 #endif
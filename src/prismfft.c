@@ -0,0 +1,232 @@
+/*
+Program to calculate gz and gzz of a regular grid of prisms with the Fourier
+transform (Parker expansion).
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "version.h"
+#include "parsers.h"
+#include "logger.h"
+#include "geometry.h"
+#include "model_cache.h"
+#include "parker.h"
+
+
+/** Print the help message */
+void print_help()
+{
+    printf("Usage: prismfft MODELFILE -zHEIGHT [OPTIONS]\n\n");
+    printf("Calculate gz and gzz of a regular grid of rectangular prisms\n");
+    printf("with the Fourier transform, using the expansion of Parker\n");
+    printf("(1973) for the relief of the interfaces of the layers.\n\n");
+    printf("The computation points are the centers of the cells of the\n");
+    printf("grid, at a constant height above all the prisms. The cost is\n");
+    printf("proportional to N*log(N) for N cells, instead of N*N for\n");
+    printf("prismgz and prismgzz on the same points. The results approach\n");
+    printf("those of prismgz and prismgzz as the number of terms grows,\n");
+    printf("except close to the edges of the grid. The grid is padded with\n");
+    printf("zeros to reduce the effect of the periodicity of the transform\n");
+    printf("(see option -e).\n\n");
+    printf("All units either SI or degrees!\n\n");
+    printf("The coordinate system used is:\n");
+    printf("  x -> North  y -> East  z -> Down\n\n");
+    printf("Input:\n");
+    printf("  MODELFILE: File containing the prism model, in the format of\n");
+    printf("  the prismg* programs (for example from tess2prism --flatten\n");
+    printf("  of a model generated by tesslayers):\n");
+    printf("    x1 x2 y1 y2 z1 z2 density\n");
+    printf("  * All prisms must have the same horizontal dimensions and be\n");
+    printf("    on the same regular grid\n");
+    printf("  * Every cell of the grid must have the same number of prisms\n");
+    printf("    (the layers)\n\n");
+    printf("Output:\n");
+    printf("  Printed to standard output (stdout) one point per line in the\n");
+    printf("  format:\n");
+    printf("    y x height gz gzz\n");
+    printf("  gz in mGal and gzz in Eotvos. A blank line separates the rows\n");
+    printf("  of points with the same x.\n");
+    printf("  Comments about the provenance of the data are inserted into\n");
+    printf("  the top of the output.\n\n");
+    printf("Options:\n");
+    printf("  -zHEIGHT     Height of the computation points (z = -HEIGHT).\n");
+    printf("               Must be above the tops of all prisms. Required.\n");
+    printf("  -tTERMS      Number of terms of the expansion of each\n");
+    printf("               interface. Defaults to 4.\n");
+    printf("  -eFACTOR     Pad the grid with zeros to FACTOR times its size\n");
+    printf("               (rounded up to a power of 2). Larger factors\n");
+    printf("               reduce the error due to the copies of the model\n");
+    printf("               around the grid (by FACTOR^3) but take more\n");
+    printf("               memory. Defaults to 2.\n");
+    printf("  -pDIGITS     Number of significant digits of the results.\n");
+    printf("               From 1 to 17. Defaults to 15.\n");
+    printf("  -h           Print instructions.\n");
+    printf("  --version    Print version and license information.\n");
+    printf("  -v           Enable verbose printing to stderr.\n");
+    printf("  -lFILENAME   Print log messages to file FILENAME.\n");
+    printf("\nReferences:\n");
+    printf("  Parker, R. L. (1973): The rapid calculation of potential\n");
+    printf("  anomalies. Geophysical Journal of the Royal Astronomical\n");
+    printf("  Society, 31, 447-455.\n");
+    print_copyright();
+}
+
+
+/** Main */
+int main(int argc, char **argv)
+{
+    char *progname = "prismfft";
+    PRISMFFT_ARGS args;
+    PRISM *model;
+    PRISM_GRID *grid;
+    int rc, modelsize, i, j, k;
+    double *gz, point[3], results[2];
+    char buff[200];
+    FILE *logfile = NULL, *modelfile = NULL;
+    time_t rawtime;
+    clock_t tstart;
+    struct tm * timeinfo;
+
+    log_init(LOG_INFO);
+    rc = parse_prismfft_args(argc, argv, progname, &args, &print_help);
+    if(rc == 3)
+    {
+        log_error("%s: missing input file", progname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+    if(rc == 2)
+    {
+        return 0;
+    }
+    if(rc == 1)
+    {
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+    /* Set the appropriate logging level and log to file if necessary */
+    if(!args.verbose)
+    {
+        log_init(LOG_WARNING);
+    }
+    if(args.logtofile)
+    {
+        logfile = fopen(args.logfname, "w");
+        if(logfile == NULL)
+        {
+            log_error("unable to create log file %s", args.logfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            return 1;
+        }
+        log_tofile(logfile, LOG_INFO);
+    }
+
+    /* Print standard verbose */
+    log_info("%s (Tesseroids project) %s", progname, tesseroids_version);
+    time(&rawtime);
+    timeinfo = localtime(&rawtime);
+    log_info("(local time) %s", asctime(timeinfo));
+
+    /* Read the model file */
+    log_info("Reading prism model from file %s", args.inputfname);
+    modelfile = fopen(args.inputfname, "r");
+    if(modelfile == NULL)
+    {
+        log_error("failed to open model file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    model = read_prism_model_cached(modelfile, args.inputfname, 0,
+                                    &modelsize);
+    fclose(modelfile);
+    if(model == NULL || modelsize == 0)
+    {
+        log_error("failed to read model from file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        free(model);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Total of %d prism(s) read", modelsize);
+    grid = prism_grid_from_model(model, modelsize);
+    free(model);
+    if(grid == NULL)
+    {
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Grid of %d x %d cells of %g x %g with %d layer(s)", grid->nx,
+             grid->ny, grid->dx, grid->dy, grid->nlayers);
+
+    /* Calculate */
+    gz = (double *)malloc(2*(size_t)grid->nx*grid->ny*sizeof(double));
+    if(gz == NULL)
+    {
+        log_error("problem allocating memory for the results");
+        free_prism_grid(grid);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Calculating with %d term(s)...", args.nterms);
+    tstart = clock();
+    if(parker_gz_gzz(grid, args.height, args.nterms, args.padding, gz,
+                     gz + grid->nx*grid->ny) != 0)
+    {
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        free(gz);
+        free_prism_grid(grid);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Calculated on %d points in %.5g seconds", grid->nx*grid->ny,
+             (double)(clock() - tstart)/CLOCKS_PER_SEC);
+
+    /* Print a header on the output with provenance information */
+    setvbuf(stdout, NULL, _IOFBF, 65536);
+    printf("# gz and gzz calculated with %s %s:\n", progname,
+           tesseroids_version);
+    printf("#   local time: %s", asctime(timeinfo));
+    printf("#   model file: %s (%d prisms)\n", args.inputfname, modelsize);
+    printf("#   grid of %d x %d cells with %d layer(s), height %g\n",
+           grid->nx, grid->ny, grid->nlayers, args.height);
+    printf("#   Parker expansion with %d term(s), padding %d\n", args.nterms,
+           args.padding);
+    printf("#   format: y x height gz gzz\n");
+    point[2] = args.height;
+    for(i = 0; i < grid->nx; i++)
+    {
+        point[1] = grid->x1 + (i + 0.5)*grid->dx;
+        for(j = 0; j < grid->ny; j++)
+        {
+            point[0] = grid->y1 + (j + 0.5)*grid->dy;
+            k = i*grid->ny + j;
+            results[0] = gz[k];
+            results[1] = gz[grid->nx*grid->ny + k];
+            format_doubles(buff, point, 3, args.precision);
+            print_doubles(stdout, buff, results, 2, args.precision);
+        }
+        printf("\n");
+    }
+    free(gz);
+    free_prism_grid(grid);
+    log_info("Done");
+    if(args.logtofile)
+        fclose(logfile);
+    return 0;
+}
@@ -3,12 +3,12 @@ Program to calculate potential of a rectangular prism model on a set of points.
 */
 
 
-#include "grav_prism.h"
+#include "grav_prism_soa.h"
 #include "prismg_main.h"
 
 
 /** Main */
 int main(int argc, char **argv)
 {
-    return run_prismg_main(argc, argv, "prismpot", &prism_pot);
+    return run_prismg_main(argc, argv, "prismpot", &prism_pot_soa);
 }
@@ -5,15 +5,9 @@ coordinates.
 
 
 #include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include "logger.h"
-#include "version.h"
 #include "grav_prism_sph.h"
 #include "geometry.h"
-#include "constants.h"
-#include "parsers.h"
+#include "prism_main.h"
 
 
 /* Print the help message  */
@@ -56,10 +50,51 @@ void print_help()
     printf("      DX DY DZ Density lon lat r\n");
     printf("    This is the format output by tess2prism.\n\n");
     printf("Options:\n");
+    printf("  -rW/E/S/N    Calculate on a regular grid of points instead of\n");
+    printf("  -bNLON/NLAT  reading them from stdin. Same as the options of\n");
+    printf("  -zHEIGHT     tessgrd: the borders of the grid in degrees, the\n");
+    printf("               number of points in longitude and latitude and\n");
+    printf("               the height of the grid in meters.\n");
+    printf("  -pDIGITS     Number of significant digits of the results.\n");
+    printf("               From 1 to 17. Defaults to 15.\n");
+    printf("  -jTHREADS    Number of threads used for the calculation.\n");
+    printf("               Defaults to the number of processors. The\n");
+    printf("               threads calculate different points and\n");
+    printf("               different parts of the model. The output is in\n");
+    printf("               the order of the input and doesn't depend on\n");
+    printf("               the number of threads.\n");
+    printf("  -cDISTANCE   Only use the prisms within DISTANCE meters\n");
+    printf("               (horizontally) of each computation point. The\n");
+    printf("               prisms are grouped into tiles and whole tiles\n");
+    printf("               are used or left out, so some prisms a little\n");
+    printf("               farther away are also used. Faster for large\n");
+    printf("               models when the field decays quickly with the\n");
+    printf("               distance (like the gradient tensor).\n");
+    printf("  --far-field  With -c, replace each tile beyond DISTANCE by a\n");
+    printf("               cube with its mass at its center of mass\n");
+    printf("               instead of leaving it out.\n");
+    printf("  --binary     Read the computation points from stdin and write\n");
+    printf("               the results to stdout in binary (see Binary\n");
+    printf("               input/output bellow).\n");
     printf("  -h           Print instructions.\n");
     printf("  --version    Print version and license information.\n");
     printf("  -v           Enable verbose printing to stderr.\n");
     printf("  -lFILENAME   Print log messages to file FILENAME.\n");
+    printf("\n");
+    printf("Binary input/output:\n");
+    printf("  With option --binary, the input and output are a header\n");
+    printf("  followed by records of NCOLS double precision numbers:\n");
+    printf("    * 8 characters: TESSPTS1\n");
+    printf("    * int: NCOLS\n");
+    printf("    * int: unused\n");
+    printf("  The first 3 numbers of an input record are lon, lat and\n");
+    printf("  height. The output records are the input records with the\n");
+    printf("  results appended. The numbers use the byte order of the\n");
+    printf("  computer.\n");
+    printf("  With options -r, -b and -z, only the output is binary and its\n");
+    printf("  records are lon, lat, height and the results.\n");
+    printf("  If the binary input is invalid or ends in an incomplete\n");
+    printf("  record, the program stops with exit status 1.\n");
     printf("\nPart of the Tesseroids package.\n");
     printf("Project site: <http://fatiando.org/software/tesseroids>\n");
     printf("Report bugs at: ");
@@ -67,164 +102,19 @@ void print_help()
 }
 
 
-/* Run the main for a generic prismg* program */
-int main(int argc, char **argv)
+/* The field of a prism in the form used by run_prism_main */
+static void prism_pot_frame(PRISM prism, const SPH_FRAME *pframe,
+                            const SPH_FRAME *point, double *res)
 {
-    BASIC_ARGS args;
-    PRISM *model;
-    int modelsize, rc, line, points = 0, error_exit = 0, bad_input = 0, i;
-    char buff[10000];
-    char progname[] = "prismpots";
-    double lon, lat, height, res;
-    FILE *logfile = NULL, *modelfile = NULL;
-    time_t rawtime;
-    clock_t tstart;
-    struct tm * timeinfo;
-
-    log_init(LOG_INFO);
-    strcpy(progname, progname);
-    rc = parse_basic_args(argc, argv, progname, &args, &print_help);
-    if(rc == 3)
-    {
-        log_error("%s: missing input file", progname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        return 1;
-    }
-    if(rc == 2)
-    {
-        return 0;
-    }
-    if(rc == 1)
-    {
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        return 1;
-    }
-    /* Set the appropriate logging level and log to file if necessary */
-    if(!args.verbose)
-    {
-        log_init(LOG_WARNING);
-    }
-    if(args.logtofile)
-    {
-        logfile = fopen(args.logfname, "w");
-        if(logfile == NULL)
-        {
-            log_error("unable to create log file %s", args.logfname);
-            log_warning("Terminating due to bad input");
-            log_warning("Try '%s -h' for instructions", progname);
-            return 1;
-        }
-        log_tofile(logfile, LOG_INFO);
-    }
-
-    /* Print standard verbose */
-    log_info("%s (Tesseroids project) %s", progname, tesseroids_version);
-    time(&rawtime);
-    timeinfo = localtime(&rawtime);
-    log_info("(local time) %s", asctime(timeinfo));
+    *res = prism_pot_sph_frame(prism, pframe, point);
+}
 
-    /* Read the model file */
-    log_info("Reading prism model from file %s", args.inputfname);
-    modelfile = fopen(args.inputfname, "r");
-    if(modelfile == NULL)
-    {
-        log_error("failed to open model file %s", args.inputfname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        if(args.logtofile)
-            fclose(logfile);
-        return 1;
-    }
-    model = read_prism_model(modelfile, 1, &modelsize);
-    fclose(modelfile);
-    if(modelsize == 0)
-    {
-        log_error("prism file %s is empty", args.inputfname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        if(args.logtofile)
-            fclose(logfile);
-        return 1;
-    }
-    if(model == NULL)
-    {
-        log_error("failed to read model from file %s", args.inputfname);
-        log_warning("Terminating due to bad input");
-        log_warning("Try '%s -h' for instructions", progname);
-        if(args.logtofile)
-            fclose(logfile);
-        return 1;
-    }
-    log_info("Total of %d prism(s) read", modelsize);
 
-    /* Print a header on the output with provenance information */
-    printf("# Potential calculated in spherical coordinates with %s %s:\n",
-        progname, tesseroids_version);
-    printf("#   local time: %s", asctime(timeinfo));
-    printf("#   model file: %s (%d prisms)\n", args.inputfname, modelsize);
+/** Main */
+int main(int argc, char **argv)
+{
+    PRISM_FIELD field = {"Potential", 1, 1, {"pot"},
+                         NULL, prism_pot_frame};
 
-    /* Read each computation point from stdin and calculate */
-    log_info("Calculating (this may take a while)...");
-    tstart = clock();
-    for(line = 1; !feof(stdin); line++)
-    {
-        if(fgets(buff, 10000, stdin) == NULL)
-        {
-            if(ferror(stdin))
-            {
-                log_error("problem encountered reading line %d", line);
-                error_exit = 1;
-                break;
-            }
-        }
-        else
-        {
-            /* Check for comments and blank lines */
-            if(buff[0] == '#' || buff[0] == '\r' || buff[0] == '\n')
-            {
-                printf("%s", buff);
-                continue;
-            }
-            if(sscanf(buff, "%lf %lf %lf", &lon, &lat, &height) != 3)
-            {
-                log_warning("bad/invalid computation point at line %d", line);
-                log_warning("skipping this line and continuing");
-                bad_input++;
-                continue;
-            }
-            /* Need to remove \n and \r from end of buff first to print the
-               result in the end */
-            strstrip(buff);
-            for(res = 0, i = 0; i < modelsize; i++)
-            {
-                res += prism_pot_sph(model[i], lon, lat,
-                                     height + MEAN_EARTH_RADIUS);
-            }
-            printf("%s %.15g\n", buff, res);
-            points++;
-        }
-    }
-    if(bad_input)
-    {
-        log_warning("Encountered %d bad computation points which were skipped",
-                    bad_input);
-    }
-    if(error_exit)
-    {
-        log_warning("Terminating due to error in input");
-        log_warning("Try '%s -h' for instructions", progname);
-    }
-    else
-    {
-        log_info("Calculated on %d points in %.5g seconds", points,
-                 (double)(clock() - tstart)/CLOCKS_PER_SEC);
-    }
-    /* Clean up */
-    free(model);
-    log_info("Done");
-    if(args.logtofile)
-        fclose(logfile);
-    return 0;
+    return run_prism_main(argc, argv, "prismpots", &field, &print_help);
 }
@@ -0,0 +1,14 @@
+/*
+Program to calculate gxx of a sphere model on a set of points.
+*/
+
+
+#include "grav_sphere_soa.h"
+#include "sphere_main.h"
+
+
+/** Main */
+int main(int argc, char **argv)
+{
+    return run_sphere_main(argc, argv, "spheregxx", &sphere_gxx_soa);
+}
@@ -0,0 +1,22 @@
+/*
+Program to calculate gz of a sphere model on a set of points.
+*/
+
+
+#include "grav_sphere_soa.h"
+#include "sphere_main.h"
+
+
+/* Calculates gz with z->Down to keep the convention of the other programs */
+static double sphere_gz_down(SPHERE_SOA *model, double lonp, double latp,
+                             double rp)
+{
+    return -sphere_gz_soa(model, lonp, latp, rp);
+}
+
+
+/** Main */
+int main(int argc, char **argv)
+{
+    return run_sphere_main(argc, argv, "spheregz", &sphere_gz_down);
+}
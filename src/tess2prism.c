@@ -76,6 +76,7 @@ int main(int argc, char **argv)
     char buff[10000];
     TESSEROID tess;
     PRISM prism;
+    double values[7];
     FILE *logfile = NULL, *modelfile = NULL;
     time_t rawtime;
     struct tm * timeinfo;
@@ -185,17 +186,26 @@ int main(int argc, char **argv)
             if(args.flatten)
             {
                 tess2prism_flatten(tess, &prism);
-                printf("%.15g %.15g %.15g %.15g %.15g %.15g %.15g\n",
-                       prism.x1, prism.x2, prism.y1, prism.y2, prism.z1,
-                       prism.z2, prism.density);
+                values[0] = prism.x1;
+                values[1] = prism.x2;
+                values[2] = prism.y1;
+                values[3] = prism.y2;
+                values[4] = prism.z1;
+                values[5] = prism.z2;
+                values[6] = prism.density;
+                print_doubles(stdout, NULL, values, 7, 15);
             }
             else
             {
                 tess2prism(tess, &prism);
-                printf("%.15g %.15g %.15g %.15g %.15g %.15g %.15g\n",
-                       prism.x2 - prism.x1, prism.y2 - prism.y1,
-                       prism.z2 - prism.z1, prism.density,
-                       prism.lon, prism.lat, prism.r);
+                values[0] = prism.x2 - prism.x1;
+                values[1] = prism.y2 - prism.y1;
+                values[2] = prism.z2 - prism.z1;
+                values[3] = prism.density;
+                values[4] = prism.lon;
+                values[5] = prism.lat;
+                values[6] = prism.r;
+                print_doubles(stdout, NULL, values, 7, 15);
             }
             converted++;
         }
@@ -0,0 +1,196 @@
+/*
+Convert a tesseroid model into a binary model file organized in tiles
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "version.h"
+#include "parsers.h"
+#include "logger.h"
+#include "geometry.h"
+#include "tess_tiles.h"
+#include "hilbert.h"
+
+
+/** Print the help message */
+void print_help()
+{
+    printf("Usage: tess2tiles TESSFILE OUTFILE [OPTIONS]\n\n");
+    printf("Convert a tesseroid model into a binary model file organized\n");
+    printf("in longitude/latitude tiles (for use with the tessg*\n");
+    printf("programs).\n\n");
+    printf("The tessg* programs recognize the binary file automatically\n");
+    printf("and memory map it, so only the tiles that are used are read\n");
+    printf("from disk. Each tile stores the bounding box and the mass of\n");
+    printf("its tesseroids, so that the tiles far away from the\n");
+    printf("computation points can be replaced by a single tesseroid\n");
+    printf("(see option -d of the tessg* programs).\n\n");
+    printf("The binary file uses the byte order and sizes of numbers of the\n");
+    printf("computer where it was created. It might not be read correctly\n");
+    printf("on a different type of computer.\n\n");
+    printf("All units either SI or degrees!\n\n");
+    printf("Input:\n");
+    printf("  TESSFILE: File containing the tesseroid model\n");
+    printf("  * Each tesseroid is specified by the values of its borders\n");
+    printf("    and density\n");
+    printf("  * The file should contain one tesseroid per line\n");
+    printf("  * Each line should have the following column format:\n");
+    printf("      West East South North Top Bottom Density\n");
+    printf("  * Top and Bottom should be read as 'height to top' and \n");
+    printf("    'height to bottom' from the mean Earth radius. Use negative\n");
+    printf("    values if bellow the surface, for example when modeling\n");
+    printf("    deep structures, and positive if above the surface, for\n");
+    printf("    example when modeling topography.\n");
+    printf("  * If a line starts with # it will be considered a comment\n");
+    printf("    and will be ignored\n\n");
+    printf("Output:\n");
+    printf("  OUTFILE: Name of the binary model file to create.\n\n");
+    printf("Options:\n");
+    printf("  -sSIZE       Size of the tiles in degrees. Defaults to 10.\n");
+    printf("  --sort       Reorder the tesseroids along a Hilbert curve\n");
+    printf("               through their centers before making the tiles.\n");
+    printf("               The columns of each tile are then stored in the\n");
+    printf("               order of the curve.\n");
+    printf("  -h           Print instructions.\n");
+    printf("  --version    Print version and license information.\n");
+    printf("  -v           Enable verbose printing to stderr.\n");
+    printf("  -lFILENAME   Print log messages to file FILENAME.\n");
+    print_copyright();
+}
+
+
+/** Main */
+int main(int argc, char **argv)
+{
+    char *progname = "tess2tiles";
+    TESS2TILES_ARGS args;
+    TESSEROID *model;
+    long modelsize, *order = NULL;
+    int rc;
+    FILE *logfile = NULL, *modelfile = NULL, *outfile = NULL;
+    time_t rawtime;
+    struct tm * timeinfo;
+
+    log_init(LOG_INFO);
+
+    rc = parse_tess2tiles_args(argc, argv, progname, &args, &print_help);
+    if(rc == 2)
+    {
+        return 0;
+    }
+    if(rc == 1)
+    {
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+
+        return 1;
+    }
+
+    /* Set the appropriate logging level and log to file if necessary */
+    if(!args.verbose)
+    {
+        log_init(LOG_WARNING);
+    }
+    if(args.logtofile)
+    {
+        logfile = fopen(args.logfname, "w");
+        if(logfile == NULL)
+        {
+            log_error("unable to create log file %s", args.logfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            return 1;
+        }
+        log_tofile(logfile, LOG_INFO);
+    }
+
+    /* Print standard verbose */
+    log_info("%s (Tesseroids project) %s", progname, tesseroids_version);
+    time(&rawtime);
+    timeinfo = localtime(&rawtime);
+    log_info("(local time) %s", asctime(timeinfo));
+
+    /* Read the tesseroid model file */
+    log_info("Reading tesseroid model from file %s", args.inputfname);
+    modelfile = fopen(args.inputfname, "r");
+    if(modelfile == NULL)
+    {
+        log_error("failed to open model file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    model = read_tess_model(modelfile, &modelsize);
+    fclose(modelfile);
+    if(modelsize == 0)
+    {
+        log_error("tesseroid file %s is empty", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        free(model);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    if(model == NULL)
+    {
+        log_error("failed to read model from file %s", args.inputfname);
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Total of %ld tesseroid(s) read", modelsize);
+    if(args.sort_model)
+    {
+        order = (long *)malloc(modelsize*sizeof(long));
+        if(order == NULL || hilbert_sort_tess(model, modelsize, order) != 0)
+        {
+            log_error("problem allocating memory to sort the model");
+            free(order);
+            free(model);
+            if(args.logtofile)
+                fclose(logfile);
+            return 1;
+        }
+        log_info("Reordered the model along a Hilbert curve");
+    }
+
+    /* Write the binary model */
+    log_info("Writing binary model with %g degree tiles to file %s",
+             args.tilesize, args.outputfname);
+    outfile = fopen(args.outputfname, "wb");
+    if(outfile == NULL)
+    {
+        log_error("failed to create file %s", args.outputfname);
+        free(model);
+        free(order);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    rc = write_tess_tiles(outfile, model, modelsize, order, args.tilesize);
+    if(fclose(outfile) != 0)
+    {
+        rc = 1;
+    }
+    free(model);
+    free(order);
+    if(rc)
+    {
+        log_error("failed to write binary model to file %s",
+                  args.outputfname);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Done");
+    if(args.logtofile)
+        fclose(logfile);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+Convert a binary point or result file into text.
+*/
+
+
+#include <stdio.h>
+#include <time.h>
+#include "version.h"
+#include "parsers.h"
+#include "logger.h"
+#include "binpoints.h"
+
+
+/** Print the help message */
+void print_help()
+{
+    printf("Usage: tessbin2txt BINFILE [OPTIONS]\n\n");
+    printf("Convert a binary file of computation points or results into\n");
+    printf("text.\n\n");
+    printf("Input:\n");
+    printf("  If BINFILE is omited, will read from standard input (stdin)\n");
+    printf("  BINFILE: Binary file written by the tessg* or prismg*\n");
+    printf("    programs with options --binary or -f.\n\n");
+    printf("Output:\n");
+    printf("  Printed to standard output (stdout). Each record of the\n");
+    printf("  binary file is printed in one line, with its values\n");
+    printf("  separated by spaces:\n");
+    printf("    lon lat height ... result\n");
+    printf("  The same layout as the text output of the tessg* and\n");
+    printf("  prismg* programs.\n\n");
+    printf("Options:\n");
+    printf("  -pDIGITS     Number of significant digits of the values.\n");
+    printf("               From 1 to 17. Defaults to 15.\n");
+    printf("  -h           Print instructions.\n");
+    printf("  --version    Print version and license information.\n");
+    printf("  -v           Enable verbose printing to stderr.\n");
+    printf("  -lFILENAME   Print log messages to file FILENAME.\n");
+    print_copyright();
+}
+
+
+/** Main */
+int main(int argc, char **argv)
+{
+    char *progname = "tessbin2txt";
+    BASIC_ARGS args;
+    BINPOINTS *binin;
+    const double *record;
+    int rc, records = 0, error_exit = 0;
+    FILE *logfile = NULL, *binfile = NULL;
+    time_t rawtime;
+    struct tm * timeinfo;
+
+    log_init(LOG_INFO);
+
+    rc = parse_basic_args(argc, argv, progname, &args, &print_help);
+    if(rc == 2)
+    {
+        return 0;
+    }
+    if(rc == 1 || args.binary || args.grid.parsed || args.nthreads > 0 ||
+       args.components != NULL || args.cutoff > 0 || args.farfield)
+    {
+        if(args.binary)
+        {
+            log_error("option --binary is not supported by %s", progname);
+        }
+        if(args.nthreads > 0 || args.components != NULL || args.cutoff > 0 ||
+           args.farfield)
+        {
+            log_error("options -j, -s, -c and --far-field are not supported "
+                      "by %s", progname);
+        }
+        if(args.grid.parsed)
+        {
+            log_error("options -r, -b and -z are not supported by %s",
+                      progname);
+        }
+        log_warning("Terminating due to bad input");
+        log_warning("Try '%s -h' for instructions", progname);
+        return 1;
+    }
+
+    /* Set the appropriate logging level and log to file if necessary */
+    if(!args.verbose)
+    {
+        log_init(LOG_WARNING);
+    }
+    if(args.logtofile)
+    {
+        logfile = fopen(args.logfname, "w");
+        if(logfile == NULL)
+        {
+            log_error("unable to create log file %s", args.logfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            return 1;
+        }
+        log_tofile(logfile, LOG_INFO);
+    }
+
+    /* Print standard verbose */
+    log_info("%s (Tesseroids project) %s", progname, tesseroids_version);
+    time(&rawtime);
+    timeinfo = localtime(&rawtime);
+    log_info("(local time) %s", asctime(timeinfo));
+
+    /* If an input file is not given, read from stdin. Else open the file */
+    if(rc == 3)
+    {
+        log_info("Reading binary records from stdin");
+        binfile = stdin;
+    }
+    else
+    {
+        log_info("Reading binary records from file %s", args.inputfname);
+        binfile = fopen(args.inputfname, "rb");
+        if(binfile == NULL)
+        {
+            log_error("failed to open file %s", args.inputfname);
+            log_warning("Terminating due to bad input");
+            log_warning("Try '%s -h' for instructions", progname);
+            if(args.logtofile)
+                fclose(logfile);
+            return 1;
+        }
+    }
+    binin = open_binpoints(binfile);
+    if(binin == NULL)
+    {
+        log_warning("Terminating due to bad input");
+        if(rc != 3)
+            fclose(binfile);
+        if(args.logtofile)
+            fclose(logfile);
+        return 1;
+    }
+    log_info("Records with %d values", binin->ncols);
+
+    /* Write the output in large blocks */
+    setvbuf(stdout, NULL, _IOFBF, 65536);
+    while((record = read_binpoint(binin)) != NULL)
+    {
+        print_doubles(stdout, NULL, record, binin->ncols, args.precision);
+        records++;
+    }
+    log_info("Total of %d record(s) converted", records);
+    error_exit = binin->error;
+    if(error_exit)
+    {
+        log_warning("Terminating due to error in input");
+    }
+    close_binpoints(binin);
+    if(rc != 3)
+        fclose(binfile);
+    log_info("Done");
+    if(args.logtofile)
+        fclose(logfile);
+    return error_exit;
+}
@@ -118,6 +118,8 @@ algorithm\n");
     printf("GLQ_MAXIT = %d\n\n", GLQ_MAXIT);
     printf("# Max error allowed for the Legendre polynomial root-finder \
 algorithm\n");
-    printf("GLQ_MAXERROR = %g\n", GLQ_MAXERROR);
+    printf("GLQ_MAXERROR = %g\n\n", GLQ_MAXERROR);
+    printf("# Highest GLQ order with tabulated nodes and weights\n");
+    printf("GLQ_MAX_TABULATED = %d\n", GLQ_MAX_TABULATED);
     return 0;
 }
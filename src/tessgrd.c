@@ -38,6 +38,8 @@ void print_tessgrd_help()
     printf("  -h           Print instructions.\n");
     printf("  --version    Print version and license information.\n");
     printf("\nOptions:\n");
+    printf("  -pDIGITS     Number of significant digits of the output.\n");
+    printf("               From 1 to 17. Defaults to 15.\n");
     printf("  -v           Enable verbose printing to stderr.\n");
     printf("  -lFILENAME   Print log messages to file FILENAME.\n");
     print_copyright();
@@ -53,10 +55,9 @@ int main(int argc, char **argv)
     FILE *logfile = NULL;
     time_t rawtime;
     struct tm * timeinfo;
-    double dlon, dlat;
-    double lon, lat;
-    /* Keep track of how many printed. Used to check if produced right amount */
-    int lons = 0, lats = 0, total = 0;
+    POINTS_GRID_ARGS grid;
+    double dlon, dlat, point[3];
+    int i;
 
     log_init(LOG_INFO);
 
@@ -107,6 +108,8 @@ int main(int argc, char **argv)
     dlat = (args.n - args.s)/(args.nlat - 1);
     log_info("Grid spacing: %.10f lon / %.10f lat", dlon, dlat);
 
+    /* Write the output in large blocks */
+    setvbuf(stdout, NULL, _IOFBF, 65536);
     /* Print a header on the output with provenance information */
     printf("# Grid generated with %s %s:\n", progname, tesseroids_version);
     printf("#   local time: %s", asctime(timeinfo));
@@ -115,49 +118,27 @@ int main(int argc, char **argv)
     printf("#   grid spacing: %.10f lon / %.10f lat\n", dlon, dlat);
     printf("#   total %d points\n", args.nlon*args.nlat);
 
-    /* Make the grid points. Print lon first as x */
-    for(lat = args.s; lat <= args.n; lat += dlat)
+    /* Make the grid points the same way as the -r, -b and -z options of the
+       programs that calculate on grids (the borders are always in the grid
+       and rounding errors don't pile up). Print lon first as x */
+    grid.parsed = 7;
+    grid.w = args.w;
+    grid.e = args.e;
+    grid.s = args.s;
+    grid.n = args.n;
+    grid.nlon = args.nlon;
+    grid.nlat = args.nlat;
+    grid.height = args.height;
+    for(i = 0; i < args.nlon*args.nlat; i++)
     {
-        lons = 0;
-        for(lon = args.w; lon <= args.e; lon += dlon)
+        points_grid_point(&grid, i, point);
+        print_doubles(stdout, NULL, point, 3, args.precision);
+        if((i + 1) % args.nlon == 0)
         {
-            printf("%.15g %.15g %.15g\n", lon, lat, args.height);
-            lons++;
-            total++;
+            printf("\n"); /* To ease plotting in Gnuplot */
         }
-        /* Sometimes prints one less because of rounding errors */
-        if(lons != args.nlon)
-        {
-            printf("%.15g %.15g %.15g\n", lon, lat, args.height);
-            lons++;
-            total++;
-        }
-        lats++;
-        printf("\n"); /* To ease plotting in Gnuplot */
-    }
-    /* Sometimes prints one less because of rounding errors */
-    if(lats != args.nlat)
-    {
-        lons = 0;
-        for(lon = args.w; lon <= args.e; lon += dlon)
-        {
-            printf("%.15g %.15g %.15g\n", lon, lat, args.height);
-            lons++;
-            total++;
-        }
-        if(lons != args.nlon)
-        {
-            printf("%.15g %.15g %.15g\n", lon, lat, args.height);
-            lons++;
-            total++;
-        }
-    }
-    if(total != args.nlat*args.nlon)
-    {
-        log_warning("%d total points made instead of required %d", total,
-                    args.nlat*args.nlon);
     }
-    log_info("Total points generated: %d", total);
+    log_info("Total points generated: %d", args.nlon*args.nlat);
     /* Clean up */
     if(args.logtofile)
         fclose(logfile);
@@ -12,5 +12,5 @@ Program to calculate gxz of a tesseroid model on a set of points.
 int main(int argc, char **argv)
 {
     return run_tessg_main(argc, argv, "tessgxz", &tess_gxz,
-                          TESSEROID_GXZ_SIZE_RATIO);
+                          &tess_gxz_column, TESSEROID_GXZ_SIZE_RATIO);
 }
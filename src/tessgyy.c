@@ -12,5 +12,5 @@ Program to calculate gyy of a tesseroid model on a set of points.
 int main(int argc, char **argv)
 {
     return run_tessg_main(argc, argv, "tessgyy", &tess_gyy,
-                          TESSEROID_GYY_SIZE_RATIO);
+                          &tess_gyy_column, TESSEROID_GYY_SIZE_RATIO);
 }
@@ -12,5 +12,5 @@ Program to calculate gzz of a tesseroid model on a set of points.
 int main(int argc, char **argv)
 {
     return run_tessg_main(argc, argv, "tessgzz", &tess_gzz,
-                          TESSEROID_GZZ_SIZE_RATIO);
+                          &tess_gzz_column, TESSEROID_GZZ_SIZE_RATIO);
 }
@@ -73,6 +73,7 @@ int main(int argc, char **argv)
     char *progname = "tesslayers";
     TESSLAYERS_ARGS args;
     TESSEROID tessbuff[BUFFSIZE];
+    double values[7];
     int t, rc, line, error_exit = 0, bad_input = 0, size = 0, nlayers_old = -1,
         nlayers_new;
     char buff[10000];
@@ -168,14 +169,14 @@ int main(int argc, char **argv)
 
             for(t = 0; t < nlayers_new; t++)
             {
-                printf("%.15g %.15g %.15g %.15g %.15g %.15g %.15g\n",
-                       tessbuff[t].w,
-                       tessbuff[t].e,
-                       tessbuff[t].s,
-                       tessbuff[t].n,
-                       tessbuff[t].r2 - MEAN_EARTH_RADIUS,
-                       tessbuff[t].r1 - MEAN_EARTH_RADIUS,
-                       tessbuff[t].density);
+                values[0] = tessbuff[t].w;
+                values[1] = tessbuff[t].e;
+                values[2] = tessbuff[t].s;
+                values[3] = tessbuff[t].n;
+                values[4] = tessbuff[t].r2 - MEAN_EARTH_RADIUS;
+                values[5] = tessbuff[t].r1 - MEAN_EARTH_RADIUS;
+                values[6] = tessbuff[t].density;
+                print_doubles(stdout, NULL, values, 7, 15);
                 size++;
             }
         }
@@ -75,7 +75,7 @@ int main(int argc, char **argv)
     TESSMODGEN_ARGS args;
     int rc, line, error_exit = 0, bad_input = 0, size = 0, nchars, nread;
     char buff[10000];
-    double lon, lat, height, w, e, s, n, top, bot, dens;
+    double lon, lat, height, w, e, s, n, top, bot, dens, values[7];
     FILE *logfile = NULL;
     time_t rawtime;
     struct tm * timeinfo;
@@ -204,8 +204,14 @@ int main(int argc, char **argv)
                 else
                     dens *= -1;
             }
-            printf("%.15g %.15g %.15g %.15g %.15g %.15g %.15g\n", w, e, s, n,
-                   top, bot, dens);
+            values[0] = w;
+            values[1] = e;
+            values[2] = s;
+            values[3] = n;
+            values[4] = top;
+            values[5] = bot;
+            values[6] = dens;
+            print_doubles(stdout, NULL, values, 7, 15);
             size++;
         }
     }
@@ -11,7 +11,17 @@ Run all unit tests. This is compiled into a single executable (tesstest).
 #include "test_parsers.c"
 #include "test_grav_prism.c"
 #include "test_grav_prism_sph.c"
+#include "test_grav_prism_soa.c"
 #include "test_grav_tess.c"
+#include "test_tess_tiles.c"
+#include "test_binpoints.c"
+#include "test_model_cache.c"
+#include "test_hilbert.c"
+#include "test_parker.c"
+#include "test_prism_index.c"
+#include "test_batch_calc.c"
+#include "test_tessg_main.c"
+#include "test_grav_sphere_soa.c"
 
 int tests_run = 0, tests_passed = 0, tests_failed = 0;
 
@@ -27,7 +37,17 @@ int main()
     failed += parsers_run_all();
     failed += grav_prism_run_all();
     failed += grav_prism_sph_run_all();
+    failed += grav_prism_soa_run_all();
     failed += grav_tess_run_all();
+    failed += tess_tiles_run_all();
+    failed += binpoints_run_all();
+    failed += model_cache_run_all();
+    failed += hilbert_run_all();
+    failed += parker_run_all();
+    failed += prism_index_run_all();
+    failed += batch_calc_run_all();
+    failed += tessg_main_run_all();
+    failed += grav_sphere_soa_run_all();
 
     mu_print_summary((double)(clock() - start)/CLOCKS_PER_SEC);
 
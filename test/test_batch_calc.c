@@ -0,0 +1,231 @@
+/*
+Unit tests for batch_calc.c functions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+#include "minunit.h"
+#include "../src/lib/batch_calc.h"
+
+
+#if defined(__unix__) || defined(__APPLE__)
+/* Read stdin from file 'infname' and write stdout to file 'outfname'. The old
+stdin and stdout are kept in 'saved' to restore them with restore_stdio().
+Also used by the tests of tessg_main.c. Returns 0 if all went well. */
+static int redirect_stdio(const char *infname, const char *outfname,
+                          int *saved)
+{
+    int in, out;
+
+    fflush(stdout);
+    in = open(infname, O_RDONLY);
+    out = open(outfname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(in < 0 || out < 0)
+    {
+        if(in >= 0)
+        {
+            close(in);
+        }
+        if(out >= 0)
+        {
+            close(out);
+        }
+        return 1;
+    }
+    saved[0] = dup(0);
+    saved[1] = dup(1);
+    dup2(in, 0);
+    dup2(out, 1);
+    close(in);
+    close(out);
+    clearerr(stdin);
+    return 0;
+}
+
+
+/* Go back to the stdin and stdout kept by redirect_stdio() */
+static void restore_stdio(int *saved)
+{
+    fflush(stdout);
+    dup2(saved[0], 0);
+    dup2(saved[1], 1);
+    close(saved[0]);
+    close(saved[1]);
+    clearerr(stdin);
+}
+
+
+/* Read a whole text file. Returns NULL if it can't be read. */
+static char * read_text_file(const char *fname)
+{
+    FILE *file;
+    char *text;
+    long size;
+
+    file = fopen(fname, "rb");
+    if(file == NULL)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    text = (char *)malloc(size + 1);
+    if(text != NULL)
+    {
+        if(fread(text, 1, size, file) != (size_t)size)
+        {
+            free(text);
+            text = NULL;
+        }
+        else
+        {
+            text[size] = '\0';
+        }
+    }
+    fclose(file);
+    return text;
+}
+
+
+/* A model of "masses" on the x axis. Component 0 is the sum of m/(1 + d^2) for
+the distance d of each mass to the point and component 1 the sum of the
+masses times the height of the point. */
+#define BATCH_TEST_SIZE 1000
+#define BATCH_TEST_CHUNKS 7
+
+static void calc_test_chunk(const void *model, int chunk, int npoints,
+                            const int *ispoint, const double *points,
+                            double *results)
+{
+    const double *masses = (const double *)model;
+    const double *point;
+    double dx;
+    int first, last, k, i;
+
+    first = chunk*BATCH_TEST_SIZE/BATCH_TEST_CHUNKS;
+    last = (chunk + 1)*BATCH_TEST_SIZE/BATCH_TEST_CHUNKS;
+    for(k = 0; k < npoints; k++)
+    {
+        if(!ispoint[k])
+        {
+            continue;
+        }
+        point = points + 3*k;
+        results[2*k] = 0;
+        results[2*k + 1] = 0;
+        for(i = first; i < last; i++)
+        {
+            dx = point[0] - 0.1*i;
+            results[2*k] += masses[i]/(1 + dx*dx + point[1]*point[1]);
+            results[2*k + 1] += masses[i]*point[2];
+        }
+    }
+}
+
+
+static char * test_batch_calc_threads()
+{
+    const char *inname = "test_batch_calc.tmp",
+               *outnames[2] = {"test_batch_calc_1.tmp",
+                               "test_batch_calc_4.tmp"};
+    double masses[BATCH_TEST_SIZE];
+    int components[2] = {1, 0}, nthreads[2] = {1, 4}, saved[2], t, i;
+    long points;
+    char *out[2], *line, expect[100];
+    FILE *file;
+    BATCH_CALC calc;
+    BATCH_INPUT input;
+    BATCH_OUTPUT output;
+
+    for(i = 0; i < BATCH_TEST_SIZE; i++)
+    {
+        masses[i] = 1 + 0.01*(i % 13);
+    }
+    calc.model = masses;
+    calc.nchunks = BATCH_TEST_CHUNKS;
+    calc.ncomponents = 2;
+    calc.calc = calc_test_chunk;
+    calc.noutput = 2;
+    calc.components = components;
+    output.ncols = 0;
+    output.ncomponents = 2;
+    output.precision = 15;
+    /* Several batches of points with comments, blank lines and a bad line */
+    file = fopen(inname, "w");
+    mu_assert(file != NULL, "couldn't write the input file");
+    fprintf(file, "# points on a line\n");
+    for(i = 0; i < 5*BATCH_SIZE; i++)
+    {
+        if(i == 100)
+        {
+            fprintf(file, "\n# second part\n");
+        }
+        if(i == 300)
+        {
+            fprintf(file, "not a point\n");
+        }
+        fprintf(file, "%d 0.5 %d\n", i, i % 10);
+    }
+    fclose(file);
+    for(t = 0; t < 2; t++)
+    {
+        memset(&input, 0, sizeof(BATCH_INPUT));
+        mu_assert(redirect_stdio(inname, outnames[t], saved) == 0,
+                  "couldn't redirect stdin and stdout");
+        points = run_batch_calc(&calc, nthreads[t], &input, &output);
+        restore_stdio(saved);
+        sprintf(msg, "%d thread(s): calculated on %ld points", nthreads[t],
+                points);
+        mu_assert(points == 5*BATCH_SIZE && !input.error &&
+                  input.bad_input == 1, msg);
+        out[t] = read_text_file(outnames[t]);
+        mu_assert(out[t] != NULL, "couldn't read the output");
+    }
+    mu_assert(strcmp(out[0], out[1]) == 0,
+              "results with 1 and 4 threads are different");
+    /* The output is in the order of the input */
+    mu_assert(strncmp(out[0], "# points on a line\n", 19) == 0,
+              "first comment not echoed");
+    line = out[0] + 19;
+    for(i = 0; i < 5*BATCH_SIZE && line != NULL; i++)
+    {
+        if(i == 100)
+        {
+            mu_assert(strncmp(line, "\n# second part\n", 15) == 0,
+                      "blank line and comment not echoed in place");
+            line += 15;
+        }
+        sprintf(expect, "%d 0.5 %d ", i, i % 10);
+        sprintf(msg, "point %d out of order: %.40s", i, line);
+        mu_assert(strncmp(line, expect, strlen(expect)) == 0, msg);
+        line = strchr(line, '\n');
+        line = line == NULL ? NULL : line + 1;
+    }
+    mu_assert(line != NULL && *line == '\0', "wrong number of lines");
+    free(out[0]);
+    free(out[1]);
+    remove(inname);
+    remove(outnames[0]);
+    remove(outnames[1]);
+    return 0;
+}
+#endif
+
+
+int batch_calc_run_all()
+{
+    int failed = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    failed += mu_run_test(test_batch_calc_threads,
+        "run_batch_calc gives the same output in input order with 1 and 4 "
+        "threads");
+#endif
+    return failed;
+}
@@ -0,0 +1,218 @@
+/*
+Unit tests for the binary computation point files.
+*/
+
+#include <stdio.h>
+#include "minunit.h"
+#include "../src/lib/binpoints.h"
+
+/* To store fail messages */
+char msg[1000];
+
+
+/* Write a header and 5 records of 4 values to file */
+static int write_binpoints_file(FILE *file)
+{
+    double record[4];
+    int i, j;
+
+    if(write_binpoints_header(file, 4))
+    {
+        return 1;
+    }
+    for(i = 0; i < 5; i++)
+    {
+        for(j = 0; j < 4; j++)
+        {
+            record[j] = 0.1*i - 3.3*j + i*j;
+        }
+        if(fwrite(record, sizeof(double), 4, file) != 4)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* Check that the 5 records are read back */
+static char * check_binpoints(BINPOINTS *points)
+{
+    const double *record;
+    int i, j;
+
+    mu_assert(points != NULL, "open_binpoints returned NULL");
+    sprintf(msg, "ncols = %d expected 4", points->ncols);
+    mu_assert(points->ncols == 4, msg);
+    for(i = 0; i < 5; i++)
+    {
+        record = read_binpoint(points);
+        sprintf(msg, "record %d is NULL", i);
+        mu_assert(record != NULL, msg);
+        for(j = 0; j < 4; j++)
+        {
+            sprintf(msg, "record %d value %d = %g expected %g", i, j,
+                    record[j], 0.1*i - 3.3*j + i*j);
+            mu_assert(record[j] == 0.1*i - 3.3*j + i*j, msg);
+        }
+    }
+    mu_assert(read_binpoint(points) == NULL, "read past the last record");
+    mu_assert(!points->error, "error flagged in the end of the records");
+    return 0;
+}
+
+
+static char * test_binpoints_file()
+{
+    FILE *file;
+    BINPOINTS *points;
+    char *fail;
+
+    file = fopen("test_binpoints.tmp", "wb");
+    mu_assert(file != NULL, "failed to create the temporary file");
+    mu_assert(write_binpoints_file(file) == 0, "failed to write the file");
+    fclose(file);
+
+    /* A regular file is memory mapped if possible */
+    file = fopen("test_binpoints.tmp", "rb");
+    mu_assert(file != NULL, "failed to open the temporary file");
+    points = open_binpoints(file);
+    fail = check_binpoints(points);
+    if(points != NULL)
+    {
+        close_binpoints(points);
+    }
+    fclose(file);
+    remove("test_binpoints.tmp");
+    return fail;
+}
+
+
+static char * test_binpoints_stream()
+{
+    FILE *file;
+    BINPOINTS *points;
+    char *fail;
+
+    /* Streams that were already read from aren't mapped (like pipes) */
+    file = tmpfile();
+    mu_assert(file != NULL, "failed to create the temporary file");
+    fputc('x', file);
+    mu_assert(write_binpoints_file(file) == 0, "failed to write the file");
+    rewind(file);
+    mu_assert(fgetc(file) == 'x', "wrong first character");
+    points = open_binpoints(file);
+    if(points != NULL)
+    {
+        mu_assert(points->map == NULL, "stream was memory mapped");
+    }
+    fail = check_binpoints(points);
+    if(points != NULL)
+    {
+        close_binpoints(points);
+    }
+    fclose(file);
+    return fail;
+}
+
+
+static char * test_binpoints_incomplete()
+{
+    FILE *file;
+    BINPOINTS *points;
+    double extra[2] = {1, 2};
+    int pass, nread, error;
+
+    /* Once memory mapped and once as a stream */
+    for(pass = 0; pass < 2; pass++)
+    {
+        file = tmpfile();
+        mu_assert(file != NULL, "failed to create the temporary file");
+        if(pass)
+            fputc('x', file);
+        mu_assert(write_binpoints_file(file) == 0 &&
+                  fwrite(extra, sizeof(double), 2, file) == 2,
+                  "failed to write the file");
+        rewind(file);
+        if(pass)
+            mu_assert(fgetc(file) == 'x', "wrong first character");
+        points = open_binpoints(file);
+        mu_assert(points != NULL, "open_binpoints returned NULL");
+        for(nread = 0; read_binpoint(points) != NULL; nread++)
+            ;
+        error = points->error;
+        close_binpoints(points);
+        fclose(file);
+        sprintf(msg, "pass %d: read %d records (expected 5) with error %d",
+                pass, nread, error);
+        mu_assert(nread == 5 && error, msg);
+    }
+    return 0;
+}
+
+
+static char * test_binresults()
+{
+    FILE *file;
+    BINRESULTS *results;
+    BINPOINTS *points;
+    double records[20];
+    char *fail;
+    int i, j, order[5] = {3, 0, 4, 2, 1};
+
+    for(i = 0; i < 5; i++)
+    {
+        for(j = 0; j < 4; j++)
+        {
+            records[4*i + j] = 0.1*i - 3.3*j + i*j;
+        }
+    }
+    /* Make room for more records than are written. The file should be cut to
+     * the records that were written. */
+    results = create_binresults("test_binresults.tmp", 4, 8);
+    mu_assert(results != NULL, "failed to create the result file");
+    /* Write the records out of order, the first 2 in a single call */
+    for(i = 0; i < 5; i++)
+    {
+        if(order[i] == 0)
+        {
+            mu_assert(write_binresults(results, 0, records, 2) == 0,
+                      "failed to write records 0 and 1");
+        }
+        else if(order[i] != 1)
+        {
+            sprintf(msg, "failed to write record %d", order[i]);
+            mu_assert(write_binresults(results, order[i],
+                                       records + 4*order[i], 1) == 0, msg);
+        }
+    }
+    mu_assert(close_binresults(results, 5) == 0,
+              "failed to close the result file");
+
+    file = fopen("test_binresults.tmp", "rb");
+    mu_assert(file != NULL, "failed to open the result file");
+    points = open_binpoints(file);
+    fail = check_binpoints(points);
+    if(points != NULL)
+    {
+        close_binpoints(points);
+    }
+    fclose(file);
+    remove("test_binresults.tmp");
+    return fail;
+}
+
+
+int binpoints_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_binpoints_file,
+            "read_binpoint reads a memory mapped file");
+    failed += mu_run_test(test_binpoints_stream,
+            "read_binpoint reads a stream");
+    failed += mu_run_test(test_binpoints_incomplete,
+            "read_binpoint flags an incomplete last record");
+    failed += mu_run_test(test_binresults,
+            "write_binresults puts the records in their place");
+    return failed;
+}
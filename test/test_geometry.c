@@ -63,6 +63,171 @@ static char * test_split_uneven_tess()
     return 0;
 }
 
+static char * test_tess_find_columns()
+{
+    TESSEROID model[6] = {
+        {1, 0, 1, 0, 1, 6, 7}, {2, 0, 1, 0, 1, 5, 6}, {3, 0, 1, 0, 1, 4, 5},
+        {1, 1, 2, 0, 1, 6, 7}, {1, 1, 2, 0, 2, 5, 6}, {2, 1, 2, 0, 2, 4, 5}};
+    long expect[4] = {0, 3, 4, 6}, columns[7], i, n;
+
+    n = tess_find_columns(model, 6, columns);
+    sprintf(msg, "found %ld columns instead of 3", n);
+    mu_assert(n == 3, msg);
+    for(i = 0; i <= n; i++)
+    {
+        sprintf(msg, "column %ld starts at %ld instead of %ld", i, columns[i],
+                expect[i]);
+        mu_assert(columns[i] == expect[i], msg);
+    }
+    return 0;
+}
+
+
+static char * test_tess_pyramid()
+{
+    /* The coarse levels should conserve the mass of each layer */
+    TESS_GRID *grid;
+    TESS_PYRAMID *pyramid;
+    TESSEROID column[2];
+    double mass_fine, mass_coarse;
+    int i, j, l, cell, size;
+
+    grid = new_tess_grid(10, -20, 0.5, 1, 5, 3, 2);
+    if(grid == NULL)
+        mu_assert(0, "grid allocation error");
+    for(cell = 0; cell < 15; cell++)
+    {
+        grid->radii[cell*3] = MEAN_EARTH_RADIUS + 100*(cell % 4);
+        grid->radii[cell*3 + 1] = MEAN_EARTH_RADIUS - 1000 - 200*(cell % 3);
+        grid->radii[cell*3 + 2] = MEAN_EARTH_RADIUS - 30000;
+        grid->density[cell*2] = 2000 + 100*cell;
+        grid->density[cell*2 + 1] = 3000 - 50*cell;
+    }
+    pyramid = new_tess_pyramid(grid, 10);
+    if(pyramid == NULL)
+        mu_assert(0, "pyramid allocation error");
+    sprintf(msg, "%d levels instead of 2", pyramid->nlevels);
+    mu_assert(pyramid->nlevels == 2, msg);
+    sprintf(msg, "level 1 has %d x %d cells instead of 2 x 1",
+            pyramid->levels[1]->nlon, pyramid->levels[1]->nlat);
+    mu_assert(pyramid->levels[1]->nlon == 2 && pyramid->levels[1]->nlat == 1,
+              msg);
+    for(i = 0; i < 2; i++)
+    {
+        for(l = 0; l < 2; l++)
+        {
+            size = tess_grid_column(pyramid->levels[1], i, column);
+            mass_coarse = tess_total_mass(&column[l], 1);
+            mass_fine = 0;
+            for(j = 0; j < 4; j++)
+            {
+                cell = (j/2)*5 + 2*i + j % 2;
+                size = tess_grid_column(grid, cell, column);
+                mass_fine += tess_total_mass(&column[l], 1);
+            }
+            sprintf(msg, "cell %d layer %d: coarse mass %g fine mass %g", i,
+                    l, mass_coarse, mass_fine);
+            mu_assert_almost_equals_rel(mass_coarse, mass_fine, 1e-8, msg);
+        }
+    }
+    sprintf(msg, "wrong size %d", size);
+    mu_assert(size == 2, msg);
+    free_tess_pyramid(pyramid);
+    free_tess_grid(grid);
+    return 0;
+}
+
+
+static char * test_tess_index_query()
+{
+    /* Compare the columns found with the index with a brute force search */
+    TESSEROID model[648];
+    TESS_INDEX *index;
+    long columns[649], found[648], nfound, c;
+    int expect, i, j, t;
+    double d2r = PI/180., points[6][3] = {
+        {0, 0, 15}, {178, 5, 20}, {-175, -30, 12}, {45, 85, 11},
+        {300, -70, 40}, {10, 10, 120}}, lonc, latc;
+
+    for(t = 0, j = 0; j < 18; j++)
+    {
+        for(i = 0; i < 36; i++, t++)
+        {
+            model[t].w = -180 + 10*i;
+            model[t].e = -170 + 10*i;
+            model[t].s = -90 + 10*j;
+            model[t].n = -80 + 10*j;
+            model[t].r1 = MEAN_EARTH_RADIUS - 1000;
+            model[t].r2 = MEAN_EARTH_RADIUS;
+            model[t].density = 1;
+        }
+    }
+    tess_find_columns(model, 648, columns);
+    index = new_tess_index(model, columns, 648, 5);
+    if(index == NULL)
+        mu_assert(0, "index allocation error");
+    for(i = 0; i < 6; i++)
+    {
+        nfound = tess_index_query(index, points[i][0], points[i][1],
+                                  points[i][2], found);
+        expect = 0;
+        for(t = 0; t < 648; t++)
+        {
+            lonc = 0.5*(model[t].w + model[t].e);
+            latc = 0.5*(model[t].s + model[t].n);
+            if(sin(d2r*points[i][1])*sin(d2r*latc) + cos(d2r*points[i][1])*
+               cos(d2r*latc)*cos(d2r*(points[i][0] - lonc)) >=
+               cos(d2r*points[i][2]))
+            {
+                expect++;
+                for(c = 0; c < nfound && found[c] != t; c++);
+                sprintf(msg, "(point %d) didn't find column %d", i, t);
+                mu_assert(c < nfound, msg);
+            }
+        }
+        sprintf(msg, "(point %d) found %ld columns instead of %d", i, nfound,
+                expect);
+        mu_assert(nfound == expect, msg);
+    }
+    free_tess_index(index);
+    return 0;
+}
+
+
+static char * test_tess_index_line()
+{
+    /* Columns on a single meridian with a tiny minimum size shouldn't make
+       more buckets than one per column (plus the last) */
+    TESSEROID model[100];
+    TESS_INDEX *index;
+    long columns[101], found[100], nfound;
+    int t;
+
+    for(t = 0; t < 100; t++)
+    {
+        model[t].w = 10;
+        model[t].e = 11;
+        model[t].s = -50 + t;
+        model[t].n = -49 + t;
+        model[t].r1 = MEAN_EARTH_RADIUS - 1000;
+        model[t].r2 = MEAN_EARTH_RADIUS;
+        model[t].density = 1;
+    }
+    tess_find_columns(model, 100, columns);
+    index = new_tess_index(model, columns, 100, 0.000001);
+    if(index == NULL)
+        mu_assert(0, "index allocation error");
+    sprintf(msg, "%d x %d buckets for 100 columns", index->nlon, index->nlat);
+    mu_assert((long)index->nlon*index->nlat <= 101, msg);
+    /* The cap has the centers of latitude -0.5 to 9.5 */
+    nfound = tess_index_query(index, 10.5, 4.5, 5.2, found);
+    sprintf(msg, "found %ld columns instead of 11", nfound);
+    mu_assert(nfound == 11, msg);
+    free_tess_index(index);
+    return 0;
+}
+
+
 static char * test_prism_volume()
 {
     PRISM prisms[4] = {
@@ -285,5 +450,13 @@ int geometry_run_all()
                 "prism2sphere produces sphere with right volume");
     failed += mu_run_test(test_split_tess, "split_tess returns correct results for 2, 2, 2 split");
     failed += mu_run_test(test_split_uneven_tess, "split_tess returns correct results for 2, 2, 1 split");
+    failed += mu_run_test(test_tess_find_columns,
+                "tess_find_columns finds the stacked layers");
+    failed += mu_run_test(test_tess_pyramid,
+                "new_tess_pyramid conserves the mass of the layers");
+    failed += mu_run_test(test_tess_index_query,
+                "tess_index_query finds the columns inside a cap");
+    failed += mu_run_test(test_tess_index_line,
+                "new_tess_index of columns on a meridian");
     return failed;
 }
@@ -496,6 +496,116 @@ static char * test_glq_sincos()
 }
 
 
+static char * test_glq_nodes_weights()
+{
+    double nodes[300], weights[300], root_nodes[300], root_weights[300],
+           result;
+    int rc, i, order, orders[4] = {65, 100, 171, 300};
+
+    /* The tables and the O(order) method against the root finder */
+    for(order = 2; order <= 80; order++)
+    {
+        rc = glq_nodes_weights(order, nodes, weights);
+        sprintf(msg, "(order %d) return code %d, expected 0", order, rc);
+        mu_assert(rc == 0, msg);
+        glq_nodes(order, root_nodes);
+        glq_weights(order, root_nodes, root_weights);
+        for(i = 0; i < order; i++)
+        {
+            sprintf(msg, "(order %d, node %d) expected %.17g got %.17g",
+                    order, i, root_nodes[i], nodes[i]);
+            mu_assert_almost_equals(nodes[i], root_nodes[i], pow(10, -15),
+                                    msg);
+            sprintf(msg, "(order %d, weight %d) expected %.17g got %.17g",
+                    order, i, root_weights[i], weights[i]);
+            mu_assert_almost_equals(weights[i], root_weights[i],
+                                    pow(10, -12)*root_weights[i], msg);
+        }
+    }
+    /* High orders integrate x^(2*order - 2) exactly */
+    for(i = 0; i < 4; i++)
+    {
+        order = orders[i];
+        glq_nodes_weights(order, nodes, weights);
+        for(rc = 0, result = 0; rc < order; rc++)
+        {
+            result += weights[rc]*pow(nodes[rc], 2*order - 2);
+        }
+        sprintf(msg, "(order %d) expected %.17g got %.17g", order,
+                2./(2*order - 1), result);
+        mu_assert_almost_equals(result, 2./(2*order - 1),
+                                pow(10, -12)*2./(2*order - 1), msg);
+    }
+    rc = glq_nodes_weights(1, nodes, weights);
+    sprintf(msg, "(order 1) return code %d, expected 1", rc);
+    mu_assert(rc == 1, msg);
+    return 0;
+}
+
+
+static char * test_glq_new_aligned()
+{
+    GLQ *glq;
+    double *arrays[5];
+    int i, order;
+
+    for(order = 2; order <= 70; order += 17)
+    {
+        glq = glq_new(order, 0, 1);
+        mu_assert(glq != NULL, "glq_new failed");
+        arrays[0] = glq->nodes;
+        arrays[1] = glq->weights;
+        arrays[2] = glq->nodes_unscaled;
+        arrays[3] = glq->nodes_sin;
+        arrays[4] = glq->nodes_cos;
+        for(i = 0; i < 5; i++)
+        {
+            sprintf(msg, "(order %d) array %d not aligned", order, i);
+            mu_assert((unsigned long)arrays[i] % 64 == 0, msg);
+        }
+        for(i = 0; i < order; i++)
+        {
+            sprintf(msg, "(order %d, node %d) expected %.17g got %.17g", order,
+                    i, 0.5*glq->nodes_unscaled[i] + 0.5, glq->nodes[i]);
+            mu_assert_almost_equals(glq->nodes[i],
+                                    0.5*glq->nodes_unscaled[i] + 0.5,
+                                    pow(10, -15), msg);
+        }
+        glq_free(glq);
+    }
+    return 0;
+}
+
+
+static char * test_glq_scale_sincos()
+{
+    GLQ *glq;
+    double nodes_sin[12], nodes_cos[12];
+    int i;
+
+    glq = glq_new(12, -1, 1);
+    mu_assert(glq != NULL, "glq_new failed");
+    glq_scale_sincos(glq, -10, 35, nodes_sin, nodes_cos);
+    for(i = 0; i < glq->order; i++)
+    {
+        sprintf(msg, "(node %d) unit node changed to %g", i, glq->nodes[i]);
+        mu_assert(glq->nodes[i] == glq->nodes_unscaled[i], msg);
+    }
+    glq_set_limits(-10, 35, glq);
+    glq_precompute_sincos(glq);
+    for(i = 0; i < glq->order; i++)
+    {
+        sprintf(msg, "(node %d) expected sin %.17g cos %.17g got %.17g %.17g",
+                i, glq->nodes_sin[i], glq->nodes_cos[i], nodes_sin[i],
+                nodes_cos[i]);
+        mu_assert(nodes_sin[i] == glq->nodes_sin[i] &&
+                  nodes_cos[i] == glq->nodes_cos[i], msg);
+    }
+    glq_free(glq);
+    return 0;
+}
+
+
 int glq_run_all()
 {
     int failed = 0;
@@ -510,5 +620,11 @@ int glq_run_all()
                 "glq cossine integration produces correct results");
     failed += mu_run_test(test_glq_sincos,
                 "glq precomputes sin and cos correctly");
+    failed += mu_run_test(test_glq_nodes_weights,
+                "glq_nodes_weights produces correct results");
+    failed += mu_run_test(test_glq_new_aligned,
+                "glq_new aligns the arrays to cache lines");
+    failed += mu_run_test(test_glq_scale_sincos,
+                "glq_scale_sincos same as glq_set_limits and precompute");
     return failed;
 }
@@ -823,6 +823,53 @@ static char * test_prism_tensor_trace()
     return 0;
 }
 
+static char * test_prism_fused()
+{
+    PRISM prism = {3000,-5000,5000,-5000,5000,-5000,5000,0,0,0};
+    double pos[5] = {-7000, -5000, 0, 5000, 8000}, xp, yp, zp, g[3],
+           ggt[6], sep[9];
+    int i, j, k, c;
+
+    /* Includes points on the edges of the prism, where the off-diagonal
+     * components need special care */
+    for(i = 0; i < 5; i++)
+    {
+        for(j = 0; j < 5; j++)
+        {
+            for(k = 0; k < 5; k++)
+            {
+                xp = pos[i];
+                yp = pos[j];
+                zp = pos[k];
+                prism_g(prism, xp, yp, zp, g);
+                prism_ggt(prism, xp, yp, zp, ggt);
+                sep[0] = prism_gx(prism, xp, yp, zp);
+                sep[1] = prism_gy(prism, xp, yp, zp);
+                sep[2] = prism_gz(prism, xp, yp, zp);
+                for(c = 0; c < 3; c++)
+                {
+                    sprintf(msg, "(%g %g %g) g[%d] fused %.15g separate "
+                            "%.15g", xp, yp, zp, c, g[c], sep[c]);
+                    mu_assert(g[c] == sep[c], msg);
+                }
+                sep[0] = prism_gxx(prism, xp, yp, zp);
+                sep[1] = prism_gxy(prism, xp, yp, zp);
+                sep[2] = prism_gxz(prism, xp, yp, zp);
+                sep[3] = prism_gyy(prism, xp, yp, zp);
+                sep[4] = prism_gyz(prism, xp, yp, zp);
+                sep[5] = prism_gzz(prism, xp, yp, zp);
+                for(c = 0; c < 6; c++)
+                {
+                    sprintf(msg, "(%g %g %g) ggt[%d] fused %.15g separate "
+                            "%.15g", xp, yp, zp, c, ggt[c], sep[c]);
+                    mu_assert(ggt[c] == sep[c], msg);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
 int grav_prism_run_all()
 {
     int failed = 0;
@@ -884,5 +931,7 @@ int grav_prism_run_all()
                 "prism_gzz results equal to sphere of same mass at distance");
     failed += mu_run_test(test_prism_tensor_trace,
         "trace of GGT for prism in Cartesian coordinates is zero");
+    failed += mu_run_test(test_prism_fused,
+        "prism_g and prism_ggt results equal the separate components");
     return failed;
 }
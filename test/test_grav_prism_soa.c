@@ -0,0 +1,227 @@
+/*
+Unit tests for grav_prism_soa.c functions.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "../src/lib/grav_prism.h"
+#include "../src/lib/grav_prism_soa.h"
+#include "../src/lib/geometry.h"
+
+
+/* Make a model of 5 x 9 prisms (more than a block) with different sizes and
+densities */
+static void make_soa_test_model(PRISM *model)
+{
+    int i, j, k = 0;
+
+    for(i = 0; i < 5; i++)
+    {
+        for(j = 0; j < 9; j++, k++)
+        {
+            model[k].density = 1000 + 100*k - 2000*(k % 3 == 0);
+            model[k].x1 = -5000 + 2000*i;
+            model[k].x2 = model[k].x1 + 2000;
+            model[k].y1 = -9000 + 2000*j;
+            model[k].y2 = model[k].y1 + 2000;
+            model[k].z1 = 100*(k % 4);
+            model[k].z2 = model[k].z1 + 500 + 100*j;
+        }
+    }
+}
+
+
+static char * test_prism_soa_kernels()
+{
+    double (*aos[10])(PRISM, double, double, double) = {
+        prism_pot, prism_gx, prism_gy, prism_gz, prism_gxx, prism_gxy,
+        prism_gxz, prism_gyy, prism_gyz, prism_gzz};
+    double (*soa[10])(PRISM_SOA *, double, double, double) = {
+        prism_pot_soa, prism_gx_soa, prism_gy_soa, prism_gz_soa,
+        prism_gxx_soa, prism_gxy_soa, prism_gxz_soa, prism_gyy_soa,
+        prism_gyz_soa, prism_gzz_soa};
+    /* Points above corners and edges of the prisms and in between */
+    double points[][3] = {{0, 0, -100}, {-5000, -9000, -10}, {1000, 3000, 0},
+                          {-1500, 700, -1000}, {5000, 9000, -50},
+                          {20000, -30000, -5000}, {3000, 0, -300}};
+    PRISM model[45];
+    PRISM_SOA *soamodel;
+    double res, expect, scale, value;
+    int f, p, i;
+
+    make_soa_test_model(model);
+    soamodel = new_prism_soa(model, 45);
+    mu_assert(soamodel != NULL, "new_prism_soa failed");
+    for(f = 0; f < 10; f++)
+    {
+        for(p = 0; p < 7; p++)
+        {
+            expect = 0;
+            scale = 0;
+            for(i = 0; i < 45; i++)
+            {
+                value = aos[f](model[i], points[p][0], points[p][1],
+                               points[p][2]);
+                expect += value;
+                scale += fabs(value);
+            }
+            res = soa[f](soamodel, points[p][0], points[p][1], points[p][2]);
+            sprintf(msg, "field %d point %d: expect %.15g got %.15g", f, p,
+                    expect, res);
+            mu_assert_almost_equals(res, expect, 1e-10*scale, msg);
+        }
+    }
+    free_prism_soa(soamodel);
+    return 0;
+}
+
+
+/* Make a model of 6 x 6 columns of 3 layers with the same interfaces in
+all columns, except for the top of each column */
+static void make_soa_grid_model(PRISM *model)
+{
+    double density[3] = {2670, 2670, 3300};
+    int i, j, l, k = 0;
+
+    for(i = 0; i < 6; i++)
+    {
+        for(j = 0; j < 6; j++)
+        {
+            for(l = 0; l < 3; l++, k++)
+            {
+                model[k].density = density[l];
+                model[k].x1 = -6000 + 2000*i;
+                model[k].x2 = model[k].x1 + 2000;
+                model[k].y1 = -4000 + 2000*j;
+                model[k].y2 = model[k].y1 + 2000;
+                model[k].z1 = l == 0 ? -100*((i + j) % 3) : 1000*l;
+                model[k].z2 = 1000*(l + 1);
+            }
+        }
+    }
+}
+
+
+static char * test_prism_soa_shared()
+{
+    double (*aos[10])(PRISM, double, double, double) = {
+        prism_pot, prism_gx, prism_gy, prism_gz, prism_gxx, prism_gxy,
+        prism_gxz, prism_gyy, prism_gyz, prism_gzz};
+    double (*soa[10])(PRISM_SOA *, double, double, double) = {
+        prism_pot_soa, prism_gx_soa, prism_gy_soa, prism_gz_soa,
+        prism_gxx_soa, prism_gxy_soa, prism_gxz_soa, prism_gyy_soa,
+        prism_gyz_soa, prism_gzz_soa};
+    /* Points on the continuation of edges of the prisms and in between */
+    double points[][3] = {{0, 0, -500}, {-6000, -4000, -10}, {1000, 3000, 0},
+                          {-1500, 700, -1000}, {6000, 8000, -50},
+                          {20000, -30000, -5000}, {3000, 0, -300},
+                          {7000, 2000, 2000}, {0, 9000, 1000}};
+    PRISM model[108];
+    PRISM_SOA *soamodel;
+    double res, expect, scale, value;
+    int f, p, i, nvertices;
+
+    make_soa_grid_model(model);
+    soamodel = new_prism_soa(model, 108);
+    mu_assert(soamodel != NULL, "new_prism_soa failed");
+    nvertices = prism_soa_share_vertices(soamodel);
+    sprintf(msg, "%d shared corners for %d prisms", nvertices, 108);
+    mu_assert(nvertices > 0 && nvertices < 4*108, msg);
+    mu_assert(soamodel->nvertices == nvertices, msg);
+    for(f = 0; f < 10; f++)
+    {
+        for(p = 0; p < 9; p++)
+        {
+            expect = 0;
+            scale = 0;
+            for(i = 0; i < 108; i++)
+            {
+                value = aos[f](model[i], points[p][0], points[p][1],
+                               points[p][2]);
+                expect += value;
+                scale += fabs(value);
+            }
+            res = soa[f](soamodel, points[p][0], points[p][1], points[p][2]);
+            sprintf(msg, "field %d point %d: expect %.15g got %.15g", f, p,
+                    expect, res);
+            mu_assert_almost_equals(res, expect, 1e-9*scale, msg);
+        }
+    }
+    free_prism_soa(soamodel);
+    return 0;
+}
+
+
+static char * test_prism_soa_shared_cancel()
+{
+    PRISM model[25], prism = {1000, -5000, 5000, -5000, 5000, 0, 1000, 0, 0,
+                              0};
+    PRISM_SOA *soamodel;
+    double res, expect;
+    int i, j, k = 0;
+
+    /* A 5 x 5 grid with the same density is the same as one big prism */
+    for(i = 0; i < 5; i++)
+    {
+        for(j = 0; j < 5; j++, k++)
+        {
+            model[k] = prism;
+            model[k].x1 = -5000 + 2000*i;
+            model[k].x2 = model[k].x1 + 2000;
+            model[k].y1 = -5000 + 2000*j;
+            model[k].y2 = model[k].y1 + 2000;
+        }
+    }
+    soamodel = new_prism_soa(model, 25);
+    mu_assert(soamodel != NULL, "new_prism_soa failed");
+    sprintf(msg, "%d shared corners instead of 8",
+            prism_soa_share_vertices(soamodel));
+    mu_assert(soamodel->nvertices == 8, msg);
+    res = prism_gz_soa(soamodel, 1500, -700, -300);
+    expect = prism_gz(prism, 1500, -700, -300);
+    sprintf(msg, "expect %.15g got %.15g", expect, res);
+    mu_assert_almost_equals_rel(res, expect, 1e-10, msg);
+    free_prism_soa(soamodel);
+    return 0;
+}
+
+
+static char * test_prism_soa_layout()
+{
+    PRISM model[45];
+    PRISM_SOA *soamodel;
+    int i;
+
+    make_soa_test_model(model);
+    soamodel = new_prism_soa(model, 45);
+    mu_assert(soamodel != NULL, "new_prism_soa failed");
+    mu_assert(soamodel->size == 45, "wrong size");
+    for(i = 0; i < 45; i++)
+    {
+        sprintf(msg, "prism %d copied wrong", i);
+        mu_assert(soamodel->density[i] == model[i].density &&
+                  soamodel->x1[i] == model[i].x1 &&
+                  soamodel->x2[i] == model[i].x2 &&
+                  soamodel->y1[i] == model[i].y1 &&
+                  soamodel->y2[i] == model[i].y2 &&
+                  soamodel->z1[i] == model[i].z1 &&
+                  soamodel->z2[i] == model[i].z2, msg);
+    }
+    free_prism_soa(soamodel);
+    return 0;
+}
+
+
+int grav_prism_soa_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_prism_soa_layout,
+        "new_prism_soa copies the model into arrays");
+    failed += mu_run_test(test_prism_soa_kernels,
+        "prism *_soa results equal the sum of the single prism functions");
+    failed += mu_run_test(test_prism_soa_shared,
+        "prism *_soa results with shared corners equal the sum of the prisms");
+    failed += mu_run_test(test_prism_soa_shared_cancel,
+        "shared corners inside a body of constant density cancel out");
+    return failed;
+}
@@ -3,6 +3,7 @@ Unit tests for grav_prism.c functions.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include "../src/lib/grav_prism_sph.h"
 #include "../src/lib/grav_prism.h"
@@ -143,6 +144,80 @@ static char * test_prism_tensor_sph_trace()
     return 0;
 }
 
+/* The frames give the same results as the transformations that compute the
+trigonometric functions for every prism */
+static char * test_prism_sph_frame()
+{
+    #define R 6378137.0
+    #define N 3
+    PRISM prisms[N] = {
+        {3000,-5000,5000,-5000,5000,0,5000, 2.45, -36.32, R},
+        {2000,-3000,3000,-2000,2000,0,800, -45.45, -103.1, R},
+        {1000,-2000,2000,-1000,1000,0,234, -80.45, 183.2, R}};
+    double offsets[3][3] = {{0.05, 0.02, 1000}, {-0.3, 0.2, 50000},
+                            {1, -0.6, 300}}, points[3][3];
+    double x, y, z, local[9], expect[9], res[6], pot;
+    SPH_FRAME *frames, point;
+    int i, p, c, pos[6] = {0, 1, 2, 4, 5, 8};
+
+    frames = prism_frames(prisms, N);
+    mu_assert(frames != NULL, "prism_frames failed");
+    for(i = 0; i < N; i++)
+    {
+        for(p = 0; p < 3; p++)
+        {
+            /* Points close to the prism. Far away, the formulas of the
+             * prism lose precision to cancellation. */
+            points[p][0] = prisms[i].lon + offsets[p][0];
+            points[p][1] = prisms[i].lat + offsets[p][1];
+            points[p][2] = R + offsets[p][2];
+            sph_frame(points[p][0], points[p][1], points[p][2], &point);
+            global2local(points[p][0], points[p][1], points[p][2], prisms[i],
+                         &x, &y, &z);
+            pot = prism_pot_sph_frame(prisms[i], &frames[i], &point);
+            sprintf(msg, "(prism %d point %d) pot: expect %.10g got %.10g", i,
+                    p, prism_pot(prisms[i], x, y, z), pot);
+            mu_assert_almost_equals(pot, prism_pot(prisms[i], x, y, z),
+                                    1e-8*fabs(pot), msg);
+            local[0] = prism_gx(prisms[i], x, y, z);
+            local[1] = prism_gy(prisms[i], x, y, z);
+            local[2] = -prism_gz(prisms[i], x, y, z);
+            g_prism2point(local, prisms[i], points[p][0], points[p][1],
+                          points[p][2], expect);
+            expect[2] = -expect[2];
+            prism_g_sph_frame(prisms[i], &frames[i], &point, res);
+            for(c = 0; c < 3; c++)
+            {
+                sprintf(msg, "(prism %d point %d) g %d: expect %.10g got "
+                        "%.10g", i, p, c, expect[c], res[c]);
+                mu_assert_almost_equals(res[c], expect[c], 1e-10, msg);
+            }
+            local[0] = prism_gxx(prisms[i], x, y, z);
+            local[1] = prism_gxy(prisms[i], x, y, z);
+            local[2] = -prism_gxz(prisms[i], x, y, z);
+            local[3] = local[1];
+            local[4] = prism_gyy(prisms[i], x, y, z);
+            local[5] = -prism_gyz(prisms[i], x, y, z);
+            local[6] = local[2];
+            local[7] = local[5];
+            local[8] = prism_gzz(prisms[i], x, y, z);
+            ggt_prism2point(local, prisms[i], points[p][0], points[p][1],
+                            points[p][2], expect);
+            prism_ggt_sph_frame(prisms[i], &frames[i], &point, res);
+            for(c = 0; c < 6; c++)
+            {
+                sprintf(msg, "(prism %d point %d) ggt %d: expect %.10g got "
+                        "%.10g", i, p, c, expect[pos[c]], res[c]);
+                mu_assert_almost_equals(res[c], expect[pos[c]], 1e-8, msg);
+            }
+        }
+    }
+    free(frames);
+    #undef R
+    #undef N
+    return 0;
+}
+
 int grav_prism_sph_run_all()
 {
     int failed = 0;
@@ -156,5 +231,7 @@ int grav_prism_sph_run_all()
         "trace of GGT for prism in spherical coordinates is zero");
     failed += mu_run_test(test_global2local,
         "global2local returns correct result");
+    failed += mu_run_test(test_prism_sph_frame,
+        "prism_*_sph_frame results equal to the transformations");
     return failed;
 }
@@ -0,0 +1,145 @@
+/*
+Unit tests for grav_sphere_soa.c functions and for sphere_gxy of
+grav_sphere.c.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "../src/lib/grav_sphere.h"
+#include "../src/lib/grav_sphere_soa.h"
+#include "../src/lib/geometry.h"
+#include "../src/lib/constants.h"
+
+
+/* Make a model of 301 spheres (more than a block and an odd number) around
+lon = 10, lat = -30 with different sizes, depths and densities */
+static void make_sphere_soa_model(SPHERE *model, int size)
+{
+    int k;
+
+    for(k = 0; k < size; k++)
+    {
+        model[k].lonc = 10 + 0.05*(k % 17) - 0.4;
+        model[k].latc = -30 + 0.05*(k/17) - 0.4;
+        model[k].rc = MEAN_EARTH_RADIUS - 2000 - 100*(k % 7);
+        model[k].r = 500 + 10*(k % 5);
+        model[k].density = 200 - 3*k;
+    }
+}
+
+
+static char * test_sphere_soa_kernels()
+{
+    double (*aos[10])(SPHERE, double, double, double) = {
+        sphere_pot, sphere_gx, sphere_gy, sphere_gz, sphere_gxx, sphere_gxy,
+        sphere_gxz, sphere_gyy, sphere_gyz, sphere_gzz};
+    double (*soa[10])(SPHERE_SOA *, double, double, double) = {
+        sphere_pot_soa, sphere_gx_soa, sphere_gy_soa, sphere_gz_soa,
+        sphere_gxx_soa, sphere_gxy_soa, sphere_gxz_soa, sphere_gyy_soa,
+        sphere_gyz_soa, sphere_gzz_soa};
+    /* Points above the spheres and away from them */
+    double points[][3] = {{10, -30, 1000}, {9.6, -29.8, 10}, {10.3, -30.2, 0},
+                          {12, -25, 5000}, {-170, 30, 100}, {10, 60, 250000}};
+    SPHERE model[301];
+    SPHERE_SOA *soamodel;
+    double res, expect, scale, value;
+    int f, p, i;
+
+    make_sphere_soa_model(model, 301);
+    soamodel = new_sphere_soa(model, 301);
+    mu_assert(soamodel != NULL, "new_sphere_soa failed");
+    mu_assert(soamodel->size == 301, "wrong size");
+    for(f = 0; f < 10; f++)
+    {
+        for(p = 0; p < 6; p++)
+        {
+            expect = 0;
+            scale = 0;
+            for(i = 0; i < 301; i++)
+            {
+                value = aos[f](model[i], points[p][0], points[p][1],
+                               points[p][2] + MEAN_EARTH_RADIUS);
+                expect += value;
+                scale += fabs(value);
+            }
+            res = soa[f](soamodel, points[p][0], points[p][1],
+                         points[p][2] + MEAN_EARTH_RADIUS);
+            sprintf(msg, "field %d point %d: expect %.15g got %.15g", f, p,
+                    expect, res);
+            mu_assert_almost_equals(res, expect, 1e-9*scale, msg);
+        }
+    }
+    free_sphere_soa(soamodel);
+    return 0;
+}
+
+
+static char * test_sphere_soa_trace()
+{
+    double points[][3] = {{10, -30, 1000}, {9.6, -29.8, 10}, {10.3, -30.2, 0},
+                          {12, -25, 5000}};
+    SPHERE model[301];
+    SPHERE_SOA *soamodel;
+    double gxx, gyy, gzz, r;
+    int p;
+
+    make_sphere_soa_model(model, 301);
+    soamodel = new_sphere_soa(model, 301);
+    mu_assert(soamodel != NULL, "new_sphere_soa failed");
+    for(p = 0; p < 4; p++)
+    {
+        r = points[p][2] + MEAN_EARTH_RADIUS;
+        gxx = sphere_gxx_soa(soamodel, points[p][0], points[p][1], r);
+        gyy = sphere_gyy_soa(soamodel, points[p][0], points[p][1], r);
+        gzz = sphere_gzz_soa(soamodel, points[p][0], points[p][1], r);
+        sprintf(msg, "point %d: gxx + gyy + gzz = %g (gzz = %g)", p,
+                gxx + gyy + gzz, gzz);
+        mu_assert_almost_equals(gxx + gyy + gzz, 0, 1e-9*fabs(gzz), msg);
+    }
+    free_sphere_soa(soamodel);
+    return 0;
+}
+
+
+/* gxy is the derivative of gy to the north (x). The unit vector to the east
+doesn't change with latitude, so gxy = (1/r) d(gy)/d(lat). Checked with a
+centered finite difference on points at other latitudes than the sphere */
+static char * test_sphere_gxy_derivative()
+{
+    double points[][3] = {{10, -25, 1000}, {9.6, -29.8, 10}, {14, -32, 0},
+                          {-170, 30, 100}, {10, 60, 250000}};
+    SPHERE model[5];
+    double gxy, diff, r, dlat = 0.0001, d2r = PI/180.;
+    int p, i;
+
+    make_sphere_soa_model(model, 5);
+    for(i = 0; i < 5; i++)
+    {
+        for(p = 0; p < 5; p++)
+        {
+            r = points[p][2] + MEAN_EARTH_RADIUS;
+            gxy = sphere_gxy(model[i], points[p][0], points[p][1], r);
+            diff = (sphere_gy(model[i], points[p][0], points[p][1] + dlat, r) -
+                    sphere_gy(model[i], points[p][0], points[p][1] - dlat, r))/
+                   (2*r*d2r*dlat);
+            diff *= SI2EOTVOS/SI2MGAL;
+            sprintf(msg, "sphere %d point %d: gxy %.15g finite difference "
+                    "%.15g", i, p, gxy, diff);
+            mu_assert_almost_equals_rel(gxy, diff, 1e-4, msg);
+        }
+    }
+    return 0;
+}
+
+
+int grav_sphere_soa_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_sphere_soa_kernels,
+        "sphere SoA kernels give the same results as grav_sphere.c");
+    failed += mu_run_test(test_sphere_soa_trace,
+        "trace of the sphere SoA gradient tensor is zero");
+    failed += mu_run_test(test_sphere_gxy_derivative,
+        "sphere_gxy is the derivative of sphere_gy to the north");
+    return failed;
+}
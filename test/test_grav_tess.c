@@ -42,15 +42,13 @@ static char * test_tess2sphere_pot()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
     tess2sphere(tess, &sphere);
     for(dist=1000000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_pot(tess,0,40,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_pot(tess,0,40,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_pot(sphere,0,40,radius+dist);
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
                 restess, ressphere);
@@ -87,8 +85,6 @@ static char * test_tess2sphere_gx()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -96,7 +92,7 @@ static char * test_tess2sphere_gx()
 
     for(dist=1000000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gx(tess,0,40,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gx(tess,0,40,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gx(sphere,0,40,radius+dist);
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
                 restess, ressphere);
@@ -134,8 +130,6 @@ static char * test_tess2sphere_gy()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -143,7 +137,7 @@ static char * test_tess2sphere_gy()
 
     for(dist=1000000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gy(tess,5,45,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gy(tess,5,45,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gy(sphere,5,45,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -182,8 +176,6 @@ static char * test_tess2sphere_gz()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -191,7 +183,7 @@ static char * test_tess2sphere_gz()
 
     for(dist=1500000; dist <= 2000000; dist += 1000)
     {
-        restess = -tess_gz(tess,0,45,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = -tess_gz(tess,0,45,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gz(sphere,0,45,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -230,8 +222,6 @@ static char * test_tess2sphere_gxx()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -239,7 +229,7 @@ static char * test_tess2sphere_gxx()
 
     for(dist=1300000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gxx(tess,0,45,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gxx(tess,0,45,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gxx(sphere,0,45,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -278,8 +268,6 @@ static char * test_tess2sphere_gxy()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -287,7 +275,7 @@ static char * test_tess2sphere_gxy()
 
     for(dist=1500000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gxy(tess,5,50,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gxy(tess,5,50,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gxy(sphere,5,50,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -326,8 +314,6 @@ static char * test_tess2sphere_gxz()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -335,7 +321,7 @@ static char * test_tess2sphere_gxz()
 
     for(dist=1500000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gxz(tess,0,50,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gxz(tess,0,50,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gxz(sphere,0,50,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -374,8 +360,6 @@ static char * test_tess2sphere_gyy()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -383,7 +367,7 @@ static char * test_tess2sphere_gyy()
 
     for(dist=1500000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gyy(tess,0,45,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gyy(tess,0,45,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gyy(sphere,0,45,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -422,8 +406,6 @@ static char * test_tess2sphere_gyz()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -431,7 +413,7 @@ static char * test_tess2sphere_gyz()
 
     for(dist=1500000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gyz(tess,5,45,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gyz(tess,5,45,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gyz(sphere,5,45,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -470,8 +452,6 @@ static char * test_tess2sphere_gzz()
     if(glqr == NULL)
         mu_assert(0, "GLQ allocation error");
 
-    glq_precompute_sincos(glqlat);
-
     radius = tess.r2;
 
     /* Make a sphere with the same mass as the tesseroid */
@@ -479,7 +459,7 @@ static char * test_tess2sphere_gzz()
 
     for(dist=1500000; dist <= 2000000; dist += 1000)
     {
-        restess = tess_gzz(tess,0,45,radius+dist,*glqlon,*glqlat,*glqr);
+        restess = tess_gzz(tess,0,45,radius+dist,glqlon,glqlat,glqr);
         ressphere = sphere_gzz(sphere,0,45,radius+dist);
 
         sprintf(msg, "(distance %g m) tess = %.5f  sphere = %.5f", dist,
@@ -603,6 +583,468 @@ static char * test_adaptative()
 }
 
 
+static char * test_column_kernels()
+{
+    /* The column kernels should give the same as summing the effect of each
+       layer */
+    #define NFIELDS 10
+    double (*fields[NFIELDS])(TESSEROID, double, double, double, const GLQ *,
+                              const GLQ *, const GLQ *) = {
+        tess_pot, tess_gx, tess_gy, tess_gz, tess_gxx, tess_gxy, tess_gxz,
+        tess_gyy, tess_gyz, tess_gzz};
+    double (*column_fields[NFIELDS])(TESSEROID *, int, double, double, double,
+                                     const GLQ *, const GLQ *,
+                                     const GLQ *) = {
+        tess_pot_column, tess_gx_column, tess_gy_column, tess_gz_column,
+        tess_gxx_column, tess_gxy_column, tess_gxz_column, tess_gyy_column,
+        tess_gyz_column, tess_gzz_column};
+    /* Radii are relative to the mean Earth radius */
+    TESSEROID column[3] = {
+        {2670, 44, 46, -1, 1, -10000, 0},
+        {2900, 44, 46, -1, 1, -35000, -10000},
+        {3300, 44, 46, -1, 1, -100000, -35000}};
+    GLQ *glqlon, *glqlat, *glqr;
+    double layers, rescol, lon, lat, r = MEAN_EARTH_RADIUS + 500000;
+    int f, t;
+
+    for(t = 0; t < 3; t++)
+    {
+        column[t].r1 += MEAN_EARTH_RADIUS;
+        column[t].r2 += MEAN_EARTH_RADIUS;
+    }
+
+    glqlon = glq_new(5, column[0].w, column[0].e);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(5, column[0].s, column[0].n);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(3, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(f = 0; f < NFIELDS; f++)
+    {
+        for(lon = 40; lon <= 50; lon += 2.5)
+        {
+            for(lat = -5; lat <= 5; lat += 2.5)
+            {
+                layers = 0;
+                for(t = 0; t < 3; t++)
+                {
+                    layers += fields[f](column[t], lon, lat, r, glqlon,
+                                        glqlat, glqr);
+                }
+                rescol = column_fields[f](column, 3, lon, lat, r, glqlon,
+                                          glqlat, glqr);
+                sprintf(msg, "(field %d lon %g lat %g) column = %.15g  "
+                        "layers = %.15g", f, lon, lat, rescol, layers);
+                /* Some components are zero because of symmetry */
+                mu_assert(fabs(rescol - layers) <=
+                          0.0000000001*(fabs(layers) + 1), msg);
+            }
+        }
+    }
+
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    #undef NFIELDS
+    return 0;
+}
+
+
+static char * test_column_adaptative()
+{
+    /* Check if the adaptative column computation gives the same as the
+       adaptative computation for each layer */
+    /* Radii are relative to the mean Earth radius */
+    TESSEROID column[2] = {
+        {2670, -0.5, 0.5, -0.5, 0.5, -5000, 0},
+        {3000, -0.5, 0.5, -0.5, 0.5, -30000, -5000}};
+    long columns[2] = {0, 2};
+    int t;
+    GLQ *glqlon, *glqlat, *glqr;
+    double rescol, reslayers, lon, lat, height;
+
+    for(t = 0; t < 2; t++)
+    {
+        column[t].r1 += MEAN_EARTH_RADIUS;
+        column[t].r2 += MEAN_EARTH_RADIUS;
+    }
+
+    glqlon = glq_new(2, -1, 1);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(2, -1, 1);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(2, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(height = 10000; height <= 100000; height += 45000)
+    {
+        for(lon = -1; lon <= 1; lon += 0.25)
+        {
+            for(lat = -1; lat <= 1; lat += 0.25)
+            {
+                rescol = calc_tess_model_columns_adapt(column, columns, 1,
+                            lon, lat, height + MEAN_EARTH_RADIUS, glqlon,
+                            glqlat, glqr, tess_gzz_column,
+                            TESSEROID_GZZ_SIZE_RATIO);
+                reslayers = calc_tess_model_adapt(column, 2, lon, lat,
+                                height + MEAN_EARTH_RADIUS, glqlon, glqlat,
+                                glqr, tess_gzz, TESSEROID_GZZ_SIZE_RATIO);
+                sprintf(msg, "(lon %g lat %g height %g) column = %.10f  "
+                        "layers = %.10f", lon, lat, height, rescol,
+                        reslayers);
+                mu_assert_almost_equals_rel(rescol, reslayers, 0.1, msg);
+            }
+        }
+    }
+
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    return 0;
+}
+
+
+static char * test_column_many_layers()
+{
+    /* A column with more layers than fit in the buffer of pieces of
+       calc_tess_column_adapt should give the same as the adaptative
+       computation for each layer */
+    #define NLAYERS 1200
+    static TESSEROID column[NLAYERS];
+    long columns[2] = {0, NLAYERS};
+    int t;
+    GLQ *glqlon, *glqlat, *glqr;
+    double rescol, reslayers, lon, height;
+
+    for(t = 0; t < NLAYERS; t++)
+    {
+        column[t].density = 2000 + t;
+        column[t].w = -0.5;
+        column[t].e = 0.5;
+        column[t].s = -0.5;
+        column[t].n = 0.5;
+        column[t].r2 = MEAN_EARTH_RADIUS - 50*t;
+        column[t].r1 = MEAN_EARTH_RADIUS - 50*(t + 1);
+    }
+
+    glqlon = glq_new(2, -1, 1);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(2, -1, 1);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(2, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(height = 20000; height <= 200000; height += 180000)
+    {
+        for(lon = 0; lon <= 1; lon += 0.5)
+        {
+            rescol = calc_tess_model_columns_adapt(column, columns, 1, lon, 0,
+                        height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                        tess_gz_column, TESSEROID_GZ_SIZE_RATIO);
+            reslayers = calc_tess_model_adapt(column, NLAYERS, lon, 0,
+                            height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                            tess_gz, TESSEROID_GZ_SIZE_RATIO);
+            sprintf(msg, "(lon %g height %g) column = %.10f  layers = %.10f",
+                    lon, height, rescol, reslayers);
+            mu_assert_almost_equals_rel(rescol, reslayers, 0.1, msg);
+        }
+    }
+
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    #undef NLAYERS
+    return 0;
+}
+
+
+static char * test_column_close()
+{
+    /* Points half a meter above the column, on its corner and center,
+       should be computed without overflowing the division stack */
+    TESSEROID column[2] = {
+        {2670, -0.5, 0.5, -0.5, 0.5, -5000, 0},
+        {3000, -0.5, 0.5, -0.5, 0.5, -30000, -5000}};
+    long columns[2] = {0, 2};
+    int t;
+    GLQ *glqlon, *glqlat, *glqr;
+    double res, lon;
+
+    for(t = 0; t < 2; t++)
+    {
+        column[t].r1 += MEAN_EARTH_RADIUS;
+        column[t].r2 += MEAN_EARTH_RADIUS;
+    }
+
+    glqlon = glq_new(2, -1, 1);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(2, -1, 1);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(2, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(lon = -0.5; lon <= 0; lon += 0.5)
+    {
+        res = calc_tess_model_columns_adapt(column, columns, 1, lon, lon,
+                    MEAN_EARTH_RADIUS + 0.5, glqlon, glqlat, glqr,
+                    tess_gz_column, TESSEROID_GZ_SIZE_RATIO);
+        sprintf(msg, "(lon %g lat %g) gz = %g", lon, lon, res);
+        mu_assert(res == res && res > 0 && res < 1e6, msg);
+    }
+
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    return 0;
+}
+
+
+static char * test_grid_model()
+{
+    /* Check if the grid model gives the same as the equivalent tesseroids */
+    /* Radii of the interfaces are relative to the mean Earth radius */
+    double radii[12] = {0, -5000, -30000, 1000, -4000, -30000,
+                        -500, -500, -20000, 200, -6000, -25000},
+           density[8] = {2670, 3000, 2000, 3100, 2800, 3300, 2500, 3000},
+           resgrid, resmodel, lon, lat, height;
+    TESSEROID model[8], column[2];
+    TESS_GRID *grid;
+    GLQ *glqlon, *glqlat, *glqr;
+    long columns[9], ncolumns;
+    int i, j, l, size = 0, adapt;
+
+    grid = new_tess_grid(-1, -1, 1, 1, 2, 2, 2);
+    if(grid == NULL)
+        mu_assert(0, "grid allocation error");
+    for(i = 0; i < 12; i++)
+    {
+        grid->radii[i] = radii[i] + MEAN_EARTH_RADIUS;
+    }
+    for(i = 0; i < 8; i++)
+    {
+        grid->density[i] = density[i];
+    }
+    /* The layer with zero thickness is skipped */
+    for(j = 0; j < 2; j++)
+    {
+        for(i = 0; i < 2; i++)
+        {
+            for(l = 0; l < 2; l++)
+            {
+                if(radii[(j*2 + i)*3 + l] == radii[(j*2 + i)*3 + l + 1])
+                    continue;
+                model[size].w = -1 + i;
+                model[size].e = i;
+                model[size].s = -1 + j;
+                model[size].n = j;
+                model[size].r2 = grid->radii[(j*2 + i)*3 + l];
+                model[size].r1 = grid->radii[(j*2 + i)*3 + l + 1];
+                model[size].density = density[(j*2 + i)*2 + l];
+                size++;
+            }
+        }
+    }
+
+    ncolumns = tess_find_columns(model, size, columns);
+
+    glqlon = glq_new(2, -1, 1);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(2, -1, 1);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(2, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(adapt = 0; adapt < 2; adapt++)
+    {
+        for(height = 10000; height <= 100000; height += 45000)
+        {
+            for(lon = -2; lon <= 1; lon += 0.5)
+            {
+                for(lat = -2; lat <= 1; lat += 0.5)
+                {
+                    if(adapt)
+                    {
+                        resgrid = calc_tess_grid_adapt(grid, column, lon, lat,
+                                    height + MEAN_EARTH_RADIUS, glqlon, glqlat,
+                                    glqr, tess_gz_column,
+                                    TESSEROID_GZ_SIZE_RATIO);
+                        resmodel = calc_tess_model_columns_adapt(model,
+                                    columns, ncolumns, lon, lat,
+                                    height + MEAN_EARTH_RADIUS, glqlon, glqlat,
+                                    glqr, tess_gz_column,
+                                    TESSEROID_GZ_SIZE_RATIO);
+                    }
+                    else
+                    {
+                        resgrid = calc_tess_grid(grid, column, lon, lat,
+                                    height + MEAN_EARTH_RADIUS, glqlon, glqlat,
+                                    glqr, tess_gz_column);
+                        resmodel = calc_tess_model(model, size, lon, lat,
+                                    height + MEAN_EARTH_RADIUS, glqlon, glqlat,
+                                    glqr, tess_gz);
+                    }
+                    sprintf(msg, "(adapt %d lon %g lat %g height %g) grid = "
+                            "%.10f  model = %.10f", adapt, lon, lat, height,
+                            resgrid, resmodel);
+                    mu_assert_almost_equals_rel(resgrid, resmodel, 1e-8, msg);
+                }
+            }
+        }
+    }
+
+    free_tess_grid(grid);
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    return 0;
+}
+
+
+static char * test_pyramid()
+{
+    /* Check if the pyramid gives the same as the original grid when the
+       coarse levels are not used and converges to it far away */
+    TESS_GRID *grid;
+    TESS_PYRAMID *pyramid;
+    TESSEROID column[2];
+    GLQ *glqlon, *glqlat, *glqr;
+    double respyr, resgrid, lon, lat, height;
+    int cell;
+
+    grid = new_tess_grid(-3, -2, 0.5, 0.5, 13, 9, 2);
+    if(grid == NULL)
+        mu_assert(0, "grid allocation error");
+    for(cell = 0; cell < 13*9; cell++)
+    {
+        grid->radii[cell*3] = MEAN_EARTH_RADIUS + 100*(cell % 7);
+        grid->radii[cell*3 + 1] = MEAN_EARTH_RADIUS - 1000 - 200*(cell % 3);
+        grid->radii[cell*3 + 2] = MEAN_EARTH_RADIUS - 30000;
+        grid->density[cell*2] = 2000 + 10*(cell % 11);
+        grid->density[cell*2 + 1] = 3000 - 20*(cell % 5);
+    }
+    pyramid = new_tess_pyramid(grid, 10);
+    if(pyramid == NULL)
+        mu_assert(0, "pyramid allocation error");
+
+    glqlon = glq_new(2, -1, 1);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(2, -1, 1);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(2, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(height = 10000; height <= 100000; height += 45000)
+    {
+        for(lon = -5; lon <= 5; lon += 2.5)
+        {
+            for(lat = -4; lat <= 4; lat += 2)
+            {
+                resgrid = calc_tess_grid_adapt(grid, column, lon, lat,
+                            height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                            tess_gz_column, TESSEROID_GZ_SIZE_RATIO);
+                respyr = calc_tess_pyramid_adapt(pyramid, column, lon, lat,
+                            height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                            tess_gz_column, TESSEROID_GZ_SIZE_RATIO, 1e10);
+                sprintf(msg, "(lon %g lat %g height %g) pyramid = %.10f  "
+                        "grid = %.10f", lon, lat, height, respyr, resgrid);
+                mu_assert_almost_equals_rel(respyr, resgrid, 1e-8, msg);
+                respyr = calc_tess_pyramid_adapt(pyramid, column, lon, lat,
+                            height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                            tess_gz_column, TESSEROID_GZ_SIZE_RATIO, 5);
+                sprintf(msg, "(lon %g lat %g height %g) coarse pyramid = "
+                        "%.10f  grid = %.10f", lon, lat, height, respyr,
+                        resgrid);
+                mu_assert_almost_equals_rel(respyr, resgrid, 0.5, msg);
+            }
+        }
+    }
+
+    free_tess_pyramid(pyramid);
+    free_tess_grid(grid);
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    return 0;
+}
+
+
+static char * test_glq_unchanged()
+{
+    /* The calculations only read the GLQ structures, so they can be shared by
+       threads */
+    TESSEROID model[2] = {{2670, 44, 46, -1, 1, 6368137, 6378137},
+                          {2670, 40, 41, 3, 5, 6358137, 6368137}};
+    long columns[3] = {0, 1, 2};
+    GLQ *glqlon, *glqlat, *glqr, *glqs[3];
+    double res;
+    int g, i;
+
+    glqlon = glq_new(3, -1, 1);
+    glqlat = glq_new(4, -1, 1);
+    glqr = glq_new(5, -1, 1);
+    mu_assert(glqlon != NULL && glqlat != NULL && glqr != NULL,
+              "GLQ allocation error");
+    res = calc_tess_model(model, 2, 45, 0, MEAN_EARTH_RADIUS + 1000, glqlon,
+                          glqlat, glqr, tess_gz) +
+          calc_tess_model_adapt(model, 2, 45, 0, MEAN_EARTH_RADIUS + 1000,
+                                glqlon, glqlat, glqr, tess_gzz,
+                                TESSEROID_GZZ_SIZE_RATIO) +
+          calc_tess_model_columns_adapt(model, columns, 2, 45, 0,
+                                MEAN_EARTH_RADIUS + 1000, glqlon, glqlat,
+                                glqr, tess_gxx_column,
+                                TESSEROID_GXX_SIZE_RATIO);
+    sprintf(msg, "result %g", res);
+    mu_assert(res == res, msg);
+    glqs[0] = glqlon;
+    glqs[1] = glqlat;
+    glqs[2] = glqr;
+    for(g = 0; g < 3; g++)
+    {
+        for(i = 0; i < glqs[g]->order; i++)
+        {
+            sprintf(msg, "(GLQ %d node %d) changed from %.17g to %.17g", g, i,
+                    glqs[g]->nodes_unscaled[i], glqs[g]->nodes[i]);
+            mu_assert(glqs[g]->nodes[i] == glqs[g]->nodes_unscaled[i], msg);
+        }
+    }
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    return 0;
+}
+
+
 int grav_tess_run_all()
 {
     int failed = 0;
@@ -629,5 +1071,19 @@ int grav_tess_run_all()
     failed += mu_run_test(test_tess_tensor_trace, "trace of GGT for tesseroid is zero");
     failed += mu_run_test(test_adaptative,
             "calc_tess_model_adapt results as non-adapt with split by hand");
+    failed += mu_run_test(test_column_kernels,
+            "column kernels results equal to sum of the layers");
+    failed += mu_run_test(test_column_adaptative,
+            "calc_tess_model_columns_adapt results as calc_tess_model_adapt");
+    failed += mu_run_test(test_column_many_layers,
+            "column with more layers than COLSTKSIZE as calc_tess_model_adapt");
+    failed += mu_run_test(test_column_close,
+            "calc_tess_model_columns_adapt on points close to the column");
+    failed += mu_run_test(test_grid_model,
+            "calc_tess_grid(_adapt) results as the equivalent model");
+    failed += mu_run_test(test_pyramid,
+            "calc_tess_pyramid_adapt results as calc_tess_grid_adapt");
+    failed += mu_run_test(test_glq_unchanged,
+            "tesseroid calculations don't change the GLQ structures");
     return failed;
 }
@@ -0,0 +1,168 @@
+/*
+Unit tests for the ordering along the Hilbert curve.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "minunit.h"
+#include "../src/lib/hilbert.h"
+#include "../src/lib/constants.h"
+
+/* To store fail messages */
+char msg[1000];
+
+
+static char * test_hilbert_index()
+{
+    int cellx[64], celly[64], seen[64], x, y, d, dist;
+
+    for(d = 0; d < 64; d++)
+    {
+        seen[d] = 0;
+    }
+    /* The first 64 cells of the curve fill the 8 x 8 corner */
+    for(x = 0; x < 8; x++)
+    {
+        for(y = 0; y < 8; y++)
+        {
+            d = (int)hilbert_index(x, y);
+            sprintf(msg, "cell %d %d at %d", x, y, d);
+            mu_assert(d >= 0 && d < 64 && !seen[d], msg);
+            seen[d] = 1;
+            cellx[d] = x;
+            celly[d] = y;
+        }
+    }
+    /* Consecutive cells are neighbors */
+    for(d = 1; d < 64; d++)
+    {
+        dist = abs(cellx[d] - cellx[d - 1]) + abs(celly[d] - celly[d - 1]);
+        sprintf(msg, "cells %d and %d are %d cells apart", d - 1, d, dist);
+        mu_assert(dist == 1, msg);
+    }
+    mu_assert(hilbert_index(0, 0) == 0, "curve doesn't start at the corner");
+    mu_assert(hilbert_index(HILBERT_SIZE - 1, 0) ==
+              (unsigned long)HILBERT_SIZE*HILBERT_SIZE - 1,
+              "curve doesn't end at the other corner");
+    return 0;
+}
+
+
+static char * test_hilbert_sort()
+{
+    double coords[3*257];
+    long order[257];
+    int i, j, k, dist;
+
+    /* A 16 x 16 grid of points in scrambled order. The extra point makes
+     * each point of the grid fall in the corner of a 4096 x 4096 block of
+     * cells of the curve. */
+    for(k = 0; k < 256; k++)
+    {
+        i = (k*37) % 256;
+        coords[3*i] = -20 + 2*(k % 16);
+        coords[3*i + 1] = 10 + 0.5*(k/16);
+        coords[3*i + 2] = k;
+    }
+    coords[3*256] = -20 + 2*16;
+    coords[3*256 + 1] = 10 + 0.5*16;
+    mu_assert(hilbert_sort(coords, 3, 257, order) == 0, "hilbert_sort failed");
+    for(k = 1; k < 257; k++)
+    {
+        i = (int)order[k - 1];
+        j = (int)order[k];
+        if(i == 256 || j == 256)
+        {
+            continue;
+        }
+        dist = abs((int)((coords[3*i] - coords[3*j])/2)) +
+               abs((int)((coords[3*i + 1] - coords[3*j + 1])/0.5));
+        sprintf(msg, "points %d and %d are %d cells apart", i, j, dist);
+        mu_assert(dist == 1, msg);
+    }
+    /* Repeated points keep their order */
+    for(k = 0; k < 10; k++)
+    {
+        coords[3*k] = 5;
+        coords[3*k + 1] = 5;
+    }
+    mu_assert(hilbert_sort(coords, 3, 10, order) == 0, "hilbert_sort failed");
+    for(k = 0; k < 10; k++)
+    {
+        sprintf(msg, "order[%d] = %ld", k, order[k]);
+        mu_assert(order[k] == k, msg);
+    }
+    return 0;
+}
+
+
+static char * test_hilbert_sort_tess()
+{
+    TESSEROID model[96], orig[96];
+    long order[96];
+    int seen[96], c, i, k, l, t, dist, lon1, lat1, lon2, lat2;
+
+    /* An 8 x 4 grid of columns with 3 layers each, in scrambled order */
+    for(c = 0, t = 0; c < 32; c++)
+    {
+        k = (c*13) % 32;
+        for(l = 0; l < 3; l++)
+        {
+            orig[t].w = 2*(k % 8);
+            orig[t].e = 2*(k % 8) + 2;
+            orig[t].s = 2*(k/8);
+            orig[t].n = 2*(k/8) + 2;
+            orig[t].r2 = MEAN_EARTH_RADIUS - 1000*l;
+            orig[t].r1 = MEAN_EARTH_RADIUS - 1000*(l + 1);
+            orig[t].density = t;
+            model[t] = orig[t];
+            seen[t] = 0;
+            t++;
+        }
+    }
+    mu_assert(hilbert_sort_tess(model, 96, order) == 0,
+              "hilbert_sort_tess failed");
+    for(t = 0; t < 96; t++)
+    {
+        i = (int)order[t];
+        sprintf(msg, "tesseroid %d comes from %d", t, i);
+        mu_assert(i >= 0 && i < 96 && !seen[i] &&
+                  model[t].density == orig[i].density, msg);
+        seen[i] = 1;
+    }
+    /* The layers of each column stay together and in order */
+    for(c = 0; c < 32; c++)
+    {
+        for(l = 1; l < 3; l++)
+        {
+            sprintf(msg, "layer %d of column %d", l, c);
+            mu_assert(order[3*c + l] == order[3*c] + l, msg);
+        }
+    }
+    /* The grid is narrower than the curve, so consecutive columns can be at
+     * most a few cells apart */
+    for(c = 1; c < 32; c++)
+    {
+        lon1 = (int)model[3*(c - 1)].w/2;
+        lat1 = (int)model[3*(c - 1)].s/2;
+        lon2 = (int)model[3*c].w/2;
+        lat2 = (int)model[3*c].s/2;
+        dist = abs(lon1 - lon2) + abs(lat1 - lat2);
+        sprintf(msg, "columns %d and %d are %d cells apart", c - 1, c, dist);
+        mu_assert(dist <= 3, msg);
+    }
+    return 0;
+}
+
+
+int hilbert_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_hilbert_index,
+            "hilbert_index visits neighboring cells");
+    failed += mu_run_test(test_hilbert_sort,
+            "hilbert_sort orders points along the curve");
+    failed += mu_run_test(test_hilbert_sort_tess,
+            "hilbert_sort_tess keeps the columns of the model");
+    return failed;
+}
@@ -0,0 +1,336 @@
+/*
+Unit tests for the binary cache files of models.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <utime.h>
+#endif
+#include "minunit.h"
+#include "../src/lib/model_cache.h"
+#include "../src/lib/constants.h"
+
+/* To store fail messages */
+char msg[1000];
+
+
+/* Write a tesseroid model file large enough to get a cache file */
+static int write_cache_model(const char *fname, int size, double density)
+{
+    FILE *file;
+    int i;
+
+    file = fopen(fname, "w");
+    if(file == NULL)
+    {
+        return 1;
+    }
+    fputs("# model for testing the cache\n", file);
+    for(i = 0; i < size; i++)
+    {
+        fprintf(file, "%d %d -10.123456 10.123456 0 -%d %.9f\n", i, i + 1,
+                i + 1, density);
+    }
+    fclose(file);
+    return 0;
+}
+
+
+/* Read the model and check its contents */
+static char * check_cache_model(const char *fname, int expect, double density)
+{
+    FILE *file;
+    TESSEROID *model;
+    long size, i;
+
+    file = fopen(fname, "r");
+    mu_assert(file != NULL, "failed to open model file");
+    model = read_tess_model_cached(file, fname, NULL, &size);
+    fclose(file);
+    mu_assert(model != NULL, "read_tess_model_cached failed");
+    sprintf(msg, "read %ld tesseroids. Expected %d", size, expect);
+    mu_assert(size == expect, msg);
+    for(i = 0; i < size; i++)
+    {
+        if(model[i].w != i || model[i].e != i + 1 ||
+           model[i].r1 != MEAN_EARTH_RADIUS - (i + 1) ||
+           model[i].density != density)
+        {
+            free(model);
+            sprintf(msg, "wrong tesseroid %ld", i);
+            mu_assert(0, msg);
+        }
+    }
+    free(model);
+    return 0;
+}
+
+
+/* Read the model reordered along the Hilbert curve and check its contents */
+static char * check_cache_model_sorted(const char *fname, int expect,
+                                       double density)
+{
+    FILE *file;
+    TESSEROID *model;
+    long *order, size, i, k, bad = -1;
+    int *seen;
+
+    file = fopen(fname, "r");
+    mu_assert(file != NULL, "failed to open model file");
+    model = read_tess_model_cached(file, fname, &order, &size);
+    fclose(file);
+    mu_assert(model != NULL && order != NULL,
+              "read_tess_model_cached failed to sort");
+    sprintf(msg, "read %ld tesseroids. Expected %d", size, expect);
+    mu_assert(size == expect, msg);
+    seen = (int *)calloc(size, sizeof(int));
+    mu_assert(seen != NULL, "failed to allocate memory");
+    for(k = 0; k < size && bad < 0; k++)
+    {
+        i = order[k];
+        if(i < 0 || i >= size || seen[i] || model[k].w != i ||
+           model[k].e != i + 1 || model[k].density != density)
+        {
+            bad = k;
+        }
+        else
+        {
+            seen[i] = 1;
+        }
+    }
+    free(seen);
+    free(model);
+    free(order);
+    sprintf(msg, "wrong tesseroid %ld of the sorted model", bad);
+    mu_assert(bad < 0, msg);
+    return 0;
+}
+
+
+static char * test_model_cache()
+{
+    const char *fname = "test_model_cache.tmp",
+               *cname = "test_model_cache.tmp.cache";
+    FILE *file;
+    char *fail;
+    long pos;
+    int c;
+
+    remove(cname);
+    mu_assert(write_cache_model(fname, 25000, 2670.5) == 0,
+              "failed to write model file");
+    /* The first read writes the cache file */
+    fail = check_cache_model(fname, 25000, 2670.5);
+    if(fail != 0)
+        return fail;
+    file = fopen(cname, "rb");
+    mu_assert(file != NULL, "cache file wasn't created");
+    fclose(file);
+    /* The second read uses it */
+    fail = check_cache_model(fname, 25000, 2670.5);
+    if(fail != 0)
+        return fail;
+    /* A different model file makes the cache stale */
+    mu_assert(write_cache_model(fname, 26000, 3300.25) == 0,
+              "failed to write model file");
+    fail = check_cache_model(fname, 26000, 3300.25);
+    if(fail != 0)
+        return fail;
+    /* Corrupt the cache file */
+    file = fopen(cname, "r+b");
+    mu_assert(file != NULL, "cache file wasn't created");
+    fseek(file, 0, SEEK_END);
+    pos = ftell(file);
+    fseek(file, pos/2, SEEK_SET);
+    c = fgetc(file);
+    fseek(file, pos/2, SEEK_SET);
+    fputc(c ^ 0xff, file);
+    fclose(file);
+    fail = check_cache_model(fname, 26000, 3300.25);
+    if(fail != 0)
+        return fail;
+    fail = check_cache_model(fname, 26000, 3300.25);
+    remove(fname);
+    remove(cname);
+    return fail;
+}
+
+
+#if defined(__unix__) || defined(__APPLE__)
+static char * test_model_cache_edit()
+{
+    /* An edit that keeps the size of the model file and its modification
+       time (in seconds) also makes the cache stale */
+    const char *fname = "test_model_cache.tmp",
+               *cname = "test_model_cache.tmp.cache";
+    FILE *file;
+    TESSEROID *model;
+    struct stat info;
+    struct utimbuf times;
+    char *fail;
+    long size, pos, i, changed = 0;
+    int c;
+
+    remove(cname);
+    mu_assert(write_cache_model(fname, 25000, 2670.5) == 0,
+              "failed to write model file");
+    fail = check_cache_model(fname, 25000, 2670.5);
+    if(fail != 0)
+        return fail;
+    mu_assert(stat(fname, &info) == 0, "failed to stat model file");
+    /* Change the last digit of the density of a tesseroid a quarter of the
+       way into the file, away from its start, middle and end */
+    file = fopen(fname, "r+b");
+    mu_assert(file != NULL, "failed to open model file");
+    fseek(file, (long)info.st_size/4, SEEK_SET);
+    while((c = fgetc(file)) != '\n' && c != EOF)
+        ;
+    while((c = fgetc(file)) != '\n' && c != EOF)
+        ;
+    pos = ftell(file) - 2;
+    fseek(file, pos, SEEK_SET);
+    fputc('1', file);
+    fclose(file);
+    times.actime = info.st_atime;
+    times.modtime = info.st_mtime;
+    mu_assert(utime(fname, &times) == 0,
+              "failed to set the time of the model file");
+    file = fopen(fname, "r");
+    mu_assert(file != NULL, "failed to open model file");
+    model = read_tess_model_cached(file, fname, NULL, &size);
+    fclose(file);
+    mu_assert(model != NULL && size == 25000,
+              "read_tess_model_cached failed");
+    for(i = 0; i < size; i++)
+    {
+        if(model[i].density != 2670.5)
+        {
+            changed++;
+        }
+    }
+    free(model);
+    remove(fname);
+    remove(cname);
+    sprintf(msg, "%ld tesseroids changed. Expected 1", changed);
+    mu_assert(changed == 1, msg);
+    return 0;
+}
+#endif
+
+
+static char * test_model_cache_foreign()
+{
+    /* A file with the name of the cache file that isn't a cache file is
+       left alone */
+    const char *fname = "test_model_cache.tmp",
+               *cname = "test_model_cache.tmp.cache",
+               *notes = "notes of the user, not a model cache\n";
+    FILE *file;
+    char *fail, text[100];
+    size_t nread;
+    int pass;
+
+    mu_assert(write_cache_model(fname, 25000, 2670.5) == 0,
+              "failed to write model file");
+    file = fopen(cname, "wb");
+    mu_assert(file != NULL, "failed to write the foreign file");
+    fputs(notes, file);
+    fclose(file);
+    /* Twice, since the first read might replace the file */
+    for(pass = 0; pass < 2; pass++)
+    {
+        fail = check_cache_model(fname, 25000, 2670.5);
+        if(fail != 0)
+        {
+            remove(fname);
+            remove(cname);
+            return fail;
+        }
+    }
+    remove(fname);
+    file = fopen(cname, "rb");
+    mu_assert(file != NULL, "the foreign file was removed");
+    nread = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+    remove(cname);
+    text[nread] = '\0';
+    mu_assert(strcmp(text, notes) == 0, "the foreign file was replaced");
+    return 0;
+}
+
+
+/* Check that the cache file has the whole model */
+static char * check_cache_file(const char *cname, int size)
+{
+    FILE *file;
+    long fsize;
+
+    file = fopen(cname, "rb");
+    mu_assert(file != NULL, "cache file wasn't created");
+    fseek(file, 0, SEEK_END);
+    fsize = ftell(file);
+    fclose(file);
+    sprintf(msg, "cache file has %ld bytes for %d tesseroids", fsize, size);
+    mu_assert(fsize > (long)(size*sizeof(TESSEROID)), msg);
+    return 0;
+}
+
+
+static char * test_model_cache_sorted()
+{
+    const char *fname = "test_model_cache.tmp",
+               *cname = "test_model_cache.tmp.cache";
+    char *fail;
+    int pass;
+
+    mu_assert(write_cache_model(fname, 25000, 2670.5) == 0,
+              "failed to write model file");
+    /* Start once with a sorted and once with an unsorted cache file. Both
+     * orders can be read from either one. */
+    for(pass = 0; pass < 2; pass++)
+    {
+        remove(cname);
+        fail = pass ? check_cache_model(fname, 25000, 2670.5) :
+                      check_cache_model_sorted(fname, 25000, 2670.5);
+        if(fail == 0)
+            fail = check_cache_model_sorted(fname, 25000, 2670.5);
+        if(fail == 0)
+            fail = check_cache_file(cname, 25000);
+        if(fail == 0)
+            fail = check_cache_model(fname, 25000, 2670.5);
+        if(fail == 0)
+            fail = check_cache_model_sorted(fname, 25000, 2670.5);
+        if(fail == 0)
+            fail = check_cache_file(cname, 25000);
+        if(fail != 0)
+        {
+            remove(fname);
+            remove(cname);
+            return fail;
+        }
+    }
+    remove(fname);
+    remove(cname);
+    return 0;
+}
+
+
+int model_cache_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_model_cache,
+            "read_tess_model_cached rebuilds stale and corrupted caches");
+    failed += mu_run_test(test_model_cache_sorted,
+            "read_tess_model_cached keeps the order of sorted models");
+    failed += mu_run_test(test_model_cache_foreign,
+            "read_tess_model_cached doesn't replace other files");
+#if defined(__unix__) || defined(__APPLE__)
+    failed += mu_run_test(test_model_cache_edit,
+            "read_tess_model_cached sees edits anywhere in the model file");
+#endif
+    return failed;
+}
@@ -0,0 +1,135 @@
+/*
+Unit tests for parker.c functions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../src/lib/grav_prism.h"
+#include "../src/lib/parker.h"
+#include "../src/lib/geometry.h"
+
+
+/* Make a grid of 32 x 32 cells of 2 layers. The top of the first layer and the
+interface between them have relief. Given in a shuffled order. */
+static void make_parker_test_model(PRISM *model)
+{
+    int i, j, k;
+
+    for(i = 0; i < 32; i++)
+    {
+        for(j = 0; j < 32; j++)
+        {
+            k = 2*((7*(i*32 + j)) % 1024);
+            model[k].x1 = 5000 + 1000*i;
+            model[k].x2 = model[k].x1 + 1000;
+            model[k].y1 = -8000 + 1000*j;
+            model[k].y2 = model[k].y1 + 1000;
+            model[k].z1 = -300*sin(0.3*i)*cos(0.2*j);
+            model[k].z2 = 1000 + 100*cos(0.5*i);
+            model[k].density = 2670 + 10*j;
+            model[k + 1] = model[k];
+            model[k + 1].z1 = model[k].z2;
+            model[k + 1].z2 = 1500;
+            model[k + 1].density = -300;
+        }
+    }
+}
+
+
+static char * test_prism_grid_from_model()
+{
+    PRISM *model;
+    PRISM_GRID *grid;
+    int i, j;
+
+    model = (PRISM *)malloc(2048*sizeof(PRISM));
+    mu_assert(model != NULL, "failed to allocate the model");
+    make_parker_test_model(model);
+    grid = prism_grid_from_model(model, 2048);
+    mu_assert(grid != NULL, "failed to make the grid");
+    sprintf(msg, "grid %d x %d x %d of %g x %g at %g, %g", grid->nx,
+            grid->ny, grid->nlayers, grid->dx, grid->dy, grid->x1, grid->y1);
+    mu_assert(grid->nx == 32 && grid->ny == 32 && grid->nlayers == 2 &&
+              grid->dx == 1000 && grid->dy == 1000 && grid->x1 == 5000 &&
+              grid->y1 == -8000, msg);
+    for(i = 0; i < 32; i++)
+    {
+        for(j = 0; j < 32; j++)
+        {
+            sprintf(msg, "wrong layers in cell %d, %d", i, j);
+            mu_assert(grid->top[i*32 + j] == -300*sin(0.3*i)*cos(0.2*j) &&
+                      grid->bottom[i*32 + j] == grid->top[1024 + i*32 + j] &&
+                      grid->bottom[1024 + i*32 + j] == 1500 &&
+                      grid->density[i*32 + j] == 2670 + 10*j &&
+                      grid->density[1024 + i*32 + j] == -300, msg);
+        }
+    }
+    free_prism_grid(grid);
+    /* Not a full grid */
+    mu_assert(prism_grid_from_model(model, 2047) == NULL,
+              "accepted a model with a missing prism");
+    /* A prism out of the grid */
+    model[10].x1 += 500;
+    model[10].x2 += 500;
+    mu_assert(prism_grid_from_model(model, 2048) == NULL,
+              "accepted a prism out of the grid");
+    free(model);
+    return 0;
+}
+
+
+static char * test_parker_prism()
+{
+    PRISM *model;
+    PRISM_GRID *grid;
+    double gz[1024], gzz[1024], x, y, expect_gz, expect_gzz, height = 500;
+    int i, j, k;
+
+    model = (PRISM *)malloc(2048*sizeof(PRISM));
+    mu_assert(model != NULL, "failed to allocate the model");
+    make_parker_test_model(model);
+    grid = prism_grid_from_model(model, 2048);
+    mu_assert(grid != NULL, "failed to make the grid");
+    mu_assert(parker_gz_gzz(grid, 100, 4, 2, gz, gzz) != 0,
+              "accepted points below the top of the model");
+    mu_assert(parker_gz_gzz(grid, height, 6, 4, gz, gzz) == 0,
+              "parker_gz_gzz failed");
+    /* Compare with the prisms away from the edges of the grid. Padding 4
+     * times keeps the copies of the model far away. */
+    for(i = 8; i < 24; i += 3)
+    {
+        for(j = 8; j < 24; j += 3)
+        {
+            x = 5000 + 1000*(i + 0.5);
+            y = -8000 + 1000*(j + 0.5);
+            expect_gz = 0;
+            expect_gzz = 0;
+            for(k = 0; k < 2048; k++)
+            {
+                expect_gz += prism_gz(model[k], x, y, -height);
+                expect_gzz += prism_gzz(model[k], x, y, -height);
+            }
+            sprintf(msg, "gz at %d, %d: expect %g got %g", i, j, expect_gz,
+                    gz[i*32 + j]);
+            mu_assert_almost_equals_rel(gz[i*32 + j], expect_gz, 0.5, msg);
+            sprintf(msg, "gzz at %d, %d: expect %g got %g", i, j, expect_gzz,
+                    gzz[i*32 + j]);
+            mu_assert_almost_equals(gzz[i*32 + j], expect_gzz, 5, msg);
+        }
+    }
+    free_prism_grid(grid);
+    free(model);
+    return 0;
+}
+
+
+int parker_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_prism_grid_from_model,
+        "prism_grid_from_model arranges a prism model in a grid");
+    failed += mu_run_test(test_parker_prism,
+        "parker_gz_gzz results close to the prisms inside the grid");
+    return failed;
+}
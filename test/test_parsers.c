@@ -3,6 +3,8 @@ Unit tests for I/O parser functions.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "minunit.h"
 #include "../src/lib/parsers.h"
@@ -217,6 +219,305 @@ static char * test_gets_prism_fail()
 }
 
 
+static char * test_read_tess_grid()
+{
+    /* Grid points out of order. The second layer of one point is empty */
+    const char *lines[4] = {
+        "1.5 10.5 100 1000 2670 2000 3000\n",
+        "0.5 10.5 0 1000 2000 2000 3100\n",
+        "# a comment\n",
+        "0.5 11.5 -100 500 1000 0 3200\n"};
+    double w[3] = {0.5, 1.5, 0.5}, s[3] = {10.5, 10.5, 11.5},
+           top[3] = {0, 100, -100}, thick[3][2] = {{1000, 2000},
+           {1000, 2000}, {500, 0}}, dens[3][2] = {{2000, 3100}, {2670, 3000},
+           {1000, 3200}}, r;
+    int cells[3] = {0, 1, 2}, i, l;
+    FILE *gridfile;
+    TESS_GRID *grid;
+
+    gridfile = tmpfile();
+    if(gridfile == NULL)
+        mu_assert(0, "failed to create temporary file");
+    for(i = 0; i < 4; i++)
+    {
+        fputs(lines[i], gridfile);
+    }
+    /* Add the missing point last */
+    fputs("1.5 11.5 0 1000 2000 2000 3100\n", gridfile);
+    rewind(gridfile);
+    grid = read_tess_grid(gridfile, 1, 1);
+    fclose(gridfile);
+    mu_assert(grid != NULL, "read_tess_grid failed");
+    sprintf(msg, "wrong grid size: %d x %d x %d", grid->nlon, grid->nlat,
+            grid->nlayers);
+    mu_assert(grid->nlon == 2 && grid->nlat == 2 && grid->nlayers == 2, msg);
+    sprintf(msg, "wrong grid origin: w %g s %g", grid->w, grid->s);
+    mu_assert(grid->w == 0 && grid->s == 10, msg);
+    for(i = 0; i < 3; i++)
+    {
+        sprintf(msg, "wrong cell %d", cells[i]);
+        mu_assert(grid->w + (cells[i] % 2) + 0.5 == w[i] &&
+                  grid->s + (cells[i] / 2) + 0.5 == s[i], msg);
+        r = top[i] + MEAN_EARTH_RADIUS;
+        for(l = 0; l < 2; l++)
+        {
+            sprintf(msg, "cell %d layer %d: top %g bottom %g density %g",
+                    cells[i], l, grid->radii[cells[i]*3 + l],
+                    grid->radii[cells[i]*3 + l + 1],
+                    grid->density[cells[i]*2 + l]);
+            mu_assert(grid->radii[cells[i]*3 + l] == r, msg);
+            r -= thick[i][l];
+            mu_assert(grid->radii[cells[i]*3 + l + 1] == r, msg);
+            mu_assert(grid->density[cells[i]*2 + l] == dens[i][l], msg);
+        }
+    }
+    free_tess_grid(grid);
+    return 0;
+}
+
+
+static char * test_read_tess_model()
+{
+    FILE *modelfile;
+    TESSEROID *model;
+    long size;
+    int i;
+
+    /* A large file with comments and a tesseroid with zero volume */
+    modelfile = tmpfile();
+    if(modelfile == NULL)
+        mu_assert(0, "failed to create temporary file");
+    fputs("# a comment\n", modelfile);
+    for(i = 0; i < 30000; i++)
+    {
+        fprintf(modelfile, "%d %d -10 10 0 -%d 2670\n", i, i + 1, i + 1);
+        if(i == 1000)
+        {
+            fputs("\n0 1 0 1 0 0 2000\n", modelfile);
+        }
+    }
+    fputs("0 1 0 1 0 -1 1000", modelfile);
+    rewind(modelfile);
+    model = read_tess_model(modelfile, &size);
+    fclose(modelfile);
+    mu_assert(model != NULL, "read_tess_model failed");
+    sprintf(msg, "read %ld tesseroids. Expected 30001", size);
+    mu_assert(size == 30001, msg);
+    for(i = 0; i < 30000; i++)
+    {
+        sprintf(msg, "wrong tesseroid %d: w %g e %g r1 %g", i, model[i].w,
+                model[i].e, model[i].r1);
+        mu_assert(model[i].w == i && model[i].e == i + 1 &&
+                  model[i].r1 == MEAN_EARTH_RADIUS - (i + 1) &&
+                  model[i].density == 2670, msg);
+    }
+    mu_assert(model[30000].density == 1000, "wrong last tesseroid");
+    free(model);
+
+    /* A bad line makes the whole model fail */
+    modelfile = tmpfile();
+    if(modelfile == NULL)
+        mu_assert(0, "failed to create temporary file");
+    fputs("0 1 0 1 0 -1 1000\n1 0 0 1 0 -1 1000\n", modelfile);
+    rewind(modelfile);
+    model = read_tess_model(modelfile, &size);
+    fclose(modelfile);
+    mu_assert(model == NULL, "read_tess_model didn't fail for w > e");
+
+    /* A file with only comments has no model to free */
+    modelfile = tmpfile();
+    if(modelfile == NULL)
+        mu_assert(0, "failed to create temporary file");
+    fputs("# only a comment\n\n", modelfile);
+    rewind(modelfile);
+    model = read_tess_model(modelfile, &size);
+    fclose(modelfile);
+    sprintf(msg, "read %ld tesseroids from an empty model", size);
+    mu_assert(size == 0, msg);
+    mu_assert(model == NULL, "read_tess_model allocated an empty model");
+    return 0;
+}
+
+
+static char * test_scan_doubles()
+{
+    int i, j, nread, nchars;
+    char str[100], *end;
+    double values[3], expect;
+    const char *numbers[] = {"0", "-0", "1", "-20", "+3.5", ".5", "5.",
+        "6.67e-11", "1E22", "1e23", "123456789012345", "1234567890123456789",
+        "0.1", "0.30000000000000004", "2.2250738585072014e-308", "4.9e-324",
+        "1.7976931348623157e308", "1e400", "0x1p3", "inf", "-nan", "1e",
+        "1e+", "7.25e-3x", "0000000000000000000012.5", "3.14159265358979",
+        "6378137.0", "-89.999999999", "1.5.5", "100000000000000000000000"};
+
+    for(i = 0; i < (int)(sizeof(numbers)/sizeof(numbers[0])); i++)
+    {
+        nread = scan_doubles(numbers[i], values, 1, &nchars);
+        expect = strtod(numbers[i], &end);
+        sprintf(msg, "(%s) read %d values", numbers[i], nread);
+        mu_assert(nread == 1, msg);
+        sprintf(msg, "(%s) used %d characters, strtod used %d", numbers[i],
+                nchars, (int)(end - numbers[i]));
+        mu_assert(nchars == (int)(end - numbers[i]), msg);
+        sprintf(msg, "(%s) read %.17g, strtod read %.17g", numbers[i],
+                values[0], expect);
+        mu_assert(values[0] == expect || (values[0] != values[0] &&
+                  expect != expect), msg);
+    }
+    /* Numbers printed with different precisions */
+    for(i = 0; i < 1000; i++)
+    {
+        for(j = 1; j <= 17; j++)
+        {
+            sprintf(str, "%.*g", j, (i - 500.3)*pow(10, i%40 - 20)/7.);
+            scan_doubles(str, values, 1, &nchars);
+            expect = strtod(str, &end);
+            sprintf(msg, "(%s) read %.17g, strtod read %.17g", str,
+                    values[0], expect);
+            mu_assert(values[0] == expect, msg);
+        }
+    }
+    nread = scan_doubles("  1.5\t-2e3 7 8", values, 3, &nchars);
+    sprintf(msg, "read %d values with %d characters", nread, nchars);
+    mu_assert(nread == 3 && nchars == 12, msg);
+    mu_assert(values[0] == 1.5 && values[1] == -2000 && values[2] == 7,
+              "wrong values for white space separated numbers");
+    nread = scan_doubles("1.5 bla 3", values, 3, &nchars);
+    sprintf(msg, "read %d values from bad input", nread);
+    mu_assert(nread == 1 && nchars == 3, msg);
+    return 0;
+}
+
+
+static char * test_format_double()
+{
+    int i, j, len;
+    char str[100], expect[100];
+    double value;
+    double numbers[] = {0, -0.0, 1, -20, 0.5, 1.5, 2.5, 0.1, 6.67e-11,
+        6378137, 1e15, 1e21, 999999999999999.5, 0.0001234, 1e-5,
+        9.9999999999999995e-5, 1.7976931348623157e308, 4.9e-324, -89.999999999,
+        123456.789, 0.125, 1e100};
+
+    for(i = 0; i < (int)(sizeof(numbers)/sizeof(numbers[0])); i++)
+    {
+        for(j = 1; j <= 17; j++)
+        {
+            len = format_double(str, numbers[i], j);
+            sprintf(expect, "%.*g", j, numbers[i]);
+            sprintf(msg, "(%.17g with %d digits) '%s' expected '%s'",
+                    numbers[i], j, str, expect);
+            mu_assert(strcmp(str, expect) == 0, msg);
+            mu_assert(len == (int)strlen(str), "wrong length returned");
+        }
+    }
+    for(i = 0; i < 2000; i++)
+    {
+        value = (i - 1000.3)*pow(10, i%40 - 20)/7.;
+        for(j = 1; j <= 17; j++)
+        {
+            format_double(str, value, j);
+            sprintf(expect, "%.*g", j, value);
+            sprintf(msg, "(%.17g with %d digits) '%s' expected '%s'", value,
+                    j, str, expect);
+            mu_assert(strcmp(str, expect) == 0, msg);
+        }
+    }
+    return 0;
+}
+
+
+static char * test_points_grid()
+{
+    POINTS_GRID_ARGS grid;
+    double point[3], lonend = 0, latend = 0;
+    int i, j;
+
+    grid.parsed = 0;
+    mu_assert(check_points_grid_args(&grid) == 0, "no grid should be valid");
+    mu_assert(parse_points_grid_arg("-r-10/20/5/8", &grid) == 0,
+              "failed to parse -r");
+    mu_assert(check_points_grid_args(&grid) == 1,
+              "-r without -b and -z should fail");
+    mu_assert(parse_points_grid_arg("-r1/2/3/4", &grid) == 1,
+              "repeated -r should fail");
+    mu_assert(parse_points_grid_arg("-b4/3x", &grid) == 1,
+              "bad -b should fail");
+    grid.parsed = 1;
+    mu_assert(parse_points_grid_arg("-b31/7", &grid) == 0,
+              "failed to parse -b");
+    mu_assert(parse_points_grid_arg("-z250.5", &grid) == 0,
+              "failed to parse -z");
+    mu_assert(check_points_grid_args(&grid) == 0, "full grid should be valid");
+    mu_assert(grid.w == -10 && grid.e == 20 && grid.s == 5 && grid.n == 8 &&
+              grid.nlon == 31 && grid.nlat == 7 && grid.height == 250.5,
+              "wrong grid values parsed");
+    for(j = 0; j < grid.nlat; j++)
+    {
+        for(i = 0; i < grid.nlon; i++)
+        {
+            points_grid_point(&grid, i + j*grid.nlon, point);
+            sprintf(msg, "point %d %d: %g %g %g", i, j, point[0], point[1],
+                    point[2]);
+            mu_assert(fabs(point[0] - (-10 + i)) < 1e-12, msg);
+            mu_assert(fabs(point[1] - (5 + 0.5*j)) < 1e-12, msg);
+            mu_assert(point[2] == 250.5, msg);
+            if(i == grid.nlon - 1)
+                lonend = point[0];
+            if(j == grid.nlat - 1)
+                latend = point[1];
+        }
+    }
+    mu_assert(lonend == 20 && latend == 8, "borders of the grid moved");
+    return 0;
+}
+
+
+static void no_help()
+{
+}
+
+
+static char * test_basic_args()
+{
+    char *argv[] = {"prismggts", "model.txt", "-j4", "-sgxx,gzz", "-p8",
+                    "-c2000"},
+         *bad[] = {"prismggts", "model.txt", "-j0", "-s"},
+         *repeated[] = {"prismggts", "model.txt", "-j2", "-j3"};
+    BASIC_ARGS args;
+
+    mu_assert(parse_basic_args(2, argv, "prismggts", &args, &no_help) == 0,
+              "failed to parse the model file");
+    mu_assert(args.nthreads == 0 && args.components == NULL &&
+              args.cutoff == 0, "wrong default threads, components or cutoff");
+    mu_assert(parse_basic_args(6, argv, "prismggts", &args, &no_help) == 0,
+              "failed to parse -j, -s and -c");
+    mu_assert(args.nthreads == 4 && strcmp(args.components, "gxx,gzz") == 0 &&
+              args.precision == 8 && args.cutoff == 2000,
+              "wrong threads, components, precision or cutoff");
+    mu_assert(parse_basic_args(4, bad, "prismggts", &args, &no_help) == 1,
+              "bad -j and -s should fail");
+    mu_assert(parse_basic_args(4, repeated, "prismggts", &args,
+                               &no_help) == 1, "repeated -j should fail");
+    return 0;
+}
+
+
+static char * test_format_doubles()
+{
+    double values[] = {1.5, -20, 6.67e-11};
+    char str[100];
+
+    format_doubles(msg, values, 3, 15);
+    mu_assert(format_doubles(str, values, 3, 15) == 16 &&
+              strcmp(str, "1.5 -20 6.67e-11") == 0, msg);
+    mu_assert(format_doubles(str, values, 0, 15) == 0 && str[0] == '\0',
+              "should be empty");
+    return 0;
+}
+
+
 int parsers_run_all()
 {
     int failed = 0;
@@ -225,5 +526,19 @@ int parsers_run_all()
     failed += mu_run_test(test_gets_prism_sph,
                 "gets_prism_sph reads correctly from string");
     failed += mu_run_test(test_gets_prism_fail, "gets_prism fails for bad input");
+    failed += mu_run_test(test_read_tess_grid,
+                "read_tess_grid reads a grid of layers out of order");
+    failed += mu_run_test(test_read_tess_model,
+                "read_tess_model reads a large file with comments");
+    failed += mu_run_test(test_scan_doubles,
+                "scan_doubles gives the same results as strtod");
+    failed += mu_run_test(test_format_double,
+                "format_double gives the same results as sprintf");
+    failed += mu_run_test(test_points_grid,
+                "parse and make the points of a grid given with -r/-b/-z");
+    failed += mu_run_test(test_format_doubles,
+                "format_doubles separates the numbers with spaces");
+    failed += mu_run_test(test_basic_args,
+                "parse the threads and the output components of prism programs");
     return failed;
 }
@@ -0,0 +1,239 @@
+/*
+Unit tests for prism_index.c functions.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "../src/lib/prism_index.h"
+#include "../src/lib/grav_prism.h"
+#include "../src/lib/grav_prism_sph.h"
+#include "../src/lib/constants.h"
+#include "../src/lib/geometry.h"
+
+
+/* Make a model of 20 x 20 prisms of 100 m in a scrambled order */
+static void make_index_test_model(PRISM *model)
+{
+    int i, j, k;
+
+    for(k = 0; k < 400; k++)
+    {
+        /* 157 and 400 have no common factors, so this visits all cells */
+        i = ((157*k) % 400)/20;
+        j = ((157*k) % 400) % 20;
+        model[k].density = 2000 + 10*k;
+        model[k].x1 = 100*i;
+        model[k].x2 = model[k].x1 + 100;
+        model[k].y1 = -1000 + 100*j;
+        model[k].y2 = model[k].y1 + 100;
+        model[k].z1 = 10*(k % 7);
+        model[k].z2 = model[k].z1 + 200 + k;
+        model[k].lon = 0;
+        model[k].lat = 0;
+        model[k].r = 0;
+    }
+}
+
+
+static char * test_prism_index_tiles()
+{
+    PRISM model[400], copy[400];
+    PRISM_INDEX *index;
+    PRISM_TILE *tile;
+    double mass, expect = 0, x, y, dist;
+    int t, i, k, next = 0;
+
+    make_index_test_model(model);
+    for(k = 0; k < 400; k++)
+    {
+        copy[k] = model[k];
+        expect += model[k].density*(model[k].x2 - model[k].x1)*
+                  (model[k].y2 - model[k].y1)*(model[k].z2 - model[k].z1);
+    }
+    index = new_prism_index(model, 400, 0, 500);
+    mu_assert(index != NULL, "new_prism_index failed");
+    sprintf(msg, "%d tiles instead of 16", index->ntiles);
+    mu_assert(index->ntiles == 16, msg);
+    mass = 0;
+    for(t = 0; t < index->ntiles; t++)
+    {
+        tile = &index->tiles[t];
+        sprintf(msg, "tile %d starts at %d instead of %d", t, tile->start,
+                next);
+        mu_assert(tile->start == next, msg);
+        next += tile->size;
+        mu_assert(tile->hasmass, "tile without mass");
+        mass += tile->far.density*(tile->far.x2 - tile->far.x1)*
+                (tile->far.y2 - tile->far.y1)*(tile->far.z2 - tile->far.z1);
+        for(i = tile->start; i < tile->start + tile->size; i++)
+        {
+            /* The corners of the prisms are inside the circle of the tile */
+            x = fabs(model[i].x1 - tile->a) > fabs(model[i].x2 - tile->a) ?
+                model[i].x1 : model[i].x2;
+            y = fabs(model[i].y1 - tile->b) > fabs(model[i].y2 - tile->b) ?
+                model[i].y1 : model[i].y2;
+            dist = prism_tile_distance(tile, 0, x, y);
+            sprintf(msg, "prism %d is %g m outside of tile %d", i, dist, t);
+            mu_assert(dist <= 1e-9, msg);
+        }
+    }
+    mu_assert(next == 400, "the tiles don't have all prisms");
+    sprintf(msg, "mass of the tiles %g expected %g", mass, expect);
+    mu_assert_almost_equals_rel(mass, expect, 1e-10, msg);
+    /* The prisms were only reordered */
+    for(k = 0; k < 400; k++)
+    {
+        for(i = 0; i < 400; i++)
+        {
+            if(model[i].density == copy[k].density)
+            {
+                break;
+            }
+        }
+        sprintf(msg, "prism %d is missing", k);
+        mu_assert(i < 400 && model[i].x1 == copy[k].x1 &&
+                  model[i].y1 == copy[k].y1 && model[i].z2 == copy[k].z2,
+                  msg);
+    }
+    free_prism_index(index);
+    return 0;
+}
+
+
+static char * test_prism_index_far()
+{
+    PRISM model[400];
+    PRISM_INDEX *index;
+    PRISM_TILE *tile;
+    double expect, res, x, y;
+    int t, i;
+
+    make_index_test_model(model);
+    index = new_prism_index(model, 400, 0, 500);
+    mu_assert(index != NULL, "new_prism_index failed");
+    for(t = 0; t < index->ntiles; t++)
+    {
+        tile = &index->tiles[t];
+        /* A point 10 times the radius of the tile away */
+        x = tile->a + 8*tile->radius;
+        y = tile->b - 6*tile->radius;
+        expect = 0;
+        for(i = tile->start; i < tile->start + tile->size; i++)
+        {
+            expect += prism_gz(model[i], x, y, -100);
+        }
+        res = prism_gz(tile->far, x, y, -100);
+        sprintf(msg, "tile %d: far field %g expected %g", t, res, expect);
+        mu_assert_almost_equals_rel(res, expect, 1, msg);
+    }
+    free_prism_index(index);
+    return 0;
+}
+
+
+static char * test_prism_index_sph()
+{
+    PRISM model[100], prism = {2670, -5000, 5000, -5000, 5000, 0, 3000, 0, 0,
+                               0};
+    PRISM_INDEX *index;
+    PRISM_TILE *tile;
+    double expect[3], res[3], g[3], lon, lat, r, dist;
+    int t, i, k, c;
+
+    /* 10 x 10 prisms of 10 km */
+    prism.r = MEAN_EARTH_RADIUS;
+    for(k = 0; k < 100; k++)
+    {
+        model[k] = prism;
+        model[k].lon = 30 + 0.09*(k % 10);
+        model[k].lat = -20 + 0.09*(k/10);
+        model[k].density = 2670 + k;
+    }
+    index = new_prism_index(model, 100, 1, 30000);
+    mu_assert(index != NULL, "new_prism_index failed");
+    mu_assert(index->ntiles > 1 && index->ntiles <= 16,
+              "wrong number of tiles");
+    for(t = 0; t < index->ntiles; t++)
+    {
+        tile = &index->tiles[t];
+        for(i = tile->start; i < tile->start + tile->size; i++)
+        {
+            dist = prism_tile_distance(tile, 1, model[i].lon, model[i].lat);
+            sprintf(msg, "prism %d is %g m outside of tile %d", i, dist, t);
+            mu_assert(dist <= -5000, msg);
+        }
+        /* A point 5 degrees away */
+        lon = tile->a + 3;
+        lat = tile->b + 4;
+        r = MEAN_EARTH_RADIUS + 1000;
+        sprintf(msg, "distance to tile %d is %g m", t,
+                prism_tile_distance(tile, 1, lon, lat));
+        mu_assert(prism_tile_distance(tile, 1, lon, lat) > 500000, msg);
+        for(c = 0; c < 3; c++)
+        {
+            expect[c] = 0;
+        }
+        for(i = tile->start; i < tile->start + tile->size; i++)
+        {
+            prism_g_sph(model[i], lon, lat, r, &g[0], &g[1], &g[2]);
+            for(c = 0; c < 3; c++)
+            {
+                expect[c] += g[c];
+            }
+        }
+        prism_g_sph(tile->far, lon, lat, r, &res[0], &res[1], &res[2]);
+        for(c = 0; c < 3; c++)
+        {
+            sprintf(msg, "tile %d component %d: far field %g expected %g", t,
+                    c, res[c], expect[c]);
+            mu_assert_almost_equals_rel(res[c], expect[c], 1, msg);
+        }
+    }
+    free_prism_index(index);
+    return 0;
+}
+
+
+static char * test_prism_index_line()
+{
+    /* Prisms along a single survey line with tiny tiles shouldn't make more
+       buckets than the prisms can fill */
+    PRISM model[400];
+    PRISM_INDEX *index;
+    int t, k, n = 0;
+
+    make_index_test_model(model);
+    for(k = 0; k < 400; k++)
+    {
+        model[k].x1 = 50*k;
+        model[k].x2 = 50*(k + 1);
+        model[k].y1 = 0;
+        model[k].y2 = 50;
+    }
+    index = new_prism_index(model, 400, 0, 0.001);
+    mu_assert(index != NULL, "new_prism_index failed");
+    sprintf(msg, "%d tiles for 400 prisms on a line", index->ntiles);
+    mu_assert(index->ntiles <= 400/16 + 1, msg);
+    for(t = 0; t < index->ntiles; t++)
+    {
+        n += index->tiles[t].size;
+    }
+    mu_assert(n == 400, "the tiles don't have all prisms");
+    free_prism_index(index);
+    return 0;
+}
+
+
+int prism_index_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_prism_index_tiles,
+        "prism index puts every prism in one tile with the mass of the model");
+    failed += mu_run_test(test_prism_index_far,
+        "prism index cubes approximate the tiles far away");
+    failed += mu_run_test(test_prism_index_sph,
+        "prism index of spherical prisms and their far field");
+    failed += mu_run_test(test_prism_index_line,
+        "prism index of prisms on a single line");
+    return failed;
+}
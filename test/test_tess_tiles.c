@@ -0,0 +1,258 @@
+/*
+Unit tests for the binary tiled model files.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "minunit.h"
+#include "../src/lib/tess_tiles.h"
+#include "../src/lib/grav_tess.h"
+#include "../src/lib/glq.h"
+#include "../src/lib/constants.h"
+
+/* To store fail messages */
+char msg[1000];
+
+
+/* Make a model of 4 x 3 columns of 2 layers */
+static void make_tiles_model(TESSEROID *model)
+{
+    int i, j, l, t = 0;
+
+    for(j = 0; j < 3; j++)
+    {
+        for(i = 0; i < 4; i++)
+        {
+            for(l = 0; l < 2; l++)
+            {
+                model[t].w = -10 + 7*i;
+                model[t].e = -3 + 7*i;
+                model[t].s = 20 + 6*j;
+                model[t].n = 26 + 6*j;
+                model[t].r2 = MEAN_EARTH_RADIUS - 10000*l + 100*(i + j);
+                model[t].r1 = MEAN_EARTH_RADIUS - 10000*(l + 1);
+                model[t].density = 2670 + 100*l + 10*t;
+                t++;
+            }
+        }
+    }
+}
+
+
+static char * test_tess_tiles_write_open()
+{
+    const char *fname = "test_tess_tiles.tmp";
+    TESSEROID model[24];
+    TESS_TILED_MODEL *tiled;
+    FILE *file;
+    double mass;
+    long t, i;
+    int rc;
+
+    make_tiles_model(model);
+    file = fopen(fname, "wb");
+    if(file == NULL)
+        mu_assert(0, "failed to create temporary file");
+    rc = write_tess_tiles(file, model, 24, NULL, 10);
+    fclose(file);
+    mu_assert(rc == 0, "write_tess_tiles failed");
+    mu_assert(is_tess_tiles(fname), "is_tess_tiles didn't recognize file");
+    tiled = open_tess_tiles(fname);
+    remove(fname);
+    mu_assert(tiled != NULL, "open_tess_tiles failed");
+    sprintf(msg, "read %ld tesseroids %ld columns instead of 24 and 12",
+            tiled->size, tiled->ncolumns);
+    mu_assert(tiled->size == 24 && tiled->ncolumns == 12, msg);
+    mass = 0;
+    for(t = 0; t < tiled->ntiles; t++)
+    {
+        mass += tiled->tiles[t].mass;
+        sprintf(msg, "tile %ld has %ld tesseroids but %ld columns", t,
+                tiled->tiles[t].size, tiled->tiles[t].ncolumns);
+        mu_assert(tiled->tiles[t].size == 2*tiled->tiles[t].ncolumns, msg);
+    }
+    sprintf(msg, "total mass of the tiles %g instead of %g", mass,
+            tess_total_mass(model, 24));
+    mu_assert_almost_equals_rel(mass, tess_total_mass(model, 24), 1e-10, msg);
+    for(i = 0; i < 24; i++)
+    {
+        t = tiled->order[i];
+        sprintf(msg, "tesseroid %ld has position %ld", i, t);
+        mu_assert(t >= 0 && t < 24 &&
+                  tiled->model[i].density == model[t].density, msg);
+    }
+    close_tess_tiles(tiled);
+    return 0;
+}
+
+
+static char * test_tess_tiles_corrupt()
+{
+    const char *fname = "test_tess_tiles.tmp";
+    TESSEROID model[24];
+    TESS_TILED_MODEL *tiled;
+    FILE *file;
+    long offsets[5], values[5];
+    unsigned long wrap;
+    int i, n, rc;
+
+    make_tiles_model(model);
+    file = fopen(fname, "wb");
+    if(file == NULL)
+        mu_assert(0, "failed to create temporary file");
+    rc = write_tess_tiles(file, model, 24, NULL, 10);
+    fclose(file);
+    mu_assert(rc == 0, "write_tess_tiles failed");
+    tiled = open_tess_tiles(fname);
+    mu_assert(tiled != NULL, "open_tess_tiles failed");
+    mu_assert(tiled->ntiles > 1, "the model should have several tiles");
+    /* Tesseroids past the end of the model, columns past the end of the
+     * columns, negative start and columns out of order */
+    offsets[0] = (char *)&tiled->tiles[1].size - (char *)tiled->data;
+    values[0] = tiled->size;
+    offsets[1] = (char *)&tiled->tiles[0].ncolumns - (char *)tiled->data;
+    values[1] = tiled->ncolumns + 1;
+    offsets[2] = (char *)&tiled->tiles[0].start - (char *)tiled->data;
+    values[2] = -1;
+    offsets[3] = (char *)&tiled->columns[1] - (char *)tiled->data;
+    values[3] = tiled->columns[3];
+    /* A number of tiles that wraps the expected file size around to the
+     * true one, with 64 bit sizes */
+    n = 4;
+    if(sizeof(long) == 8 && sizeof(size_t) == 8)
+    {
+        /* The smallest power of 2 that times the size of a tile is 0 */
+        wrap = 1UL << 63;
+        while((wrap >> 1)*sizeof(TESS_TILE) == 0)
+            wrap >>= 1;
+        if(wrap < (1UL << 63))
+        {
+            offsets[4] = 8;
+            values[4] = tiled->ntiles + (long)wrap;
+            n = 5;
+        }
+    }
+    close_tess_tiles(tiled);
+    for(i = 0; i < n; i++)
+    {
+        file = fopen(fname, "r+b");
+        if(file == NULL)
+        {
+            remove(fname);
+            mu_assert(0, "failed to open temporary file");
+        }
+        rc = fseek(file, offsets[i], SEEK_SET) != 0 ||
+             fwrite(&values[i], sizeof(long), 1, file) != 1;
+        fclose(file);
+        if(rc)
+        {
+            remove(fname);
+            mu_assert(0, "failed to change temporary file");
+        }
+        tiled = open_tess_tiles(fname);
+        if(tiled != NULL)
+        {
+            close_tess_tiles(tiled);
+            remove(fname);
+            sprintf(msg, "opened model with corrupted value %d", i);
+            mu_assert(0, msg);
+        }
+        /* Put back the original file for the next value */
+        file = fopen(fname, "wb");
+        if(file == NULL)
+            mu_assert(0, "failed to create temporary file");
+        write_tess_tiles(file, model, 24, NULL, 10);
+        fclose(file);
+    }
+    remove(fname);
+    return 0;
+}
+
+
+static char * test_calc_tess_tiles()
+{
+    const char *fname = "test_tess_tiles.tmp";
+    TESSEROID model[24];
+    TESS_TILED_MODEL *tiled;
+    GLQ *glqlon, *glqlat, *glqr;
+    FILE *file;
+    long columns[25], ncolumns;
+    double restiles, resmodel, lon, lat, height;
+
+    make_tiles_model(model);
+    ncolumns = tess_find_columns(model, 24, columns);
+    file = fopen(fname, "wb");
+    if(file == NULL)
+        mu_assert(0, "failed to create temporary file");
+    write_tess_tiles(file, model, 24, NULL, 10);
+    fclose(file);
+    tiled = open_tess_tiles(fname);
+    remove(fname);
+    mu_assert(tiled != NULL, "open_tess_tiles failed");
+
+    glqlon = glq_new(2, -1, 1);
+    if(glqlon == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqlat = glq_new(2, -1, 1);
+    if(glqlat == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    glqr = glq_new(2, -1, 1);
+    if(glqr == NULL)
+        mu_assert(0, "GLQ allocation error");
+
+    for(height = 10000; height <= 100000; height += 45000)
+    {
+        for(lon = -10; lon <= 20; lon += 10)
+        {
+            for(lat = 20; lat <= 40; lat += 10)
+            {
+                resmodel = calc_tess_model_columns_adapt(model, columns,
+                            ncolumns, lon, lat, height + MEAN_EARTH_RADIUS,
+                            glqlon, glqlat, glqr, tess_gz_column,
+                            TESSEROID_GZ_SIZE_RATIO);
+                restiles = calc_tess_tiles(tiled, lon, lat,
+                            height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                            tess_gz, tess_gz_column, 1,
+                            TESSEROID_GZ_SIZE_RATIO, 0);
+                sprintf(msg, "(lon %g lat %g height %g) tiles = %.10f  "
+                        "model = %.10f", lon, lat, height, restiles,
+                        resmodel);
+                mu_assert_almost_equals_rel(restiles, resmodel, 1e-8, msg);
+            }
+        }
+    }
+    /* Far away the tiles can be replaced by their aggregates */
+    lon = 100;
+    lat = -30;
+    height = 100000;
+    resmodel = calc_tess_model_columns_adapt(model, columns, ncolumns, lon,
+                lat, height + MEAN_EARTH_RADIUS, glqlon, glqlat, glqr,
+                tess_gz_column, TESSEROID_GZ_SIZE_RATIO);
+    restiles = calc_tess_tiles(tiled, lon, lat, height + MEAN_EARTH_RADIUS,
+                glqlon, glqlat, glqr, tess_gz, tess_gz_column, 1,
+                TESSEROID_GZ_SIZE_RATIO, 2);
+    sprintf(msg, "(far away) tiles = %.10f  model = %.10f", restiles,
+            resmodel);
+    mu_assert_almost_equals_rel(restiles, resmodel, 1, msg);
+
+    close_tess_tiles(tiled);
+    glq_free(glqlon);
+    glq_free(glqlat);
+    glq_free(glqr);
+    return 0;
+}
+
+
+int tess_tiles_run_all()
+{
+    int failed = 0;
+    failed += mu_run_test(test_tess_tiles_write_open,
+            "write_tess_tiles and open_tess_tiles keep the model");
+    failed += mu_run_test(test_tess_tiles_corrupt,
+            "open_tess_tiles rejects tiles outside of the model");
+    failed += mu_run_test(test_calc_tess_tiles,
+            "calc_tess_tiles results as calc_tess_model_columns_adapt");
+    return failed;
+}
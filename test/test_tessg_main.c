@@ -0,0 +1,125 @@
+/*
+Unit tests for the pipeline of tessg_main.c. Uses redirect_stdio(),
+restore_stdio() and read_text_file() of test_batch_calc.c.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minunit.h"
+#include "../src/lib/logger.h"
+#include "../src/lib/grav_tess.h"
+#include "../src/lib/tessg_main.h"
+
+
+#if defined(__unix__) || defined(__APPLE__)
+static char * test_tessg_main_threads()
+{
+    const char *modelname = "test_tessg_main_model.tmp",
+               *inname = "test_tessg_main.tmp",
+               *outnames[3] = {"test_tessg_main_1.tmp",
+                               "test_tessg_main_4.tmp",
+                               "test_tessg_main_sort.tmp"};
+    char *argv[3][4] = {{"tessgz", NULL, "-j1", NULL},
+                        {"tessgz", NULL, "-j4", NULL},
+                        {"tessgz", NULL, "-j4", "--sort"}};
+    int argc[3] = {3, 3, 4}, saved[2], rc, t, i, j;
+    char *out[3], *body[3], *line, expect[100];
+    FILE *file;
+
+    /* A model of 30 x 30 x 3 tesseroids */
+    file = fopen(modelname, "w");
+    mu_assert(file != NULL, "couldn't write the model file");
+    for(i = 0; i < 30; i++)
+    {
+        for(j = 0; j < 30; j++)
+        {
+            fprintf(file, "%d %d %d %d 0 -1000 2670\n", i, i + 1, j, j + 1);
+            fprintf(file, "%d %d %d %d -1000 -5000 2900\n", i, i + 1, j,
+                    j + 1);
+            fprintf(file, "%d %d %d %d -5000 -20000 3300\n", i, i + 1, j,
+                    j + 1);
+        }
+    }
+    fclose(file);
+    /* Several batches of points with comments, blank lines and a bad line */
+    file = fopen(inname, "w");
+    mu_assert(file != NULL, "couldn't write the input file");
+    fprintf(file, "# points on a line\n");
+    for(i = 0; i < 5*128; i++)
+    {
+        if(i == 100)
+        {
+            fprintf(file, "\n# second part\n");
+        }
+        if(i == 300)
+        {
+            fprintf(file, "not a point\n");
+        }
+        fprintf(file, "%g 15 %d\n", 0.05*i, 50000 + 100*(i % 10));
+    }
+    fclose(file);
+    for(t = 0; t < 3; t++)
+    {
+        argv[t][1] = (char *)modelname;
+        mu_assert(redirect_stdio(inname, outnames[t], saved) == 0,
+                  "couldn't redirect stdin and stdout");
+        rc = run_tessg_main(argc[t], argv[t], "tessgz", &tess_gz,
+                            &tess_gz_column, TESSEROID_GZ_SIZE_RATIO);
+        restore_stdio(saved);
+        /* run_tessg_main sets the log level */
+        log_init(LOG_INFO);
+        sprintf(msg, "run %d failed", t);
+        mu_assert(rc == 0, msg);
+        out[t] = read_text_file(outnames[t]);
+        mu_assert(out[t] != NULL, "couldn't read the output");
+        /* Leave out the header up to the local time, which can change */
+        body[t] = strstr(out[t], "local time");
+        mu_assert(body[t] != NULL, "no local time in the header");
+        body[t] = strchr(body[t], '\n');
+        mu_assert(body[t] != NULL, "header ends in the local time");
+    }
+    mu_assert(strcmp(body[0], body[1]) == 0,
+              "results with 1 and 4 threads are different");
+    mu_assert(strcmp(body[0], body[2]) == 0,
+              "results with and without --sort are different");
+    /* The output is in the order of the input */
+    line = strstr(body[0], "# points on a line\n");
+    mu_assert(line != NULL, "first comment not echoed");
+    line += 19;
+    for(i = 0; i < 5*128 && line != NULL; i++)
+    {
+        if(i == 100)
+        {
+            mu_assert(strncmp(line, "\n# second part\n", 15) == 0,
+                      "blank line and comment not echoed in place");
+            line += 15;
+        }
+        sprintf(expect, "%g 15 %d ", 0.05*i, 50000 + 100*(i % 10));
+        sprintf(msg, "point %d out of order: %.40s", i, line);
+        mu_assert(strncmp(line, expect, strlen(expect)) == 0, msg);
+        line = strchr(line, '\n');
+        line = line == NULL ? NULL : line + 1;
+    }
+    mu_assert(line != NULL && *line == '\0', "wrong number of lines");
+    for(t = 0; t < 3; t++)
+    {
+        free(out[t]);
+        remove(outnames[t]);
+    }
+    remove(modelname);
+    remove(inname);
+    return 0;
+}
+#endif
+
+
+int tessg_main_run_all()
+{
+    int failed = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    failed += mu_run_test(test_tessg_main_threads,
+        "tessgz gives the same output in input order for any -j and --sort");
+#endif
+    return failed;
+}